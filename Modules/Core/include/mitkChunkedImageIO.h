@@ -0,0 +1,83 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKCHUNKEDIMAGEIO_H
+#define MITKCHUNKEDIMAGEIO_H
+
+#include "mitkAbstractFileIO.h"
+
+namespace mitk
+{
+  class Image;
+
+  /**
+   * @ingroup IO
+   * @brief Reader and writer for the native MITK image format (*.mitkimage).
+   *
+   * The pixel data is split into chunks of whole slices that never span two time steps.
+   * Each chunk is deflated independently with a fast compression level (writer option
+   * OPTION_COMPRESSION_LEVEL(), 0 stores the chunks uncompressed), so chunks are compressed
+   * and decompressed by several threads in parallel.
+   *
+   * Since every chunk is decodable on its own, the reader options OPTION_TIME_STEP(),
+   * OPTION_FIRST_SLICE() and OPTION_NUMBER_OF_SLICES() load a single time step and/or a slab
+   * of slices by reading only the chunks that overlap it. The geometry of the resulting
+   * image is shifted accordingly.
+   *
+   * Images with a ProportionalTimeGeometry or an ArbitraryTimeGeometry, up to four dimensions
+   * and a single channel are supported.
+   */
+  class MITKCORE_EXPORT ChunkedImageIO : public AbstractFileIO
+  {
+  public:
+    ChunkedImageIO();
+
+    /** Time step to read (int), -1 reads all time steps. */
+    static std::string OPTION_TIME_STEP();
+
+    /** First slice to read (int). */
+    static std::string OPTION_FIRST_SLICE();
+
+    /** Number of slices to read (int), 0 reads all slices starting at OPTION_FIRST_SLICE(). */
+    static std::string OPTION_NUMBER_OF_SLICES();
+
+    /** zlib compression level of the chunks (int, 0 - 9). */
+    static std::string OPTION_COMPRESSION_LEVEL();
+
+    /** Returns true if @a image can be written in the chunked format, see GetWriterConfidenceLevel(). */
+    static bool CanWriteImage(const Image *image);
+
+    // -------------- AbstractFileReader -------------
+
+    using AbstractFileReader::Read;
+    std::vector<BaseData::Pointer> Read() override;
+
+    ConfidenceLevel GetReaderConfidenceLevel() const override;
+
+    // -------------- AbstractFileWriter -------------
+
+    void Write() override;
+
+    ConfidenceLevel GetWriterConfidenceLevel() const override;
+
+  private:
+    ChunkedImageIO(const ChunkedImageIO &other);
+
+    ChunkedImageIO *IOClone() const override;
+  };
+}
+
+#endif // MITKCHUNKEDIMAGEIO_H
@@ -102,6 +102,8 @@ namespace mitk
     //## (see definition of NodePredicateBase for details).
     //## The method returns a set of SmartPointers to the DataNodes that fulfill the
     //## conditions. A set of all objects can be retrieved with the GetAll() method;
+    //## The condition is only checked for the nodes returned by GetSubsetCandidates(), so storages
+    //## maintaining indexes can answer common queries without visiting all nodes.
     SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const;
 
     //##Documentation
@@ -427,6 +429,13 @@ namespace mitk
     //## @brief Standard Destructor
     ~DataStorage() override;
 
+    //##Documentation
+    //## @brief Returns the nodes GetSubset() checks the condition for
+    //##
+    //## Subclasses may return any subset of GetAll() that contains all nodes fulfilling the condition,
+    //## in the order of GetAll(). The default implementation returns GetAll().
+    virtual SetOfObjects::ConstPointer GetSubsetCandidates(const NodePredicateBase *condition) const;
+
     //##Documentation
     //## @brief Filters a SetOfObjects by the condition. If no condition is provided, the original set is returned
     SetOfObjects::ConstPointer FilterSetOfObjects(const SetOfObjects *set, const NodePredicateBase *condition) const;
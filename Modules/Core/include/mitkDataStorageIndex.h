@@ -0,0 +1,119 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKDATASTORAGEINDEX_H
+#define MITKDATASTORAGEINDEX_H
+
+#include <MitkCoreExports.h>
+
+#include <itkObject.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  class DataNode;
+  class NodePredicateBase;
+
+  /**
+   * \brief Secondary indexes of the nodes of a data storage.
+   *
+   * Nodes are indexed by the class name of their data and by the value (GetValueAsString()) of a set of
+   * property keys, by default "name". Properties are looked up like NodePredicateProperty does without
+   * a renderer, i.e. including the properties of the data.
+   *
+   * GetCandidates() answers NodePredicateDataType and NodePredicateProperty queries on indexed keys, as
+   * well as NodePredicateAnd compositions containing at least one of them, with a superset of the
+   * matching nodes. The caller still has to check the predicate for each candidate.
+   *
+   * The index observes the nodes, the property lists of their data and the indexed properties. Changed
+   * nodes are only marked as dirty, they are re-indexed by the next call of Update().
+   *
+   * Apart from the dirty marking, which may happen on any thread, the index is not synchronized; the
+   * owning data storage has to guard it.
+   *
+   * \sa StandaloneDataStorage
+   */
+  class MITKCORE_EXPORT DataStorageIndex
+  {
+  public:
+    /** \brief List of nodes, sorted by address like the nodes of StandaloneDataStorage::GetAll(). */
+    typedef std::vector<const DataNode *> NodeListType;
+
+    DataStorageIndex();
+    ~DataStorageIndex();
+
+    /** \brief Additionally index the values of the property @a key. Existing nodes are re-indexed by the next Update(). */
+    void AddIndexedPropertyKey(const std::string &key);
+
+    bool IsIndexedPropertyKey(const std::string &key) const;
+
+    void Insert(const DataNode *node);
+    void Remove(const DataNode *node);
+
+    /** \brief Returns true if nodes changed since the last Update(). Thread-safe. */
+    bool HasDirtyNodes() const;
+
+    /** \brief Re-index all nodes that changed since the last Update(). */
+    void Update();
+
+    /** \brief Collect the nodes that may fulfill @a condition.
+     *
+     * \return false if the condition cannot be answered by the index. */
+    bool GetCandidates(const NodePredicateBase *condition, NodeListType &candidates) const;
+
+  private:
+    DataStorageIndex(const DataStorageIndex &) = delete;
+    DataStorageIndex &operator=(const DataStorageIndex &) = delete;
+
+    class InvalidateCommand;
+
+    typedef std::set<const DataNode *> NodeSetType;
+
+    struct Entry
+    {
+      std::string DataType;
+      std::map<std::string, std::string> PropertyValues;
+      std::vector<std::pair<itk::Object::Pointer, unsigned long>> Observers;
+    };
+
+    void MarkDirty(const DataNode *node);
+
+    void IndexNode(const DataNode *node);
+    void UnindexNode(const DataNode *node);
+
+    void Observe(const DataNode *node, const itk::Object *object, Entry &entry);
+
+    std::map<const DataNode *, Entry> m_Entries;
+
+    std::map<std::string, NodeSetType> m_DataTypes;
+
+    /** Property key -> property value -> nodes */
+    std::map<std::string, std::map<std::string, NodeSetType>> m_PropertyValues;
+
+    std::set<std::string> m_IndexedPropertyKeys;
+
+    mutable std::mutex m_DirtyMutex;
+    NodeSetType m_DirtyNodes;
+  };
+}
+
+#endif
@@ -38,8 +38,12 @@ namespace mitk
    *
    * This filter is completely based on ITK compared to the VTK-based
    * mitk::ExtractSliceFilter. It is more robust, easy to use, and produces
-   * an mitk::Image with valid geometry. Generally it is not as fast as
-   * mitk::ExtractSliceFilter, though.
+   * an mitk::Image with valid geometry.
+   *
+   * The output image is split into bands of rows which are processed in
+   * parallel. Nearest neighbor and linear interpolation are evaluated by
+   * pixel-type-specific kernels directly on the input buffer while the
+   * continuous input index is advanced incrementally along each row.
    */
   class MITKCORE_EXPORT ExtractSliceFilter2 final : public ImageToImageFilter
   {
@@ -70,9 +74,9 @@ namespace mitk
     ~ExtractSliceFilter2() override;
 
     void AllocateOutputs() override;
-    // void BeforeThreadedGenerateData() override;
-    // void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
-    void GenerateData() override;
+    void BeforeThreadedGenerateData() override;
+    void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
+    void AfterThreadedGenerateData() override;
     void VerifyInputInformation() override;
 
     struct Impl;
@@ -83,8 +83,10 @@ namespace mitk
 
     static CustomMimeType POINTSET_MIMETYPE();      // mps
     static CustomMimeType GEOMETRY_DATA_MIMETYPE(); // .mitkgeometry
+    static CustomMimeType MITK_IMAGE_MIMETYPE();    // (mitk::Image) mitkimage
 
-    static std::string POINTSET_MIMETYPE_NAME(); // DEFAULT_BASE_NAME.pointset
+    static std::string POINTSET_MIMETYPE_NAME();   // DEFAULT_BASE_NAME.pointset
+    static std::string MITK_IMAGE_MIMETYPE_NAME(); // DEFAULT_BASE_NAME.image.mitk
 
   private:
     // purposely not implemented
@@ -34,6 +34,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef __itkHistogram_h
 #include <itkHistogram.h>
 #endif
+#include <itkSimpleFastMutexLock.h>
 
 class vtkImageData;
 
@@ -160,6 +161,32 @@ namespace mitk
                                                      unsigned int timestep = 0,
                                                      unsigned int component = 0);
 
+    /** @brief Interpolation used by GetPixelValuesByWorldCoordinates(). */
+    enum class PixelInterpolation
+    {
+      NearestNeighbor,
+      Linear
+    };
+
+    /** @brief Get the pixel values at many index positions at once.
+
+    The pixel type is dispatched once and the volume of time step @a timestep is read-locked once for
+    all positions, so this should be preferred over calling GetPixelValueByIndex() in a loop.
+    The pixel type is always being converted to double. Positions outside of the image yield 0. */
+    std::vector<double> GetPixelValuesByIndex(const std::vector<itk::Index<3>> &positions,
+                                              unsigned int timestep = 0,
+                                              unsigned int component = 0);
+
+    /** @brief Get the pixel values at many world positions at once.
+
+    Like GetPixelValuesByIndex(), but the positions are given in world coordinates. With
+    PixelInterpolation::Linear the values are trilinearly interpolated between the neighbouring voxel centers. */
+    std::vector<double> GetPixelValuesByWorldCoordinates(
+      const std::vector<mitk::Point3D> &positions,
+      unsigned int timestep = 0,
+      unsigned int component = 0,
+      PixelInterpolation interpolation = PixelInterpolation::NearestNeighbor);
+
     //##Documentation
     //## @brief Get a volume at a specific time @a t of channel @a n as a vtkImageData.
     virtual vtkImageData *GetVtkImageData(int t = 0, int n = 0);
@@ -184,6 +211,33 @@ namespace mitk
     //## @brief Check whether the channel @a n is set
     bool IsChannelSet(int n = 0) const override;
 
+    //##Documentation
+    //## @brief Allocate the image memory, but report all slices as not set until SetSliceReady() is called for them.
+    //##
+    //## Intended for sources that fill the image progressively in the background, e.g. readers that
+    //## hand out the image before all slices are loaded. The memory of all channels is allocated
+    //## and stays in place, so the source can write slices at any time and data accessors can be
+    //## used for the slices that are ready. IsSliceSet(), IsVolumeSet() and IsChannelSet() return
+    //## false for pending slices, which read as zero until they are filled.
+    void SetAllSlicesPending();
+
+    //##Documentation
+    //## @brief Report the pending slice @a s at time @a t in channel @a n as set. Thread-safe.
+    //##
+    //## Does not call Modified(), the filling source decides when to notify observers.
+    void SetSliceReady(int s = 0, int t = 0, int n = 0);
+
+    //##Documentation
+    //## @brief Number of slices that are still pending, see SetAllSlicesPending()
+    unsigned int GetNumberOfPendingSlices() const;
+
+    //##Documentation
+    //## @brief Check whether volume at time @a t in channel @a n is set or allocated with pending slices
+    //##
+    //## Consumers that can show partially filled volumes, e.g. reslicers, use this instead of
+    //## IsVolumeSet() to work on progressively filled images (see SetAllSlicesPending()).
+    bool IsVolumeSetOrPending(int t = 0, int n = 0) const;
+
     //##Documentation
     //## @brief Set @a data as slice @a s at time @a t in channel @a n. It is in
     //## the responsibility of the caller to ensure that the data vector @a data
@@ -261,6 +315,18 @@ namespace mitk
                                   int n = 0,
                                   ImportMemoryManagementType importMemoryManagement = CopyMemory);
 
+    //##Documentation
+    //## @brief Use the memory mapped file @a mappedFile as data of channel @a n.
+    //##
+    //## The data is not read into memory. Instead, the operating system pages in the parts of
+    //## the file that are accessed (e.g. single time steps or slabs of a volume), so that large
+    //## images occupy resident memory only for the data actually used. The file content has to
+    //## be the uncompressed channel in native byte order. Writing to the image is possible, but
+    //## modifications are private to the image and never written back to the file.
+    //## Returns false if @a n is not a valid channel.
+    //## @throws mitk::Exception if the mapped region is smaller than the channel.
+    virtual bool SetMappedChannel(MemoryMappedFile *mappedFile, int n = 0);
+
     //##Documentation
     //## initialize new (or re-initialize) image information
     //## @warning Initialize() by pic assumes a plane, evenly spaced geometry starting at (0,0,0).
@@ -529,6 +595,15 @@ namespace mitk
 
     ImageDescriptor::Pointer GetImageDescriptor() const { return m_ImageDescriptor; }
     ChannelDescriptor GetChannelDescriptor(int id = 0) const { return m_ImageDescriptor->GetChannelDescriptor(id); }
+
+    //##Documentation
+    //## @brief Get the contention counters of the locks of the image accessors of this image,
+    //## e.g. to profile concurrent access from rendering and processing threads.
+    //##
+    //## @sa ImageAccessLock
+    ImageAccessLock::Statistics GetAccessLockStatistics() const;
+    void ResetAccessLockStatistics() const;
+
     /** \brief Sets a geometry to an image.
       */
     void SetGeometry(BaseGeometry *aGeometry3D) override;
@@ -692,6 +767,10 @@ namespace mitk
     mutable ImageDataItemPointerArray m_Slices;
     mutable itk::SimpleFastMutexLock m_ImageDataArraysLock;
 
+    /** Slices that are allocated but not yet filled, see SetAllSlicesPending(); empty if there are none */
+    std::vector<bool> m_PendingSlices;
+    unsigned int m_NumberOfPendingSlices;
+
     unsigned int m_Dimension;
 
     unsigned int *m_Dimensions;
@@ -730,14 +809,12 @@ namespace mitk
     bool IsVolumeSet_unlocked(int t, int n) const;
     bool IsChannelSet_unlocked(int n) const;
 
-    /** Stores all existing ImageReadAccessors */
-    mutable std::vector<ImageAccessorBase *> m_Readers;
-    /** Stores all existing ImageWriteAccessors */
-    mutable std::vector<ImageAccessorBase *> m_Writers;
+    /** Locks the memory ranges of all existing ImageReadAccessors and ImageWriteAccessors */
+    mutable ImageAccessLock m_AccessLock;
     /** Stores all existing ImageVtkAccessors */
     mutable std::vector<ImageAccessorBase *> m_VtkReaders;
 
-    /** A mutex, which needs to be locked to manage m_Readers and m_Writers */
+    /** A mutex, which needs to be locked when image accessors request the data items of an image */
     itk::SimpleFastMutexLock m_ReadWriteLock;
     /** A mutex, which needs to be locked to manage m_VtkReaders */
     itk::SimpleFastMutexLock m_VtkReadersLock;
@@ -0,0 +1,123 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKIMAGEACCESSLOCK_H
+#define MITKIMAGEACCESSLOCK_H
+
+#include <MitkCoreExports.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace mitk
+{
+  /**
+   * \brief Shared-read/exclusive-write lock for memory ranges of an image.
+   *
+   * Locked ranges (e.g. the memory of a time step or slab accessed by an image accessor) are tracked
+   * in an interval map of disjoint segments, each of which holds the number of readers and writers
+   * covering it. A read lock only waits for writers of overlapping ranges, a write lock waits for
+   * overlapping readers and writers. Hence any number of readers, as well as writers of disjoint
+   * ranges, proceed in parallel.
+   *
+   * Contention counters are collected for profiling, see GetStatistics().
+   *
+   * \sa ImageReadAccessor, ImageWriteAccessor, Image::GetAccessLockStatistics()
+   */
+  class MITKCORE_EXPORT ImageAccessLock
+  {
+  public:
+    typedef std::uint64_t TicketType;
+
+    struct Statistics
+    {
+      /** \brief Number of granted read locks. */
+      std::uint64_t ReadLocks = 0;
+      /** \brief Number of granted write locks. */
+      std::uint64_t WriteLocks = 0;
+      /** \brief Number of read locks that had to wait for a writer. */
+      std::uint64_t ContendedReadLocks = 0;
+      /** \brief Number of write locks that had to wait for a reader or writer. */
+      std::uint64_t ContendedWriteLocks = 0;
+      /** \brief Number of lock requests rejected because of ImageAccessorBase::ExceptionIfLocked. */
+      std::uint64_t RejectedLocks = 0;
+      /** \brief Accumulated time spent waiting for locks in microseconds. */
+      std::uint64_t WaitTimeInMicroseconds = 0;
+      /** \brief Maximum number of locks held at the same time. */
+      std::uint64_t PeakNumberOfLocks = 0;
+    };
+
+    ImageAccessLock();
+    ~ImageAccessLock();
+
+    /** \brief Lock the memory range [begin, end) for reading or writing.
+     *
+     * Waits until conflicting locks are released, unless @a throwIfLocked is true.
+     * \return a ticket identifying the lock in Unlock().
+     * \throws mitk::MemoryIsLockedException if @a throwIfLocked is true and the range is locked.
+     * \throws mitk::Exception if a conflicting lock is held by the calling thread, which would never be released. */
+    TicketType Lock(const void *begin, const void *end, bool write, bool throwIfLocked);
+
+    /** \brief Release a lock acquired by Lock(). */
+    void Unlock(TicketType ticket);
+
+    Statistics GetStatistics() const;
+    void ResetStatistics();
+
+  private:
+    ImageAccessLock(const ImageAccessLock &) = delete;
+    ImageAccessLock &operator=(const ImageAccessLock &) = delete;
+
+    typedef std::uintptr_t AddressType;
+
+    /** A segment begins at its key in m_Segments and ends at the next key. */
+    struct Segment
+    {
+      unsigned int Readers = 0;
+      unsigned int Writers = 0;
+
+      bool operator==(const Segment &other) const { return Readers == other.Readers && Writers == other.Writers; }
+    };
+
+    struct Holder
+    {
+      AddressType Begin;
+      AddressType End;
+      bool Write;
+      std::thread::id Thread;
+    };
+
+    bool IsConflicting(AddressType begin, AddressType end, bool write) const;
+    bool IsConflictingWithCallingThread(AddressType begin, AddressType end, bool write) const;
+
+    std::map<AddressType, Segment>::iterator Split(AddressType address);
+    void Coalesce(AddressType begin, AddressType end);
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Released;
+
+    std::map<AddressType, Segment> m_Segments;
+    std::map<TicketType, Holder> m_Holders;
+    TicketType m_NextTicket;
+
+    Statistics m_Statistics;
+  };
+}
+
+#endif
@@ -33,6 +33,7 @@ namespace mitk
   class ImageVtkWriteAccessor;
 
   class Image;
+  class MemoryMappedFile;
 
   //##Documentation
   //## @brief Internal class for managing references on sub-images
@@ -92,6 +93,13 @@ namespace mitk
 
     ImageDataItem(const ImageDataItem &other);
 
+    /** \brief Image data item backed by a memory mapped file instead of allocated memory.
+     *
+     * The data is paged in by the operating system on first access, so only the parts of the
+     * image that are actually used become resident. The item keeps @a mappedFile alive, as do
+     * all sub-items (e.g. volumes of a channel) through their parent. */
+    ImageDataItem(const mitk::ImageDescriptor::Pointer desc, int timestep, MemoryMappedFile *mappedFile);
+
     /**
     \deprecatedSince{2012_09} Please use image accessors instead: See Doxygen/Related-Pages/Concepts/Image. This method
     can be replaced by ImageWriteAccessor::GetData() or ImageReadAccessor::GetData() */
@@ -134,6 +142,9 @@ namespace mitk
     size_t GetSize() const { return m_Size; }
     virtual void Modified() const;
 
+    /** \brief Returns true if the data of this item (or of its parent) is a memory mapped file. */
+    bool IsMemoryMapped() const;
+
   protected:
     unsigned char *m_Data;
 
@@ -155,6 +166,8 @@ namespace mitk
 
     ImageDataItem::ConstPointer m_Parent;
 
+    itk::SmartPointer<const MemoryMappedFile> m_MappedFile;
+
     unsigned int m_Dimension;
 
     unsigned int m_Dimensions[MAX_IMAGE_DIMENSIONS];
@@ -30,6 +30,18 @@ namespace mitk
    * Instantiating this class with a given itk::ImageIOBase instance
    * will register corresponding MITK reader/writer services for that
    * ITK ImageIO object.
+   *
+   * If the reader option OPTION_MEMORY_MAPPING() is enabled, uncompressed NRRD files
+   * (attached or detached raw data in native byte order) are not read into memory but
+   * memory mapped, see mitk::Image::SetMappedChannel(). Other files are read as usual. A memory
+   * mapped file must not be overwritten or truncated while the image is in use.
+   *
+   * The reader options OPTION_FIRST_TIME_STEP(), OPTION_NUMBER_OF_TIME_STEPS(), OPTION_REGION_INDEX(axis)
+   * and OPTION_REGION_SIZE(axis) restrict reading to a range of time steps and/or a spatial region. ImageIOs
+   * capable of streaming read only that region, uncompressed NRRD payloads are memory mapped and the
+   * region is copied out of the mapping. All other files are read completely before the region is extracted.
+   * The geometry of the image is moved to the first voxel and time step of the region. Reading a single
+   * time step of a 4D image results in a 3D image.
    */
   class MITKCORE_EXPORT ItkImageIO : public AbstractFileIO
   {
@@ -37,6 +49,20 @@ namespace mitk
     ItkImageIO(itk::ImageIOBase::Pointer imageIO);
     ItkImageIO(const CustomMimeType &mimeType, itk::ImageIOBase::Pointer imageIO, int rank);
 
+    static std::string OPTION_MEMORY_MAPPING();
+
+    /** First time step to read (int). */
+    static std::string OPTION_FIRST_TIME_STEP();
+
+    /** Number of time steps to read (int), 0 reads all remaining time steps. */
+    static std::string OPTION_NUMBER_OF_TIME_STEPS();
+
+    /** Start index of the spatial region to read along @a axis 0, 1 or 2 (int). */
+    static std::string OPTION_REGION_INDEX(unsigned int axis);
+
+    /** Size of the spatial region to read along @a axis 0, 1 or 2 (int), 0 extends the region to the image border. */
+    static std::string OPTION_REGION_SIZE(unsigned int axis);
+
     // -------------- AbstractFileReader -------------
 
     using AbstractFileReader::Read;
@@ -56,6 +82,9 @@ namespace mitk
     // Fills the m_DefaultMetaDataKeys vector with default values
     virtual void InitializeDefaultMetaDataKeys();
 
+    // Sets the default reader options shared by all wrapped ITK image IO objects
+    void InitializeDefaultReaderOptions();
+
   private:
     ItkImageIO(const ItkImageIO &other);
 
@@ -0,0 +1,85 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKMEMORYMAPPEDFILE_H
+#define MITKMEMORYMAPPEDFILE_H
+
+#include <MitkCoreExports.h>
+#include <mitkCommon.h>
+
+#include <itkLightObject.h>
+
+#include <string>
+
+namespace mitk
+{
+  /**
+   * \brief Copy-on-write memory mapping of a region of a file.
+   *
+   * The region is mapped into the address space of the process without reading it. Pages are
+   * read from disk by the operating system when they are accessed for the first time and can
+   * be evicted again under memory pressure, as long as they were not written to. Writing to the
+   * mapped memory is allowed, but modified pages are private to the process and never written
+   * back to the file.
+   *
+   * Used as backing store of mitk::ImageDataItem, see mitk::Image::SetMappedChannel().
+   *
+   * \warning The file must not be truncated while it is mapped.
+   */
+  class MITKCORE_EXPORT MemoryMappedFile : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(MemoryMappedFile, itk::LightObject);
+
+    /** \brief Map @a size bytes of file @a fileName starting at byte @a offset.
+     * \throw mitk::Exception if the file cannot be opened or is smaller than the requested region. */
+    mitkNewMacro3Param(Self, const std::string &, size_t, size_t);
+
+    void *GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+    size_t GetOffset() const { return m_Offset; }
+    const std::string &GetFileName() const { return m_FileName; }
+
+    /** \brief Hint that the bytes [offset, offset + size) of the region will be accessed soon. */
+    void WillNeed(size_t offset, size_t size) const;
+
+  protected:
+    MemoryMappedFile(const std::string &fileName, size_t offset, size_t size);
+    ~MemoryMappedFile() override;
+
+  private:
+    MemoryMappedFile(const MemoryMappedFile &) = delete;
+    MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
+
+    std::string m_FileName;
+    size_t m_Offset;
+    size_t m_Size;
+    void *m_Data;
+
+    // start and length of the mapping, which begins at a page boundary before the requested region
+    void *m_MappedAddress;
+    size_t m_MappedSize;
+
+#ifdef _WIN32
+    void *m_FileHandle;
+    void *m_MappingHandle;
+#else
+    int m_FileDescriptor;
+#endif
+  };
+}
+
+#endif
@@ -48,6 +48,18 @@ namespace mitk
     //## @brief Checks, if the nodes contains a property that is equal to m_ValidProperty
     bool CheckNode(const mitk::DataNode *node) const override;
 
+    //##Documentation
+    //## @brief Returns the name of the checked property
+    const std::string &GetValidPropertyName() const { return m_ValidPropertyName; }
+
+    //##Documentation
+    //## @brief Returns the property the node's property is compared to, or nullptr if only its existence is checked
+    const mitk::BaseProperty *GetValidProperty() const { return m_ValidProperty; }
+
+    //##Documentation
+    //## @brief Returns the renderer whose renderer-specific properties are checked, or nullptr
+    const mitk::BaseRenderer *GetRenderer() const { return m_Renderer; }
+
   protected:
     //##Documentation
     //## @brief Constructor to check for a named property
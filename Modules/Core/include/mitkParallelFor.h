@@ -0,0 +1,46 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkParallelFor_h
+#define mitkParallelFor_h
+
+#include <MitkCoreExports.h>
+
+#include <cstddef>
+#include <functional>
+
+namespace mitk
+{
+  /**
+    \brief Calls function(index) for all indices in [0, count) on several threads.
+
+    Indices are handed out dynamically to up to numberOfThreads threads, the calling
+    thread included. A numberOfThreads of 0 uses the global default number of threads
+    of itk::MultiThreader. If a call throws, no further indices are handed out and the
+    first exception is rethrown in the calling thread after all threads have finished.
+
+    \code
+    mitk::ParallelFor(slices.size(), [&](std::size_t index) {
+      ProcessSlice(slices[index]);
+    });
+    \endcode
+  */
+  MITKCORE_EXPORT void ParallelFor(std::size_t count,
+                                   const std::function<void(std::size_t)> &function,
+                                   unsigned int numberOfThreads = 0);
+}
+
+#endif
@@ -42,6 +42,18 @@ namespace mitk
     return std::string();
   }
 
+  class PixelType;
+
+  /**
+   * \brief Create a MITK pixel type from an ITK component type, an ITK pixel type and the number of components
+   *
+   * Counterpart of PixelType::GetComponentType(), PixelType::GetPixelType() and PixelType::GetNumberOfComponents()
+   * for file formats that store these values. Throws for user defined component types.
+   */
+  MITKCORE_EXPORT PixelType MakePixelType(int componentType,
+                                          itk::ImageIOBase::IOPixelType pixelType,
+                                          std::size_t numberOfComponents);
+
   /**
    * @brief Class for defining the data type of pixels
    *
@@ -125,6 +137,8 @@ namespace mitk
   private:
     friend PixelType MakePixelType(const itk::ImageIOBase *imageIO);
 
+    friend PixelType MakePixelType(int componentType, ItkIOPixelType pixelType, std::size_t numberOfComponents);
+
     template <typename ComponentT, typename PixelT>
     friend PixelType MakePixelType(std::size_t numberOfComponents);
 
@@ -19,8 +19,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkVectorContainer.h"
 #include "mitkDataStorage.h"
+#include "mitkDataStorageIndex.h"
 #include "mitkMessage.h"
 #include <map>
+#include <shared_mutex>
 
 namespace mitk
 {
@@ -36,6 +38,11 @@ namespace mitk
   //## Thus, nodes are stored in a noncyclical directed graph data structure.
   //## It is derived from mitk::DataStorage and implements its interface,
   //## including AddNodeEvent and RemoveNodeEvent.
+  //##
+  //## GetSubset() queries by data type and by the "name" property, as well as conjunctions containing
+  //## them, are answered by a DataStorageIndex instead of checking all nodes. Further property keys
+  //## can be indexed with AddIndexedPropertyKey(). Queries do not block each other, only adding and
+  //## removing nodes requires exclusive access.
   //## @ingroup StandaloneDataStorage
   class MITKCORE_EXPORT StandaloneDataStorage : public mitk::DataStorage
   {
@@ -91,7 +98,13 @@ namespace mitk
     //##
     SetOfObjects::ConstPointer GetAll() const override;
 
-    /*ITK Mutex */
+    //##Documentation
+    //## @brief Index the values of the property @a key to speed up GetSubset() queries using NodePredicateProperty
+    //##
+    //## The "name" property is always indexed. Renderer specific properties cannot be indexed.
+    void AddIndexedPropertyKey(const std::string &key);
+
+    /*ITK Mutex, locked while nodes are added or removed. Kept for code that locks it from outside. */
     mutable itk::SimpleFastMutexLock m_Mutex;
 
   protected:
@@ -121,6 +134,14 @@ namespace mitk
     //## @brief deletes all references to a node in a given relation (used in Remove() and TreeListener)
     void RemoveFromRelation(const mitk::DataNode *node, AdjacencyList &relation);
 
+    //##Documentation
+    //## @brief Returns the candidates of indexed queries, GetAll() otherwise
+    SetOfObjects::ConstPointer GetSubsetCandidates(const NodePredicateBase *condition) const override;
+
+    //##Documentation
+    //## @brief Shared for queries, exclusive for modifications of the relations and the index
+    mutable std::shared_timed_mutex m_StorageMutex;
+
     //##Documentation
     //## @brief Prints the contents of the StandaloneDataStorage to os. Do not call directly, call ->Print() instead
     void PrintSelf(std::ostream &os, itk::Indent indent) const override;
@@ -131,6 +152,10 @@ namespace mitk
     //##Documentation
     //## @brief Nodes are stored in reverse relation for easier traversal in the opposite direction of the relation
     AdjacencyList m_DerivedNodes;
+
+    //##Documentation
+    //## @brief Secondary indexes for GetSubset(), re-indexing of changed nodes is deferred to the next query
+    mutable DataStorageIndex m_Index;
   };
 } // namespace mitk
 #endif /* MITKSTANDALONEDATASTORAGE_H_HEADER_INCLUDED_ */
@@ -120,7 +120,7 @@ void mitk::ExtractSliceFilter::GenerateData()
   }
 
   // check if there is something to display.
-  if (!input->IsVolumeSet(m_TimeStep))
+  if (!input->IsVolumeSetOrPending(m_TimeStep))
   {
     itkWarningMacro(<< "No volume data existent at given timestep " << m_TimeStep);
     return;
@@ -20,9 +20,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageWriteAccessor.h>
 
 #include <itkBSplineInterpolateImageFunction.h>
-#include <itkLinearInterpolateImageFunction.h>
-#include <itkNearestNeighborInterpolateImageFunction.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
 #include <limits>
 
 struct mitk::ExtractSliceFilter2::Impl
@@ -33,10 +35,13 @@ struct mitk::ExtractSliceFilter2::Impl
   PlaneGeometry::Pointer OutputGeometry;
   mitk::ExtractSliceFilter2::Interpolator Interpolator;
   itk::Object::Pointer InterpolateImageFunction;
+  itk::ModifiedTimeType InterpolateImageFunctionTime;
+  std::function<void(const OutputImageRegionType&)> Kernel;
 };
 
 mitk::ExtractSliceFilter2::Impl::Impl()
-  : Interpolator(NearestNeighbor)
+  : Interpolator(NearestNeighbor),
+    InterpolateImageFunctionTime(0)
 {
 }
 
@@ -46,93 +51,282 @@ mitk::ExtractSliceFilter2::Impl::~Impl()
 
 namespace
 {
+  // Number of output pixels of a row that are processed as one batch. The
+  // continuous indices of a batch are computed first in a tight loop over
+  // plain arrays before the input buffer is sampled (gathered) for all of
+  // them. Both loops are free of branches and virtual calls so that the
+  // compiler is able to vectorize them.
+  const std::size_t BatchSize = 64;
+
   template <class TInputImage>
-  void CreateInterpolateImageFunction(const TInputImage* inputImage, mitk::ExtractSliceFilter2::Interpolator interpolator, itk::Object::Pointer& result)
+  void CreateInterpolateImageFunction(const TInputImage* inputImage, itk::Object::Pointer& result)
   {
-    typename itk::InterpolateImageFunction<TInputImage>::Pointer interpolateImageFunction;
+    auto bSplineInterpolateImageFunction = itk::BSplineInterpolateImageFunction<TInputImage>::New();
+    bSplineInterpolateImageFunction->SetSplineOrder(2);
+    bSplineInterpolateImageFunction->SetInputImage(inputImage);
 
-    switch (interpolator)
+    result = bSplineInterpolateImageFunction.GetPointer();
+  }
+
+  /** \brief Mapping of output pixel indices to continuous input indices.
+   *
+   * The mapping from output pixels to continuous indices of the input image
+   * is affine. Hence it is sufficient to transform the origin of the output
+   * geometry and its two in-plane steps once. Afterwards the continuous index
+   * of any output pixel is a linear combination of these three vectors.
+   */
+  struct IndexStepping
+  {
+    double Origin[3];
+    double StepX[3];
+    double StepY[3];
+    double Size[3];
+  };
+
+  template <typename TPixel, unsigned int VImageDimension>
+  IndexStepping ComputeIndexStepping(const itk::Image<TPixel, VImageDimension>* inputImage, const mitk::PlaneGeometry* outputGeometry)
+  {
+    auto origin = outputGeometry->GetOrigin();
+    auto spacing = outputGeometry->GetSpacing();
+    auto xDirection = outputGeometry->GetAxisVector(0);
+    auto yDirection = outputGeometry->GetAxisVector(1);
+
+    xDirection.Normalize();
+    yDirection.Normalize();
+
+    itk::ContinuousIndex<mitk::ScalarType, 3> originIndex;
+    itk::ContinuousIndex<mitk::ScalarType, 3> xIndex;
+    itk::ContinuousIndex<mitk::ScalarType, 3> yIndex;
+
+    inputImage->TransformPhysicalPointToContinuousIndex(origin, originIndex);
+    inputImage->TransformPhysicalPointToContinuousIndex(origin + xDirection * spacing[0], xIndex);
+    inputImage->TransformPhysicalPointToContinuousIndex(origin + yDirection * spacing[1], yIndex);
+
+    const auto& region = inputImage->GetLargestPossibleRegion();
+
+    IndexStepping stepping;
+
+    for (unsigned int i = 0; i < 3; ++i)
     {
-      case mitk::ExtractSliceFilter2::NearestNeighbor:
-        interpolateImageFunction = itk::NearestNeighborInterpolateImageFunction<TInputImage>::New().GetPointer();
-        break;
+      stepping.Origin[i] = originIndex[i] - region.GetIndex(i);
+      stepping.StepX[i] = xIndex[i] - originIndex[i];
+      stepping.StepY[i] = yIndex[i] - originIndex[i];
+      stepping.Size[i] = static_cast<double>(region.GetSize(i));
+    }
 
-      case mitk::ExtractSliceFilter2::Linear:
-        interpolateImageFunction = itk::LinearInterpolateImageFunction<TInputImage>::New().GetPointer();
-        break;
+    return stepping;
+  }
 
-      case mitk::ExtractSliceFilter2::Cubic:
+  /** \brief Compute the continuous indices of a batch of consecutive output pixels of a row.
+   *
+   * A continuous index is considered to be inside of the input image if it
+   * lies within [-0.5, size - 0.5) in each dimension, which corresponds to
+   * itk::ImageRegion::IsInside().
+   */
+  void ComputeBatchIndices(const IndexStepping& stepping, double rowStart[3], std::size_t n, double* ix, double* iy, double* iz, bool* inside)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      const double x = rowStart[0] + stepping.StepX[0] * i;
+      const double y = rowStart[1] + stepping.StepX[1] * i;
+      const double z = rowStart[2] + stepping.StepX[2] * i;
+
+      ix[i] = x;
+      iy[i] = y;
+      iz[i] = z;
+
+      inside[i] = x >= -0.5 && x < stepping.Size[0] - 0.5 &&
+                  y >= -0.5 && y < stepping.Size[1] - 0.5 &&
+                  z >= -0.5 && z < stepping.Size[2] - 0.5;
+    }
+  }
+
+  template <typename TPixel>
+  struct NearestNeighborKernel
+  {
+    void operator()(const TPixel* input, const std::size_t size[3], const double* ix, const double* iy, const double* iz, const bool* inside, std::size_t n, TPixel* output) const
+    {
+      const std::size_t strideY = size[0];
+      const std::size_t strideZ = size[0] * size[1];
+      const TPixel backgroundPixel = std::numeric_limits<TPixel>::lowest();
+
+      std::size_t offsets[BatchSize];
+
+      // Rounding half integers up matches itk::NearestNeighborInterpolateImageFunction.
+      for (std::size_t i = 0; i < n; ++i)
       {
-        auto bSplineInterpolateImageFunction = itk::BSplineInterpolateImageFunction<TInputImage>::New();
-        bSplineInterpolateImageFunction->SetSplineOrder(2);
-        interpolateImageFunction = bSplineInterpolateImageFunction.GetPointer();
-        break;
+        offsets[i] = inside[i]
+          ? static_cast<std::size_t>(std::floor(ix[i] + 0.5)) +
+            static_cast<std::size_t>(std::floor(iy[i] + 0.5)) * strideY +
+            static_cast<std::size_t>(std::floor(iz[i] + 0.5)) * strideZ
+          : 0;
       }
 
-      default:
-        mitkThrow() << "Interplator is unknown.";
+      for (std::size_t i = 0; i < n; ++i)
+        output[i] = inside[i] ? input[offsets[i]] : backgroundPixel;
     }
+  };
 
-    interpolateImageFunction->SetInputImage(inputImage);
+  template <typename TPixel>
+  struct LinearKernel
+  {
+    // Base index and fraction along a single dimension. Like
+    // itk::LinearInterpolateImageFunction, the base index is clamped to the
+    // lower bound and the upper neighbor is clamped to the upper bound.
+    static void Split(double index, std::size_t size, std::size_t& lower, std::size_t& upper, double& fraction)
+    {
+      const double base = std::max(std::floor(index), 0.0);
+      lower = static_cast<std::size_t>(base);
+      upper = std::min(lower + 1, size - 1);
+      fraction = index - base;
+    }
 
-    result = interpolateImageFunction.GetPointer();
-  }
+    void operator()(const TPixel* input, const std::size_t size[3], const double* ix, const double* iy, const double* iz, const bool* inside, std::size_t n, TPixel* output) const
+    {
+      const std::size_t strideY = size[0];
+      const std::size_t strideZ = size[0] * size[1];
+      const TPixel backgroundPixel = std::numeric_limits<TPixel>::lowest();
+
+      std::size_t x0, x1, y0, y1, z0, z1;
+      double fx, fy, fz;
+
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (!inside[i])
+        {
+          output[i] = backgroundPixel;
+          continue;
+        }
+
+        Split(ix[i], size[0], x0, x1, fx);
+        Split(iy[i], size[1], y0, y1, fy);
+        Split(iz[i], size[2], z0, z1, fz);
+
+        const TPixel* slice0 = input + z0 * strideZ;
+        const TPixel* slice1 = input + z1 * strideZ;
+
+        const double v00 = slice0[y0 * strideY + x0] + fx * (static_cast<double>(slice0[y0 * strideY + x1]) - slice0[y0 * strideY + x0]);
+        const double v01 = slice0[y1 * strideY + x0] + fx * (static_cast<double>(slice0[y1 * strideY + x1]) - slice0[y1 * strideY + x0]);
+        const double v10 = slice1[y0 * strideY + x0] + fx * (static_cast<double>(slice1[y0 * strideY + x1]) - slice1[y0 * strideY + x0]);
+        const double v11 = slice1[y1 * strideY + x0] + fx * (static_cast<double>(slice1[y1 * strideY + x1]) - slice1[y1 * strideY + x0]);
+
+        const double v0 = v00 + fy * (v01 - v00);
+        const double v1 = v10 + fy * (v11 - v10);
+
+        output[i] = static_cast<TPixel>(v0 + fz * (v1 - v0));
+      }
+    }
+  };
 
   template <typename TPixel, unsigned int VImageDimension>
-  void GenerateData(const itk::Image<TPixel, VImageDimension>* inputImage, mitk::Image* outputImage, const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion, itk::Object* interpolateImageFunction)
+  struct CubicKernel
   {
     typedef itk::Image<TPixel, VImageDimension> TInputImage;
     typedef itk::InterpolateImageFunction<TInputImage> TInterpolateImageFunction;
 
-    auto outputGeometry = outputImage->GetSlicedGeometry()->GetPlaneGeometry(0);
-    auto interpolator = static_cast<TInterpolateImageFunction*>(interpolateImageFunction);
+    const TInterpolateImageFunction* Interpolator;
+    const TInputImage* InputImage;
 
-    auto origin = outputGeometry->GetOrigin();
-    auto spacing = outputGeometry->GetSpacing();
-    auto xDirection = outputGeometry->GetAxisVector(0);
-    auto yDirection = outputGeometry->GetAxisVector(1);
+    void operator()(const TPixel*, const std::size_t[3], const double* ix, const double* iy, const double* iz, const bool* inside, std::size_t n, TPixel* output) const
+    {
+      const TPixel backgroundPixel = std::numeric_limits<TPixel>::lowest();
+      const auto& start = InputImage->GetLargestPossibleRegion().GetIndex();
 
-    xDirection.Normalize();
-    yDirection.Normalize();
+      itk::ContinuousIndex<mitk::ScalarType, 3> index;
 
-    auto spacingAlongXDirection = xDirection * spacing[0];
-    auto spacingAlongYDirection = yDirection * spacing[1];
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (inside[i])
+        {
+          index[0] = ix[i] + start[0];
+          index[1] = iy[i] + start[1];
+          index[2] = iz[i] + start[2];
+
+          output[i] = static_cast<TPixel>(Interpolator->EvaluateAtContinuousIndex(index));
+        }
+        else
+        {
+          output[i] = backgroundPixel;
+        }
+      }
+    }
+  };
 
-    const std::size_t pixelSize = outputImage->GetPixelType().GetSize();
-    const std::size_t width = outputGeometry->GetExtent(0);
+  template <typename TPixel, class TKernel>
+  void GenerateRegion(const TPixel* input, const std::size_t inputSize[3], const IndexStepping& stepping, const TKernel& kernel, mitk::Image* outputImage, const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion)
+  {
+    const std::size_t width = outputImage->GetDimension(0);
     const std::size_t xBegin = outputRegion.GetIndex(0);
     const std::size_t yBegin = outputRegion.GetIndex(1);
     const std::size_t xEnd = xBegin + outputRegion.GetSize(0);
     const std::size_t yEnd = yBegin + outputRegion.GetSize(1);
 
     mitk::ImageWriteAccessor writeAccess(outputImage, nullptr, mitk::ImageAccessorBase::IgnoreLock);
-    auto data = static_cast<char*>(writeAccess.GetData());
+    auto data = static_cast<TPixel*>(writeAccess.GetData());
 
-    const TPixel backgroundPixel = std::numeric_limits<TPixel>::lowest();
-    TPixel pixel;
-
-    itk::ContinuousIndex<mitk::ScalarType, 3> index;
-    mitk::Point3D yPoint;
-    mitk::Point3D point;
+    double ix[BatchSize];
+    double iy[BatchSize];
+    double iz[BatchSize];
+    bool inside[BatchSize];
+    double rowStart[3];
 
     for (std::size_t y = yBegin; y < yEnd; ++y)
     {
-      yPoint = origin + spacingAlongYDirection * y;
+      for (std::size_t x = xBegin; x < xEnd; x += BatchSize)
+      {
+        const std::size_t n = std::min(BatchSize, xEnd - x);
 
-      for (std::size_t x = xBegin; x < xEnd; ++x)
+        for (unsigned int i = 0; i < 3; ++i)
+          rowStart[i] = stepping.Origin[i] + stepping.StepY[i] * y + stepping.StepX[i] * x;
+
+        ComputeBatchIndices(stepping, rowStart, n, ix, iy, iz, inside);
+        kernel(input, inputSize, ix, iy, iz, inside, n, data + width * y + x);
+      }
+    }
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void CreateKernel(const itk::Image<TPixel, VImageDimension>* inputImage, mitk::ExtractSliceFilter2::Interpolator interpolator, const itk::Object* interpolateImageFunction, mitk::Image* outputImage, std::function<void(const mitk::ExtractSliceFilter2::OutputImageRegionType&)>& result)
+  {
+    typedef itk::Image<TPixel, VImageDimension> TInputImage;
+    typedef itk::InterpolateImageFunction<TInputImage> TInterpolateImageFunction;
+
+    // The captured smart pointer keeps the ITK image and thus its read access
+    // to the mitk::Image alive until the kernel is released again.
+    typename TInputImage::ConstPointer input = inputImage;
+
+    const auto stepping = ComputeIndexStepping(inputImage, outputImage->GetSlicedGeometry()->GetPlaneGeometry(0));
+    const auto& inputRegion = inputImage->GetLargestPossibleRegion();
+    const std::array<std::size_t, 3> inputSize = {{ inputRegion.GetSize(0), inputRegion.GetSize(1), inputRegion.GetSize(2) }};
+
+    switch (interpolator)
+    {
+      case mitk::ExtractSliceFilter2::NearestNeighbor:
+        result = [=](const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion) {
+          GenerateRegion(input->GetBufferPointer(), inputSize.data(), stepping, NearestNeighborKernel<TPixel>(), outputImage, outputRegion);
+        };
+        break;
+
+      case mitk::ExtractSliceFilter2::Linear:
+        result = [=](const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion) {
+          GenerateRegion(input->GetBufferPointer(), inputSize.data(), stepping, LinearKernel<TPixel>(), outputImage, outputRegion);
+        };
+        break;
+
+      case mitk::ExtractSliceFilter2::Cubic:
       {
-        point = yPoint + spacingAlongXDirection * x;
+        CubicKernel<TPixel, VImageDimension> kernel;
+        kernel.Interpolator = static_cast<const TInterpolateImageFunction*>(interpolateImageFunction);
+        kernel.InputImage = input.GetPointer();
 
-        if (inputImage->TransformPhysicalPointToContinuousIndex(point, index))
-        {
-          pixel = interpolator->EvaluateAtContinuousIndex(index);
-          memcpy(static_cast<void*>(data + pixelSize * (width * y + x)), static_cast<const void*>(&pixel), pixelSize);
-        }
-        else
-        {
-          memcpy(static_cast<void*>(data + pixelSize * (width * y + x)), static_cast<const void*>(&backgroundPixel), pixelSize);
-        }
+        result = [=](const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion) {
+          GenerateRegion(input->GetBufferPointer(), inputSize.data(), stepping, kernel, outputImage, outputRegion);
+        };
+        break;
       }
+
+      default:
+        mitkThrow() << "Interplator is unknown.";
     }
   }
 
@@ -146,7 +340,7 @@ namespace
     if (!inputImage->IsInitialized())
       mitkThrow() << "Input image is not initialized.";
 
-    if (!inputImage->IsVolumeSet())
+    if (!inputImage->IsVolumeSetOrPending())
       mitkThrow() << "Input image volume is not set.";
 
     auto geometry = inputImage->GetGeometry();
@@ -198,36 +392,33 @@ void mitk::ExtractSliceFilter2::AllocateOutputs()
   {
     delete[] data;
   }
+
+  outputImage->SetRequestedRegionToLargestPossibleRegion();
 }
 
-/*void mitk::ExtractSliceFilter2::BeforeThreadedGenerateData()
+void mitk::ExtractSliceFilter2::BeforeThreadedGenerateData()
 {
-  if (nullptr != m_Impl->InterpolateImageFunction && this->GetInput()->GetMTime() < this->GetMTime())
-    return;
-
   const auto* inputImage = this->GetInput();
-  AccessFixedDimensionByItk_2(inputImage, CreateInterpolateImageFunction, 3, this->GetInterpolator(), m_Impl->InterpolateImageFunction);
+  const auto interpolator = this->GetInterpolator();
+
+  // The B-spline coefficients only have to be recomputed if the input changed since they were computed
+  if (Cubic == interpolator && (nullptr == m_Impl->InterpolateImageFunction || m_Impl->InterpolateImageFunctionTime != inputImage->GetMTime()))
+  {
+    AccessFixedDimensionByItk_1(inputImage, CreateInterpolateImageFunction, 3, m_Impl->InterpolateImageFunction);
+    m_Impl->InterpolateImageFunctionTime = inputImage->GetMTime();
+  }
+
+  AccessFixedDimensionByItk_n(inputImage, CreateKernel, 3, (interpolator, m_Impl->InterpolateImageFunction.GetPointer(), this->GetOutput(), m_Impl->Kernel));
 }
 
 void mitk::ExtractSliceFilter2::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType)
 {
-  const auto* inputImage = this->GetInput();
-  AccessFixedDimensionByItk_3(inputImage, ::GenerateData, 3, this->GetOutput(), outputRegionForThread, m_Impl->InterpolateImageFunction);
-}*/
+  m_Impl->Kernel(outputRegionForThread);
+}
 
-void mitk::ExtractSliceFilter2::GenerateData()
+void mitk::ExtractSliceFilter2::AfterThreadedGenerateData()
 {
-  if (nullptr != m_Impl->InterpolateImageFunction && this->GetInput()->GetMTime() < this->GetMTime())
-    return;
-
-  const auto* inputImage = this->GetInput();
-
-  AccessFixedDimensionByItk_2(inputImage, CreateInterpolateImageFunction, 3, this->GetInterpolator(), m_Impl->InterpolateImageFunction);
-
-  this->AllocateOutputs();
-  auto outputRegion = this->GetOutput()->GetLargestPossibleRegion();
-
-  AccessFixedDimensionByItk_3(inputImage, ::GenerateData, 3, this->GetOutput(), outputRegion, m_Impl->InterpolateImageFunction);
+  m_Impl->Kernel = nullptr;
 }
 
 void mitk::ExtractSliceFilter2::SetInput(const InputImageType* image)
@@ -0,0 +1,72 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkParallelFor.h>
+
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+void mitk::ParallelFor(std::size_t count, const std::function<void(std::size_t)> &function, unsigned int numberOfThreads)
+{
+  if (0 == numberOfThreads)
+    numberOfThreads = std::max(1, static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads()));
+
+  const std::size_t numberOfWorkers = std::min<std::size_t>(numberOfThreads, count);
+
+  if (numberOfWorkers < 2)
+  {
+    for (std::size_t index = 0; index < count; ++index)
+      function(index);
+    return;
+  }
+
+  std::atomic<std::size_t> nextIndex(0);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+
+  auto worker = [&]() {
+    try
+    {
+      for (std::size_t index = nextIndex++; index < count; index = nextIndex++)
+        function(index);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(exceptionMutex);
+      if (!exception)
+        exception = std::current_exception();
+      nextIndex = count;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < numberOfWorkers; ++i)
+    threads.emplace_back(worker);
+
+  worker();
+
+  for (auto &thread : threads)
+    thread.join();
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
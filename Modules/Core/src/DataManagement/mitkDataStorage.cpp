@@ -58,10 +58,17 @@ void mitk::DataStorage::Remove(const DataStorage::SetOfObjects *nodes)
 
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::DataStorage::GetSubset(const NodePredicateBase *condition) const
 {
-  DataStorage::SetOfObjects::ConstPointer result = this->FilterSetOfObjects(this->GetAll(), condition);
+  DataStorage::SetOfObjects::ConstPointer result =
+    this->FilterSetOfObjects(this->GetSubsetCandidates(condition), condition);
   return result;
 }
 
+mitk::DataStorage::SetOfObjects::ConstPointer mitk::DataStorage::GetSubsetCandidates(
+  const NodePredicateBase * /*condition*/) const
+{
+  return this->GetAll();
+}
+
 mitk::DataNode *mitk::DataStorage::GetNamedNode(const char *name) const
 
 {
@@ -0,0 +1,276 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDataStorageIndex.h"
+
+#include "mitkDataNode.h"
+#include "mitkNodePredicateAnd.h"
+#include "mitkNodePredicateDataType.h"
+#include "mitkNodePredicateProperty.h"
+
+#include <itkCommand.h>
+
+#include <algorithm>
+#include <iterator>
+
+/** Marks a node as dirty if the node or one of the observed objects belonging to it is modified. */
+class mitk::DataStorageIndex::InvalidateCommand : public itk::Command
+{
+public:
+  mitkClassMacroItkParent(InvalidateCommand, itk::Command);
+  mitkNewMacro2Param(Self, DataStorageIndex *, const DataNode *);
+
+  void Execute(itk::Object *, const itk::EventObject &) override { m_Index->MarkDirty(m_Node); }
+  void Execute(const itk::Object *, const itk::EventObject &) override { m_Index->MarkDirty(m_Node); }
+
+protected:
+  InvalidateCommand(DataStorageIndex *index, const DataNode *node) : m_Index(index), m_Node(node) {}
+
+private:
+  DataStorageIndex *m_Index;
+  const DataNode *m_Node;
+};
+
+mitk::DataStorageIndex::DataStorageIndex()
+{
+  m_IndexedPropertyKeys.insert("name");
+}
+
+mitk::DataStorageIndex::~DataStorageIndex()
+{
+  while (!m_Entries.empty())
+    this->UnindexNode(m_Entries.begin()->first);
+}
+
+void mitk::DataStorageIndex::AddIndexedPropertyKey(const std::string &key)
+{
+  if (!m_IndexedPropertyKeys.insert(key).second)
+    return;
+
+  for (const auto &entry : m_Entries)
+    this->MarkDirty(entry.first);
+}
+
+bool mitk::DataStorageIndex::IsIndexedPropertyKey(const std::string &key) const
+{
+  return m_IndexedPropertyKeys.count(key) != 0;
+}
+
+void mitk::DataStorageIndex::Insert(const DataNode *node)
+{
+  if (node == nullptr)
+    return;
+
+  this->UnindexNode(node);
+  this->IndexNode(node);
+}
+
+void mitk::DataStorageIndex::Remove(const DataNode *node)
+{
+  this->UnindexNode(node);
+
+  std::lock_guard<std::mutex> lock(m_DirtyMutex);
+  m_DirtyNodes.erase(node);
+}
+
+bool mitk::DataStorageIndex::HasDirtyNodes() const
+{
+  std::lock_guard<std::mutex> lock(m_DirtyMutex);
+  return !m_DirtyNodes.empty();
+}
+
+void mitk::DataStorageIndex::MarkDirty(const DataNode *node)
+{
+  std::lock_guard<std::mutex> lock(m_DirtyMutex);
+  m_DirtyNodes.insert(node);
+}
+
+void mitk::DataStorageIndex::Update()
+{
+  NodeSetType dirtyNodes;
+
+  {
+    std::lock_guard<std::mutex> lock(m_DirtyMutex);
+    dirtyNodes.swap(m_DirtyNodes);
+  }
+
+  for (const DataNode *node : dirtyNodes)
+  {
+    // nodes might have been removed after they were marked
+    if (m_Entries.count(node) != 0)
+      this->Insert(node);
+  }
+}
+
+void mitk::DataStorageIndex::Observe(const DataNode *node, const itk::Object *object, Entry &entry)
+{
+  itk::Object::Pointer observed = const_cast<itk::Object *>(object);
+  const unsigned long tag = observed->AddObserver(itk::ModifiedEvent(), InvalidateCommand::New(this, node));
+  entry.Observers.emplace_back(observed, tag);
+}
+
+void mitk::DataStorageIndex::IndexNode(const DataNode *node)
+{
+  Entry &entry = m_Entries[node];
+
+  // covers SetData() and changes of the node's property list
+  this->Observe(node, node, entry);
+
+  BaseData *data = node->GetData();
+
+  if (data != nullptr)
+  {
+    entry.DataType = data->GetNameOfClass();
+    m_DataTypes[entry.DataType].insert(node);
+
+    // properties not found in the node are looked up in the data
+    this->Observe(node, data->GetPropertyList(), entry);
+  }
+
+  for (const auto &key : m_IndexedPropertyKeys)
+  {
+    BaseProperty *property = node->GetProperty(key.c_str());
+
+    if (property == nullptr)
+      continue;
+
+    const std::string value = property->GetValueAsString();
+    entry.PropertyValues[key] = value;
+    m_PropertyValues[key][value].insert(node);
+
+    // the value of a property can be changed without modifying the list containing it
+    this->Observe(node, property, entry);
+  }
+}
+
+void mitk::DataStorageIndex::UnindexNode(const DataNode *node)
+{
+  auto entryIter = m_Entries.find(node);
+
+  if (entryIter == m_Entries.end())
+    return;
+
+  Entry &entry = entryIter->second;
+
+  for (auto &observer : entry.Observers)
+    observer.first->RemoveObserver(observer.second);
+
+  if (!entry.DataType.empty())
+  {
+    auto dataTypeIter = m_DataTypes.find(entry.DataType);
+    dataTypeIter->second.erase(node);
+
+    if (dataTypeIter->second.empty())
+      m_DataTypes.erase(dataTypeIter);
+  }
+
+  for (const auto &propertyValue : entry.PropertyValues)
+  {
+    auto &values = m_PropertyValues[propertyValue.first];
+    auto valueIter = values.find(propertyValue.second);
+    valueIter->second.erase(node);
+
+    if (valueIter->second.empty())
+      values.erase(valueIter);
+  }
+
+  m_Entries.erase(entryIter);
+}
+
+bool mitk::DataStorageIndex::GetCandidates(const NodePredicateBase *condition, NodeListType &candidates) const
+{
+  candidates.clear();
+
+  if (const auto *dataTypePredicate = dynamic_cast<const NodePredicateDataType *>(condition))
+  {
+    auto dataTypeIter = m_DataTypes.find(dataTypePredicate->GetValidDataType());
+
+    if (dataTypeIter != m_DataTypes.end())
+      candidates.assign(dataTypeIter->second.begin(), dataTypeIter->second.end());
+
+    return true;
+  }
+
+  if (const auto *propertyPredicate = dynamic_cast<const NodePredicateProperty *>(condition))
+  {
+    // renderer specific properties are not indexed
+    if (propertyPredicate->GetRenderer() != nullptr ||
+        !this->IsIndexedPropertyKey(propertyPredicate->GetValidPropertyName()))
+      return false;
+
+    auto propertyIter = m_PropertyValues.find(propertyPredicate->GetValidPropertyName());
+
+    if (propertyIter == m_PropertyValues.end())
+      return true;
+
+    const BaseProperty *validProperty = propertyPredicate->GetValidProperty();
+
+    if (validProperty != nullptr)
+    {
+      auto valueIter = propertyIter->second.find(validProperty->GetValueAsString());
+
+      if (valueIter != propertyIter->second.end())
+        candidates.assign(valueIter->second.begin(), valueIter->second.end());
+    }
+    else
+    {
+      // the predicate only asks for the existence of the property
+      NodeSetType nodes;
+      for (const auto &value : propertyIter->second)
+        nodes.insert(value.second.begin(), value.second.end());
+
+      candidates.assign(nodes.begin(), nodes.end());
+    }
+
+    return true;
+  }
+
+  if (const auto *andPredicate = dynamic_cast<const NodePredicateAnd *>(condition))
+  {
+    bool isIndexed = false;
+    NodeListType childCandidates;
+    NodeListType intersection;
+
+    for (const auto &child : andPredicate->GetPredicates())
+    {
+      if (!this->GetCandidates(child, childCandidates))
+        continue;
+
+      if (isIndexed)
+      {
+        intersection.clear();
+        std::set_intersection(candidates.begin(),
+                              candidates.end(),
+                              childCandidates.begin(),
+                              childCandidates.end(),
+                              std::back_inserter(intersection));
+        candidates.swap(intersection);
+      }
+      else
+      {
+        candidates.swap(childCandidates);
+        isIndexed = true;
+      }
+
+      if (candidates.empty())
+        break;
+    }
+
+    return isIndexed;
+  }
+
+  return false;
+}
@@ -17,9 +17,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK
 #include "mitkImage.h"
 #include "mitkCompareImageDataFilter.h"
+#include "mitkImageReadAccessor.h"
 #include "mitkImageStatisticsHolder.h"
 #include "mitkImageVtkReadAccessor.h"
 #include "mitkImageVtkWriteAccessor.h"
+#include "mitkMemoryMappedFile.h"
 #include "mitkPixelTypeMultiplex.h"
 #include <mitkProportionalTimeGeometry.h>
 
@@ -30,7 +32,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkMutexLockHolder.h>
 
 // Other
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #define FILL_C_ARRAY(_arr, _size, _value)                                                                              \
   for (unsigned int i = 0u; i < _size; i++)                                                                            \
@@ -45,6 +49,7 @@ mitk::Image::Image()
     m_ImageDescriptor(nullptr),
     m_OffsetTable(nullptr),
     m_CompleteData(nullptr),
+    m_NumberOfPendingSlices(0),
     m_ImageStatistics(nullptr)
 {
   m_Dimensions = new unsigned int[MAX_IMAGE_DIMENSIONS];
@@ -60,6 +65,7 @@ mitk::Image::Image(const Image &other)
     m_ImageDescriptor(nullptr),
     m_OffsetTable(nullptr),
     m_CompleteData(nullptr),
+    m_NumberOfPendingSlices(0),
     m_ImageStatistics(nullptr)
 {
   m_Dimensions = new unsigned int[MAX_IMAGE_DIMENSIONS];
@@ -218,6 +224,195 @@ double mitk::Image::GetPixelValueByWorldCoordinate(const mitk::Point3D &position
   return value;
 }
 
+namespace
+{
+  const std::size_t InvalidPixelOffset = std::numeric_limits<std::size_t>::max();
+
+  /** Weighted sum of the pixels at @a offsets for each value. Each value is composed of the same number of
+   * (offset, weight) terms, values whose first offset is InvalidPixelOffset are 0. */
+  template <class T>
+  void AccessPixels(const mitk::PixelType ptype,
+                    const void *data,
+                    const std::vector<std::size_t> &offsets,
+                    const std::vector<double> &weights,
+                    std::vector<double> &values)
+  {
+    const T *buffer = static_cast<const T *>(data);
+    const std::size_t numberOfTerms = offsets.size() / values.size();
+    const bool isRGB = ptype.GetBpe() == 24;
+
+    for (std::size_t i = 0, term = 0; i < values.size(); ++i, term += numberOfTerms)
+    {
+      if (offsets[term] == InvalidPixelOffset)
+        continue;
+
+      double value = 0.0;
+      for (std::size_t j = term; j < term + numberOfTerms; ++j)
+      {
+        const double pixel = isRGB ? static_cast<double>(buffer[offsets[j]]) + buffer[offsets[j] + 1] +
+                                       buffer[offsets[j] + 2]
+                                   : static_cast<double>(buffer[offsets[j]]);
+        value += numberOfTerms == 1 ? pixel : weights[j] * pixel;
+      }
+      values[i] = value;
+    }
+  }
+
+  void WarnAboutPixelsOutOfRange(std::size_t numberOfPixelsOutOfRange)
+  {
+    if (numberOfPixelsOutOfRange != 0)
+      MITK_WARN << numberOfPixelsOutOfRange << " of the given positions are out of image range, returning 0 for them.";
+  }
+
+  /** Dispatch on the pixel type once and read all pixels of time step @a timestep under a single read lock. */
+  void ReadPixels(mitk::Image *image,
+                  const std::vector<std::size_t> &offsets,
+                  const std::vector<double> &weights,
+                  unsigned int timestep,
+                  std::vector<double> &values)
+  {
+    if (values.empty())
+      return;
+
+    mitk::Image::ImageDataItemPointer volume = image->GetVolumeData(timestep);
+    if (volume.IsNull())
+      return;
+
+    mitk::ImageReadAccessor accessor(image, volume);
+    const mitk::PixelType ptype = image->GetPixelType();
+
+    mitkPixelTypeMultiplex4(AccessPixels, ptype, accessor.GetData(), offsets, weights, values);
+  }
+}
+
+std::vector<double> mitk::Image::GetPixelValuesByIndex(const std::vector<itk::Index<3>> &positions,
+                                                       unsigned int timestep,
+                                                       unsigned int component)
+{
+  std::vector<double> values(positions.size(), 0.0);
+
+  if (timestep >= this->GetTimeSteps())
+  {
+    MITK_WARN << "Given time step " << timestep << " is out of image range, returning 0.";
+    return values;
+  }
+
+  const std::size_t dimensions[3] = {this->GetDimension(0), this->GetDimension(1), this->GetDimension(2)};
+  const std::size_t numberOfComponents = this->m_ImageDescriptor->GetChannelTypeById(0).GetNumberOfComponents();
+
+  std::vector<std::size_t> offsets(positions.size(), InvalidPixelOffset);
+  std::size_t numberOfPixelsOutOfRange = 0;
+
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    const itk::Index<3> &position = positions[i];
+
+    if (position[0] < 0 || position[1] < 0 || position[2] < 0 ||
+        static_cast<std::size_t>(position[0]) >= dimensions[0] ||
+        static_cast<std::size_t>(position[1]) >= dimensions[1] ||
+        static_cast<std::size_t>(position[2]) >= dimensions[2])
+    {
+      ++numberOfPixelsOutOfRange;
+      continue;
+    }
+
+    offsets[i] = component + numberOfComponents * (position[0] + dimensions[0] * (position[1] + dimensions[1] * position[2]));
+  }
+
+  WarnAboutPixelsOutOfRange(numberOfPixelsOutOfRange);
+
+  ReadPixels(this, offsets, std::vector<double>(), timestep, values);
+
+  return values;
+}
+
+std::vector<double> mitk::Image::GetPixelValuesByWorldCoordinates(const std::vector<mitk::Point3D> &positions,
+                                                                  unsigned int timestep,
+                                                                  unsigned int component,
+                                                                  PixelInterpolation interpolation)
+{
+  if (interpolation == PixelInterpolation::NearestNeighbor)
+  {
+    std::vector<itk::Index<3>> indices(positions.size());
+    const BaseGeometry *geometry = this->GetGeometry(timestep);
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+      geometry->WorldToIndex(positions[i], indices[i]);
+
+    return this->GetPixelValuesByIndex(indices, timestep, component);
+  }
+
+  std::vector<double> values(positions.size(), 0.0);
+
+  if (timestep >= this->GetTimeSteps())
+  {
+    MITK_WARN << "Given time step " << timestep << " is out of image range, returning 0.";
+    return values;
+  }
+
+  const BaseGeometry *geometry = this->GetGeometry(timestep);
+  const std::size_t dimensions[3] = {this->GetDimension(0), this->GetDimension(1), this->GetDimension(2)};
+  const std::size_t numberOfComponents = this->m_ImageDescriptor->GetChannelTypeById(0).GetNumberOfComponents();
+
+  // eight (offset, weight) terms per position, i.e. the corners of the cell between the neighbouring voxel centers
+  std::vector<std::size_t> offsets(8 * positions.size(), InvalidPixelOffset);
+  std::vector<double> weights(8 * positions.size(), 0.0);
+  std::size_t numberOfPixelsOutOfRange = 0;
+
+  mitk::Point3D continuousIndex;
+
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    geometry->WorldToIndex(positions[i], continuousIndex);
+
+    std::size_t lower[3];
+    std::size_t upper[3];
+    double fraction[3];
+    bool isInside = true;
+
+    for (int d = 0; d < 3 && isInside; ++d)
+    {
+      // the image extends half a voxel beyond the outermost voxel centers
+      const double x = continuousIndex[d];
+      isInside = x >= -0.5 && x < dimensions[d] - 0.5;
+
+      const double clamped = std::min(std::max(x, 0.0), static_cast<double>(dimensions[d] - 1));
+      lower[d] = static_cast<std::size_t>(std::floor(clamped));
+      upper[d] = std::min(lower[d] + 1, dimensions[d] - 1);
+      fraction[d] = clamped - lower[d];
+    }
+
+    if (!isInside)
+    {
+      ++numberOfPixelsOutOfRange;
+      continue;
+    }
+
+    for (unsigned int corner = 0; corner < 8; ++corner)
+    {
+      std::size_t index[3];
+      double weight = 1.0;
+
+      for (int d = 0; d < 3; ++d)
+      {
+        const bool isUpper = 0 != (corner & (1u << d));
+        index[d] = isUpper ? upper[d] : lower[d];
+        weight *= isUpper ? fraction[d] : 1.0 - fraction[d];
+      }
+
+      offsets[8 * i + corner] =
+        component + numberOfComponents * (index[0] + dimensions[0] * (index[1] + dimensions[1] * index[2]));
+      weights[8 * i + corner] = weight;
+    }
+  }
+
+  WarnAboutPixelsOutOfRange(numberOfPixelsOutOfRange);
+
+  ReadPixels(this, offsets, weights, timestep, values);
+
+  return values;
+}
+
 vtkImageData *mitk::Image::GetVtkImageData(int t, int n)
 {
   if (m_Initialized == false)
@@ -584,6 +779,9 @@ bool mitk::Image::IsSliceSet_unlocked(int s, int t, int n) const
   if (IsValidSlice(s, t, n) == false)
     return false;
 
+  if (m_NumberOfPendingSlices != 0 && m_PendingSlices[GetSliceIndex(s, t, n)])
+    return false;
+
   if (m_Slices[GetSliceIndex(s, t, n)].GetPointer() != nullptr)
   {
     return true;
@@ -613,6 +811,16 @@ bool mitk::Image::IsVolumeSet_unlocked(int t, int n) const
 {
   if (IsValidVolume(t, n) == false)
     return false;
+
+  if (m_NumberOfPendingSlices != 0)
+  {
+    for (unsigned int s = 0; s < m_Dimensions[2]; ++s)
+    {
+      if (m_PendingSlices[GetSliceIndex(s, t, n)])
+        return false;
+    }
+  }
+
   ImageDataItemPointer ch, vol;
 
   // volume directly available?
@@ -647,6 +855,19 @@ bool mitk::Image::IsChannelSet_unlocked(int n) const
 {
   if (IsValidChannel(n) == false)
     return false;
+
+  if (m_NumberOfPendingSlices != 0)
+  {
+    for (unsigned int t = 0; t < m_Dimensions[3]; ++t)
+    {
+      for (unsigned int s = 0; s < m_Dimensions[2]; ++s)
+      {
+        if (m_PendingSlices[GetSliceIndex(s, t, n)])
+          return false;
+      }
+    }
+  }
+
   ImageDataItemPointer ch, vol;
   ch = m_Channels[n];
   if ((ch.GetPointer() != nullptr) && (ch->IsComplete()))
@@ -664,6 +885,54 @@ bool mitk::Image::IsChannelSet_unlocked(int n) const
   return true;
 }
 
+void mitk::Image::SetAllSlicesPending()
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+
+  // all data items are views into the channels, which stay in place while the slices are filled
+  for (unsigned int n = 0; n < GetNumberOfChannels(); ++n)
+  {
+    ImageDataItemPointer channel = GetChannelData_unlocked(n, nullptr, CopyMemory);
+    std::memset(channel->GetData(), 0, channel->GetSize());
+  }
+
+  m_PendingSlices.assign(m_Slices.size(), true);
+  m_NumberOfPendingSlices = static_cast<unsigned int>(m_Slices.size());
+}
+
+void mitk::Image::SetSliceReady(int s, int t, int n)
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+
+  if (m_NumberOfPendingSlices == 0 || IsValidSlice(s, t, n) == false)
+    return;
+
+  const int pos = GetSliceIndex(s, t, n);
+  if (m_PendingSlices[pos])
+  {
+    m_PendingSlices[pos] = false;
+    if (--m_NumberOfPendingSlices == 0)
+      m_PendingSlices.clear();
+  }
+}
+
+unsigned int mitk::Image::GetNumberOfPendingSlices() const
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+  return m_NumberOfPendingSlices;
+}
+
+bool mitk::Image::IsVolumeSetOrPending(int t, int n) const
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+
+  // SetAllSlicesPending() has allocated the channels, so the volume is readable
+  if (m_NumberOfPendingSlices != 0)
+    return IsValidVolume(t, n);
+
+  return IsVolumeSet_unlocked(t, n);
+}
+
 bool mitk::Image::SetSlice(const void *data, int s, int t, int n)
 {
   // const_cast is no risk for ImportMemoryManagementType == CopyMemory
@@ -804,6 +1073,40 @@ bool mitk::Image::SetImportChannel(void *data, int n, ImportMemoryManagementType
   return true;
 }
 
+bool mitk::Image::SetMappedChannel(MemoryMappedFile *mappedFile, int n)
+{
+  if (IsValidChannel(n) == false || mappedFile == nullptr)
+    return false;
+
+  ImageDataItemPointer ch = new ImageDataItem(this->m_ImageDescriptor, -1, mappedFile);
+  ch->SetComplete(true);
+
+  bool wasSet;
+  {
+    MutexHolder lock(m_ImageDataArraysLock);
+    wasSet = IsChannelSet_unlocked(n);
+
+    // volumes and slices of the channel still refer to the data they were set with
+    for (unsigned int t = 0; t < m_Dimensions[3]; ++t)
+    {
+      m_Volumes[GetVolumeIndex(t, n)] = nullptr;
+      for (unsigned int s = 0; s < m_Dimensions[2]; ++s)
+        m_Slices[GetSliceIndex(s, t, n)] = nullptr;
+    }
+
+    m_Channels[n] = ch;
+    m_CompleteData = nullptr;
+  }
+
+  this->m_ImageDescriptor->GetChannelDescriptor(n).SetData(ch->GetData());
+
+  // replacing data that was already set is a modification, adding a missing channel is not
+  if (wasSet)
+    Modified();
+
+  return true;
+}
+
 void mitk::Image::Initialize()
 {
   ImageDataItemPointerArray::iterator it, end;
@@ -821,6 +1124,9 @@ void mitk::Image::Initialize()
   }
   m_CompleteData = nullptr;
 
+  m_PendingSlices.clear();
+  m_NumberOfPendingSlices = 0;
+
   if (m_ImageStatistics == nullptr)
   {
     m_ImageStatistics = new mitk::ImageStatisticsHolder(this);
@@ -1310,6 +1616,16 @@ mitk::Image::ImageDataItemPointer mitk::Image::AllocateChannelData_unlocked(
   return ch;
 }
 
+mitk::ImageAccessLock::Statistics mitk::Image::GetAccessLockStatistics() const
+{
+  return m_AccessLock.GetStatistics();
+}
+
+void mitk::Image::ResetAccessLockStatistics() const
+{
+  m_AccessLock.ResetStatistics();
+}
+
 unsigned int *mitk::Image::GetDimensions() const
 {
   return m_Dimensions;
@@ -0,0 +1,208 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageAccessLock.h"
+#include "mitkImageAccessorBase.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+mitk::ImageAccessLock::ImageAccessLock() : m_NextTicket(1)
+{
+}
+
+mitk::ImageAccessLock::~ImageAccessLock()
+{
+}
+
+mitk::ImageAccessLock::TicketType mitk::ImageAccessLock::Lock(const void *begin,
+                                                              const void *end,
+                                                              bool write,
+                                                              bool throwIfLocked)
+{
+  const auto beginAddress = reinterpret_cast<AddressType>(begin);
+  const auto endAddress = std::max(beginAddress, reinterpret_cast<AddressType>(end));
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+
+  if (this->IsConflicting(beginAddress, endAddress, write))
+  {
+    if (throwIfLocked)
+    {
+      ++m_Statistics.RejectedLocks;
+      mitkThrowException(mitk::MemoryIsLockedException)
+        << "The image part being ordered by the ImageAccessor is already in use and locked";
+    }
+
+#ifdef MITK_USE_RECURSIVE_MUTEX_PREVENTION
+    if (this->IsConflictingWithCallingThread(beginAddress, endAddress, write))
+    {
+      mitkThrow()
+        << "Prohibited image access: the requested image part is already in use and cannot be requested recursively!";
+    }
+#endif
+
+    if (write)
+      ++m_Statistics.ContendedWriteLocks;
+    else
+      ++m_Statistics.ContendedReadLocks;
+
+    const auto waitBegin = std::chrono::steady_clock::now();
+
+    m_Released.wait(lock, [&]() { return !this->IsConflicting(beginAddress, endAddress, write); });
+
+    m_Statistics.WaitTimeInMicroseconds += static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitBegin).count());
+  }
+
+  if (beginAddress != endAddress)
+  {
+    const auto last = this->Split(endAddress);
+
+    for (auto segment = this->Split(beginAddress); segment != last; ++segment)
+    {
+      if (write)
+        ++segment->second.Writers;
+      else
+        ++segment->second.Readers;
+    }
+  }
+
+  const TicketType ticket = m_NextTicket++;
+  m_Holders[ticket] = { beginAddress, endAddress, write, std::this_thread::get_id() };
+
+  if (write)
+    ++m_Statistics.WriteLocks;
+  else
+    ++m_Statistics.ReadLocks;
+
+  m_Statistics.PeakNumberOfLocks = std::max<std::uint64_t>(m_Statistics.PeakNumberOfLocks, m_Holders.size());
+
+  return ticket;
+}
+
+void mitk::ImageAccessLock::Unlock(TicketType ticket)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto holder = m_Holders.find(ticket);
+    if (holder == m_Holders.end())
+      return;
+
+    const auto begin = holder->second.Begin;
+    const auto end = holder->second.End;
+    const bool write = holder->second.Write;
+    m_Holders.erase(holder);
+
+    if (begin != end)
+    {
+      // boundaries may have been coalesced with neighbouring segments of equal counts in the meantime
+      const auto last = this->Split(end);
+
+      for (auto segment = this->Split(begin); segment != last; ++segment)
+      {
+        if (write)
+          --segment->second.Writers;
+        else
+          --segment->second.Readers;
+      }
+
+      this->Coalesce(begin, end);
+    }
+  }
+
+  m_Released.notify_all();
+}
+
+mitk::ImageAccessLock::Statistics mitk::ImageAccessLock::GetStatistics() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Statistics;
+}
+
+void mitk::ImageAccessLock::ResetStatistics()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Statistics = Statistics();
+}
+
+bool mitk::ImageAccessLock::IsConflicting(AddressType begin, AddressType end, bool write) const
+{
+  if (begin == end)
+    return false;
+
+  // start with the segment containing begin
+  auto segment = m_Segments.upper_bound(begin);
+  if (segment != m_Segments.begin())
+    --segment;
+
+  for (; segment != m_Segments.end() && segment->first < end; ++segment)
+  {
+    if (0 != segment->second.Writers || (write && 0 != segment->second.Readers))
+      return true;
+  }
+
+  return false;
+}
+
+bool mitk::ImageAccessLock::IsConflictingWithCallingThread(AddressType begin, AddressType end, bool write) const
+{
+  const auto thread = std::this_thread::get_id();
+
+  for (const auto &holder : m_Holders)
+  {
+    if (holder.second.Thread == thread && (write || holder.second.Write) && holder.second.Begin < end &&
+        begin < holder.second.End)
+      return true;
+  }
+
+  return false;
+}
+
+std::map<mitk::ImageAccessLock::AddressType, mitk::ImageAccessLock::Segment>::iterator mitk::ImageAccessLock::Split(
+  AddressType address)
+{
+  auto next = m_Segments.upper_bound(address);
+
+  if (next == m_Segments.begin())
+    return m_Segments.emplace_hint(next, address, Segment());
+
+  auto segment = std::prev(next);
+
+  if (segment->first == address)
+    return segment;
+
+  // the new segment inherits the counts of the segment it is split from
+  return m_Segments.emplace_hint(next, address, segment->second);
+}
+
+void mitk::ImageAccessLock::Coalesce(AddressType begin, AddressType end)
+{
+  auto segment = m_Segments.find(begin);
+
+  while (segment != m_Segments.end() && segment->first <= end)
+  {
+    const bool isRedundant = segment == m_Segments.begin() ? segment->second == Segment()
+                                                           : std::prev(segment)->second == segment->second;
+
+    if (isRedundant)
+      segment = m_Segments.erase(segment);
+    else
+      ++segment;
+  }
+}
@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkImageDataItem.h"
+#include "mitkExceptionMacro.h"
+#include "mitkMemoryMappedFile.h"
 #include "mitkMemoryUtilities.h"
 #include <vtkImageData.h>
 #include <vtkPointData.h>
@@ -180,6 +182,7 @@ mitk::ImageDataItem::ImageDataItem(const ImageDataItem &other)
     m_IsComplete(other.m_IsComplete),
     m_Size(other.m_Size),
     m_Parent(other.m_Parent),
+    m_MappedFile(other.m_MappedFile),
     m_Dimension(other.m_Dimension),
     m_Timestep(other.m_Timestep)
 {
@@ -188,6 +191,47 @@ mitk::ImageDataItem::ImageDataItem(const ImageDataItem &other)
     m_Dimensions[i] = other.m_Dimensions[i];
 }
 
+mitk::ImageDataItem::ImageDataItem(const mitk::ImageDescriptor::Pointer desc,
+                                   int timestep,
+                                   MemoryMappedFile *mappedFile)
+  : m_Data(static_cast<unsigned char *>(mappedFile->GetData())),
+    m_PixelType(new mitk::PixelType(desc->GetChannelDescriptor(0).GetPixelType())),
+    m_ManageMemory(false),
+    m_VtkImageData(nullptr),
+    m_VtkImageReadAccessor(nullptr),
+    m_VtkImageWriteAccessor(nullptr),
+    m_Offset(0),
+    m_IsComplete(false),
+    m_Size(0),
+    m_MappedFile(mappedFile),
+    m_Dimension(desc->GetNumberOfDimensions()),
+    m_Timestep(timestep)
+{
+  const unsigned int *dimensions = desc->GetDimensions();
+  for (unsigned int i = 0; i < m_Dimension; i++)
+  {
+    m_Dimensions[i] = dimensions[i];
+  }
+
+  this->ComputeItemSize(m_Dimensions, m_Dimension);
+
+  if (mappedFile->GetSize() < m_Size)
+  {
+    delete m_PixelType;
+    mitkThrow() << "Memory mapped file \"" << mappedFile->GetFileName() << "\" is smaller than the image data.";
+  }
+
+  m_ReferenceCount = 0;
+}
+
+bool mitk::ImageDataItem::IsMemoryMapped() const
+{
+  if (m_MappedFile.IsNotNull())
+    return true;
+
+  return m_Parent.IsNotNull() && m_Parent->IsMemoryMapped();
+}
+
 itk::LightObject::Pointer mitk::ImageDataItem::InternalClone() const
 {
   Self::Pointer newGeometry = new Self(*this);
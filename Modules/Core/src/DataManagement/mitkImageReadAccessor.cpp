@@ -23,15 +23,7 @@ mitk::ImageReadAccessor::ImageReadAccessor(ImageConstPointer image, const mitk::
 {
   if (!(OptionFlags & ImageAccessorBase::IgnoreLock))
   {
-    try
-    {
-      OrganizeReadAccess();
-    }
-    catch (...)
-    {
-      delete m_WaitLock;
-      throw;
-    }
+    OrganizeReadAccess();
   }
 }
 
@@ -40,15 +32,7 @@ mitk::ImageReadAccessor::ImageReadAccessor(ImagePointer image, const mitk::Image
 {
   if (!(OptionFlags & ImageAccessorBase::IgnoreLock))
   {
-    try
-    {
-      OrganizeReadAccess();
-    }
-    catch (...)
-    {
-      delete m_WaitLock;
-      throw;
-    }
+    OrganizeReadAccess();
   }
 }
 
@@ -63,29 +47,7 @@ mitk::ImageReadAccessor::~ImageReadAccessor()
   if (!(m_Options & ImageAccessorBase::IgnoreLock))
   {
     // Future work: In case of non-coherent memory, copied area needs to be deleted
-
-    m_Image->m_ReadWriteLock.Lock();
-
-    // delete self from list of ImageReadAccessors in Image
-    auto it = std::find(m_Image->m_Readers.begin(), m_Image->m_Readers.end(), this);
-    m_Image->m_Readers.erase(it);
-
-    // delete lock, if there are no waiting ImageAccessors
-    if (m_WaitLock->m_WaiterCount <= 0)
-    {
-      m_WaitLock->m_Mutex.Unlock();
-      delete m_WaitLock;
-    }
-    else
-    {
-      m_WaitLock->m_Mutex.Unlock();
-    }
-
-    m_Image->m_ReadWriteLock.Unlock();
-  }
-  else
-  {
-    delete m_WaitLock;
+    m_Image->m_AccessLock.Unlock(m_LockTicket);
   }
 }
 
@@ -96,56 +58,6 @@ const mitk::Image *mitk::ImageReadAccessor::GetImage() const
 
 void mitk::ImageReadAccessor::OrganizeReadAccess()
 {
-  m_Image->m_ReadWriteLock.Lock();
-
-  // Check, if there is any Write-Access going on
-  if (m_Image->m_Writers.size() > 0)
-  {
-    // Check for every WriteAccessors, if the Region of this ImageAccessors overlaps
-    // make sure this iterator is not used, when m_ReadWriteLock is Unlocked!
-    auto it = m_Image->m_Writers.begin();
-
-    for (; it != m_Image->m_Writers.end(); ++it)
-    {
-      ImageAccessorBase *w = *it;
-      if (Overlap(w))
-      {
-        // An Overlap was detected. There are two possibilities to deal with this situation:
-        // Throw an exception or wait for the WriteAccessor w until it is released and start again with the request
-        // afterwards.
-        if (!(m_Options & ExceptionIfLocked))
-        {
-          PreventRecursiveMutexLock(w);
-
-          // WAIT
-          w->Increment();
-          m_Image->m_ReadWriteLock.Unlock();
-          ImageAccessorBase::WaitForReleaseOf(w->m_WaitLock);
-
-          // after waiting for the WriteAccessor w, start this method again
-          OrganizeReadAccess();
-          return;
-        }
-        else
-        {
-          // THROW EXCEPTION
-          m_Image->m_ReadWriteLock.Unlock();
-          mitkThrowException(mitk::MemoryIsLockedException)
-            << "The image part being ordered by the ImageAccessor is already in use and locked";
-          return;
-        }
-      } // if
-    }   // for
-  }     // if
-
-  // Now, we know, that there is no conflict with a Write-Access
-  // Lock the Mutex in ImageAccessorBase, to make sure that every other ImageAccessor has to wait if it locks the mutex
-  m_WaitLock->m_Mutex.Lock();
-
-  // insert self into readers list in Image
-  m_Image->m_Readers.push_back(this);
-
-  // printf("ReadAccess %d %d\n",(int) m_Image->m_Readers.size(),(int) m_Image->m_Writers.size());
-  // fflush(0);
-  m_Image->m_ReadWriteLock.Unlock();
+  // Shares the image part with other readers, waits for (or rejects if ExceptionIfLocked) overlapping writers
+  m_LockTicket = m_Image->m_AccessLock.Lock(m_AddressBegin, m_AddressEnd, false, (m_Options & ExceptionIfLocked) != 0);
 }
@@ -0,0 +1,149 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkMemoryMappedFile.h"
+#include "mitkExceptionMacro.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mitk::MemoryMappedFile::MemoryMappedFile(const std::string &fileName, size_t offset, size_t size)
+  : m_FileName(fileName),
+    m_Offset(offset),
+    m_Size(size),
+    m_Data(nullptr),
+    m_MappedAddress(nullptr),
+    m_MappedSize(0)
+#ifdef _WIN32
+    ,
+    m_FileHandle(INVALID_HANDLE_VALUE),
+    m_MappingHandle(nullptr)
+#else
+    ,
+    m_FileDescriptor(-1)
+#endif
+{
+  if (0 == size)
+    mitkThrow() << "Cannot map an empty region of file \"" << fileName << "\".";
+
+#ifdef _WIN32
+  m_FileHandle = CreateFileA(
+    fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+  if (INVALID_HANDLE_VALUE == m_FileHandle)
+    mitkThrow() << "Cannot open file \"" << fileName << "\" for memory mapping.";
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(m_FileHandle, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) < offset + size)
+  {
+    CloseHandle(m_FileHandle);
+    mitkThrow() << "File \"" << fileName << "\" is smaller than the region to be mapped.";
+  }
+
+  m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+  if (nullptr == m_MappingHandle)
+  {
+    CloseHandle(m_FileHandle);
+    mitkThrow() << "Cannot create file mapping of \"" << fileName << "\".";
+  }
+
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+
+  const unsigned long long mappedOffset = offset - offset % systemInfo.dwAllocationGranularity;
+  m_MappedSize = size + static_cast<size_t>(offset - mappedOffset);
+  m_MappedAddress = MapViewOfFile(m_MappingHandle,
+                                  FILE_MAP_COPY,
+                                  static_cast<DWORD>(mappedOffset >> 32),
+                                  static_cast<DWORD>(mappedOffset & 0xFFFFFFFF),
+                                  m_MappedSize);
+
+  if (nullptr == m_MappedAddress)
+  {
+    CloseHandle(m_MappingHandle);
+    CloseHandle(m_FileHandle);
+    mitkThrow() << "Cannot map view of file \"" << fileName << "\".";
+  }
+#else
+  m_FileDescriptor = open(fileName.c_str(), O_RDONLY);
+
+  if (-1 == m_FileDescriptor)
+    mitkThrow() << "Cannot open file \"" << fileName << "\" for memory mapping.";
+
+  struct stat fileStatus;
+  if (0 != fstat(m_FileDescriptor, &fileStatus) || static_cast<size_t>(fileStatus.st_size) < offset + size)
+  {
+    close(m_FileDescriptor);
+    mitkThrow() << "File \"" << fileName << "\" is smaller than the region to be mapped.";
+  }
+
+  const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t mappedOffset = offset - offset % pageSize;
+  m_MappedSize = size + offset - mappedOffset;
+
+  // MAP_PRIVATE: written pages are copied on write and never reach the file
+  m_MappedAddress = mmap(nullptr, m_MappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_FileDescriptor, mappedOffset);
+
+  if (MAP_FAILED == m_MappedAddress)
+  {
+    close(m_FileDescriptor);
+    mitkThrow() << "Cannot map file \"" << fileName << "\".";
+  }
+#endif
+
+  m_Data = static_cast<unsigned char *>(m_MappedAddress) + (m_MappedSize - size);
+}
+
+mitk::MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef _WIN32
+  UnmapViewOfFile(m_MappedAddress);
+  CloseHandle(m_MappingHandle);
+  CloseHandle(m_FileHandle);
+#else
+  munmap(m_MappedAddress, m_MappedSize);
+  close(m_FileDescriptor);
+#endif
+}
+
+void mitk::MemoryMappedFile::WillNeed(size_t offset, size_t size) const
+{
+  if (offset >= m_Size)
+    return;
+
+  size = std::min(size, m_Size - offset);
+
+#ifdef _WIN32
+  WIN32_MEMORY_RANGE_ENTRY range;
+  range.VirtualAddress = static_cast<unsigned char *>(m_Data) + offset;
+  range.NumberOfBytes = size;
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+  const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto begin = static_cast<unsigned char *>(m_Data) + offset;
+  const size_t misalignment = reinterpret_cast<size_t>(begin) % pageSize;
+  madvise(begin - misalignment, size + misalignment, MADV_WILLNEED);
+#endif
+}
@@ -24,6 +24,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNodePredicateProperty.h"
 #include "mitkProperties.h"
 
+#include <mutex>
+
 mitk::StandaloneDataStorage::StandaloneDataStorage() : mitk::DataStorage()
 {
 }
@@ -45,6 +47,7 @@ void mitk::StandaloneDataStorage::Add(mitk::DataNode *node, const mitk::DataStor
 {
   {
     itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    std::unique_lock<std::shared_timed_mutex> storageLocked(m_StorageMutex);
     if (!IsInitialized())
       throw std::logic_error("DataStorage not initialized");
     /* check if node is in its own list of sources */
@@ -85,6 +88,8 @@ void mitk::StandaloneDataStorage::Add(mitk::DataNode *node, const mitk::DataStor
 
     // register for ITK changed events
     this->AddListeners(node);
+
+    m_Index.Insert(node);
   }
 
   /* Notify observers */
@@ -113,15 +118,18 @@ void mitk::StandaloneDataStorage::Remove(const mitk::DataNode *node)
   EmitRemoveNodeEvent(node);
   {
     itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    std::unique_lock<std::shared_timed_mutex> storageLocked(m_StorageMutex);
     /* remove node from both relation adjacency lists */
     this->RemoveFromRelation(node, m_SourceNodes);
     this->RemoveFromRelation(node, m_DerivedNodes);
+
+    m_Index.Remove(node);
   }
 }
 
 bool mitk::StandaloneDataStorage::Exists(const mitk::DataNode *node) const
 {
-  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+  std::shared_lock<std::shared_timed_mutex> locked(m_StorageMutex);
   return (m_SourceNodes.find(node) != m_SourceNodes.end());
 }
 
@@ -149,7 +157,7 @@ void mitk::StandaloneDataStorage::RemoveFromRelation(const mitk::DataNode *node,
 
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetAll() const
 {
-  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+  std::shared_lock<std::shared_timed_mutex> locked(m_StorageMutex);
   if (!IsInitialized())
     throw std::logic_error("DataStorage not initialized");
 
@@ -165,6 +173,47 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetAl
   return SetOfObjects::ConstPointer(resultset);
 }
 
+void mitk::StandaloneDataStorage::AddIndexedPropertyKey(const std::string &key)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+  std::unique_lock<std::shared_timed_mutex> storageLocked(m_StorageMutex);
+  m_Index.AddIndexedPropertyKey(key);
+}
+
+mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSubsetCandidates(
+  const NodePredicateBase *condition) const
+{
+  if (condition == nullptr)
+    return this->GetAll();
+
+  DataStorageIndex::NodeListType candidates;
+
+  // re-indexing modifies the index, concurrent queries only read it
+  if (m_Index.HasDirtyNodes())
+  {
+    std::unique_lock<std::shared_timed_mutex> locked(m_StorageMutex);
+    m_Index.Update();
+  }
+
+  {
+    std::shared_lock<std::shared_timed_mutex> locked(m_StorageMutex);
+
+    if (m_Index.GetCandidates(condition, candidates))
+    {
+      mitk::DataStorage::SetOfObjects::Pointer resultset = mitk::DataStorage::SetOfObjects::New();
+      resultset->Reserve(static_cast<unsigned int>(candidates.size()));
+
+      unsigned int index = 0;
+      for (const auto *node : candidates)
+        resultset->SetElement(index++, const_cast<mitk::DataNode *>(node));
+
+      return SetOfObjects::ConstPointer(resultset);
+    }
+  }
+
+  return this->GetAll();
+}
+
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRelations(
   const mitk::DataNode *node,
   const AdjacencyList &relation,
@@ -244,14 +293,14 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSources(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectSources) const
 {
-  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+  std::shared_lock<std::shared_timed_mutex> locked(m_StorageMutex);
   return this->GetRelations(node, m_SourceNodes, condition, onlyDirectSources);
 }
 
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetDerivations(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectDerivations) const
 {
-  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+  std::shared_lock<std::shared_timed_mutex> locked(m_StorageMutex);
   return this->GetRelations(node, m_DerivedNodes, condition, onlyDirectDerivations);
 }
 
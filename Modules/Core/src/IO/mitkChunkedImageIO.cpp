@@ -0,0 +1,614 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkChunkedImageIO.h"
+
+#include <mitkArbitraryTimeGeometry.h>
+#include <mitkIOMimeTypes.h>
+#include <mitkImage.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkParallelFor.h>
+#include <mitkProportionalTimeGeometry.h>
+
+#include <itkMultiThreader.h>
+#include <itk_zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+  const char FileSignature[8] = {'M', 'I', 'T', 'K', 'I', 'M', 'G', '\0'};
+  const std::uint32_t FileVersion = 1;
+
+  // chunks are made of whole slices and hold about this many bytes
+  const std::size_t TargetChunkSize = 4 << 20;
+
+  enum TimeGeometryType : std::uint8_t
+  {
+    ProportionalTimeGeometryType = 0,
+    ArbitraryTimeGeometryType = 1
+  };
+
+  struct FileHeader
+  {
+    std::int32_t ComponentType = 0;
+    std::int32_t PixelType = 0;
+    std::uint32_t NumberOfComponents = 0;
+    std::uint32_t Dimension = 0;
+    std::uint32_t Dimensions[4] = {1, 1, 1, 1};
+    double Origin[3] = {0.0, 0.0, 0.0};
+    double Spacing[3] = {1.0, 1.0, 1.0};
+    double Direction[9] = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0}; // row major, without spacing
+    std::uint8_t TimeGeometry = ProportionalTimeGeometryType;
+
+    // first time point and step duration, or all time bounds of an ArbitraryTimeGeometry
+    std::vector<double> TimePoints;
+
+    std::uint32_t SlicesPerChunk = 1;
+
+    std::size_t GetSliceSize() const
+    {
+      return static_cast<std::size_t>(Dimensions[0]) * Dimensions[1] *
+             mitk::MakePixelType(ComponentType,
+                                 static_cast<itk::ImageIOBase::IOPixelType>(PixelType),
+                                 NumberOfComponents).GetSize();
+    }
+
+    std::size_t GetChunksPerTimeStep() const { return (Dimensions[2] + SlicesPerChunk - 1) / SlicesPerChunk; }
+  };
+
+  struct ChunkInfo
+  {
+    std::uint64_t Offset = 0;
+    std::uint64_t StoredSize = 0;
+    std::uint8_t Compressed = 0;
+  };
+
+  template <typename T>
+  void WriteValue(std::ostream &stream, T value)
+  {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool ReadValue(std::istream &stream, T &value)
+  {
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+  }
+
+  void WriteHeader(std::ostream &stream, const FileHeader &header)
+  {
+    stream.write(FileSignature, sizeof(FileSignature));
+    WriteValue(stream, FileVersion);
+    WriteValue(stream, header.ComponentType);
+    WriteValue(stream, header.PixelType);
+    WriteValue(stream, header.NumberOfComponents);
+    WriteValue(stream, header.Dimension);
+
+    for (auto dimension : header.Dimensions)
+      WriteValue(stream, dimension);
+    for (auto value : header.Origin)
+      WriteValue(stream, value);
+    for (auto value : header.Spacing)
+      WriteValue(stream, value);
+    for (auto value : header.Direction)
+      WriteValue(stream, value);
+
+    WriteValue(stream, header.TimeGeometry);
+    WriteValue(stream, static_cast<std::uint32_t>(header.TimePoints.size()));
+    for (auto value : header.TimePoints)
+      WriteValue(stream, value);
+
+    WriteValue(stream, header.SlicesPerChunk);
+  }
+
+  bool ReadHeader(std::istream &stream, FileHeader &header)
+  {
+    char signature[sizeof(FileSignature)];
+    std::uint32_t version = 0;
+
+    if (!stream.read(signature, sizeof(signature)) || std::memcmp(signature, FileSignature, sizeof(signature)) != 0 ||
+        !ReadValue(stream, version) || version != FileVersion || !ReadValue(stream, header.ComponentType) ||
+        !ReadValue(stream, header.PixelType) || !ReadValue(stream, header.NumberOfComponents) ||
+        !ReadValue(stream, header.Dimension))
+      return false;
+
+    for (auto &dimension : header.Dimensions)
+      if (!ReadValue(stream, dimension))
+        return false;
+    for (auto &value : header.Origin)
+      if (!ReadValue(stream, value))
+        return false;
+    for (auto &value : header.Spacing)
+      if (!ReadValue(stream, value))
+        return false;
+    for (auto &value : header.Direction)
+      if (!ReadValue(stream, value))
+        return false;
+
+    std::uint32_t numberOfTimePoints = 0;
+    if (!ReadValue(stream, header.TimeGeometry) || !ReadValue(stream, numberOfTimePoints))
+      return false;
+
+    header.TimePoints.resize(numberOfTimePoints);
+    for (auto &value : header.TimePoints)
+      if (!ReadValue(stream, value))
+        return false;
+
+    return ReadValue(stream, header.SlicesPerChunk) && header.SlicesPerChunk > 0 && header.Dimension >= 2 &&
+           header.Dimension <= 4;
+  }
+
+  /** The width of long differs between platforms, so it is recorded as a fixed-width type. */
+  int GetFixedWidthComponentType(int componentType)
+  {
+    switch (componentType)
+    {
+      case itk::ImageIOBase::LONG:
+        return sizeof(long) == 4 ? itk::ImageIOBase::INT : itk::ImageIOBase::LONGLONG;
+      case itk::ImageIOBase::ULONG:
+        return sizeof(unsigned long) == 4 ? itk::ImageIOBase::UINT : itk::ImageIOBase::ULONGLONG;
+      default:
+        return componentType;
+    }
+  }
+
+  int GetIntOption(const us::Any &option, int defaultValue)
+  {
+    return option.Empty() ? defaultValue : us::any_cast<int>(option);
+  }
+}
+
+namespace mitk
+{
+  ChunkedImageIO::ChunkedImageIO()
+    : AbstractFileIO(Image::GetStaticNameOfClass(), IOMimeTypes::MITK_IMAGE_MIMETYPE(), "MITK Chunked Image")
+  {
+    Options defaultReaderOptions;
+    defaultReaderOptions[OPTION_TIME_STEP()] = us::Any(-1);
+    defaultReaderOptions[OPTION_FIRST_SLICE()] = us::Any(0);
+    defaultReaderOptions[OPTION_NUMBER_OF_SLICES()] = us::Any(0);
+    this->SetDefaultReaderOptions(defaultReaderOptions);
+
+    Options defaultWriterOptions;
+    defaultWriterOptions[OPTION_COMPRESSION_LEVEL()] = us::Any(1);
+    this->SetDefaultWriterOptions(defaultWriterOptions);
+
+    this->RegisterService();
+  }
+
+  ChunkedImageIO::ChunkedImageIO(const ChunkedImageIO &other) : AbstractFileIO(other) {}
+
+  std::string ChunkedImageIO::OPTION_TIME_STEP()
+  {
+    static std::string s = "Time step";
+    return s;
+  }
+
+  std::string ChunkedImageIO::OPTION_FIRST_SLICE()
+  {
+    static std::string s = "First slice";
+    return s;
+  }
+
+  std::string ChunkedImageIO::OPTION_NUMBER_OF_SLICES()
+  {
+    static std::string s = "Number of slices";
+    return s;
+  }
+
+  std::string ChunkedImageIO::OPTION_COMPRESSION_LEVEL()
+  {
+    static std::string s = "Compression level";
+    return s;
+  }
+
+  std::vector<BaseData::Pointer> ChunkedImageIO::Read()
+  {
+    // every chunk is read through its own stream, so we need a file
+    const std::string path = this->GetLocalFileName();
+
+    std::ifstream stream(path.c_str(), std::ios::binary);
+    if (!stream.is_open())
+    {
+      mitkThrow() << "Cannot open " << path << " for reading";
+    }
+
+    FileHeader header;
+    if (!ReadHeader(stream, header))
+    {
+      mitkThrow() << path << " is no valid MITK image file";
+    }
+
+    const PixelType pixelType = MakePixelType(
+      header.ComponentType, static_cast<itk::ImageIOBase::IOPixelType>(header.PixelType), header.NumberOfComponents);
+    const std::size_t sliceSize = header.GetSliceSize();
+    const std::size_t chunksPerTimeStep = header.GetChunksPerTimeStep();
+    const std::size_t numberOfChunks = chunksPerTimeStep * header.Dimensions[3];
+
+    // chunk table and its offset are stored at the end of the file
+    std::uint64_t tableOffset = 0;
+    std::uint64_t numberOfStoredChunks = 0;
+    stream.seekg(-static_cast<std::streamoff>(sizeof(std::uint64_t)), std::ios::end);
+    if (!ReadValue(stream, tableOffset) || !stream.seekg(tableOffset) || !ReadValue(stream, numberOfStoredChunks) ||
+        numberOfStoredChunks != numberOfChunks)
+    {
+      mitkThrow() << "Chunk table of " << path << " is corrupted";
+    }
+
+    std::vector<ChunkInfo> chunks(numberOfChunks);
+    for (auto &chunk : chunks)
+    {
+      if (!ReadValue(stream, chunk.Offset) || !ReadValue(stream, chunk.StoredSize) ||
+          !ReadValue(stream, chunk.Compressed) || chunk.Offset + chunk.StoredSize > tableOffset)
+      {
+        mitkThrow() << "Chunk table of " << path << " is corrupted";
+      }
+    }
+
+    // requested region
+    const int timeStep = GetIntOption(this->GetReaderOption(OPTION_TIME_STEP()), -1);
+    const int firstSlice = GetIntOption(this->GetReaderOption(OPTION_FIRST_SLICE()), 0);
+    const int numberOfSlices = GetIntOption(this->GetReaderOption(OPTION_NUMBER_OF_SLICES()), 0);
+
+    if (timeStep >= static_cast<int>(header.Dimensions[3]) || firstSlice < 0 ||
+        firstSlice >= static_cast<int>(header.Dimensions[2]) || numberOfSlices < 0 ||
+        firstSlice + numberOfSlices > static_cast<int>(header.Dimensions[2]))
+    {
+      mitkThrow() << "Requested time step " << timeStep << " or slices " << firstSlice << " + " << numberOfSlices
+                  << " are outside of the image " << path;
+    }
+
+    const std::size_t t0 = timeStep < 0 ? 0 : timeStep;
+    const std::size_t t1 = timeStep < 0 ? header.Dimensions[3] : timeStep + 1;
+    const std::size_t z0 = firstSlice;
+    const std::size_t z1 = numberOfSlices == 0 ? header.Dimensions[2] : firstSlice + numberOfSlices;
+
+    unsigned int dimensions[4] = {header.Dimensions[0],
+                                  header.Dimensions[1],
+                                  static_cast<unsigned int>(z1 - z0),
+                                  static_cast<unsigned int>(t1 - t0)};
+    unsigned int dimension = header.Dimension;
+    if (dimension == 4 && dimensions[3] == 1)
+      dimension = 3;
+
+    Image::Pointer image = Image::New();
+    image->Initialize(pixelType, dimension, dimensions);
+
+    std::vector<std::size_t> requiredChunks;
+    for (std::size_t t = t0; t < t1; ++t)
+    {
+      for (std::size_t c = z0 / header.SlicesPerChunk; c <= (z1 - 1) / header.SlicesPerChunk; ++c)
+      {
+        requiredChunks.push_back(t * chunksPerTimeStep + c);
+      }
+    }
+
+    {
+      ImageWriteAccessor accessor(image);
+      auto *output = static_cast<char *>(accessor.GetData());
+
+      mitk::ParallelFor(requiredChunks.size(), [&](std::size_t index) {
+        const std::size_t chunkIndex = requiredChunks[index];
+        const ChunkInfo &chunk = chunks[chunkIndex];
+
+        const std::size_t t = chunkIndex / chunksPerTimeStep;
+        const std::size_t chunkFirstSlice = (chunkIndex % chunksPerTimeStep) * header.SlicesPerChunk;
+        const std::size_t chunkSlices =
+          std::min<std::size_t>(header.SlicesPerChunk, header.Dimensions[2] - chunkFirstSlice);
+
+        // slices of this chunk that are part of the output
+        const std::size_t s0 = std::max(z0, chunkFirstSlice);
+        const std::size_t s1 = std::min(z1, chunkFirstSlice + chunkSlices);
+        char *target = output + ((t - t0) * dimensions[2] + (s0 - z0)) * sliceSize;
+
+        std::ifstream chunkStream(path.c_str(), std::ios::binary);
+
+        if (!chunk.Compressed)
+        {
+          // uncompressed chunks are read slice-exact
+          chunkStream.seekg(chunk.Offset + (s0 - chunkFirstSlice) * sliceSize);
+          if (!chunkStream.read(target, (s1 - s0) * sliceSize))
+          {
+            mitkThrow() << "Cannot read chunk " << chunkIndex << " of " << path;
+          }
+          return;
+        }
+
+        std::vector<char> compressed(chunk.StoredSize);
+        chunkStream.seekg(chunk.Offset);
+        if (!chunkStream.read(compressed.data(), compressed.size()))
+        {
+          mitkThrow() << "Cannot read chunk " << chunkIndex << " of " << path;
+        }
+
+        // decompress in place if the complete chunk is needed
+        std::vector<char> decompressed;
+        char *chunkData = target;
+        if (s0 != chunkFirstSlice || s1 != chunkFirstSlice + chunkSlices)
+        {
+          decompressed.resize(chunkSlices * sliceSize);
+          chunkData = decompressed.data();
+        }
+
+        uLongf size = static_cast<uLongf>(chunkSlices * sliceSize);
+        if (uncompress(reinterpret_cast<Bytef *>(chunkData),
+                       &size,
+                       reinterpret_cast<const Bytef *>(compressed.data()),
+                       static_cast<uLong>(compressed.size())) != Z_OK ||
+            size != chunkSlices * sliceSize)
+        {
+          mitkThrow() << "Cannot decompress chunk " << chunkIndex << " of " << path;
+        }
+
+        if (chunkData != target)
+        {
+          std::memcpy(target, chunkData + (s0 - chunkFirstSlice) * sliceSize, (s1 - s0) * sliceSize);
+        }
+      });
+    }
+
+    // geometry, shifted to the first slice read
+    Vector3D spacing;
+    Point3D origin;
+    Matrix3D matrix;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      spacing[i] = header.Spacing[i];
+      origin[i] = header.Origin[i] + header.Direction[i * 3 + 2] * header.Spacing[2] * z0;
+      for (unsigned int j = 0; j < 3; ++j)
+        matrix[i][j] = header.Direction[i * 3 + j];
+    }
+
+    PlaneGeometry *planeGeometry = image->GetSlicedGeometry(0)->GetPlaneGeometry(0);
+    planeGeometry->SetOrigin(origin);
+    planeGeometry->GetIndexToWorldTransform()->SetMatrix(matrix);
+
+    SlicedGeometry3D *slicedGeometry = image->GetSlicedGeometry(0);
+    slicedGeometry->InitializeEvenlySpaced(planeGeometry, image->GetDimension(2));
+    slicedGeometry->SetSpacing(spacing);
+
+    TimeGeometry::Pointer timeGeometry;
+    if (header.TimeGeometry == ArbitraryTimeGeometryType && header.TimePoints.size() == header.Dimensions[3] + 1)
+    {
+      ArbitraryTimeGeometry::Pointer arbitraryTimeGeometry = ArbitraryTimeGeometry::New();
+      for (std::size_t t = t0; t < t1; ++t)
+      {
+        arbitraryTimeGeometry->AppendNewTimeStepClone(slicedGeometry, header.TimePoints[t], header.TimePoints[t + 1]);
+      }
+      timeGeometry = arbitraryTimeGeometry;
+    }
+    else
+    {
+      ProportionalTimeGeometry::Pointer proportionalTimeGeometry = ProportionalTimeGeometry::New();
+      proportionalTimeGeometry->Initialize(slicedGeometry, image->GetDimension(3));
+      if (header.TimePoints.size() == 2)
+      {
+        // avoid 0 * infinity for images with a single time step
+        proportionalTimeGeometry->SetFirstTimePoint(
+          t0 == 0 ? header.TimePoints[0] : header.TimePoints[0] + t0 * header.TimePoints[1]);
+        proportionalTimeGeometry->SetStepDuration(header.TimePoints[1]);
+      }
+      timeGeometry = proportionalTimeGeometry;
+    }
+
+    image->SetTimeGeometry(timeGeometry);
+
+    std::vector<BaseData::Pointer> result;
+    result.push_back(image.GetPointer());
+    return result;
+  }
+
+  IFileIO::ConfidenceLevel ChunkedImageIO::GetReaderConfidenceLevel() const
+  {
+    if (AbstractFileIO::GetReaderConfidenceLevel() == Unsupported)
+      return Unsupported;
+
+    std::ifstream stream(this->GetLocalFileName().c_str(), std::ios::binary);
+    char signature[sizeof(FileSignature)];
+    if (stream.read(signature, sizeof(signature)) && std::memcmp(signature, FileSignature, sizeof(signature)) == 0)
+      return Supported;
+
+    return Unsupported;
+  }
+
+  void ChunkedImageIO::Write()
+  {
+    ValidateOutputLocation();
+
+    const auto *image = dynamic_cast<const Image *>(this->GetInput());
+    if (image == nullptr)
+    {
+      mitkThrow() << "Cannot write non-image data";
+    }
+
+    const int compressionLevel =
+      std::max(0, std::min(9, GetIntOption(this->GetWriterOption(OPTION_COMPRESSION_LEVEL()), 1)));
+
+    const PixelType pixelType = image->GetPixelType();
+
+    FileHeader header;
+    header.ComponentType = GetFixedWidthComponentType(pixelType.GetComponentType());
+    header.PixelType = pixelType.GetPixelType();
+    header.NumberOfComponents = static_cast<std::uint32_t>(pixelType.GetNumberOfComponents());
+    header.Dimension = std::max(2u, image->GetDimension());
+    for (unsigned int i = 0; i < 4; ++i)
+      header.Dimensions[i] = image->GetDimension(i);
+
+    const BaseGeometry *geometry = image->GetGeometry();
+    const Vector3D spacing = geometry->GetSpacing();
+    const Point3D origin = geometry->GetOrigin();
+    const auto &matrix = geometry->GetIndexToWorldTransform()->GetMatrix();
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      header.Spacing[i] = spacing[i];
+      header.Origin[i] = origin[i];
+      for (unsigned int j = 0; j < 3; ++j)
+        header.Direction[i * 3 + j] = matrix[i][j] / spacing[j];
+    }
+
+    const TimeGeometry *timeGeometry = image->GetTimeGeometry();
+    if (const auto *arbitraryTimeGeometry = dynamic_cast<const ArbitraryTimeGeometry *>(timeGeometry))
+    {
+      header.TimeGeometry = ArbitraryTimeGeometryType;
+      header.TimePoints.push_back(arbitraryTimeGeometry->GetMinimumTimePoint(0));
+      for (TimeStepType t = 0; t < arbitraryTimeGeometry->CountTimeSteps(); ++t)
+        header.TimePoints.push_back(arbitraryTimeGeometry->GetMaximumTimePoint(t));
+    }
+    else if (const auto *proportionalTimeGeometry = dynamic_cast<const ProportionalTimeGeometry *>(timeGeometry))
+    {
+      header.TimeGeometry = ProportionalTimeGeometryType;
+      header.TimePoints.push_back(proportionalTimeGeometry->GetFirstTimePoint());
+      header.TimePoints.push_back(proportionalTimeGeometry->GetStepDuration());
+    }
+    else
+    {
+      mitkThrow() << "Cannot write images with a " << timeGeometry->GetNameOfClass();
+    }
+
+    const std::size_t sliceSize = header.GetSliceSize();
+    header.SlicesPerChunk = static_cast<std::uint32_t>(
+      std::max<std::size_t>(1, std::min<std::size_t>(header.Dimensions[2], TargetChunkSize / sliceSize)));
+
+    const std::size_t chunksPerTimeStep = header.GetChunksPerTimeStep();
+    const std::size_t numberOfChunks = chunksPerTimeStep * header.Dimensions[3];
+
+    OutputStream out(this, std::ios_base::binary | std::ios_base::trunc | std::ios_base::out);
+    if (!out.good())
+    {
+      mitkThrow() << "Stream not good.";
+    }
+
+    // chunk offsets are counted instead of queried, the output stream might not be seekable
+    std::ostringstream headerStream;
+    WriteHeader(headerStream, header);
+    const std::string headerData = headerStream.str();
+    out.write(headerData.data(), headerData.size());
+    std::uint64_t position = headerData.size();
+
+    ImageReadAccessor accessor(image);
+    const auto *data = static_cast<const char *>(accessor.GetData());
+
+    std::vector<ChunkInfo> chunks(numberOfChunks);
+
+    // compress a batch of chunks in parallel, then append them in order
+    const std::size_t batchSize =
+      4 * static_cast<std::size_t>(std::max(1, static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads())));
+    std::vector<std::vector<char>> buffers(batchSize);
+
+    for (std::size_t firstChunk = 0; firstChunk < numberOfChunks; firstChunk += batchSize)
+    {
+      const std::size_t count = std::min(batchSize, numberOfChunks - firstChunk);
+
+      auto chunkData = [&](std::size_t chunkIndex, std::size_t &size) {
+        const std::size_t t = chunkIndex / chunksPerTimeStep;
+        const std::size_t chunkFirstSlice = (chunkIndex % chunksPerTimeStep) * header.SlicesPerChunk;
+        size = std::min<std::size_t>(header.SlicesPerChunk, header.Dimensions[2] - chunkFirstSlice) * sliceSize;
+        return data + (t * header.Dimensions[2] + chunkFirstSlice) * sliceSize;
+      };
+
+      mitk::ParallelFor(count, [&](std::size_t index) {
+        std::vector<char> &buffer = buffers[index];
+        buffer.clear();
+
+        if (compressionLevel == 0)
+          return;
+
+        std::size_t size = 0;
+        const char *source = chunkData(firstChunk + index, size);
+
+        uLongf compressedSize = compressBound(static_cast<uLong>(size));
+        buffer.resize(compressedSize);
+        if (compress2(reinterpret_cast<Bytef *>(buffer.data()),
+                      &compressedSize,
+                      reinterpret_cast<const Bytef *>(source),
+                      static_cast<uLong>(size),
+                      compressionLevel) == Z_OK &&
+            compressedSize < size)
+        {
+          buffer.resize(compressedSize);
+        }
+        else
+        {
+          // incompressible chunks are stored as they are
+          buffer.clear();
+        }
+      });
+
+      for (std::size_t index = 0; index < count; ++index)
+      {
+        ChunkInfo &chunk = chunks[firstChunk + index];
+        chunk.Offset = position;
+
+        if (!buffers[index].empty())
+        {
+          chunk.Compressed = 1;
+          chunk.StoredSize = buffers[index].size();
+          out.write(buffers[index].data(), buffers[index].size());
+        }
+        else
+        {
+          std::size_t size = 0;
+          const char *source = chunkData(firstChunk + index, size);
+          chunk.StoredSize = size;
+          out.write(source, size);
+        }
+
+        position += chunk.StoredSize;
+      }
+    }
+
+    WriteValue(out, static_cast<std::uint64_t>(chunks.size()));
+    for (const auto &chunk : chunks)
+    {
+      WriteValue(out, chunk.Offset);
+      WriteValue(out, chunk.StoredSize);
+      WriteValue(out, chunk.Compressed);
+    }
+    WriteValue(out, position);
+
+    if (!out)
+    {
+      mitkThrow() << "Cannot write image to " << this->GetOutputLocation();
+    }
+  }
+
+  bool ChunkedImageIO::CanWriteImage(const Image *image)
+  {
+    if (image == nullptr || image->GetDimension() > 4 || image->GetNumberOfChannels() != 1 ||
+        image->GetPixelType().GetComponentType() >= PixelComponentUserType)
+      return false;
+
+    const TimeGeometry *timeGeometry = image->GetTimeGeometry();
+    return dynamic_cast<const ProportionalTimeGeometry *>(timeGeometry) != nullptr ||
+           dynamic_cast<const ArbitraryTimeGeometry *>(timeGeometry) != nullptr;
+  }
+
+  IFileIO::ConfidenceLevel ChunkedImageIO::GetWriterConfidenceLevel() const
+  {
+    if (AbstractFileIO::GetWriterConfidenceLevel() == Unsupported)
+      return Unsupported;
+
+    return CanWriteImage(dynamic_cast<const Image *>(this->GetInput())) ? Supported : Unsupported;
+  }
+
+  ChunkedImageIO *ChunkedImageIO::IOClone() const { return new ChunkedImageIO(*this); }
+}
@@ -98,6 +98,7 @@ namespace mitk
 
     mimeTypes.push_back(NRRD_MIMETYPE().Clone());
     mimeTypes.push_back(NIFTI_MIMETYPE().Clone());
+    mimeTypes.push_back(MITK_IMAGE_MIMETYPE().Clone());
 
     mimeTypes.push_back(VTK_IMAGE_MIMETYPE().Clone());
     mimeTypes.push_back(VTK_PARALLEL_IMAGE_MIMETYPE().Clone());
@@ -345,6 +346,21 @@ namespace mitk
     return name;
   }
 
+  CustomMimeType IOMimeTypes::MITK_IMAGE_MIMETYPE()
+  {
+    CustomMimeType mimeType(MITK_IMAGE_MIMETYPE_NAME());
+    mimeType.AddExtension("mitkimage");
+    mimeType.SetCategory(CATEGORY_IMAGES());
+    mimeType.SetComment("MITK Chunked Image");
+    return mimeType;
+  }
+
+  std::string IOMimeTypes::MITK_IMAGE_MIMETYPE_NAME()
+  {
+    static std::string name = DEFAULT_BASE_NAME() + ".image.mitk";
+    return name;
+  }
+
   CustomMimeType IOMimeTypes::GEOMETRY_DATA_MIMETYPE()
   {
     mitk::CustomMimeType mimeType(DEFAULT_BASE_NAME() + ".geometrydata");
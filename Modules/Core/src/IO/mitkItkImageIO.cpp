@@ -24,14 +24,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 #include <mitkImageReadAccessor.h>
 #include <mitkLocaleSwitch.h>
+#include <mitkMemoryMappedFile.h>
 
 #include <itkImage.h>
 #include <itkImageFileReader.h>
 #include <itkImageIOFactory.h>
+#include <itkByteSwapper.h>
 #include <itkImageIORegion.h>
 #include <itkMetaDataObject.h>
 
+#include <itksys/SystemTools.hxx>
+
 #include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 namespace mitk
 {
@@ -40,6 +47,192 @@ namespace mitk
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TYPE = "org_mitk_timegeometry_type";
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TIMEPOINTS = "org_mitk_timegeometry_timepoints";
 
+  std::string ItkImageIO::OPTION_MEMORY_MAPPING()
+  {
+    static std::string s = "Memory mapping";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_FIRST_TIME_STEP()
+  {
+    static std::string s = "First time step";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_NUMBER_OF_TIME_STEPS()
+  {
+    static std::string s = "Number of time steps";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_REGION_INDEX(unsigned int axis)
+  {
+    static const std::string s[] = {"Region index x", "Region index y", "Region index z"};
+    if (axis > 2)
+      mitkThrow() << "Invalid region axis " << axis;
+    return s[axis];
+  }
+
+  std::string ItkImageIO::OPTION_REGION_SIZE(unsigned int axis)
+  {
+    static const std::string s[] = {"Region size x", "Region size y", "Region size z"};
+    if (axis > 2)
+      mitkThrow() << "Invalid region axis " << axis;
+    return s[axis];
+  }
+
+  /**Helper function that parses an integer value of a NRRD header field. Returns false if the value
+   * is not a single integer.*/
+  bool ParseNrrdInteger(const std::string &text, long long &value)
+  {
+    std::istringstream stream(text);
+    stream >> value;
+
+    return !stream.fail() && (stream >> std::ws).eof();
+  }
+
+  /**Helper function that locates the pixel data of an uncompressed NRRD file in native byte order.
+   * Returns false if the file cannot be memory mapped (e.g. compressed, other byte order, multiple
+   * detached data files or a file format other than NRRD).*/
+  bool LocateUncompressedNrrdPayload(const std::string &path,
+                                     const itk::ImageIOBase *imageIO,
+                                     std::string &dataFileName,
+                                     size_t &offset)
+  {
+    if (std::string("NrrdImageIO") != imageIO->GetNameOfClass() || imageIO->GetNumberOfComponents() != 1)
+      return false;
+
+    std::ifstream stream(path.c_str(), std::ios::binary);
+    std::string line;
+
+    if (!std::getline(stream, line) || line.compare(0, 4, "NRRD") != 0)
+      return false;
+
+    std::string encoding;
+    std::string endian;
+    long long byteSkip = 0;
+    long long lineSkip = 0;
+    dataFileName.clear();
+
+    while (std::getline(stream, line))
+    {
+      if (!line.empty() && '\r' == line.back())
+        line.pop_back();
+
+      if (line.empty())
+        break;
+
+      if ('#' == line[0])
+        continue;
+
+      const auto separator = line.find(": ");
+      if (std::string::npos == separator)
+        continue; // key/value pairs ("key:=value") are not relevant
+
+      const std::string field = line.substr(0, separator);
+      const std::string value = line.substr(separator + 2);
+
+      if ("encoding" == field)
+        encoding = value;
+      else if ("endian" == field)
+        endian = value;
+      else if ("byte skip" == field || "byteskip" == field)
+      {
+        // malformed headers are left to the regular reader
+        if (!ParseNrrdInteger(value, byteSkip))
+          return false;
+      }
+      else if ("line skip" == field || "lineskip" == field)
+      {
+        if (!ParseNrrdInteger(value, lineSkip))
+          return false;
+      }
+      else if ("data file" == field || "datafile" == field)
+        dataFileName = value;
+    }
+
+    if ("raw" != encoding || 0 != lineSkip)
+      return false;
+
+    if (imageIO->GetComponentSize() > 1)
+    {
+      const bool isSystemBigEndian = itk::ByteSwapper<int>::SystemIsBigEndian();
+      if (endian != (isSystemBigEndian ? "big" : "little"))
+        return false;
+    }
+
+    const auto payloadSize = static_cast<long long>(imageIO->GetImageSizeInBytes());
+
+    if (dataFileName.empty())
+    {
+      if (!stream)
+        return false;
+
+      dataFileName = path;
+      offset = static_cast<size_t>(stream.tellg());
+    }
+    else
+    {
+      // lists and format strings of several data files are not supported
+      if (dataFileName.find(' ') != std::string::npos || "LIST" == dataFileName)
+        return false;
+
+      if (!itksys::SystemTools::FileIsFullPath(dataFileName))
+        dataFileName = itksys::SystemTools::GetFilenamePath(path) + "/" + dataFileName;
+
+      offset = 0;
+    }
+
+    if (-1 == byteSkip)
+    {
+      // the data are located at the end of the file
+      const auto fileSize = static_cast<long long>(itksys::SystemTools::FileLength(dataFileName));
+      if (fileSize < static_cast<long long>(offset) + payloadSize)
+        return false;
+
+      offset = static_cast<size_t>(fileSize - payloadSize);
+    }
+    else if (byteSkip < 0)
+    {
+      return false;
+    }
+    else
+    {
+      offset += static_cast<size_t>(byteSkip);
+    }
+
+    return true;
+  }
+
+  /**Helper function that copies the region given by start and size out of a complete 4D pixel buffer
+   * with the given dimensions. Each contiguous row of the region is copied at once.*/
+  void CopyImageRegion(const char *source,
+                       const unsigned int *dimensions,
+                       const unsigned int *start,
+                       const unsigned int *size,
+                       size_t pixelSize,
+                       char *target)
+  {
+    const size_t rowSize = size[0] * pixelSize;
+
+    for (unsigned int t = 0; t < size[3]; ++t)
+    {
+      for (unsigned int z = 0; z < size[2]; ++z)
+      {
+        for (unsigned int y = 0; y < size[1]; ++y)
+        {
+          const size_t sourceIndex =
+            ((static_cast<size_t>(start[3] + t) * dimensions[2] + start[2] + z) * dimensions[1] + start[1] + y) *
+              dimensions[0] +
+            start[0];
+
+          std::memcpy(target, source + sourceIndex * pixelSize, rowSize);
+          target += rowSize;
+        }
+      }
+    }
+  }
+
   ItkImageIO::ItkImageIO(const ItkImageIO &other)
     : AbstractFileIO(other), m_ImageIO(dynamic_cast<itk::ImageIOBase *>(other.m_ImageIO->Clone().GetPointer()))
   {
@@ -124,6 +317,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultReaderOptions();
 
     std::vector<std::string> readExtensions = m_ImageIO->GetSupportedReadExtensions();
 
@@ -209,6 +403,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultReaderOptions();
 
     if (rank)
     {
@@ -274,6 +469,63 @@ namespace mitk
       ndim = MAXDIM;
     }
 
+    unsigned int fullDimensions[MAXDIM] = {1, 1, 1, 1};
+    unsigned int regionStart[MAXDIM] = {0, 0, 0, 0};
+    unsigned int regionSize[MAXDIM] = {1, 1, 1, 1};
+
+    unsigned int i;
+    for (i = 0; i < ndim; ++i)
+    {
+      fullDimensions[i] = m_ImageIO->GetDimensions(i);
+      regionSize[i] = fullDimensions[i];
+    }
+
+    // restrict the read to the region requested by the reader options
+    for (i = 0; i < std::min(ndim, 3u); ++i)
+    {
+      auto regionIndexOption = this->GetReaderOption(OPTION_REGION_INDEX(i));
+      auto regionSizeOption = this->GetReaderOption(OPTION_REGION_SIZE(i));
+      const int index = regionIndexOption.Empty() ? 0 : us::any_cast<int>(regionIndexOption);
+      const int requestedSize = regionSizeOption.Empty() ? 0 : us::any_cast<int>(regionSizeOption);
+      const int size = requestedSize > 0 ? requestedSize : static_cast<int>(fullDimensions[i]) - index;
+
+      if (index < 0 || size <= 0 || index + size > static_cast<int>(fullDimensions[i]))
+      {
+        mitkThrow() << "Requested region (index " << index << ", size " << size << ") exceeds dimension " << i
+                    << " of " << path << " (" << fullDimensions[i] << ")";
+      }
+
+      regionStart[i] = index;
+      regionSize[i] = size;
+    }
+
+    if (ndim == MAXDIM)
+    {
+      auto firstTimeStepOption = this->GetReaderOption(OPTION_FIRST_TIME_STEP());
+      auto numberOfTimeStepsOption = this->GetReaderOption(OPTION_NUMBER_OF_TIME_STEPS());
+      const int firstTimeStep = firstTimeStepOption.Empty() ? 0 : us::any_cast<int>(firstTimeStepOption);
+      const int numberOfTimeSteps = numberOfTimeStepsOption.Empty() || us::any_cast<int>(numberOfTimeStepsOption) == 0
+                                      ? static_cast<int>(fullDimensions[3]) - firstTimeStep
+                                      : us::any_cast<int>(numberOfTimeStepsOption);
+
+      if (firstTimeStep < 0 || numberOfTimeSteps <= 0 ||
+          firstTimeStep + numberOfTimeSteps > static_cast<int>(fullDimensions[3]))
+      {
+        mitkThrow() << "Requested time steps " << firstTimeStep << " + " << numberOfTimeSteps << " exceed the "
+                    << fullDimensions[3] << " time steps of " << path;
+      }
+
+      regionStart[3] = firstTimeStep;
+      regionSize[3] = numberOfTimeSteps;
+    }
+
+    bool isPartialRegion = false;
+    for (i = 0; i < MAXDIM; ++i)
+    {
+      if (regionSize[i] != fullDimensions[i])
+        isPartialRegion = true;
+    }
+
     itk::ImageIORegion ioRegion(ndim);
     itk::ImageIORegion::SizeType ioSize = ioRegion.GetSize();
     itk::ImageIORegion::IndexType ioStart = ioRegion.GetIndex();
@@ -293,14 +545,13 @@ namespace mitk
     Point3D origin;
     origin.Fill(0);
 
-    unsigned int i;
     for (i = 0; i < ndim; ++i)
     {
-      ioStart[i] = 0;
-      ioSize[i] = m_ImageIO->GetDimensions(i);
+      ioStart[i] = regionStart[i];
+      ioSize[i] = regionSize[i];
       if (i < MAXDIM)
       {
-        dimensions[i] = m_ImageIO->GetDimensions(i);
+        dimensions[i] = regionSize[i];
         spacing[i] = m_ImageIO->GetSpacing(i);
         if (spacing[i] <= 0)
           spacing[i] = 1.0f;
@@ -316,11 +567,122 @@ namespace mitk
 
     MITK_INFO << "ioRegion: " << ioRegion << std::endl;
     m_ImageIO->SetIORegion(ioRegion);
-    void *buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
-    m_ImageIO->Read(buffer);
 
-    image->Initialize(MakePixelType(m_ImageIO), ndim, dimensions);
-    image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    // a single time step requested from a 4D image results in a 3D image
+    unsigned int imageDimension = ndim;
+    if (ndim == MAXDIM && regionSize[3] == 1 && fullDimensions[3] > 1)
+      imageDimension = 3;
+
+    image->Initialize(MakePixelType(m_ImageIO), imageDimension, dimensions);
+
+    bool isMemoryMapped = false;
+    auto memoryMappingOption = this->GetReaderOption(OPTION_MEMORY_MAPPING());
+
+    if (!memoryMappingOption.Empty() && us::any_cast<bool>(memoryMappingOption) &&
+        ndim == m_ImageIO->GetNumberOfDimensions() && !isPartialRegion)
+    {
+      std::string dataFileName;
+      size_t offset = 0;
+
+      if (LocateUncompressedNrrdPayload(path, m_ImageIO, dataFileName, offset))
+      {
+        try
+        {
+          auto mappedFile = MemoryMappedFile::New(dataFileName, offset, m_ImageIO->GetImageSizeInBytes());
+          isMemoryMapped = image->SetMappedChannel(mappedFile);
+        }
+        catch (const mitk::Exception &e)
+        {
+          MITK_WARN << "Memory mapping failed, reading file instead: " << e.GetDescription();
+        }
+      }
+      else
+      {
+        MITK_INFO << "Memory mapping is only supported for uncompressed NRRD files in native byte order. Reading "
+                  << path << " instead.";
+      }
+    }
+
+    void *buffer = nullptr;
+    if (!isMemoryMapped && !isPartialRegion)
+    {
+      buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
+      m_ImageIO->Read(buffer);
+      image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    }
+    else if (!isMemoryMapped)
+    {
+      const size_t pixelSize = m_ImageIO->GetPixelSize();
+      buffer = new unsigned char[ioRegion.GetNumberOfPixels() * pixelSize];
+
+      if (m_ImageIO->CanStreamRead())
+      {
+        // the ImageIO reads the requested region only, it is shared with later reads of complete files
+        const bool useStreamedReading = m_ImageIO->GetUseStreamedReading();
+        m_ImageIO->SetUseStreamedReading(true);
+        try
+        {
+          m_ImageIO->Read(buffer);
+        }
+        catch (...)
+        {
+          m_ImageIO->SetUseStreamedReading(useStreamedReading);
+          delete[] static_cast<unsigned char *>(buffer);
+          throw;
+        }
+        m_ImageIO->SetUseStreamedReading(useStreamedReading);
+      }
+      else
+      {
+        // uncompressed NRRD payloads are mapped, so that only the pages of the region are read
+        MemoryMappedFile::Pointer mappedFile;
+        std::string dataFileName;
+        size_t offset = 0;
+
+        if (ndim == m_ImageIO->GetNumberOfDimensions() &&
+            LocateUncompressedNrrdPayload(path, m_ImageIO, dataFileName, offset))
+        {
+          try
+          {
+            mappedFile = MemoryMappedFile::New(dataFileName, offset, m_ImageIO->GetImageSizeInBytes());
+          }
+          catch (const mitk::Exception &e)
+          {
+            MITK_DEBUG << "Memory mapping failed, reading complete file instead: " << e.GetDescription();
+          }
+        }
+
+        if (mappedFile.IsNotNull())
+        {
+          CopyImageRegion(static_cast<const char *>(mappedFile->GetData()),
+                          fullDimensions,
+                          regionStart,
+                          regionSize,
+                          pixelSize,
+                          static_cast<char *>(buffer));
+        }
+        else
+        {
+          MITK_INFO << m_ImageIO->GetNameOfClass() << " does not support streaming, reading the complete image to "
+                    << "extract the requested region";
+
+          itk::ImageIORegion fullRegion(ndim);
+          for (i = 0; i < ndim; ++i)
+          {
+            fullRegion.SetIndex(i, 0);
+            fullRegion.SetSize(i, fullDimensions[i]);
+          }
+          m_ImageIO->SetIORegion(fullRegion);
+
+          std::vector<char> fullBuffer(m_ImageIO->GetImageSizeInBytes());
+          m_ImageIO->Read(fullBuffer.data());
+          CopyImageRegion(
+            fullBuffer.data(), fullDimensions, regionStart, regionSize, pixelSize, static_cast<char *>(buffer));
+        }
+      }
+
+      image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    }
 
     const itk::MetaDataDictionary &dictionary = m_ImageIO->GetMetaDataDictionary();
 
@@ -332,6 +694,11 @@ namespace mitk
       for (j = 0; j < itkDimMax3; ++j)
         matrix[i][j] = m_ImageIO->GetDirection(j)[i];
 
+    // move the origin to the first voxel of the read region
+    for (i = 0; i < itkDimMax3; ++i)
+      for (j = 0; j < itkDimMax3; ++j)
+        origin[i] += matrix[i][j] * spacing[j] * regionStart[j];
+
     // re-initialize PlaneGeometry with origin and direction
     PlaneGeometry *planeGeometry = image->GetSlicedGeometry(0)->GetPlaneGeometry(0);
     planeGeometry->SetOrigin(origin);
@@ -378,19 +745,20 @@ namespace mitk
           timePoints = ConvertMetaDataObjectToTimePointList(dictionary.Get(PROPERTY_KEY_TIMEGEOMETRY_TIMEPOINTS));
         }
 
-        if (timePoints.size() - 1 != image->GetDimension(3))
+        if (timePoints.size() - 1 != fullDimensions[3])
         {
           MITK_ERROR << "Stored timepoints (" << timePoints.size() - 1 << ") and size of image time dimension ("
-                     << image->GetDimension(3) << ") do not match. Switch to ProportionalTimeGeometry fallback"
+                     << fullDimensions[3] << ") do not match. Switch to ProportionalTimeGeometry fallback"
                      << std::endl;
         }
         else
         {
           ArbitraryTimeGeometry::Pointer arbitraryTimeGeometry = ArbitraryTimeGeometry::New();
-          TimePointVector::const_iterator pos = timePoints.begin();
+          TimePointVector::const_iterator pos = timePoints.begin() + regionStart[3];
           auto prePos = pos++;
+          const auto end = pos + regionSize[3];
 
-          for (; pos != timePoints.end(); ++prePos, ++pos)
+          for (; pos != end; ++prePos, ++pos)
           {
             arbitraryTimeGeometry->AppendNewTimeStepClone(slicedGeometry, *prePos, *pos);
           }
@@ -405,6 +773,8 @@ namespace mitk
       MITK_INFO << "used time geometry: " << ProportionalTimeGeometry::GetStaticNameOfClass() << std::endl;
       ProportionalTimeGeometry::Pointer propTimeGeometry = ProportionalTimeGeometry::New();
       propTimeGeometry->Initialize(slicedGeometry, image->GetDimension(3));
+      if (regionStart[3] > 0)
+        propTimeGeometry->SetFirstTimePoint(regionStart[3] * propTimeGeometry->GetStepDuration());
       timeGeometry = propTimeGeometry;
     }
 
@@ -692,6 +1062,20 @@ namespace mitk
   }
 
   ItkImageIO *ItkImageIO::IOClone() const { return new ItkImageIO(*this); }
+  void ItkImageIO::InitializeDefaultReaderOptions()
+  {
+    Options defaultOptions;
+    defaultOptions[OPTION_MEMORY_MAPPING()] = us::Any(false);
+    defaultOptions[OPTION_FIRST_TIME_STEP()] = us::Any(0);
+    defaultOptions[OPTION_NUMBER_OF_TIME_STEPS()] = us::Any(0);
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+      defaultOptions[OPTION_REGION_INDEX(axis)] = us::Any(0);
+      defaultOptions[OPTION_REGION_SIZE(axis)] = us::Any(0);
+    }
+    this->SetDefaultReaderOptions(defaultOptions);
+  }
+
   void ItkImageIO::InitializeDefaultMetaDataKeys()
   {
     this->m_DefaultMetaDataKeys.push_back("NRRD.space");
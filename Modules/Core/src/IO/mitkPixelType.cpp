@@ -180,3 +180,57 @@ mitk::PixelType mitk::MakePixelType(vtkImageData *vtkimagedata)
 
   mitkThrow() << "tried to make pixeltype from vtkimage of unknown data type(short, char, int, ...)";
 }
+
+mitk::PixelType mitk::MakePixelType(int componentType,
+                                    itk::ImageIOBase::IOPixelType pixelType,
+                                    std::size_t numberOfComponents)
+{
+  std::size_t bytesPerComponent = 0;
+  switch (componentType)
+  {
+    case itk::ImageIOBase::UCHAR:
+    case itk::ImageIOBase::CHAR:
+      bytesPerComponent = sizeof(char);
+      break;
+
+    case itk::ImageIOBase::USHORT:
+    case itk::ImageIOBase::SHORT:
+      bytesPerComponent = sizeof(short);
+      break;
+
+    case itk::ImageIOBase::UINT:
+    case itk::ImageIOBase::INT:
+      bytesPerComponent = sizeof(int);
+      break;
+
+    case itk::ImageIOBase::ULONG:
+    case itk::ImageIOBase::LONG:
+      bytesPerComponent = sizeof(long);
+      break;
+
+    case itk::ImageIOBase::ULONGLONG:
+    case itk::ImageIOBase::LONGLONG:
+      bytesPerComponent = sizeof(long long);
+      break;
+
+    case itk::ImageIOBase::FLOAT:
+      bytesPerComponent = sizeof(float);
+      break;
+
+    case itk::ImageIOBase::DOUBLE:
+      bytesPerComponent = sizeof(double);
+      break;
+
+    default:
+      mitkThrow() << "tried to make pixeltype from unknown component type " << componentType;
+  }
+
+  const auto ioComponentType = static_cast<itk::ImageIOBase::IOComponentType>(componentType);
+
+  return PixelType(componentType,
+                   pixelType,
+                   bytesPerComponent,
+                   numberOfComponents,
+                   itk::ImageIOBase::GetComponentTypeAsString(ioComponentType),
+                   itk::ImageIOBase::GetPixelTypeAsString(pixelType));
+}
@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCoreActivator.h"
 
 // File IO
+#include <mitkChunkedImageIO.h>
 #include <mitkGeometryDataReaderService.h>
 #include <mitkGeometryDataWriterService.h>
 #include <mitkIOMimeTypes.h>
@@ -284,6 +285,8 @@ void MitkCoreActivator::RegisterItkReaderWriter()
   FixedNiftiImageIO::Pointer itkNiftiIO = FixedNiftiImageIO::New();
   mitk::ItkImageIO *niftiIO = new mitk::ItkImageIO(mitk::IOMimeTypes::NIFTI_MIMETYPE(), itkNiftiIO.GetPointer(), 0);
   m_FileIOs.push_back(niftiIO);
+
+  m_FileIOs.push_back(new mitk::ChunkedImageIO());
 }
 
 void MitkCoreActivator::RegisterVtkReaderWriter()
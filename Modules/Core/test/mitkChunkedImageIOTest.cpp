@@ -0,0 +1,151 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+
+#include <mitkChunkedImageIO.h>
+#include <mitkIOUtil.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+
+#include <cstring>
+
+class mitkChunkedImageIOTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkChunkedImageIOTestSuite);
+  MITK_TEST(TestWriteAndReadRandomImage);
+  MITK_TEST(TestWriteAndReadCompressibleImage);
+  MITK_TEST(TestWriteAndReadLongImage);
+  MITK_TEST(TestReadTimeStepAndSlab);
+  MITK_TEST(TestReadInvalidRegion);
+  MITK_TEST(TestCanWriteImage);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  std::string m_FileName;
+
+public:
+  void setUp() override
+  {
+    // several chunks per time step, the last one only partially filled
+    m_Image = mitk::ImageGenerator::GenerateRandomImage<float>(256, 256, 40, 2, 0.5, 0.75, 2.0);
+    mitk::Point3D origin;
+    mitk::FillVector3D(origin, -10.0, 20.0, 5.0);
+    m_Image->SetOrigin(origin);
+
+    m_FileName = mitk::IOUtil::CreateTemporaryFile("chunked-XXXXXX.mitkimage");
+  }
+
+  void tearDown() override
+  {
+    m_Image = nullptr;
+    std::remove(m_FileName.c_str());
+  }
+
+  void TestWriteAndReadRandomImage()
+  {
+    mitk::IOUtil::Save(m_Image, m_FileName);
+    auto loadedImage = mitk::IOUtil::Load<mitk::Image>(m_FileName);
+
+    MITK_ASSERT_EQUAL(m_Image, loadedImage, "Image read from the chunked format should equal the written image");
+  }
+
+  void TestWriteAndReadCompressibleImage()
+  {
+    auto image = mitk::ImageGenerator::GenerateGradientImage<short>(256, 256, 40);
+
+    mitk::IOUtil::Save(image, m_FileName);
+    auto loadedImage = mitk::IOUtil::Load<mitk::Image>(m_FileName);
+
+    MITK_ASSERT_EQUAL(image, loadedImage, "Compressed image should equal the written image");
+  }
+
+  void TestWriteAndReadLongImage()
+  {
+    auto image = mitk::ImageGenerator::GenerateGradientImage<long>(64, 64, 8);
+
+    mitk::IOUtil::Save(image, m_FileName);
+    auto loadedImage = mitk::IOUtil::Load<mitk::Image>(m_FileName);
+
+    // long is stored as the fixed-width type of the same size
+    const auto componentType = loadedImage->GetPixelType().GetComponentType();
+    CPPUNIT_ASSERT(componentType != itk::ImageIOBase::LONG);
+    CPPUNIT_ASSERT_EQUAL(sizeof(long), loadedImage->GetPixelType().GetSize());
+
+    mitk::ImageReadAccessor imageAccessor(image);
+    mitk::ImageReadAccessor loadedAccessor(loadedImage);
+    CPPUNIT_ASSERT(std::memcmp(imageAccessor.GetData(), loadedAccessor.GetData(), 64 * 64 * 8 * sizeof(long)) == 0);
+  }
+
+  void TestReadTimeStepAndSlab()
+  {
+    mitk::IOUtil::Save(m_Image, m_FileName);
+
+    mitk::IFileReader::Options options;
+    options[mitk::ChunkedImageIO::OPTION_TIME_STEP()] = us::Any(1);
+    options[mitk::ChunkedImageIO::OPTION_FIRST_SLICE()] = us::Any(10);
+    options[mitk::ChunkedImageIO::OPTION_NUMBER_OF_SLICES()] = us::Any(25);
+
+    auto slab = mitk::IOUtil::Load<mitk::Image>(m_FileName, options);
+
+    CPPUNIT_ASSERT_EQUAL(3u, slab->GetDimension());
+    CPPUNIT_ASSERT_EQUAL(25u, slab->GetDimension(2));
+
+    const std::size_t sliceSize = 256 * 256 * sizeof(float);
+    mitk::ImageReadAccessor imageAccessor(m_Image);
+    mitk::ImageReadAccessor slabAccessor(slab);
+    const auto *expected = static_cast<const char *>(imageAccessor.GetData()) + (40 + 10) * sliceSize;
+    CPPUNIT_ASSERT(std::memcmp(expected, slabAccessor.GetData(), 25 * sliceSize) == 0);
+
+    mitk::Point3D index;
+    mitk::FillVector3D(index, 0.0, 0.0, 10.0);
+    mitk::Point3D expectedOrigin;
+    m_Image->GetGeometry()->IndexToWorld(index, expectedOrigin);
+    CPPUNIT_ASSERT_MESSAGE("Slab origin should be the world position of its first slice",
+                           mitk::Equal(expectedOrigin, slab->GetGeometry()->GetOrigin()));
+    CPPUNIT_ASSERT_MESSAGE("Spacing should be kept",
+                           mitk::Equal(m_Image->GetGeometry()->GetSpacing(), slab->GetGeometry()->GetSpacing()));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(m_Image->GetTimeGeometry()->GetMinimumTimePoint(1),
+                                 slab->GetTimeGeometry()->GetMinimumTimePoint(),
+                                 mitk::eps);
+  }
+
+  void TestCanWriteImage()
+  {
+    CPPUNIT_ASSERT(mitk::ChunkedImageIO::CanWriteImage(m_Image));
+    CPPUNIT_ASSERT(!mitk::ChunkedImageIO::CanWriteImage(nullptr));
+
+    unsigned int dimensions[] = {8, 8, 4};
+    auto twoChannelImage = mitk::Image::New();
+    twoChannelImage->Initialize(mitk::MakeScalarPixelType<short>(), 3, dimensions, 2);
+    CPPUNIT_ASSERT(!mitk::ChunkedImageIO::CanWriteImage(twoChannelImage));
+  }
+
+  void TestReadInvalidRegion()
+  {
+    mitk::IOUtil::Save(m_Image, m_FileName);
+
+    mitk::IFileReader::Options options;
+    options[mitk::ChunkedImageIO::OPTION_FIRST_SLICE()] = us::Any(30);
+    options[mitk::ChunkedImageIO::OPTION_NUMBER_OF_SLICES()] = us::Any(20);
+
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::Load(m_FileName, options), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkChunkedImageIO)
@@ -546,6 +546,26 @@ void TestDataStorage(mitk::DataStorage *ds, std::string filename)
       mitk::NodePredicateDataType::Pointer p(mitk::NodePredicateDataType::New("PointSet"));
       MITK_TEST_CONDITION(ds->GetNode(p) == nullptr, "Checking GetNode with invalid predicate");
     }
+    /* Checking that indexed queries follow changes of the nodes */
+    {
+      mitk::StringProperty *nameProperty = dynamic_cast<mitk::StringProperty *>(n2->GetProperty("name"));
+      nameProperty->SetValue("Node 2 - Renamed");
+      MITK_TEST_CONDITION((ds->GetNamedNode("Node 2 - Renamed") == n2) &&
+                            (ds->GetNamedNode("Node 2 - Surface Node") == nullptr),
+                          "Checking GetNamedNode after changing the value of the name property");
+
+      n2->SetName("Node 2 - Surface Node");
+      MITK_TEST_CONDITION((ds->GetNamedNode("Node 2 - Surface Node") == n2) &&
+                            (ds->GetNamedNode("Node 2 - Renamed") == nullptr),
+                          "Checking GetNamedNode after renaming the node");
+
+      mitk::NodePredicateAnd::Pointer p = mitk::NodePredicateAnd::New(
+        mitk::NodePredicateDataType::New("Surface"),
+        mitk::NodePredicateProperty::New("name", mitk::StringProperty::New("Node 2 - Surface Node")));
+      const mitk::DataStorage::SetOfObjects::ConstPointer all = ds->GetSubset(p);
+      MITK_TEST_CONDITION((all->Size() == 1) && (all->GetElement(0) == n2),
+                          "Checking GetSubset with a conjunction of indexed predicates");
+    }
   } // object retrieval methods
   catch (...)
   {
@@ -0,0 +1,230 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+
+#include <mitkExtractSliceFilter2.h>
+#include <mitkImageCast.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+class mitkExtractSliceFilter2TestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkExtractSliceFilter2TestSuite);
+  MITK_TEST(TestThreadedNearestNeighbor);
+  MITK_TEST(TestThreadedLinear);
+  MITK_TEST(TestThreadedCubic);
+  MITK_TEST(TestNearestNeighborMatchesItk);
+  MITK_TEST(TestLinearMatchesItk);
+  MITK_TEST(TestCubicMatchesItk);
+  MITK_TEST(TestCubicAfterInputModified);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  mitk::PlaneGeometry::Pointer m_ObliquePlane;
+
+  mitk::Image::Pointer ExtractSlice(mitk::ExtractSliceFilter2::Interpolator interpolator, itk::ThreadIdType numberOfThreads)
+  {
+    auto filter = mitk::ExtractSliceFilter2::New();
+    filter->SetInput(m_Image);
+    filter->SetOutputGeometry(m_ObliquePlane);
+    filter->SetInterpolator(interpolator);
+    filter->SetNumberOfThreads(numberOfThreads);
+    filter->Update();
+
+    return filter->GetOutput();
+  }
+
+  void CompareThreadedToSingleThreaded(mitk::ExtractSliceFilter2::Interpolator interpolator)
+  {
+    auto singleThreaded = this->ExtractSlice(interpolator, 1);
+    auto threaded = this->ExtractSlice(interpolator, 7);
+
+    CPPUNIT_ASSERT_EQUAL(singleThreaded->GetDimension(0), threaded->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(singleThreaded->GetDimension(1), threaded->GetDimension(1));
+
+    const std::size_t size = singleThreaded->GetDimension(0) * singleThreaded->GetDimension(1) * singleThreaded->GetPixelType().GetSize();
+
+    mitk::ImageReadAccessor singleThreadedAccessor(singleThreaded);
+    mitk::ImageReadAccessor threadedAccessor(threaded);
+
+    CPPUNIT_ASSERT_MESSAGE("Threaded slice extraction should equal single-threaded slice extraction",
+                           std::memcmp(singleThreadedAccessor.GetData(), threadedAccessor.GetData(), size) == 0);
+  }
+
+  typedef itk::Image<short, 3> ItkImageType;
+
+  /** Compares the extracted slice to the given ITK interpolator evaluated at the world position of every output pixel.
+   *
+   * The filter steps through the plane incrementally while ITK transforms every point on its own, so values may differ
+   * by one due to truncation and pixels exactly on a rounding or border decision may flip. At most 0.1% of the pixels
+   * may deviate by more than one.
+   */
+  void CompareToItk(mitk::ExtractSliceFilter2::Interpolator interpolator, itk::InterpolateImageFunction<ItkImageType>* itkInterpolator)
+  {
+    ItkImageType::Pointer itkImage;
+    mitk::CastToItkImage(m_Image, itkImage);
+    itkInterpolator->SetInputImage(itkImage);
+
+    auto slice = this->ExtractSlice(interpolator, 4);
+    mitk::ImageReadAccessor accessor(slice);
+    auto data = static_cast<const short*>(accessor.GetData());
+
+    const unsigned int width = slice->GetDimension(0);
+    const unsigned int height = slice->GetDimension(1);
+
+    auto xDirection = m_ObliquePlane->GetAxisVector(0);
+    auto yDirection = m_ObliquePlane->GetAxisVector(1);
+    xDirection.Normalize();
+    yDirection.Normalize();
+    const auto spacing = m_ObliquePlane->GetSpacing();
+
+    unsigned int numberOfInside = 0;
+    unsigned int numberOfDeviations = 0;
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+      for (unsigned int x = 0; x < width; ++x)
+      {
+        const mitk::Point3D point = m_ObliquePlane->GetOrigin() + xDirection * (spacing[0] * x) + yDirection * (spacing[1] * y);
+
+        itk::ContinuousIndex<mitk::ScalarType, 3> index;
+        itkImage->TransformPhysicalPointToContinuousIndex(point, index);
+
+        short expected = std::numeric_limits<short>::lowest();
+        if (itkImage->GetLargestPossibleRegion().IsInside(index))
+        {
+          expected = static_cast<short>(itkInterpolator->EvaluateAtContinuousIndex(index));
+          ++numberOfInside;
+        }
+
+        if (std::abs(static_cast<int>(expected) - data[y * width + x]) > 1)
+          ++numberOfDeviations;
+      }
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("The plane should intersect the volume", numberOfInside > width * height / 4);
+    CPPUNIT_ASSERT_MESSAGE("Extracted slice should match the ITK interpolator", numberOfDeviations <= width * height / 1000);
+  }
+
+public:
+  void setUp() override
+  {
+    m_Image = mitk::ImageGenerator::GenerateRandomImage<short>(64, 48, 40, 1, 0.8, 1.0, 1.5, 1000.0, -1000.0);
+
+    // oblique plane that leaves the volume on some of its rows so that both
+    // interpolated and background pixels are covered
+    mitk::Vector3D right;
+    mitk::FillVector3D(right, 1.0, 0.3, 0.2);
+    mitk::Vector3D down;
+    mitk::FillVector3D(down, -0.25, 1.0, 0.4);
+    mitk::Vector3D spacing;
+    mitk::FillVector3D(spacing, 0.7, 0.9, 1.0);
+
+    m_ObliquePlane = mitk::PlaneGeometry::New();
+    m_ObliquePlane->InitializeStandardPlane(97, 83, right, down, &spacing);
+    m_ObliquePlane->SetImageGeometry(true);
+
+    mitk::Point3D origin;
+    mitk::FillVector3D(origin, 3.5, -2.0, 12.25);
+    m_ObliquePlane->SetOrigin(origin);
+  }
+
+  void tearDown() override
+  {
+    m_Image = nullptr;
+    m_ObliquePlane = nullptr;
+  }
+
+  void TestThreadedNearestNeighbor()
+  {
+    this->CompareThreadedToSingleThreaded(mitk::ExtractSliceFilter2::NearestNeighbor);
+  }
+
+  void TestThreadedLinear()
+  {
+    this->CompareThreadedToSingleThreaded(mitk::ExtractSliceFilter2::Linear);
+  }
+
+  void TestThreadedCubic()
+  {
+    this->CompareThreadedToSingleThreaded(mitk::ExtractSliceFilter2::Cubic);
+  }
+
+  void TestNearestNeighborMatchesItk()
+  {
+    auto itkInterpolator = itk::NearestNeighborInterpolateImageFunction<ItkImageType>::New();
+    this->CompareToItk(mitk::ExtractSliceFilter2::NearestNeighbor, itkInterpolator);
+  }
+
+  void TestLinearMatchesItk()
+  {
+    auto itkInterpolator = itk::LinearInterpolateImageFunction<ItkImageType>::New();
+    this->CompareToItk(mitk::ExtractSliceFilter2::Linear, itkInterpolator);
+  }
+
+  void TestCubicMatchesItk()
+  {
+    auto itkInterpolator = itk::BSplineInterpolateImageFunction<ItkImageType>::New();
+    itkInterpolator->SetSplineOrder(2);
+    this->CompareToItk(mitk::ExtractSliceFilter2::Cubic, itkInterpolator);
+  }
+
+  void TestCubicAfterInputModified()
+  {
+    auto filter = mitk::ExtractSliceFilter2::New();
+    filter->SetInput(m_Image);
+    filter->SetOutputGeometry(m_ObliquePlane);
+    filter->SetInterpolator(mitk::ExtractSliceFilter2::Cubic);
+    filter->Update();
+
+    // changed pixel values have to reach the cached B-spline coefficients
+    {
+      mitk::ImageWriteAccessor accessor(m_Image);
+      auto data = static_cast<short*>(accessor.GetData());
+      const std::size_t numberOfPixels = m_Image->GetDimension(0) * m_Image->GetDimension(1) * m_Image->GetDimension(2);
+      for (std::size_t i = 0; i < numberOfPixels; ++i)
+        data[i] = static_cast<short>(data[i] / 2);
+    }
+    m_Image->Modified();
+
+    filter->Modified();
+    filter->Update();
+    mitk::Image::Pointer cached = filter->GetOutput()->Clone();
+
+    auto expected = this->ExtractSlice(mitk::ExtractSliceFilter2::Cubic, 1);
+
+    const std::size_t size = expected->GetDimension(0) * expected->GetDimension(1) * expected->GetPixelType().GetSize();
+    mitk::ImageReadAccessor cachedAccessor(cached);
+    mitk::ImageReadAccessor expectedAccessor(expected);
+
+    CPPUNIT_ASSERT_MESSAGE("Cubic slice extraction should use the modified input",
+                           std::memcmp(cachedAccessor.GetData(), expectedAccessor.GetData(), size) == 0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkExtractSliceFilter2)
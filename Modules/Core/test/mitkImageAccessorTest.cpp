@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestingMacros.h>
 #include <cstdlib>
 #include <ctime>
+#include <thread>
 
 struct ThreadData
 {
@@ -211,6 +212,63 @@ int mitkImageAccessorTest(int argc, char *argv[])
     MITK_TEST_CONDITION_REQUIRED(false, "Ignoring the lock mechanism leads to exception.");
   }
 
+  // ignore lock mechanism in write accessors, e.g. threads of a filter writing disjoint parts of their output
+  {
+    image->ResetAccessLockStatistics();
+
+    mitk::ImageWriteAccessor first(image, nullptr, mitk::ImageAccessorBase::IgnoreLock);
+    bool secondWriterBlocked = false;
+
+    std::thread secondWriter([&]() {
+      try
+      {
+        mitk::ImageWriteAccessor second(
+          image, nullptr, mitk::ImageAccessorBase::IgnoreLock | mitk::ImageAccessorBase::ExceptionIfLocked);
+      }
+      catch (const mitk::Exception & /*e*/)
+      {
+        secondWriterBlocked = true;
+      }
+    });
+    secondWriter.join();
+
+    MITK_TEST_CONDITION_REQUIRED(!secondWriterBlocked && image->GetAccessLockStatistics().WriteLocks == 0,
+                                 "Testing the option flag \"IgnoreLock\" in concurrent WriteAccessors");
+  }
+
+  // accessors of disjoint image parts do not block each other
+  if (image->GetDimension(2) > 1)
+  {
+    image->ResetAccessLockStatistics();
+
+    mitk::ImageWriteAccessor firstSlice(image, image->GetSliceData(0));
+
+    try
+    {
+      mitk::ImageWriteAccessor secondSlice(image, image->GetSliceData(1), mitk::ImageAccessorBase::ExceptionIfLocked);
+      mitk::ImageReadAccessor secondSliceRead(image, image->GetSliceData(1), mitk::ImageAccessorBase::ExceptionIfLocked);
+      MITK_TEST_CONDITION_REQUIRED(false, "Reading a slice while it is written leads to an exception");
+    }
+    catch (const mitk::MemoryIsLockedException & /*e*/)
+    {
+      MITK_TEST_CONDITION_REQUIRED(true, "Reading a slice while it is written leads to an exception");
+    }
+
+    try
+    {
+      mitk::ImageWriteAccessor secondSlice(image, image->GetSliceData(1), mitk::ImageAccessorBase::ExceptionIfLocked);
+      MITK_TEST_CONDITION_REQUIRED(true, "Writing disjoint slices in parallel");
+    }
+    catch (const mitk::Exception & /*e*/)
+    {
+      MITK_TEST_CONDITION_REQUIRED(false, "Writing disjoint slices in parallel");
+    }
+
+    const auto statistics = image->GetAccessLockStatistics();
+    MITK_TEST_CONDITION_REQUIRED(statistics.WriteLocks == 3 && statistics.RejectedLocks == 1,
+                                 "Testing the contention counters of the access lock");
+  }
+
   // CREATE THREADS
 
   image->GetGeometry()->Initialize();
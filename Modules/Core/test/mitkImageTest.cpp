@@ -34,6 +34,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkMersenneTwisterRandomVariateGenerator.h>
 
 // stl includes
+#include <algorithm>
 #include <fstream>
 
 // vtk includes
@@ -246,6 +247,23 @@ int mitkImageTest(int argc, char *argv[])
   }
   MITK_TEST_CONDITION(isEqual, "The SliceData are correct [pixelwise comparison]. ");
 
+  // Testing batched pixel value lookup, the geometry maps index to world coordinates 1:1
+  std::vector<itk::Index<3>> indices(3);
+  indices[0][0] = 10; indices[0][1] = 20; indices[0][2] = 3;
+  indices[1][0] = 99; indices[1][1] = 99; indices[1][2] = 19;
+  indices[2][0] = 100; indices[2][1] = 0; indices[2][2] = 0;
+  std::vector<double> values = imgMem->GetPixelValuesByIndex(indices);
+  MITK_TEST_CONDITION(values.size() == 3 && values[0] == 32010 && values[1] == size - 1 &&
+                        values[2] == 0,
+                      "GetPixelValuesByIndex() returns the pixel values and 0 outside of the image.");
+
+  std::vector<mitk::Point3D> worldPoints(2);
+  mitk::FillVector3D(worldPoints[0], 10.5, 20, 3);
+  mitk::FillVector3D(worldPoints[1], -1, 0, 0);
+  values = imgMem->GetPixelValuesByWorldCoordinates(worldPoints, 0, 0, mitk::Image::PixelInterpolation::Linear);
+  MITK_TEST_CONDITION(mitk::Equal(values[0], 32010.5) && values[1] == 0,
+                      "GetPixelValuesByWorldCoordinates() interpolates linearly between voxel centers.");
+
   imgMem = mitk::Image::New();
 
   // testing re-initialization of test image
@@ -258,6 +276,35 @@ int mitkImageTest(int argc, char *argv[])
     "Testing initialization of dimensions!");
   MITK_TEST_CONDITION(imgMem->IsInitialized(), "Image is initialized.");
 
+  // Testing progressive filling: slices are reported as set once they are ready
+  {
+    mitk::Image::Pointer progressiveImage = mitk::Image::New();
+    progressiveImage->Initialize(pType, 3, dim);
+    progressiveImage->SetAllSlicesPending();
+    MITK_TEST_CONDITION(progressiveImage->GetNumberOfPendingSlices() == dim[2] && !progressiveImage->IsSliceSet(0) &&
+                          !progressiveImage->IsVolumeSet(0) && !progressiveImage->IsChannelSet(0),
+                        "All slices are pending after SetAllSlicesPending().");
+    MITK_TEST_CONDITION(progressiveImage->IsVolumeSetOrPending(0) && !progressiveImage->IsVolumeSetOrPending(1),
+                        "A volume with pending slices can be read by reslicers.");
+    {
+      mitk::ImageReadAccessor accessor(progressiveImage, progressiveImage->GetSliceData(0));
+      const auto *pendingSlice = static_cast<const int *>(accessor.GetData());
+      MITK_TEST_CONDITION(std::all_of(pendingSlice, pendingSlice + dim[0] * dim[1], [](int value) { return value == 0; }),
+                          "Pending slices read as zero.");
+    }
+
+    progressiveImage->SetSliceReady(1);
+    MITK_TEST_CONDITION(progressiveImage->IsSliceSet(1) && !progressiveImage->IsSliceSet(0) &&
+                          !progressiveImage->IsVolumeSet(0),
+                        "SetSliceReady() marks a single slice as set.");
+
+    for (unsigned int s = 0; s < dim[2]; ++s)
+      progressiveImage->SetSliceReady(s);
+    MITK_TEST_CONDITION(progressiveImage->GetNumberOfPendingSlices() == 0 && progressiveImage->IsVolumeSet(0) &&
+                          progressiveImage->IsChannelSet(0),
+                        "The volume is set once all slices are ready.");
+  }
+
   // Setting volume again:
   try
   {
@@ -22,6 +22,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIOUtil.h"
 #include "mitkITKImageImport.h"
 #include <mitkExtractSliceFilter.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkItkImageIO.h>
+#include <mitkStandaloneDataStorage.h>
+
+#include <itkByteSwapper.h>
 
 #include "itksys/SystemTools.hxx"
 #include <itkImageRegionIterator.h>
@@ -47,6 +53,8 @@ class mitkItkImageIOTestSuite : public mitk::TestFixture
   MITK_TEST(TestWrite3DImageWithTwoPlanes);
   MITK_TEST(TestWrite3DplusT_ArbitraryTG);
   MITK_TEST(TestWrite3DplusT_ProportionalTG);
+  MITK_TEST(TestReadMemoryMapped);
+  MITK_TEST(TestReadRegion);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -422,6 +430,129 @@ public:
     CPPUNIT_ASSERT_THROW(mitk::IOUtil::Save(image, mitk::IOUtil::CreateTemporaryFile("3Dto2DTestImageXXXXXX.png")),
                          mitk::Exception);
   }
+
+  /**
+  * Writes a 5x4x3x2 short image as uncompressed NRRD file in native byte order to a temporary file
+  * and returns its path. The pixel values are returned in \a pixels.
+  */
+  std::string WriteUncompressedNrrd(std::vector<short> &pixels)
+  {
+    const unsigned int size[4] = {5, 4, 3, 2};
+    pixels.resize(size[0] * size[1] * size[2] * size[3]);
+    for (size_t i = 0; i < pixels.size(); ++i)
+      pixels[i] = static_cast<short>(i) - 50;
+
+    std::ofstream stream;
+    const std::string path = mitk::IOUtil::CreateTemporaryFile(stream, std::ios_base::out | std::ios_base::binary, "XXXXXX.nrrd");
+    stream << "NRRD0004\n"
+           << "type: short\n"
+           << "dimension: 4\n"
+           << "sizes: 5 4 3 2\n"
+           << "endian: " << (itk::ByteSwapper<int>::SystemIsBigEndian() ? "big" : "little") << "\n"
+           << "encoding: raw\n"
+           << "\n";
+    stream.write(reinterpret_cast<const char *>(pixels.data()), pixels.size() * sizeof(short));
+    stream.close();
+
+    return path;
+  }
+
+  /**
+  * Read an uncompressed NRRD file with memory mapping enabled
+  */
+  void TestReadMemoryMapped()
+  {
+    std::vector<short> pixels;
+    const std::string path = WriteUncompressedNrrd(pixels);
+
+    mitk::IFileReader::Options options;
+    options[mitk::ItkImageIO::OPTION_MEMORY_MAPPING()] = us::Any(true);
+
+    mitk::StandaloneDataStorage::Pointer storage = mitk::StandaloneDataStorage::New();
+    auto nodes = mitk::IOUtil::Load(path, options, *storage);
+    CPPUNIT_ASSERT_EQUAL(1u, static_cast<unsigned int>(nodes->size()));
+
+    mitk::Image::Pointer image = dynamic_cast<mitk::Image *>(nodes->front()->GetData());
+    CPPUNIT_ASSERT(image.IsNotNull());
+    CPPUNIT_ASSERT(image->GetChannelData()->IsMemoryMapped());
+
+    mitk::Image::Pointer referenceImage = mitk::IOUtil::Load<mitk::Image>(path);
+    CPPUNIT_ASSERT(!referenceImage->GetChannelData()->IsMemoryMapped());
+    CPPUNIT_ASSERT_MESSAGE("Memory mapped image equals read image", mitk::Equal(*referenceImage, *image, mitk::eps, true));
+
+    {
+      mitk::ImagePixelReadAccessor<short, 3> accessor(image, image->GetVolumeData(1));
+      itk::Index<3> index = {{4, 3, 2}};
+      CPPUNIT_ASSERT_EQUAL(pixels.back(), accessor.GetPixelByIndex(index));
+    }
+
+    // modifications are private to the image
+    {
+      mitk::ImageWriteAccessor accessor(image);
+      static_cast<short *>(accessor.GetData())[0] = 1000;
+    }
+
+    mitk::Image::Pointer reloadedImage = mitk::IOUtil::Load<mitk::Image>(path);
+    CPPUNIT_ASSERT_MESSAGE("File is not modified", mitk::Equal(*referenceImage, *reloadedImage, mitk::eps, true));
+
+    image = nullptr;
+    nodes = nullptr;
+    storage = nullptr;
+    std::remove(path.c_str());
+  }
+
+  void CheckRegion(const std::string &path, const std::vector<short> &pixels)
+  {
+    // time step 1, x 1-3, y 1-2, z 0-2 of a 5x4x3x2 image
+    mitk::IFileReader::Options options;
+    options[mitk::ItkImageIO::OPTION_FIRST_TIME_STEP()] = us::Any(1);
+    options[mitk::ItkImageIO::OPTION_NUMBER_OF_TIME_STEPS()] = us::Any(1);
+    options[mitk::ItkImageIO::OPTION_REGION_INDEX(0)] = us::Any(1);
+    options[mitk::ItkImageIO::OPTION_REGION_INDEX(1)] = us::Any(1);
+    options[mitk::ItkImageIO::OPTION_REGION_SIZE(0)] = us::Any(3);
+    options[mitk::ItkImageIO::OPTION_REGION_SIZE(1)] = us::Any(2);
+
+    auto region = mitk::IOUtil::Load<mitk::Image>(path, options);
+    CPPUNIT_ASSERT_EQUAL(3u, region->GetDimension());
+    CPPUNIT_ASSERT_EQUAL(3u, region->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(2u, region->GetDimension(1));
+    CPPUNIT_ASSERT_EQUAL(3u, region->GetDimension(2));
+
+    mitk::ImagePixelReadAccessor<short, 3> accessor(region);
+    for (itk::IndexValueType z = 0; z < 3; ++z)
+      for (itk::IndexValueType y = 0; y < 2; ++y)
+        for (itk::IndexValueType x = 0; x < 3; ++x)
+        {
+          itk::Index<3> index = {{x, y, z}};
+          CPPUNIT_ASSERT_EQUAL(pixels[((1 * 3 + z) * 4 + y + 1) * 5 + x + 1], accessor.GetPixelByIndex(index));
+        }
+
+    mitk::Point3D expectedOrigin;
+    mitk::FillVector3D(expectedOrigin, 1.0, 1.0, 0.0);
+    CPPUNIT_ASSERT(mitk::Equal(expectedOrigin, region->GetGeometry()->GetOrigin()));
+  }
+
+  void TestReadRegion()
+  {
+    std::vector<short> pixels;
+    const std::string path = WriteUncompressedNrrd(pixels);
+
+    // uncompressed NRRD, the region is copied from the mapped file
+    CheckRegion(path, pixels);
+
+    // MetaImage, read by streaming
+    const std::string mhdPath = mitk::IOUtil::CreateTemporaryFile("XXXXXX.mhd");
+    mitk::IOUtil::Save(mitk::IOUtil::Load<mitk::Image>(path), mhdPath);
+    CheckRegion(mhdPath, pixels);
+
+    mitk::IFileReader::Options options;
+    options[mitk::ItkImageIO::OPTION_FIRST_TIME_STEP()] = us::Any(2);
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::Load(path, options), mitk::Exception);
+
+    std::remove(path.c_str());
+    std::remove(mhdPath.c_str());
+    std::remove((mhdPath.substr(0, mhdPath.size() - 3) + "zraw").c_str());
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkItkImageIO)
@@ -0,0 +1,67 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+
+#include <mitkParallelFor.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+class mitkParallelForTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkParallelForTestSuite);
+  MITK_TEST(TestEveryIndexIsProcessedOnce);
+  MITK_TEST(TestExceptionIsRethrown);
+  MITK_TEST(TestEmptyRange);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void TestEveryIndexIsProcessedOnce()
+  {
+    std::vector<std::atomic<int>> calls(1000);
+    for (auto &count : calls)
+      count = 0;
+
+    mitk::ParallelFor(calls.size(), [&](std::size_t index) { ++calls[index]; }, 8);
+
+    for (const auto &count : calls)
+      CPPUNIT_ASSERT_EQUAL(1, count.load());
+  }
+
+  void TestExceptionIsRethrown()
+  {
+    CPPUNIT_ASSERT_THROW(mitk::ParallelFor(100,
+                                           [](std::size_t index) {
+                                             if (42 == index)
+                                               throw std::runtime_error("failure");
+                                           },
+                                           4),
+                         std::runtime_error);
+  }
+
+  void TestEmptyRange()
+  {
+    bool called = false;
+    mitk::ParallelFor(0, [&](std::size_t) { called = true; });
+
+    CPPUNIT_ASSERT(!called);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkParallelFor)
@@ -28,6 +28,7 @@ set(CPP_FILES
   mitkDICOMTagsOfInterestHelper.cpp
   mitkDICOMTagCache.cpp
   mitkDICOMGDCMTagCache.cpp
+  mitkDICOMGDCMTagIndex.cpp
   mitkDICOMGenericTagCache.cpp
   mitkDICOMEnums.cpp
   mitkDICOMReaderConfigurator.cpp
@@ -69,6 +69,7 @@ namespace mitk
         Calling Scan() will invalidate previous scans, forgetting
         all about files and tags from files that have been scanned
         previously.
+        Files are loaded and searched in parallel.
       */
       void Scan() override;
 
@@ -19,8 +19,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMTagCache.h"
 
+#include <map>
 #include <set>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <gdcmScanner.h>
 
@@ -47,6 +51,20 @@ namespace mitk
 
       void InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles);
 
+      typedef std::map<DICOMTag, std::string> TagValueMapType;
+
+      /**
+        \brief Initialize the cache from tag values that were collected per input file,
+        e.g. by several scanners working in parallel. The values are copied into the cache.
+
+        \param tagValues the found tags of each file, in the order of inputFiles.
+      */
+      void InitCache(const std::set<DICOMTag>& scannedTags, const std::vector<TagValueMapType>& tagValues, const StringList& inputFiles);
+
+      /**
+        \brief Returns the scanner the cache was initialized with.
+        \throw mitk::Exception if the cache was initialized from tag values.
+      */
       const gdcm::Scanner& GetScanner() const;
 
   protected:
@@ -54,12 +72,20 @@ namespace mitk
       DICOMGDCMTagCache();
       ~DICOMGDCMTagCache() override;
 
+      void InitFrameIndices();
+
       std::set<DICOMTag> m_ScannedTags;
 
       std::shared_ptr<gdcm::Scanner> m_Scanner;
 
       DICOMDatasetAccessingImageFrameList m_ScanResult;
 
+      /** Storage of the tag values if the cache is not initialized from a scanner. */
+      std::set<std::string> m_TagValues;
+
+      /** Index of the first frame of each file in m_ScanResult */
+      std::unordered_map<std::string, std::size_t> m_FrameIndices;
+
     private:
       DICOMGDCMTagCache(const DICOMGDCMTagCache&);
   };
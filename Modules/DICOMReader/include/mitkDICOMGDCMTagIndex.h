@@ -0,0 +1,119 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkDICOMGDCMTagIndex_h
+#define mitkDICOMGDCMTagIndex_h
+
+#include "mitkDICOMTag.h"
+
+#include <mitkCommon.h>
+
+#include <itkLightObject.h>
+#include <itkObjectFactory.h>
+
+#include "MitkDICOMReaderExports.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+
+namespace mitk
+{
+  /**
+    \ingroup DICOMReaderModule
+    \brief Persistent index of scanned tag values, used by DICOMGDCMTagScanner to skip unchanged files.
+
+    For every file the index stores the values of the scanned tags, together with the
+    size and modification time of the file at scanning time. A lookup only succeeds if
+    size and modification time still match and all requested tags have been scanned
+    before, so re-opening a folder only re-parses new or changed files.
+
+    The index is kept in memory; Load() and Save() transfer it from and to a file.
+
+    @remark Modification times have a resolution of one second, a file that is rewritten
+    with the same size within the second of its last scan is not detected as changed.
+  */
+  class MITKDICOMREADER_EXPORT DICOMGDCMTagIndex : public itk::LightObject
+  {
+    public:
+
+      mitkClassMacroItkParent(DICOMGDCMTagIndex, itk::LightObject);
+      itkFactorylessNewMacro( DICOMGDCMTagIndex );
+
+      typedef std::map<DICOMTag, std::string> TagValueMapType;
+
+      /**
+        \brief Replace the index by the content of the given file.
+
+        A missing or invalid file results in an empty index.
+      */
+      void Load(const std::string& indexFilename);
+
+      /**
+        \brief Write the index to the given file.
+        \throw mitk::Exception if the file cannot be written.
+      */
+      void Save(const std::string& indexFilename) const;
+
+      /**
+        \brief Retrieve the values of tags for a file.
+
+        Tags that were scanned but not found in the file are not contained in values.
+        \return false if the file is not indexed, changed since it was indexed, or
+        if not all tags were scanned.
+      */
+      bool Lookup(const std::string& filename, const std::set<DICOMTag>& tags, TagValueMapType& values) const;
+
+      /**
+        \brief Store the scanned tags of a file. Tags without value are stored as missing.
+      */
+      void Update(const std::string& filename, const std::set<DICOMTag>& tags, const TagValueMapType& values);
+
+      /**
+        \brief Returns true if Update() changed the index since the last Load() or Save().
+      */
+      bool IsModified() const;
+
+      std::size_t GetNumberOfEntries() const;
+
+    protected:
+
+      DICOMGDCMTagIndex();
+      ~DICOMGDCMTagIndex() override;
+
+      struct Entry
+      {
+        std::uint64_t Size = 0;
+        std::int64_t ModificationTime = 0;
+
+        /** Scanned tags; the flag is false for tags not found in the file. */
+        std::map<DICOMTag, std::pair<bool, std::string>> Tags;
+      };
+
+      static bool GetFileStatus(const std::string& filename, std::uint64_t& size, std::int64_t& modificationTime);
+
+      std::map<std::string, Entry> m_Entries;
+
+      mutable bool m_Modified;
+
+    private:
+
+      DICOMGDCMTagIndex(const DICOMGDCMTagIndex&);
+  };
+}
+
+#endif
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMTagScanner.h"
 #include "mitkDICOMEnums.h"
 #include "mitkDICOMGDCMTagCache.h"
+#include "mitkDICOMGDCMTagIndex.h"
 
 namespace mitk
 {
@@ -45,6 +46,13 @@ namespace mitk
     results, care should be taken that all the tags and files of interest
     are communicated to DICOMGDCMTagScanner before requesting the results!
 
+    Files are scanned in parallel, each thread using its own gdcm::Scanner for a
+    part of the file list. The results are merged into one DICOMGDCMTagCache.
+
+    If a DICOMGDCMTagIndex is set, files that are unchanged since they were
+    indexed are not parsed again, and the index is updated with the tags of
+    all parsed files.
+
     @remark This scanner does only support the scanning for simple value tag.
     If you need to scann for sequence items or non-top-level elements, this scanner
     will not be sufficient. See i.a. DICOMDCMTKTagScanner for these cases.
@@ -89,6 +97,19 @@ namespace mitk
       */
       void Scan() override;
 
+      /**
+        \brief Set an index of previously scanned tags, used and updated by Scan().
+
+        The index is not saved by the scanner.
+      */
+      void SetTagIndex(DICOMGDCMTagIndex* index);
+      DICOMGDCMTagIndex* GetTagIndex() const;
+
+      /**
+        \brief Number of files that had to be parsed by the last Scan(), i.e. were not found in the tag index.
+      */
+      std::size_t GetNumberOfParsedFiles() const;
+
       /**
         \brief Retrieve a result list for file-by-file tag access.
       */
@@ -113,7 +134,8 @@ namespace mitk
       std::set<DICOMTag> m_ScannedTags;
       StringList m_InputFilenames;
       DICOMGDCMTagCache::Pointer m_Cache;
-      std::shared_ptr<gdcm::Scanner> m_GDCMScanner;
+      DICOMGDCMTagIndex::Pointer m_TagIndex;
+      std::size_t m_NumberOfParsedFiles;
 
     private:
       DICOMGDCMTagScanner(const DICOMGDCMTagScanner&);
@@ -17,6 +17,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef mitkDICOMITKSeriesGDCMReader_h
 #define mitkDICOMITKSeriesGDCMReader_h
 
+#include <future>
+#include <mutex>
 #include <stack>
 #include "itkMutexLock.h"
 #include "mitkDICOMFileReader.h"
@@ -159,7 +161,7 @@ namespace mitk
   \subsection DICOMITKSeriesGDCMReader_TiltInternals Details about the tilt correction
 
   The gantry tilt "correction" algorithm fixes two errors introduced by ITK's ImageSeriesReader:
-    - the plane shift that is ignored by ITK's reader is recreated by applying a shearing transformation using itk::ResampleFilter.
+    - the plane shift that is ignored by ITK's reader is recreated by a shearing transformation, applied as a shift of each slice while it is decoded (see ITKDICOMSeriesReaderHelper).
     - the spacing is corrected (it is calculated by ITK's reader from the distance between two origins, which is NOT the slice distance in this special case)
 
   Both errors are introduced in
@@ -210,9 +212,33 @@ class MITKDICOMREADER_EXPORT DICOMITKSeriesGDCMReader : public DICOMFileReader
     // void AllocateOutputImages();
     /**
       \brief Loads images using itk::ImageSeriesReader, potentially applies shearing to correct gantry tilt.
+
+      With progressive loading, the images of the outputs are returned before their slices are read,
+      see SetProgressiveLoading().
     */
     bool LoadImages() override;
 
+    /**
+      \brief Controls whether LoadImages() returns before the pixel data of 3D images is read (default: off).
+
+      In progressive mode, the output images are allocated from the block geometry and their slices
+      are decoded in the background. Slices that are not yet decoded are reported as not set by
+      Image::IsSliceSet(), and Image::GetNumberOfPendingSlices() tells whether an image is complete.
+      Reslicers accept such images (Image::IsVolumeSetOrPending()) and show pending slices as zero.
+      The background tasks call Modified() on an image after each decoded file, so observers of the
+      images are notified from the loading threads. Errors during decoding are reported by WaitForProgressiveLoading().
+
+      3D+t blocks of ThreeDnTDICOMSeriesReader are always loaded completely.
+    */
+    void SetProgressiveLoading(bool on);
+    bool GetProgressiveLoading() const;
+
+    /**
+      \brief Blocks until all images of progressive loading are complete.
+      \return false if decoding of any image failed.
+    */
+    bool WaitForProgressiveLoading() const;
+
     // re-implemented from super-class
     bool CanHandleFile(const std::string& filename) override;
 
@@ -247,6 +273,15 @@ class MITKDICOMREADER_EXPORT DICOMITKSeriesGDCMReader : public DICOMFileReader
     */
     void SetToleratedOriginOffset(double millimeters = 0.005) const;
 
+    /**
+      \brief File of a persistent DICOMGDCMTagIndex used for tag scanning; empty (default) disables the index.
+
+      With an index, re-analyzing a set of files only parses files that are new or changed
+      since they were last scanned. The index file is updated after each scan.
+    */
+    void SetTagIndexFileName(const std::string& fileName);
+    std::string GetTagIndexFileName() const;
+
     /**
     \brief Ignore all dicom tags that are non-essential for simple 3D volume import.
     */
@@ -374,6 +409,14 @@ class MITKDICOMREADER_EXPORT DICOMITKSeriesGDCMReader : public DICOMFileReader
 
     DICOMTagCache::Pointer m_TagCache;
     bool m_ExternalCache;
+
+    std::string m_TagIndexFileName;
+
+    bool m_ProgressiveLoading;
+
+    /** Background tasks of progressive loading, not copied with the reader */
+    mutable std::vector<std::shared_future<void>> m_ProgressiveLoads;
+    mutable std::mutex m_ProgressiveLoadsMutex;
 };
 
 }
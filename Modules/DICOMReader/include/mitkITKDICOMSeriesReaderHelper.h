@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkGDCMImageIO.h>
 
+#include <functional>
+#include <future>
+
 /* Forward deceleration of an DCMTK class. Used in the txx but part of the interface.*/
 class OFDateTime;
 
@@ -41,6 +44,22 @@ class ITKDICOMSeriesReaderHelper
     typedef std::list<StringContainer> StringContainerList;
 
     Image::Pointer Load( const StringContainer& filenames, bool correctTilt, const GantryTiltInformation& tiltInfo );
+
+    /**
+      \brief Like Load(), but returns the image before its pixel data is read.
+
+      The image is allocated with all slices pending (see Image::SetAllSlicesPending()). A background
+      task decodes the files and marks each slice as set as soon as it is decoded, so consumers can
+      use completed slices (Image::IsSliceSet()) while the rest is still loading. The image is
+      modified after each decoded file.
+
+      \param loading becomes ready when all slices are loaded and rethrows errors of the background task.
+      \return nullptr if the series cannot be loaded; errors during decoding are reported via loading only.
+    */
+    Image::Pointer LoadProgressively( const StringContainer& filenames,
+                                      bool correctTilt,
+                                      const GantryTiltInformation& tiltInfo,
+                                      std::shared_future<void>& loading );
     Image::Pointer Load3DnT( const StringContainerList& filenamesLists, bool correctTilt, const GantryTiltInformation& tiltInfo );
 
     static bool CanHandleFile(const std::string& filename);
@@ -83,16 +102,70 @@ class ITKDICOMSeriesReaderHelper
     */
     static TimeGeometry::Pointer GenerateTimeGeometry(const BaseGeometry* templateGeometry, const TimeBoundsList& boundsList);
 
+    /** Placement of the pixels of one file in the slice of the output volume. */
+    struct SliceLayout
+    {
+      /** Size of the slices in the files */
+      unsigned int InputSize[2];
+
+      /** Size of the slices in the output, larger in y direction for tilt correction */
+      unsigned int OutputSize[2];
+
+      /** Number of slices of one time step */
+      unsigned int NumberOfSlices;
+
+      /** Number of frames in each file, slices of multi-frame files are consecutive */
+      unsigned int FramesPerFile;
+
+      /** Tilt correction: output row y of slice z is taken from the input row y + RowOffset + RowShiftPerSlice * z */
+      bool CorrectTilt;
+      double RowOffset;
+      double RowShiftPerSlice;
+    };
+
+    /** Determines the geometry of the output volume from the headers of the files, without reading pixel data.
+        With correctTilt, the returned geometry is the sheared one and layout describes the per-slice shift.
+        @return an ITK image of the output geometry, without buffer. */
     template <typename ImageType>
     typename ImageType::Pointer
-    FixUpTiltedGeometry( ImageType* input, const GantryTiltInformation& tiltInfo );
+    ReadOutputGeometry( const StringContainer& filenames,
+                        bool correctTilt,
+                        const GantryTiltInformation& tiltInfo,
+                        itk::GDCMImageIO::Pointer& io,
+                        SliceLayout& layout );
+
+    /** Decodes the files of all time steps in parallel, each directly into its slice of volumes.
+        fileLoaded is called with the index of the first slice of each decoded file, from the decoding thread. */
+    template <typename PixelType>
+    static void
+    LoadSlices( const StringContainerList& filenamesForTimeSteps,
+                const SliceLayout& layout,
+                PixelType* volumes,
+                const std::function<void(std::size_t)>& fileLoaded = std::function<void(std::size_t)>() );
+
+    /** Decodes one single-frame file into buffer, converting the pixel type if necessary. */
+    template <typename PixelType>
+    static void
+    ReadSlice( const std::string& filename, const SliceLayout& layout, PixelType* buffer );
+
+    /** Copies input into the output slice, shifted and linearly interpolated in y direction as described by layout. */
+    template <typename PixelType>
+    static void
+    ShiftSlice( const PixelType* input, const SliceLayout& layout, unsigned int slice, PixelType* output );
+
+    /** Shared implementation of Load() and LoadProgressively(), loading is nullptr for Load(). */
+    Image::Pointer Load( const StringContainer& filenames,
+                         bool correctTilt,
+                         const GantryTiltInformation& tiltInfo,
+                         std::shared_future<void>* loading );
 
     template <typename PixelType>
     Image::Pointer
     LoadDICOMByITK( const StringContainer& filenames,
                     bool correctTilt,
                     const GantryTiltInformation& tiltInfo,
-                    itk::GDCMImageIO::Pointer& io);
+                    itk::GDCMImageIO::Pointer& io,
+                    std::shared_future<void>* loading );
 
     template <typename PixelType>
     Image::Pointer
@@ -15,14 +15,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkITKDICOMSeriesReaderHelper.h"
 
+#include <mitkImageWriteAccessor.h>
+#include <mitkParallelFor.h>
+
+#include <itkImageFileReader.h>
 #include <itkImageSeriesReader.h>
-#include <itkResampleImageFilter.h>
-//#include <itkAffineTransform.h>
-//#include <itkLinearInterpolateImageFunction.h>
-//#include <itkTimeProbesCollectorBase.h>
 
 #include "dcmtk/ofstd/ofdatime.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 template <typename PixelType>
 mitk::Image::Pointer
 mitk::ITKDICOMSeriesReaderHelper
@@ -30,36 +34,42 @@ mitk::ITKDICOMSeriesReaderHelper
     const StringContainer& filenames,
     bool correctTilt,
     const GantryTiltInformation& tiltInfo,
-    itk::GDCMImageIO::Pointer& io)
+    itk::GDCMImageIO::Pointer& io,
+    std::shared_future<void>* loading)
 {
   /******** Normal Case, 3D (also for GDCM < 2 usable) ***************/
   mitk::Image::Pointer image = mitk::Image::New();
 
   typedef itk::Image<PixelType, 3> ImageType;
-  typedef itk::ImageSeriesReader<ImageType> ReaderType;
 
-  io = itk::GDCMImageIO::New();
-  typename ReaderType::Pointer reader = ReaderType::New();
+  // if we detected that the images are from a tilted gantry acquisition, the slices are pushed into the right position while decoding
+  SliceLayout layout;
+  typename ImageType::Pointer outputGeometry = ReadOutputGeometry<ImageType>( filenames, correctTilt, tiltInfo, io, layout );
 
-  reader->SetImageIO(io);
-  reader->ReverseOrderOff(); // at this point we require an order of input images so that
-                             // the direction between the origin of the first and the last slice
-                             // is the same direction as the image normals! Otherwise we might
-                             // see images upside down. Unclear whether this is a bug in MITK,
-                             // see NormalDirectionConsistencySorter.
-
-  reader->SetFileNames(filenames);
-  reader->Update();
-  typename ImageType::Pointer readVolume = reader->GetOutput();
+  image->InitializeByItk(outputGeometry.GetPointer());
 
-  // if we detected that the images are from a tilted gantry acquisition, we need to push some pixels into the right position
-  if (correctTilt)
+  if (loading != nullptr)
   {
-    readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
+    // no write accessor here: it would block readers of the slices that are already complete
+    image->SetAllSlicesPending();
+    PixelType* volume = static_cast<PixelType*>(image->GetChannelData()->GetData());
+
+    *loading = std::async(std::launch::async, [image, filenames, layout, volume]() {
+      LoadSlices( StringContainerList(1, filenames), layout, volume, [&](std::size_t firstSlice) {
+        for (unsigned int frame = 0; frame < layout.FramesPerFile; ++frame)
+        {
+          image->SetSliceReady(firstSlice + frame);
+        }
+        // let mappers pick up the new slices with their next update
+        image->Modified();
+      });
+    }).share();
+  }
+  else
+  {
+    mitk::ImageWriteAccessor accessor(image);
+    LoadSlices( StringContainerList(1, filenames), layout, static_cast<PixelType*>(accessor.GetData()) );
   }
-
-  image->InitializeByItk(readVolume.GetPointer());
-  image->SetImportVolume(readVolume->GetBufferPointer());
 
 #ifdef MBILOG_ENABLE_DEBUG
 
@@ -104,59 +114,27 @@ mitk::ITKDICOMSeriesReaderHelper
   mitk::Image::Pointer image = mitk::Image::New();
 
   typedef itk::Image<PixelType, 4> ImageType;
-  typedef itk::ImageSeriesReader<ImageType> ReaderType;
 
-  io = itk::GDCMImageIO::New();
-  typename ReaderType::Pointer reader = ReaderType::New();
+  // all time steps share the geometry of the first one
+  SliceLayout layout;
+  typename ImageType::Pointer outputGeometry =
+    ReadOutputGeometry<ImageType>( filenamesForTimeSteps.front(), correctTilt, tiltInfo, io, layout );
 
-  reader->SetImageIO(io);
-  reader->ReverseOrderOff(); // at this point we require an order of input images so that
-                             // the direction between the origin of the first and the last slice
-                             // is the same direction as the image normals! Otherwise we might
-                             // see images upside down. Unclear whether this is a bug in MITK,
-                             // see NormalDirectionConsistencySorter.
-
-
-  unsigned int currentTimeStep = 0;
+  image->InitializeByItk(outputGeometry.GetPointer(), 1, numberOfTimeSteps);
 
 #ifdef MBILOG_ENABLE_DEBUG
-  MITK_DEBUG << "Start loading timestep " << currentTimeStep;
-  MITK_DEBUG_OUTPUT_FILELIST( filenamesForTimeSteps.front() )
-#endif // MBILOG_ENABLE_DEBUG
-
-  reader->SetFileNames(filenamesForTimeSteps.front());
-  reader->Update();
-  typename ImageType::Pointer readVolume = reader->GetOutput();
-
-  // if we detected that the images are from a tilted gantry acquisition, we need to push some pixels into the right position
-  if (correctTilt)
-  {
-    readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
-  }
-
-  image->InitializeByItk(readVolume.GetPointer(), 1, numberOfTimeSteps);
-  image->SetImportVolume(readVolume->GetBufferPointer(), currentTimeStep++); // timestep 0
-
-  // for other time-steps
-  for (auto timestepsIter = ++(filenamesForTimeSteps.cbegin()); // start with SECOND entry
-      timestepsIter != filenamesForTimeSteps.cend();
-      ++currentTimeStep, ++timestepsIter)
+  unsigned int currentTimeStep = 0;
+  for (auto timestepsIter = filenamesForTimeSteps.cbegin(); timestepsIter != filenamesForTimeSteps.cend(); ++currentTimeStep, ++timestepsIter)
   {
-#ifdef MBILOG_ENABLE_DEBUG
-    MITK_DEBUG << "Start loading timestep " << currentTimeStep;
+    MITK_DEBUG << "Loading timestep " << currentTimeStep;
     MITK_DEBUG_OUTPUT_FILELIST( *timestepsIter )
+  }
 #endif // MBILOG_ENABLE_DEBUG
 
-    reader->SetFileNames( *timestepsIter );
-    reader->Update();
-    readVolume = reader->GetOutput();
-
-    if (correctTilt)
-    {
-      readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
-    }
-
-    image->SetImportVolume(readVolume->GetBufferPointer(), currentTimeStep);
+  {
+    // slices of all time steps are decoded in parallel
+    mitk::ImageWriteAccessor accessor(image);
+    LoadSlices( filenamesForTimeSteps, layout, static_cast<PixelType*>(accessor.GetData()) );
   }
 
 #ifdef MBILOG_ENABLE_DEBUG
@@ -179,127 +157,255 @@ mitk::ITKDICOMSeriesReaderHelper
 template <typename ImageType>
 typename ImageType::Pointer
 mitk::ITKDICOMSeriesReaderHelper
-::FixUpTiltedGeometry( ImageType* input, const GantryTiltInformation& tiltInfo )
+::ReadOutputGeometry(
+    const StringContainer& filenames,
+    bool correctTilt,
+    const GantryTiltInformation& tiltInfo,
+    itk::GDCMImageIO::Pointer& io,
+    SliceLayout& layout)
 {
-  typedef itk::ResampleImageFilter<ImageType,ImageType> ResampleFilterType;
-  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
-  resampler->SetInput( input );
+  typedef itk::ImageSeriesReader<ImageType> ReaderType;
 
-  /*
-     Transform for a point is
-      - transform from actual position to index coordinates
-      - apply a shear that undoes the gantry tilt
-      - transform back into world coordinates
+  io = itk::GDCMImageIO::New();
+  typename ReaderType::Pointer reader = ReaderType::New();
 
-     Anybody who does this in a simpler way: don't forget to write up how and why your solution works
-  */
-  typedef itk::ScalableAffineTransform< double, ImageType::ImageDimension > TransformType;
-  typename TransformType::Pointer transformShear = TransformType::New();
-
-  /**
-    - apply a shear and spacing correction to the image block that corrects the ITK reader's error
-      - ITK ignores the shear and loads slices into an orthogonal volume
-      - ITK calculates the spacing from the origin distance, which is more than the actual spacing with gantry tilt images
-    - to undo the effect
-      - we have calculated some information in tiltInfo:
-        - the shift in Y direction that is added with each additional slice is the most important information
-        - the Y-shift is calculated in mm world coordinates
-      - we apply a shearing transformation to the ITK-read image volume
-        - to do this locally,
-          - we transform the image volume back to origin and "normal" orientation by applying the inverse of its transform
-            (this brings us into the image's "index coordinate" system)
-          - we apply a shear with the Y-shift factor put into a unit transform at row 1, col 2
-          - we transform the image volume back to its actual position (from index to world coordinates)
-      - we lastly apply modify the image spacing in z direction by replacing this number with the correctly calulcated inter-slice distance
-  */
+  reader->SetImageIO(io);
+  reader->ReverseOrderOff(); // at this point we require an order of input images so that
+                             // the direction between the origin of the first and the last slice
+                             // is the same direction as the image normals! Otherwise we might
+                             // see images upside down. Unclear whether this is a bug in MITK,
+                             // see NormalDirectionConsistencySorter.
 
-  const ScalarType factor = tiltInfo.GetMatrixCoefficientForCorrectionInWorldCoordinates() / input->GetSpacing()[1];
-  // row 1, column 2 corrects shear in parallel to Y axis, proportional to distance in Z direction
-  transformShear->Shear( 1, 2, factor );
+  reader->SetFileNames(filenames);
+  reader->UpdateOutputInformation(); // reads the headers only, pixel data is decoded by LoadSlices()
 
-  typename TransformType::Pointer imageIndexToWorld = TransformType::New();
-  imageIndexToWorld->SetOffset( input->GetOrigin().GetVectorFromOrigin() );
+  const ImageType* input = reader->GetOutput();
 
-  typename TransformType::MatrixType indexToWorldMatrix;
-  indexToWorldMatrix = input->GetDirection();
+  typename ImageType::RegionType region = input->GetLargestPossibleRegion();
+  typename ImageType::SizeType size = region.GetSize();
+  typename ImageType::PointType origin = input->GetOrigin();
+  typename ImageType::SpacingType spacing = input->GetSpacing();
 
-  typename ImageType::DirectionType scale;
-  for ( unsigned int i = 0; i < ImageType::ImageDimension; i++ )
+  // slices of all files are stacked in z direction
+  for ( unsigned int i = 3; i < ImageType::ImageDimension; i++ )
   {
-    scale[i][i] = input->GetSpacing()[i];
+    if ( size[i] != 1 )
+    {
+      mitkThrow() << "Cannot load DICOM series: unexpected image size " << size;
+    }
   }
-  indexToWorldMatrix *= scale;
 
-  imageIndexToWorld->SetMatrix( indexToWorldMatrix );
+  if ( size[2] % filenames.size() != 0 )
+  {
+    mitkThrow() << "Cannot load DICOM series: " << size[2] << " slices cannot be distributed over " << filenames.size() << " files.";
+  }
 
-  typename TransformType::Pointer imageWorldToIndex = TransformType::New();
-  imageIndexToWorld->GetInverse( imageWorldToIndex );
+  layout.InputSize[0] = layout.OutputSize[0] = size[0];
+  layout.InputSize[1] = layout.OutputSize[1] = size[1];
+  layout.NumberOfSlices = size[2];
+  layout.FramesPerFile = size[2] / filenames.size();
+  layout.CorrectTilt = correctTilt;
+  layout.RowOffset = 0.0;
+  layout.RowShiftPerSlice = 0.0;
 
-  typename TransformType::Pointer gantryTiltCorrection = TransformType::New();
-  gantryTiltCorrection->Compose( imageWorldToIndex );
-  gantryTiltCorrection->Compose( transformShear );
-  gantryTiltCorrection->Compose( imageIndexToWorld );
+  if (correctTilt)
+  {
+    /*
+      ITK ignores the shear and loads slices into an orthogonal volume, with a spacing calculated from
+      the origin distance, which is more than the actual spacing with gantry tilt images.
+
+      In index coordinates, undoing the tilt is a shear: every slice is shifted in y direction by a
+      multiple of the shift between two slices, which we calculated in tiltInfo in mm world coordinates.
+      This equals resampling the volume with a shear transform at row 1, col 2 and linear interpolation,
+      but is done for each slice while decoding it (see ShiftSlice()).
+    */
+    const double imageSizeZ = size[2];
+    const double additionalSize = tiltInfo.GetTiltCorrectedAdditionalSize(imageSizeZ);
+
+    layout.RowShiftPerSlice = tiltInfo.GetMatrixCoefficientForCorrectionInWorldCoordinates() / spacing[1];
+
+    // in any case we need more size to accomodate shifted slices
+    size[1] += static_cast<typename ImageType::SizeType::SizeValueType>(additionalSize / spacing[1] + 2.0);
+    layout.OutputSize[1] = size[1];
+
+    // in SOME cases this additional size is below/behind origin
+    if ( tiltInfo.GetMatrixCoefficientForCorrectionInWorldCoordinates() > 0.0 )
+    {
+      typename ImageType::DirectionType imageDirection = input->GetDirection();
+      Vector3D yDirection;
+      yDirection[0] = imageDirection[0][1];
+      yDirection[1] = imageDirection[1][1];
+      yDirection[2] = imageDirection[2][1];
+      yDirection.Normalize();
+
+      // add some pixels to make everything fit
+      origin[0] -= yDirection[0] * (additionalSize + 1.0 * spacing[1]);
+      origin[1] -= yDirection[1] * (additionalSize + 1.0 * spacing[1]);
+      origin[2] -= yDirection[2] * (additionalSize + 1.0 * spacing[1]);
+
+      layout.RowOffset = -(additionalSize / spacing[1] + 1.0);
+    }
 
-  resampler->SetTransform( gantryTiltCorrection );
+    // ImageSeriesReader calculates z spacing as the distance between the first two origins.
+    // This is not correct in case of gantry tilt, so we set our calculated spacing.
+    spacing[2] = tiltInfo.GetRealZSpacing();
+  }
 
-  typedef itk::LinearInterpolateImageFunction< ImageType, double > InterpolatorType;
-  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
-  resampler->SetInterpolator( interpolator );
-  /*
-     This would be the right place to invent a meaningful value for positions outside of the image.
-     For CT, HU -1000 might be meaningful, but a general solution seems not possible. Even for CT,
-     -1000 would only look natural for many not all images.
-  */
+  region.SetSize(size);
 
-  // TODO use (0028,0120) Pixel Padding Value if present
-  resampler->SetDefaultPixelValue( itk::NumericTraits< typename ImageType::PixelType >::min() );
+  typename ImageType::Pointer result = ImageType::New();
+  result->SetRegions(region);
+  result->SetOrigin(origin);
+  result->SetSpacing(spacing);
+  result->SetDirection(input->GetDirection());
+
+  return result;
+}
+
+template <typename PixelType>
+void
+mitk::ITKDICOMSeriesReaderHelper
+::LoadSlices( const StringContainerList& filenamesForTimeSteps,
+              const SliceLayout& layout,
+              PixelType* volumes,
+              const std::function<void(std::size_t)>& fileLoaded )
+{
+  const std::size_t inputSliceSize = static_cast<std::size_t>(layout.InputSize[0]) * layout.InputSize[1];
+  const std::size_t outputSliceSize = static_cast<std::size_t>(layout.OutputSize[0]) * layout.OutputSize[1];
 
-  // adjust size in Y direction! (maybe just transform the outer last pixel to see how much space we would need
+  // each file with the index of its first slice in volumes
+  std::vector<std::pair<const std::string*, std::size_t>> files;
+  std::size_t firstSlice = 0;
+  for (const auto& filenames : filenamesForTimeSteps)
+  {
+    if (filenames.size() * layout.FramesPerFile != layout.NumberOfSlices)
+    {
+      mitkThrow() << "Cannot load DICOM series: time steps differ in their number of files.";
+    }
 
-  resampler->SetOutputParametersFromImage( input ); // we basically need the same image again, just sheared
+    for (const auto& filename : filenames)
+    {
+      files.emplace_back(&filename, firstSlice);
+      firstSlice += layout.FramesPerFile;
+    }
+  }
 
+  mitk::ParallelFor(files.size(), [&](std::size_t fileIndex) {
+    PixelType* output = volumes + files[fileIndex].second * outputSliceSize;
 
-  // if tilt positive, then we need additional pixels BELOW origin, otherwise we need pixels behind the end of the block
+    if (!layout.CorrectTilt)
+    {
+      ReadSlice( *files[fileIndex].first, layout, output );
+    }
+    else
+    {
+      std::vector<PixelType> input(inputSliceSize * layout.FramesPerFile);
+      ReadSlice( *files[fileIndex].first, layout, input.data() );
+
+      for (unsigned int frame = 0; frame < layout.FramesPerFile; ++frame)
+      {
+        const unsigned int slice = (files[fileIndex].second + frame) % layout.NumberOfSlices;
+        ShiftSlice( input.data() + frame * inputSliceSize, layout, slice, output + frame * outputSliceSize );
+      }
+    }
+
+    if (fileLoaded)
+    {
+      fileLoaded( files[fileIndex].second );
+    }
+  });
+}
 
-  // in any case we need more size to accomodate shifted slices
-  typename ImageType::SizeType largerSize = resampler->GetSize(); // now the resampler already holds the input image's size.
-  const double imageSizeZ = largerSize[2];
-  //MITK_DEBUG <<"Calculate lager size = " << largerSize[1] << " + " << tiltInfo.GetTiltCorrectedAdditionalSize(imageSizeZ) << " / " << input->GetSpacing()[1] << "+ 2.0";
-  largerSize[1] += static_cast<typename ImageType::SizeType::SizeValueType>(tiltInfo.GetTiltCorrectedAdditionalSize(imageSizeZ) / input->GetSpacing()[1]+ 2.0);
-  resampler->SetSize( largerSize );
-  //MITK_DEBUG << "Fix Y size of image w/ spacing " << input->GetSpacing()[1] << " from " << input->GetLargestPossibleRegion().GetSize()[1] << " to " << largerSize[1];
+template <typename PixelType>
+void
+mitk::ITKDICOMSeriesReaderHelper
+::ReadSlice( const std::string& filename, const SliceLayout& layout, PixelType* buffer )
+{
+  typedef typename itk::NumericTraits<PixelType>::ValueType ComponentType;
 
-  // in SOME cases this additional size is below/behind origin
-  if ( tiltInfo.GetMatrixCoefficientForCorrectionInWorldCoordinates() > 0.0 )
+  itk::GDCMImageIO::Pointer io = itk::GDCMImageIO::New();
+  io->SetFileName(filename);
+  io->ReadImageInformation();
+
+  const unsigned int frames = io->GetNumberOfDimensions() > 2 ? io->GetDimensions(2) : 1;
+
+  if (io->GetDimensions(0) != layout.InputSize[0] || io->GetDimensions(1) != layout.InputSize[1] || frames != layout.FramesPerFile)
   {
-    typename ImageType::DirectionType imageDirection = input->GetDirection();
-    Vector3D yDirection;
-    yDirection[0] = imageDirection[0][1];
-    yDirection[1] = imageDirection[1][1];
-    yDirection[2] = imageDirection[2][1];
-    yDirection.Normalize();
-
-    typename ImageType::PointType shiftedOrigin;
-    shiftedOrigin = input->GetOrigin();
-
-    // add some pixels to make everything fit
-    shiftedOrigin[0] -= yDirection[0] * (tiltInfo.GetTiltCorrectedAdditionalSize(imageSizeZ) + 1.0 * input->GetSpacing()[1]);
-    shiftedOrigin[1] -= yDirection[1] * (tiltInfo.GetTiltCorrectedAdditionalSize(imageSizeZ) + 1.0 * input->GetSpacing()[1]);
-    shiftedOrigin[2] -= yDirection[2] * (tiltInfo.GetTiltCorrectedAdditionalSize(imageSizeZ) + 1.0 * input->GetSpacing()[1]);
-
-    resampler->SetOutputOrigin( shiftedOrigin );
+    mitkThrow() << "Cannot load DICOM series: size of file " << filename << " differs from the first file.";
   }
 
-  resampler->Update();
-  typename ImageType::Pointer result = resampler->GetOutput();
+  if (io->GetComponentType() == itk::ImageIOBase::MapPixelType<ComponentType>::CType &&
+      io->GetNumberOfComponents() * sizeof(ComponentType) == sizeof(PixelType))
+  {
+    io->Read(buffer);
+  }
+  else
+  {
+    // like itk::ImageSeriesReader, convert files whose pixel type differs from the first file
+    typedef itk::Image<PixelType, 3> FileImageType;
+    typedef itk::ImageFileReader<FileImageType> FileReaderType;
 
-  // ImageSeriesReader calculates z spacing as the distance between the first two origins.
-  // This is not correct in case of gantry tilt, so we set our calculated spacing.
-  typename ImageType::SpacingType correctedSpacing = result->GetSpacing();
-  correctedSpacing[2] = tiltInfo.GetRealZSpacing();
-  result->SetSpacing( correctedSpacing );
+    typename FileReaderType::Pointer reader = FileReaderType::New();
+    reader->SetImageIO(io);
+    reader->SetFileName(filename);
+    reader->Update();
 
-  return result;
+    const FileImageType* fileImage = reader->GetOutput();
+    std::copy(fileImage->GetBufferPointer(),
+              fileImage->GetBufferPointer() + fileImage->GetLargestPossibleRegion().GetNumberOfPixels(),
+              buffer);
+  }
 }
 
+template <typename PixelType>
+void
+mitk::ITKDICOMSeriesReaderHelper
+::ShiftSlice( const PixelType* input, const SliceLayout& layout, unsigned int slice, PixelType* output )
+{
+  typedef typename itk::NumericTraits<PixelType>::ValueType ComponentType;
 
+  // rows are processed component-wise, this covers scalar and RGB pixels
+  const std::size_t rowLength = static_cast<std::size_t>(layout.InputSize[0]) * (sizeof(PixelType) / sizeof(ComponentType));
+  const auto* inputComponents = reinterpret_cast<const ComponentType*>(input);
+  auto* outputComponents = reinterpret_cast<ComponentType*>(output);
+
+  /*
+     This would be the right place to invent a meaningful value for positions outside of the image.
+     For CT, HU -1000 might be meaningful, but a general solution seems not possible. Even for CT,
+     -1000 would only look natural for many not all images.
+  */
+  // TODO use (0028,0120) Pixel Padding Value if present
+  const ComponentType defaultValue = itk::NumericTraits<ComponentType>::min();
+
+  const int lastRow = static_cast<int>(layout.InputSize[1]) - 1;
+  const double rowShift = layout.RowOffset + layout.RowShiftPerSlice * slice;
+
+  for (unsigned int y = 0; y < layout.OutputSize[1]; ++y, outputComponents += rowLength)
+  {
+    const double inputRow = y + rowShift;
+
+    // like itk::LinearInterpolateImageFunction, values are defined up to half a pixel outside of the input
+    if (inputRow < -0.5 || inputRow >= lastRow + 0.5)
+    {
+      std::fill(outputComponents, outputComponents + rowLength, defaultValue);
+      continue;
+    }
+
+    const int row = static_cast<int>(std::floor(inputRow));
+    const double weight = inputRow - row;
+
+    if (row < 0 || row >= lastRow || weight <= 0.0)
+    {
+      const ComponentType* nearestRow = inputComponents + std::min(std::max(row, 0), lastRow) * rowLength;
+      std::copy(nearestRow, nearestRow + rowLength, outputComponents);
+      continue;
+    }
+
+    const ComponentType* row0 = inputComponents + row * rowLength;
+    const ComponentType* row1 = row0 + rowLength;
+    for (std::size_t i = 0; i < rowLength; ++i)
+    {
+      outputComponents[i] = static_cast<ComponentType>(row0[i] + weight * (static_cast<double>(row1[i]) - row0[i]));
+    }
+  }
+}
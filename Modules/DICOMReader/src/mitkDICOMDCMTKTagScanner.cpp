@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <dcmtk/dcmdata/dcfilefo.h>
 #include <dcmtk/dcmdata/dcpath.h>
 
+#include <mitkParallelFor.h>
+
 mitk::DICOMDCMTKTagScanner::DICOMDCMTKTagScanner()
 {
 }
@@ -108,55 +110,67 @@ void mitk::DICOMDCMTKTagScanner::Scan()
 
   try
   {
-    DcmPathProcessor processor;
-    processor.setItemWildcardSupport(true);
+    // files are loaded and searched in parallel, the frame infos are added in input order
+    std::vector<DICOMGenericImageFrameInfo::Pointer> infos(this->m_InputFilenames.size());
 
-    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+    mitk::ParallelFor(this->m_InputFilenames.size(), [&](std::size_t fileIndex) {
+      const std::string& fileName = this->m_InputFilenames[fileIndex];
 
-    for (const auto& fileName : this->m_InputFilenames)
-    {
       DcmFileFormat dfile;
       OFCondition cond = dfile.loadFile(fileName.c_str());
       if (cond.bad())
       {
         MITK_ERROR << "Error when scanning for tags. Cannot open given file. File: " << fileName;
+        return;
       }
-      else
-      {
-        DICOMGenericImageFrameInfo::Pointer info = DICOMGenericImageFrameInfo::New(fileName);
 
-        for (const auto& path : this->m_ScannedTags)
+      DcmPathProcessor processor;
+      processor.setItemWildcardSupport(true);
+
+      DICOMGenericImageFrameInfo::Pointer info = DICOMGenericImageFrameInfo::New(fileName);
+
+      for (const auto& path : this->m_ScannedTags)
+      {
+        std::string tagPath = DICOMTagPathToDCMTKSearchPath(path);
+        cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
+        if (cond.good())
         {
-          std::string tagPath = DICOMTagPathToDCMTKSearchPath(path);
-          cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
-          if (cond.good())
+          OFList< DcmPath * > findings;
+          processor.getResults(findings);
+          for (const auto& finding : findings)
           {
-            OFList< DcmPath * > findings;
-            processor.getResults(findings);
-            for (const auto& finding : findings)
+            auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
+            if (!element)
             {
-              auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
-              if (!element)
+              auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
+              if (item)
               {
-                auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
-                if (item)
-                {
-                  element = item->getElement(finding->back()->m_itemNo);
-                }
+                element = item->getElement(finding->back()->m_itemNo);
               }
+            }
 
-              if (element)
+            if (element)
+            {
+              OFString value;
+              cond = element->getOFStringArray(value);
+              if (cond.good())
               {
-                OFString value;
-                cond = element->getOFStringArray(value);
-                if (cond.good())
-                {
-                  info->SetTagValue(DcmPathToTagPath(finding), std::string(value.c_str()));
-                }
+                info->SetTagValue(DcmPathToTagPath(finding), std::string(value.c_str()));
               }
             }
           }
         }
+      }
+
+      infos[fileIndex] = info;
+    });
+
+    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+
+    for (const auto& info : infos)
+    {
+      if (info.IsNotNull())
+      {
         newCache->AddFrameInfo(info);
       }
     }
@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMEnums.h"
 #include "mitkDICOMGDCMImageFrameInfo.h"
 
+#include <mitkExceptionMacro.h>
+
 mitk::DICOMGDCMTagCache::DICOMGDCMTagCache()
 {
 }
@@ -30,11 +32,15 @@ mitk::DICOMDatasetFinding mitk::DICOMGDCMTagCache::GetTagValue( DICOMImageFrameI
 {
   assert( frame );
 
-  for ( auto frameIter = m_ScanResult.cbegin(); frameIter != m_ScanResult.cend(); ++frameIter )
+  auto indexIter = m_FrameIndices.find( frame->Filename );
+  if ( indexIter != m_FrameIndices.cend() )
   {
-    if ( **frameIter == *frame )
+    for ( auto frameIter = m_ScanResult.cbegin() + indexIter->second; frameIter != m_ScanResult.cend(); ++frameIter )
     {
-      return (*frameIter)->GetTagValueAsString(tag);
+      if ( **frameIter == *frame )
+      {
+        return (*frameIter)->GetTagValueAsString(tag);
+      }
     }
   }
 
@@ -99,10 +105,59 @@ mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const
     m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(*inputIter, 0),
       m_Scanner->GetMapping(inputIter->c_str())).GetPointer());
   }
+
+  this->InitFrameIndices();
+}
+
+void
+mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const std::vector<TagValueMapType>& tagValues, const StringList& inputFiles)
+{
+  if (tagValues.size() != inputFiles.size())
+  {
+    mitkThrow() << "Invalid call to DICOMGDCMTagCache::InitCache(). Number of tag value lists does not match the number of files.";
+  }
+
+  m_ScannedTags = scannedTags;
+  m_InputFilenames = inputFiles;
+  m_Scanner.reset();
+  m_TagValues.clear();
+  m_ScanResult.clear();
+  m_ScanResult.reserve(m_InputFilenames.size());
+
+  for (std::size_t fileIndex = 0; fileIndex < m_InputFilenames.size(); ++fileIndex)
+  {
+    // like gdcm::Scanner, the frame infos refer to values owned by the cache
+    gdcm::Scanner::TagToValue mapping;
+    for (const auto& tagValue : tagValues[fileIndex])
+    {
+      const std::string& value = *(m_TagValues.insert(tagValue.second).first);
+      mapping.insert(std::make_pair(gdcm::Tag(tagValue.first.GetGroup(), tagValue.first.GetElement()), value.c_str()));
+    }
+
+    m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(m_InputFilenames[fileIndex], 0),
+      mapping).GetPointer());
+  }
+
+  this->InitFrameIndices();
+}
+
+void
+mitk::DICOMGDCMTagCache::InitFrameIndices()
+{
+  m_FrameIndices.clear();
+  for (std::size_t frameIndex = 0; frameIndex < m_ScanResult.size(); ++frameIndex)
+  {
+    m_FrameIndices.insert(std::make_pair(m_ScanResult[frameIndex]->Filename, frameIndex));
+  }
 }
 
 const gdcm::Scanner&
 mitk::DICOMGDCMTagCache::GetScanner() const
 {
+  if (!m_Scanner)
+  {
+    mitkThrow() << "DICOMGDCMTagCache was not initialized from a gdcm::Scanner.";
+  }
+
   return *(this->m_Scanner);
 }
@@ -0,0 +1,264 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDICOMGDCMTagIndex.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkLogMacros.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+
+namespace
+{
+  const char IndexFileSignature[] = "MITKDICOMTAGINDEX";
+  const std::uint32_t IndexFileVersion = 1;
+
+  template <typename T>
+  void WriteValue(std::ostream& stream, T value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void WriteString(std::ostream& stream, const std::string& value)
+  {
+    WriteValue(stream, static_cast<std::uint32_t>(value.size()));
+    stream.write(value.data(), value.size());
+  }
+
+  template <typename T>
+  bool ReadValue(std::istream& stream, T& value)
+  {
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  bool ReadString(std::istream& stream, std::string& value)
+  {
+    std::uint32_t size = 0;
+    if (!ReadValue(stream, size))
+      return false;
+
+    value.resize(size);
+    return size == 0 || static_cast<bool>(stream.read(&value[0], size));
+  }
+}
+
+mitk::DICOMGDCMTagIndex::DICOMGDCMTagIndex()
+: m_Modified(false)
+{
+}
+
+mitk::DICOMGDCMTagIndex::~DICOMGDCMTagIndex()
+{
+}
+
+bool
+mitk::DICOMGDCMTagIndex::GetFileStatus(const std::string& filename, std::uint64_t& size, std::int64_t& modificationTime)
+{
+  if (!itksys::SystemTools::FileExists(filename.c_str(), true))
+  {
+    return false;
+  }
+
+  size = static_cast<std::uint64_t>(itksys::SystemTools::FileLength(filename));
+  modificationTime = static_cast<std::int64_t>(itksys::SystemTools::ModifiedTime(filename));
+  return true;
+}
+
+bool
+mitk::DICOMGDCMTagIndex::Lookup(const std::string& filename, const std::set<DICOMTag>& tags, TagValueMapType& values) const
+{
+  values.clear();
+
+  auto entryIter = m_Entries.find(filename);
+  if (entryIter == m_Entries.cend())
+  {
+    return false;
+  }
+
+  const Entry& entry = entryIter->second;
+
+  std::uint64_t size = 0;
+  std::int64_t modificationTime = 0;
+  if (!GetFileStatus(filename, size, modificationTime) || size != entry.Size || modificationTime != entry.ModificationTime)
+  {
+    return false;
+  }
+
+  for (const auto& tag : tags)
+  {
+    auto tagIter = entry.Tags.find(tag);
+    if (tagIter == entry.Tags.cend())
+    {
+      values.clear();
+      return false;
+    }
+
+    if (tagIter->second.first)
+    {
+      values.insert(std::make_pair(tag, tagIter->second.second));
+    }
+  }
+
+  return true;
+}
+
+void
+mitk::DICOMGDCMTagIndex::Update(const std::string& filename, const std::set<DICOMTag>& tags, const TagValueMapType& values)
+{
+  std::uint64_t size = 0;
+  std::int64_t modificationTime = 0;
+  if (!GetFileStatus(filename, size, modificationTime))
+  {
+    return;
+  }
+
+  Entry& entry = m_Entries[filename];
+
+  // keep the tags of previous scans as long as the file did not change
+  if (entry.Tags.empty() || entry.Size != size || entry.ModificationTime != modificationTime)
+  {
+    entry.Size = size;
+    entry.ModificationTime = modificationTime;
+    entry.Tags.clear();
+  }
+
+  for (const auto& tag : tags)
+  {
+    auto valueIter = values.find(tag);
+    entry.Tags.erase(tag);
+
+    if (valueIter != values.cend())
+    {
+      entry.Tags.insert(std::make_pair(tag, std::make_pair(true, valueIter->second)));
+    }
+    else
+    {
+      entry.Tags.insert(std::make_pair(tag, std::make_pair(false, std::string())));
+    }
+  }
+
+  m_Modified = true;
+}
+
+bool
+mitk::DICOMGDCMTagIndex::IsModified() const
+{
+  return m_Modified;
+}
+
+std::size_t
+mitk::DICOMGDCMTagIndex::GetNumberOfEntries() const
+{
+  return m_Entries.size();
+}
+
+void
+mitk::DICOMGDCMTagIndex::Load(const std::string& indexFilename)
+{
+  m_Entries.clear();
+  m_Modified = false;
+
+  std::ifstream stream(indexFilename.c_str(), std::ios::binary);
+  if (!stream.is_open())
+  {
+    return;
+  }
+
+  std::string signature;
+  std::uint32_t version = 0;
+  std::uint64_t numberOfEntries = 0;
+
+  if (!ReadString(stream, signature) || signature != IndexFileSignature || !ReadValue(stream, version) ||
+      version != IndexFileVersion || !ReadValue(stream, numberOfEntries))
+  {
+    MITK_WARN << "Ignoring invalid DICOM tag index " << indexFilename;
+    return;
+  }
+
+  for (std::uint64_t entryIndex = 0; entryIndex < numberOfEntries; ++entryIndex)
+  {
+    std::string filename;
+    Entry entry;
+    std::uint32_t numberOfTags = 0;
+
+    if (!ReadString(stream, filename) || !ReadValue(stream, entry.Size) || !ReadValue(stream, entry.ModificationTime) ||
+        !ReadValue(stream, numberOfTags))
+    {
+      MITK_WARN << "Ignoring truncated DICOM tag index " << indexFilename;
+      m_Entries.clear();
+      return;
+    }
+
+    for (std::uint32_t tagIndex = 0; tagIndex < numberOfTags; ++tagIndex)
+    {
+      std::uint16_t group = 0;
+      std::uint16_t element = 0;
+      std::uint8_t hasValue = 0;
+      std::string value;
+
+      if (!ReadValue(stream, group) || !ReadValue(stream, element) || !ReadValue(stream, hasValue) ||
+          !ReadString(stream, value))
+      {
+        MITK_WARN << "Ignoring truncated DICOM tag index " << indexFilename;
+        m_Entries.clear();
+        return;
+      }
+
+      entry.Tags.insert(std::make_pair(DICOMTag(group, element), std::make_pair(hasValue != 0, value)));
+    }
+
+    m_Entries.insert(std::make_pair(filename, entry));
+  }
+}
+
+void
+mitk::DICOMGDCMTagIndex::Save(const std::string& indexFilename) const
+{
+  std::ofstream stream(indexFilename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!stream.is_open())
+  {
+    mitkThrow() << "Cannot write DICOM tag index " << indexFilename;
+  }
+
+  WriteString(stream, IndexFileSignature);
+  WriteValue(stream, IndexFileVersion);
+  WriteValue(stream, static_cast<std::uint64_t>(m_Entries.size()));
+
+  for (const auto& entry : m_Entries)
+  {
+    WriteString(stream, entry.first);
+    WriteValue(stream, entry.second.Size);
+    WriteValue(stream, entry.second.ModificationTime);
+    WriteValue(stream, static_cast<std::uint32_t>(entry.second.Tags.size()));
+
+    for (const auto& tag : entry.second.Tags)
+    {
+      WriteValue(stream, static_cast<std::uint16_t>(tag.first.GetGroup()));
+      WriteValue(stream, static_cast<std::uint16_t>(tag.first.GetElement()));
+      WriteValue(stream, static_cast<std::uint8_t>(tag.second.first ? 1 : 0));
+      WriteString(stream, tag.second.second);
+    }
+  }
+
+  if (!stream)
+  {
+    mitkThrow() << "Cannot write DICOM tag index " << indexFilename;
+  }
+
+  m_Modified = false;
+}
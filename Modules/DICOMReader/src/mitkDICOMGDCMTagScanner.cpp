@@ -20,9 +20,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <gdcmScanner.h>
 
+#include <mitkParallelFor.h>
+
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+
 mitk::DICOMGDCMTagScanner::DICOMGDCMTagScanner()
+: m_NumberOfParsedFiles(0)
 {
-  m_GDCMScanner = std::make_shared<gdcm::Scanner>();
 }
 
 mitk::DICOMGDCMTagScanner::~DICOMGDCMTagScanner()
@@ -45,8 +51,6 @@ mitk::DICOMDatasetFinding mitk::DICOMGDCMTagScanner::GetTagValue( DICOMImageFram
 void mitk::DICOMGDCMTagScanner::AddTag( const DICOMTag& tag )
 {
   m_ScannedTags.insert( tag );
-  m_GDCMScanner->AddTag(
-    gdcm::Tag( tag.GetGroup(), tag.GetElement() ) ); // also a set, duplicate calls to AddTag don't hurt
 }
 
 void mitk::DICOMGDCMTagScanner::AddTags( const DICOMTagList& tags )
@@ -94,13 +98,97 @@ void mitk::DICOMGDCMTagScanner::SetInputFiles( const StringList& filenames )
 }
 
 
+void mitk::DICOMGDCMTagScanner::SetTagIndex( DICOMGDCMTagIndex* index )
+{
+  m_TagIndex = index;
+}
+
+mitk::DICOMGDCMTagIndex* mitk::DICOMGDCMTagScanner::GetTagIndex() const
+{
+  return m_TagIndex.GetPointer();
+}
+
+std::size_t mitk::DICOMGDCMTagScanner::GetNumberOfParsedFiles() const
+{
+  return m_NumberOfParsedFiles;
+}
+
 void mitk::DICOMGDCMTagScanner::Scan()
 {
   // TODO integrate push/pop locale??
-  m_GDCMScanner->Scan( m_InputFilenames );
+  std::vector<DICOMGDCMTagCache::TagValueMapType> tagValues( m_InputFilenames.size() );
+
+  // only files that are not known to the index need to be parsed
+  std::vector<std::size_t> filesToParse;
+  for ( std::size_t fileIndex = 0; fileIndex < m_InputFilenames.size(); ++fileIndex )
+  {
+    if ( m_TagIndex.IsNull() || !m_TagIndex->Lookup( m_InputFilenames[fileIndex], m_ScannedTags, tagValues[fileIndex] ) )
+    {
+      filesToParse.push_back( fileIndex );
+    }
+  }
+
+  m_NumberOfParsedFiles = filesToParse.size();
+
+  // files are parsed in contiguous chunks, each by its own gdcm::Scanner; more chunks than
+  // threads balance the load if files differ in size
+  const std::size_t numberOfThreads = std::max( 1, static_cast<int>( itk::MultiThreader::GetGlobalDefaultNumberOfThreads() ) );
+  const std::size_t numberOfChunks = std::min( filesToParse.size(), 4 * numberOfThreads );
+  std::vector<char> parsed( m_InputFilenames.size(), 0 );
+
+  mitk::ParallelFor( numberOfChunks, [&]( std::size_t chunk ) {
+    const std::size_t begin = chunk * filesToParse.size() / numberOfChunks;
+    const std::size_t end = ( chunk + 1 ) * filesToParse.size() / numberOfChunks;
+
+    gdcm::Directory::FilenamesType chunkFiles;
+    chunkFiles.reserve( end - begin );
+    for ( std::size_t i = begin; i < end; ++i )
+    {
+      chunkFiles.push_back( m_InputFilenames[ filesToParse[i] ] );
+    }
+
+    gdcm::Scanner scanner;
+    for ( const auto& tag : m_ScannedTags )
+    {
+      scanner.AddTag( gdcm::Tag( tag.GetGroup(), tag.GetElement() ) );
+    }
+    scanner.Scan( chunkFiles );
+
+    // each file index is written by exactly one chunk
+    for ( std::size_t i = begin; i < end; ++i )
+    {
+      const std::size_t fileIndex = filesToParse[i];
+      const char* filename = m_InputFilenames[fileIndex].c_str();
+
+      if ( !scanner.IsKey( filename ) )
+      {
+        continue;
+      }
+
+      parsed[fileIndex] = 1;
+
+      const gdcm::Scanner::TagToValue& mapping = scanner.GetMapping( filename );
+      for ( const auto& tagValue : mapping )
+      {
+        tagValues[fileIndex][ DICOMTag( tagValue.first.GetGroup(), tagValue.first.GetElement() ) ] =
+          tagValue.second != nullptr ? tagValue.second : "";
+      }
+    }
+  } );
+
+  if ( m_TagIndex.IsNotNull() )
+  {
+    for ( const auto fileIndex : filesToParse )
+    {
+      if ( parsed[fileIndex] )
+      {
+        m_TagIndex->Update( m_InputFilenames[fileIndex], m_ScannedTags, tagValues[fileIndex] );
+      }
+    }
+  }
 
   DICOMGDCMTagCache::Pointer newCache = DICOMGDCMTagCache::New();
-  newCache->InitCache(m_ScannedTags, m_GDCMScanner, m_InputFilenames);
+  newCache->InitCache(m_ScannedTags, tagValues, m_InputFilenames);
 
   m_Cache = newCache;
 }
@@ -34,6 +34,7 @@ mitk::DICOMITKSeriesGDCMReader::DICOMITKSeriesGDCMReader( unsigned int decimalPl
 , m_SimpleVolumeReading( simpleVolumeImport )
 , m_DecimalPlacesForOrientation( decimalPlacesForOrientation )
 , m_ExternalCache(false)
+, m_ProgressiveLoading(false)
 {
   this->EnsureMandatorySortersArePresent( decimalPlacesForOrientation, simpleVolumeImport );
 }
@@ -51,11 +52,15 @@ mitk::DICOMITKSeriesGDCMReader::DICOMITKSeriesGDCMReader( const DICOMITKSeriesGD
 , m_DecimalPlacesForOrientation( other.m_DecimalPlacesForOrientation )
 , m_TagCache( other.m_TagCache )
 , m_ExternalCache(other.m_ExternalCache)
+, m_TagIndexFileName( other.m_TagIndexFileName )
+, m_ProgressiveLoading( other.m_ProgressiveLoading )
 {
 }
 
 mitk::DICOMITKSeriesGDCMReader::~DICOMITKSeriesGDCMReader()
 {
+  // background tasks write into images that might still be in use elsewhere, let them finish
+  this->WaitForProgressiveLoading();
 }
 
 mitk::DICOMITKSeriesGDCMReader& mitk::DICOMITKSeriesGDCMReader::
@@ -73,6 +78,8 @@ mitk::DICOMITKSeriesGDCMReader& mitk::DICOMITKSeriesGDCMReader::
     this->m_ReplacedCinLocales               = other.m_ReplacedCinLocales;
     this->m_DecimalPlacesForOrientation      = other.m_DecimalPlacesForOrientation;
     this->m_TagCache                         = other.m_TagCache;
+    this->m_TagIndexFileName                 = other.m_TagIndexFileName;
+    this->m_ProgressiveLoading               = other.m_ProgressiveLoading;
   }
   return *this;
 }
@@ -123,6 +130,55 @@ bool mitk::DICOMITKSeriesGDCMReader::GetFixTiltByShearing() const
   return m_FixTiltByShearing;
 }
 
+void mitk::DICOMITKSeriesGDCMReader::SetTagIndexFileName( const std::string& fileName )
+{
+  if ( m_TagIndexFileName != fileName )
+  {
+    m_TagIndexFileName = fileName;
+    this->Modified();
+  }
+}
+
+std::string mitk::DICOMITKSeriesGDCMReader::GetTagIndexFileName() const
+{
+  return m_TagIndexFileName;
+}
+
+void mitk::DICOMITKSeriesGDCMReader::SetProgressiveLoading( bool on )
+{
+  m_ProgressiveLoading = on;
+}
+
+bool mitk::DICOMITKSeriesGDCMReader::GetProgressiveLoading() const
+{
+  return m_ProgressiveLoading;
+}
+
+bool mitk::DICOMITKSeriesGDCMReader::WaitForProgressiveLoading() const
+{
+  std::vector<std::shared_future<void>> loads;
+  {
+    std::lock_guard<std::mutex> lock( m_ProgressiveLoadsMutex );
+    loads.swap( m_ProgressiveLoads );
+  }
+
+  bool success = true;
+  for ( auto& load : loads )
+  {
+    try
+    {
+      load.get();
+    }
+    catch ( const std::exception& e )
+    {
+      success = false;
+      MITK_ERROR << "Exception during progressive image loading: " << e.what();
+    }
+  }
+
+  return success;
+}
+
 void mitk::DICOMITKSeriesGDCMReader::SetAcceptTwoSlicesGroups( bool accept ) const
 {
   this->Modified();
@@ -242,10 +298,30 @@ void mitk::DICOMITKSeriesGDCMReader::AnalyzeInputFiles()
     filescanner->SetInputFiles( inputFilenames );
     filescanner->AddTagPaths( this->GetTagsOfInterest() );
 
+    DICOMGDCMTagIndex::Pointer tagIndex;
+    if ( !m_TagIndexFileName.empty() )
+    {
+      tagIndex = DICOMGDCMTagIndex::New();
+      tagIndex->Load( m_TagIndexFileName );
+      filescanner->SetTagIndex( tagIndex );
+    }
+
     PushLocale();
     filescanner->Scan();
     PopLocale();
 
+    if ( tagIndex.IsNotNull() && tagIndex->IsModified() )
+    {
+      try
+      {
+        tagIndex->Save( m_TagIndexFileName );
+      }
+      catch ( const std::exception& e )
+      {
+        MITK_WARN << "Could not update DICOM tag index: " << e.what();
+      }
+    }
+
     m_TagCache = filescanner->GetScanCache(); // keep alive and make accessible to sub-classes
 
     timeStop("Tag scanning");
@@ -454,7 +530,24 @@ bool mitk::DICOMITKSeriesGDCMReader::LoadMitkImageForImageBlockDescriptor(
   bool success( true );
   try
   {
-    mitk::Image::Pointer mitkImage = helper.Load( filenames, m_FixTiltByShearing && hasTilt, tiltInfo );
+    mitk::Image::Pointer mitkImage;
+
+    if ( m_ProgressiveLoading )
+    {
+      std::shared_future<void> loading;
+      mitkImage = helper.LoadProgressively( filenames, m_FixTiltByShearing && hasTilt, tiltInfo, loading );
+
+      if ( loading.valid() )
+      {
+        std::lock_guard<std::mutex> lock( m_ProgressiveLoadsMutex );
+        m_ProgressiveLoads.push_back( loading );
+      }
+    }
+    else
+    {
+      mitkImage = helper.Load( filenames, m_FixTiltByShearing && hasTilt, tiltInfo );
+    }
+
     block.SetMitkImage( mitkImage );
   }
   catch ( const std::exception& e )
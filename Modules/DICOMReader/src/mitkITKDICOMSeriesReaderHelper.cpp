@@ -42,7 +42,7 @@ const mitk::DICOMTag mitk::ITKDICOMSeriesReaderHelper::TriggerTimeTag = mitk::DI
 
 #define switch3DCase( IOType, T ) \
   case IOType:                    \
-    return LoadDICOMByITK<T>( filenames, correctTilt, tiltInfo, io );
+    return LoadDICOMByITK<T>( filenames, correctTilt, tiltInfo, io, loading );
 
 bool mitk::ITKDICOMSeriesReaderHelper::CanHandleFile( const std::string& filename )
 {
@@ -54,6 +54,22 @@ bool mitk::ITKDICOMSeriesReaderHelper::CanHandleFile( const std::string& filenam
 mitk::Image::Pointer mitk::ITKDICOMSeriesReaderHelper::Load( const StringContainer& filenames,
                                                              bool correctTilt,
                                                              const GantryTiltInformation& tiltInfo )
+{
+  return this->Load( filenames, correctTilt, tiltInfo, nullptr );
+}
+
+mitk::Image::Pointer mitk::ITKDICOMSeriesReaderHelper::LoadProgressively( const StringContainer& filenames,
+                                                                          bool correctTilt,
+                                                                          const GantryTiltInformation& tiltInfo,
+                                                                          std::shared_future<void>& loading )
+{
+  return this->Load( filenames, correctTilt, tiltInfo, &loading );
+}
+
+mitk::Image::Pointer mitk::ITKDICOMSeriesReaderHelper::Load( const StringContainer& filenames,
+                                                             bool correctTilt,
+                                                             const GantryTiltInformation& tiltInfo,
+                                                             std::shared_future<void>* loading )
 {
   if ( filenames.empty() )
   {
@@ -0,0 +1,139 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDICOMGDCMTagScanner.h"
+#include "mitkDICOMGDCMTagIndex.h"
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkIOUtil.h>
+
+#include <itksys/SystemTools.hxx>
+
+class mitkDICOMGDCMTagScannerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkDICOMGDCMTagScannerTestSuite);
+
+  MITK_TEST(MultiFileScanning);
+  MITK_TEST(IndexedScanning);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::StringList ctFiles;
+  std::string indexFile;
+
+  mitk::DICOMTag instanceUID;
+  mitk::DICOMTag missingTag;
+
+  mitk::DICOMDatasetAccessingImageFrameList Scan(mitk::DICOMGDCMTagIndex* index, std::size_t& numberOfParsedFiles)
+  {
+    mitk::DICOMGDCMTagScanner::Pointer scanner = mitk::DICOMGDCMTagScanner::New();
+    scanner->SetInputFiles(ctFiles);
+    scanner->AddTag(instanceUID);
+    scanner->AddTag(missingTag);
+    scanner->SetTagIndex(index);
+    scanner->Scan();
+
+    numberOfParsedFiles = scanner->GetNumberOfParsedFiles();
+    return scanner->GetFrameInfoList();
+  }
+
+  void CheckFrames(const mitk::DICOMDatasetAccessingImageFrameList& frames)
+  {
+    const char* expectedUIDs[] = { "1.2.276.0.99.1.4.8323329.3795.1303917947.940051",
+                                   "1.2.276.0.99.1.4.8323329.3795.1303917947.940052",
+                                   "1.2.276.0.99.1.4.8323329.3795.1303917947.940053",
+                                   "1.2.276.0.99.1.4.8323329.3795.1303917947.940055" };
+
+    CPPUNIT_ASSERT_MESSAGE("Testing number of frames", frames.size() == ctFiles.size());
+
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Testing order of frames", frames[i]->GetFilenameIfAvailable() == ctFiles[i]);
+
+      mitk::DICOMDatasetFinding finding = frames[i]->GetTagValueAsString(instanceUID);
+      CPPUNIT_ASSERT_MESSAGE("Testing validity of instance uid finding", finding.isValid);
+      CPPUNIT_ASSERT_EQUAL(std::string(expectedUIDs[i]), finding.value);
+
+      finding = frames[i]->GetTagValueAsString(missingTag);
+      CPPUNIT_ASSERT_MESSAGE("Testing finding of missing tag", !finding.isValid);
+    }
+  }
+
+public:
+
+  void setUp() override
+  {
+    ctFiles.clear();
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/100"));
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/101"));
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/102"));
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/104"));
+
+    instanceUID = mitk::DICOMTag(0x0008, 0x0018);
+    missingTag = mitk::DICOMTag(0x0009, 0x1234);
+
+    indexFile = mitk::IOUtil::CreateTemporaryFile("mitkDICOMTagIndex_XXXXXX");
+  }
+
+  void tearDown() override
+  {
+    itksys::SystemTools::RemoveFile(indexFile);
+  }
+
+  void MultiFileScanning()
+  {
+    std::size_t numberOfParsedFiles = 0;
+    this->CheckFrames(this->Scan(nullptr, numberOfParsedFiles));
+    CPPUNIT_ASSERT_EQUAL(ctFiles.size(), numberOfParsedFiles);
+  }
+
+  void IndexedScanning()
+  {
+    std::size_t numberOfParsedFiles = 0;
+
+    mitk::DICOMGDCMTagIndex::Pointer index = mitk::DICOMGDCMTagIndex::New();
+    index->Load(indexFile);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), index->GetNumberOfEntries());
+
+    this->CheckFrames(this->Scan(index, numberOfParsedFiles));
+    CPPUNIT_ASSERT_EQUAL(ctFiles.size(), numberOfParsedFiles);
+    CPPUNIT_ASSERT_MESSAGE("Testing modification of the index", index->IsModified());
+    CPPUNIT_ASSERT_EQUAL(ctFiles.size(), index->GetNumberOfEntries());
+
+    index->Save(indexFile);
+    CPPUNIT_ASSERT_MESSAGE("Testing modification of the index after saving", !index->IsModified());
+
+    mitk::DICOMGDCMTagIndex::Pointer loadedIndex = mitk::DICOMGDCMTagIndex::New();
+    loadedIndex->Load(indexFile);
+    CPPUNIT_ASSERT_EQUAL(ctFiles.size(), loadedIndex->GetNumberOfEntries());
+
+    this->CheckFrames(this->Scan(loadedIndex, numberOfParsedFiles));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), numberOfParsedFiles);
+    CPPUNIT_ASSERT_MESSAGE("Testing modification of the index by an indexed scan", !loadedIndex->IsModified());
+
+    // tags that were not scanned before require parsing
+    mitk::DICOMGDCMTagCache::TagValueMapType values;
+    std::set<mitk::DICOMTag> tags;
+    tags.insert(mitk::DICOMTag(0x0020, 0x0013));
+    CPPUNIT_ASSERT_MESSAGE("Testing lookup of unscanned tag", !loadedIndex->Lookup(ctFiles.front(), tags, values));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDICOMGDCMTagScanner)
@@ -0,0 +1,230 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkClassicDICOMSeriesReader.h"
+
+#include "mitkIOUtil.h"
+#include "mitkImageCast.h"
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <itkGDCMImageIO.h>
+#include <itkImageFileWriter.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkMetaDataObject.h>
+#include <itkMultiThreader.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  const unsigned int Columns = 24;
+  const unsigned int Rows = 32;
+  const unsigned int Slices = 12;
+
+  const double ShiftUp = 0.4;
+  const double SliceDistance = 2.0;
+
+  /** All intensities are integral at the input pixel centers, see ShiftUp and SliceDistance. */
+  double Intensity(const itk::Point<double, 3> &point)
+  {
+    return 3.0 * point[0] + 10.0 * point[1] + 2.5 * point[2];
+  }
+}
+
+/**
+  Writes a synthetic CT series acquired with a tilted gantry and checks the sheared volume
+  produced by the tilt correction.
+
+  Slice k is located at (0, k * ShiftUp, k * SliceDistance) with the standard orientation.
+  The pixels of the series sample an intensity that is linear in world coordinates, so
+  interpolating between rows is exact and every corrected voxel that is covered by its input
+  slice has to show the intensity of its world position. This is what the former correction by
+  itk::ResampleImageFilter produced, up to the truncation to the integer pixel type.
+*/
+class mitkDICOMGantryTiltCorrectionTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkDICOMGantryTiltCorrectionTestSuite);
+
+  MITK_TEST(TestShearedGeometry);
+  MITK_TEST(TestShearedIntensities);
+  MITK_TEST(TestThreadedDecoding);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<short, 3> SliceType;
+  typedef itk::Image<double, 3> VolumeType;
+
+  std::string m_Directory;
+  mitk::StringList m_Files;
+
+  void WriteTiltedSeries()
+  {
+    for (unsigned int k = 0; k < Slices; ++k)
+    {
+      SliceType::SizeType size = {{Columns, Rows, 1}};
+      SliceType::SpacingType spacing;
+      spacing.Fill(1.0);
+      spacing[2] = SliceDistance;
+      SliceType::PointType origin;
+      origin[0] = 0.0;
+      origin[1] = k * ShiftUp;
+      origin[2] = k * SliceDistance;
+
+      SliceType::Pointer slice = SliceType::New();
+      slice->SetRegions(size);
+      slice->SetSpacing(spacing);
+      slice->SetOrigin(origin);
+      slice->Allocate();
+
+      itk::ImageRegionIteratorWithIndex<SliceType> iter(slice, slice->GetLargestPossibleRegion());
+      for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+      {
+        SliceType::PointType point;
+        slice->TransformIndexToPhysicalPoint(iter.GetIndex(), point);
+        iter.Set(static_cast<short>(std::round(Intensity(point))));
+      }
+
+      const std::string uidRoot = "1.2.276.0.7230010.3.1.4.2718281828.";
+
+      itk::MetaDataDictionary &dictionary = slice->GetMetaDataDictionary();
+      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0016", "1.2.840.10008.5.1.4.1.1.2"); // CT Image Storage
+      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0018", uidRoot + "3." + std::to_string(k + 1));
+      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0060", "CT");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|000d", uidRoot + "1");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|000e", uidRoot + "2");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0052", uidRoot + "4");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0013", std::to_string(k + 1));
+      itk::EncapsulateMetaData<std::string>(dictionary, "0018|0050", "2");
+
+      itk::GDCMImageIO::Pointer io = itk::GDCMImageIO::New();
+      io->KeepOriginalUIDOn();
+
+      const std::string filename = m_Directory + "/slice" + std::to_string(k) + ".dcm";
+
+      itk::ImageFileWriter<SliceType>::Pointer writer = itk::ImageFileWriter<SliceType>::New();
+      writer->SetImageIO(io);
+      writer->SetFileName(filename);
+      writer->SetInput(slice);
+      writer->Update();
+
+      m_Files.push_back(filename);
+    }
+  }
+
+  mitk::Image::Pointer LoadSeries()
+  {
+    mitk::ClassicDICOMSeriesReader::Pointer reader = mitk::ClassicDICOMSeriesReader::New();
+    reader->SetFixTiltByShearing(true);
+    reader->SetInputFiles(m_Files);
+    reader->AnalyzeInputFiles();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("The tilted slices should form one block", 1u, reader->GetNumberOfOutputs());
+    CPPUNIT_ASSERT(reader->LoadImages());
+
+    mitk::Image::Pointer image = reader->GetOutput(0).GetMitkImage();
+    CPPUNIT_ASSERT(image.IsNotNull());
+
+    bool tiltCorrected = false;
+    image->GetPropertyList()->GetBoolProperty("dicomseriesreader.GantyTiltCorrected", tiltCorrected);
+    CPPUNIT_ASSERT_MESSAGE("The gantry tilt was not detected", tiltCorrected);
+
+    return image;
+  }
+
+public:
+  void setUp() override
+  {
+    m_Directory = mitk::IOUtil::CreateTemporaryDirectory("mitkDICOMGantryTiltCorrectionTest-XXXXXX");
+    m_Files.clear();
+    this->WriteTiltedSeries();
+  }
+
+  void tearDown() override
+  {
+    itksys::SystemTools::RemoveADirectory(m_Directory);
+  }
+
+  void TestShearedGeometry()
+  {
+    mitk::Image::Pointer image = this->LoadSeries();
+
+    // the rows are extended by the total shift plus two rows, as before
+    const unsigned int expectedRows =
+      Rows + static_cast<unsigned int>(ShiftUp * (Slices - 1) + 2.0);
+
+    CPPUNIT_ASSERT_EQUAL(Columns, image->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(expectedRows, image->GetDimension(1));
+    CPPUNIT_ASSERT_EQUAL(Slices, image->GetDimension(2));
+
+    const mitk::Vector3D spacing = image->GetGeometry()->GetSpacing();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, spacing[0], mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, spacing[1], mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(
+      "The z spacing should be the distance of the slice planes", SliceDistance, spacing[2], 1e-4);
+  }
+
+  void TestShearedIntensities()
+  {
+    mitk::Image::Pointer image = this->LoadSeries();
+
+    VolumeType::Pointer volume;
+    mitk::CastToItkImage(image, volume);
+
+    unsigned int numberOfCheckedVoxels = 0;
+
+    itk::ImageRegionConstIteratorWithIndex<VolumeType> iter(volume, volume->GetLargestPossibleRegion());
+    for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+      mitk::Point3D index;
+      mitk::FillVector3D(index, iter.GetIndex()[0], iter.GetIndex()[1], iter.GetIndex()[2]);
+      mitk::Point3D world;
+      image->GetGeometry()->IndexToWorld(index, world);
+
+      // only voxels that are covered by their input slice, with one row margin
+      const double firstRow = std::round(world[2] / SliceDistance) * ShiftUp;
+      if (world[1] < firstRow + 1.0 || world[1] > firstRow + Rows - 2.0)
+        continue;
+
+      // the pixel type is integral, so interpolated values may be truncated
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(Intensity(world), iter.Get(), 1.0);
+      ++numberOfCheckedVoxels;
+    }
+
+    CPPUNIT_ASSERT(numberOfCheckedVoxels >= Columns * (Rows - 3) * Slices);
+  }
+
+  void TestThreadedDecoding()
+  {
+    const int numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(1);
+    mitk::Image::Pointer singleThreaded = this->LoadSeries();
+
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(std::max(4, numberOfThreads));
+    mitk::Image::Pointer threaded = this->LoadSeries();
+
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(numberOfThreads);
+
+    MITK_ASSERT_EQUAL(singleThreaded, threaded, "Threaded decoding should equal single-threaded decoding");
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDICOMGantryTiltCorrection)
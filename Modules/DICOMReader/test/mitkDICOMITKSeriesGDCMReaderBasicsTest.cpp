@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTestingMacros.h"
 
 #include <unordered_map>
+#include <vector>
 #include "mitkStringProperty.h"
 
 using mitk::DICOMTag;
@@ -121,5 +122,46 @@ int mitkDICOMITKSeriesGDCMReaderBasicsTest(int argc, char* argv[])
   mitk::DICOMFileReaderTestHelper::TestMitkImagesAreLoaded( gdcmReader, additionalTags, expectedPropertyTypes );
 
 
+  //////////////////////////////////////////////////////////////////////////
+  //
+  // Load the images progressively and compare them to the complete images
+  //
+  //////////////////////////////////////////////////////////////////////////
+
+  std::vector<mitk::Image::Pointer> completeImages;
+  for ( unsigned int o = 0; o < gdcmReader->GetNumberOfOutputs(); ++o )
+  {
+    completeImages.push_back( gdcmReader->GetOutput(o).GetMitkImage() );
+  }
+
+  MITK_TEST_CONDITION( !gdcmReader->GetProgressiveLoading(), "Progressive loading is off by default" );
+  gdcmReader->SetProgressiveLoading( true );
+  MITK_TEST_CONDITION( gdcmReader->GetProgressiveLoading(), "Progressive loading can be switched on" );
+
+  gdcmReader->LoadImages();
+  MITK_TEST_CONDITION_REQUIRED( gdcmReader->GetNumberOfOutputs() == completeImages.size(),
+                                "Progressive loading yields the same number of outputs" );
+
+  for ( unsigned int o = 0; o < gdcmReader->GetNumberOfOutputs(); ++o )
+  {
+    const mitk::Image::Pointer progressiveImage = gdcmReader->GetOutput(o).GetMitkImage();
+    MITK_TEST_CONDITION_REQUIRED( progressiveImage.IsNotNull() && progressiveImage->IsVolumeSetOrPending(),
+                                  "Progressively loaded image can be read before loading is finished" );
+  }
+
+  MITK_TEST_CONDITION( gdcmReader->WaitForProgressiveLoading(), "Progressive loading succeeds" );
+
+  for ( unsigned int o = 0; o < gdcmReader->GetNumberOfOutputs(); ++o )
+  {
+    const mitk::Image::Pointer progressiveImage = gdcmReader->GetOutput(o).GetMitkImage();
+    MITK_TEST_CONDITION( progressiveImage->GetNumberOfPendingSlices() == 0 && progressiveImage->IsVolumeSet(),
+                         "No slices are pending after WaitForProgressiveLoading()" );
+    MITK_TEST_CONDITION( mitk::Equal( *progressiveImage, *completeImages[o], mitk::eps, true ),
+                         "Progressively loaded image equals the completely loaded image" );
+  }
+
+  MITK_TEST_CONDITION( gdcmReader->WaitForProgressiveLoading(), "Waiting again without pending loads succeeds" );
+
+
   MITK_TEST_END();
 }
@@ -17,19 +17,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include<mitkConnectomicsShortestPathHistogram.h>
 
-#ifdef _MSC_VER
-# pragma warning(push)
-# pragma warning(disable: 4172)
-#endif
-
-#include <boost/graph/dijkstra_shortest_paths.hpp>
-
-#ifdef _MSC_VER
-# pragma warning(pop)
-#endif
-
 #include "mitkConnectomicsConstantsManager.h"
 
+#include <limits>
+
 mitk::ConnectomicsShortestPathHistogram::ConnectomicsShortestPathHistogram()
 : m_Mode( UnweightedUndirectedMode )
 , m_EverythingConnected( true )
@@ -60,7 +51,7 @@ void mitk::ConnectomicsShortestPathHistogram::ComputeFromConnectomicsNetwork( Co
   {
   case UnweightedUndirectedMode:
     {
-      CalculateUnweightedUndirectedShortestPaths( boostGraph );
+      CalculateUnweightedUndirectedShortestPaths( source->GetCompressedGraph() );
       break;
     }
   case WeightedUndirectedMode:
@@ -73,23 +64,41 @@ void mitk::ConnectomicsShortestPathHistogram::ComputeFromConnectomicsNetwork( Co
     ConvertDistanceMapToHistogram();
 }
 
-void mitk::ConnectomicsShortestPathHistogram::CalculateUnweightedUndirectedShortestPaths( NetworkType* boostGraph )
+void mitk::ConnectomicsShortestPathHistogram::CalculateUnweightedUndirectedShortestPaths( const mitk::ConnectomicsNetwork::CompressedGraph& graph )
 {
-  std::vector< DescriptorType > predecessorMap( boost::num_vertices( *boostGraph ) );
-  int numberOfNodes( boost::num_vertices( *boostGraph ) );
+  const int numberOfNodes = graph.offsets.size() - 1;
 
   m_DistanceMatrix.resize( numberOfNodes );
-  for(unsigned int index(0); index < m_DistanceMatrix.size(); index++ )
-  {
-    m_DistanceMatrix[ index ].resize( numberOfNodes );
-  }
-
-  IteratorType iterator, end;
-  boost::tie(iterator, end) = boost::vertices( *boostGraph );
 
-  for ( int index(0) ; iterator != end; ++iterator, index++)
+#pragma omp parallel
   {
-          boost::dijkstra_shortest_paths(*boostGraph, *iterator, boost::predecessor_map(&predecessorMap[ 0 ]).distance_map(&m_DistanceMatrix[ index ][ 0 ]).weight_map( boost::get( &mitk::ConnectomicsNetwork::NetworkEdge::edge_weight ,*boostGraph ) ) ) ;
+    std::vector< int > queue;
+    queue.reserve( numberOfNodes );
+
+#pragma omp for schedule(dynamic, 16)
+    for( int index = 0; index < numberOfNodes; index++ )
+    {
+      // unreachable nodes keep the maximum distance, as with the boost shortest paths
+      std::vector< int >& distances = m_DistanceMatrix[ index ];
+      distances.assign( numberOfNodes, std::numeric_limits< int >::max() );
+      distances[ index ] = 0;
+
+      queue.clear();
+      queue.push_back( index );
+      for( std::size_t head( 0 ); head < queue.size(); ++head )
+      {
+        const int v = queue[ head ];
+        for( int i = graph.offsets[ v ]; i < graph.offsets[ v + 1 ]; ++i )
+        {
+          const int w = graph.neighbors[ i ];
+          if( distances[ w ] == std::numeric_limits< int >::max() )
+          {
+            distances[ w ] = distances[ v ] + 1;
+            queue.push_back( w );
+          }
+        }
+      }
+    }
   }
 }
 
@@ -62,8 +62,8 @@ namespace mitk {
     /** @brief Creates a new histogram from the network source. */
     void ComputeFromConnectomicsNetwork( ConnectomicsNetwork* source ) override;
 
-    /** Calculate shortest paths ignoring the weight of the edges */
-    void CalculateUnweightedUndirectedShortestPaths( NetworkType* boostGraph );
+    /** Calculate shortest paths ignoring the weight of the edges, using one breadth first search per vertex in parallel */
+    void CalculateUnweightedUndirectedShortestPaths( const mitk::ConnectomicsNetwork::CompressedGraph& graph );
 
     /** Calculate shortest paths taking into consideration the weight of the edges */
     void CalculateWeightedUndirectedShortestPaths( NetworkType* boostGraph );
@@ -18,8 +18,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkConnectomicsNetwork.h"
 #include <mitkConnectomicsStatisticsCalculator.h>
 
-#include <boost/graph/clustering_coefficient.hpp>
-
 #ifdef _MSC_VER
 # pragma warning(push)
 # pragma warning(disable: 4172)
@@ -31,6 +29,123 @@ See LICENSE.txt or http://www.mitk.org for details.
 # pragma warning(pop)
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace
+{
+  /** Unweighted single source shortest paths followed by the dependency accumulation of Brandes' algorithm.
+  *
+  * On return order holds the vertices reachable from the source in order of their distance and delta holds their
+  * dependencies. The distance of all vertices is expected to be -1 on entry and is reset before returning.
+  */
+  void AccumulateDependencies( const mitk::ConnectomicsNetwork::CompressedGraph& graph, int source,
+    std::vector< int >& order, std::vector< int >& distance, std::vector< double >& sigma, std::vector< double >& delta )
+  {
+    order.clear();
+    order.push_back( source );
+    distance[ source ] = 0;
+    sigma[ source ] = 1.0;
+    delta[ source ] = 0.0;
+
+    // the order vector doubles as breadth first search queue
+    for( std::size_t head( 0 ); head < order.size(); ++head )
+    {
+      const int v = order[ head ];
+      for( int i = graph.offsets[ v ]; i < graph.offsets[ v + 1 ]; ++i )
+      {
+        const int w = graph.neighbors[ i ];
+        if( distance[ w ] < 0 )
+        {
+          distance[ w ] = distance[ v ] + 1;
+          sigma[ w ] = 0.0;
+          delta[ w ] = 0.0;
+          order.push_back( w );
+        }
+        if( distance[ w ] == distance[ v ] + 1 )
+        {
+          sigma[ w ] += sigma[ v ];
+        }
+      }
+    }
+
+    // predecessors are not stored, they are the neighbors one step closer to the source
+    for( std::size_t index( order.size() ); index > 1; --index )
+    {
+      const int w = order[ index - 1 ];
+      const double factor = ( 1.0 + delta[ w ] ) / sigma[ w ];
+      for( int i = graph.offsets[ w ]; i < graph.offsets[ w + 1 ]; ++i )
+      {
+        const int v = graph.neighbors[ i ];
+        if( distance[ v ] == distance[ w ] - 1 )
+        {
+          delta[ v ] += sigma[ v ] * factor;
+        }
+      }
+    }
+
+    for( std::size_t index( 0 ); index < order.size(); ++index )
+    {
+      distance[ order[ index ] ] = -1;
+    }
+  }
+
+  /** Sums the dependencies and squared dependencies of the given source vertices in parallel */
+  void AccumulateBetweenness( const mitk::ConnectomicsNetwork::CompressedGraph& graph, const std::vector< int >& sources,
+    std::vector< double >& sum, std::vector< double >* squaredSum )
+  {
+    const int numberOfVertices = graph.offsets.size() - 1;
+    const int numberOfSources = sources.size();
+
+    sum.assign( numberOfVertices, 0.0 );
+    if( squaredSum )
+    {
+      squaredSum->assign( numberOfVertices, 0.0 );
+    }
+
+#pragma omp parallel
+    {
+      std::vector< int > order;
+      std::vector< int > distance( numberOfVertices, -1 );
+      std::vector< double > sigma( numberOfVertices, 0.0 );
+      std::vector< double > delta( numberOfVertices, 0.0 );
+      std::vector< double > localSum( numberOfVertices, 0.0 );
+      std::vector< double > localSquaredSum( squaredSum ? numberOfVertices : 0, 0.0 );
+
+#pragma omp for schedule(dynamic, 8)
+      for( int index = 0; index < numberOfSources; ++index )
+      {
+        AccumulateDependencies( graph, sources[ index ], order, distance, sigma, delta );
+
+        // the source is the first vertex and has no dependency on itself
+        for( std::size_t i( 1 ); i < order.size(); ++i )
+        {
+          const int w = order[ i ];
+          localSum[ w ] += delta[ w ];
+          if( squaredSum )
+          {
+            localSquaredSum[ w ] += delta[ w ] * delta[ w ];
+          }
+        }
+      }
+
+#pragma omp critical
+      {
+        for( int v = 0; v < numberOfVertices; ++v )
+        {
+          sum[ v ] += localSum[ v ];
+          if( squaredSum )
+          {
+            ( *squaredSum )[ v ] += localSquaredSum[ v ];
+          }
+        }
+      }
+    }
+  }
+}
+
 /* Constructor and Destructor */
 mitk::ConnectomicsNetwork::ConnectomicsNetwork()
 : m_IsModified( false )
@@ -352,28 +467,77 @@ int mitk::ConnectomicsNetwork::GetMaximumDegree() const
 
 std::vector< double > mitk::ConnectomicsNetwork::GetLocalClusteringCoefficients( ) const
 {
-  std::vector< double > vectorOfClusteringCoefficients;
-
-  typedef boost::graph_traits<NetworkType>::vertex_iterator vertexIter;
+  const CompressedGraph graph = this->GetCompressedGraph();
+  const int numberOfVertices = graph.offsets.size() - 1;
 
+  std::vector< double > vectorOfClusteringCoefficients;
   vectorOfClusteringCoefficients.resize( this->GetNumberOfVertices() );
 
-  std::pair<vertexIter, vertexIter> vertexPair;
-
   //for every vertex calculate the clustering coefficient
   int size = vectorOfClusteringCoefficients.size();
-  for (vertexPair = vertices(m_Network); vertexPair.first != vertexPair.second; ++vertexPair.first)
+#pragma omp parallel
   {
-    int index = m_Network[ *vertexPair.first ].id;
+    // number of times each vertex appears in the neighborhood of the current vertex
+    std::vector< int > multiplicity( numberOfVertices, 0 );
 
-    if( index > size )
+#pragma omp for schedule(dynamic, 64)
+    for( int v = 0; v < numberOfVertices; ++v )
     {
-      MITK_ERROR << "Trying to access out of bounds clustering coefficient";
-      continue;
-    }
+      int index = m_Network[ v ].id;
 
-    vectorOfClusteringCoefficients[ index ] =
-      boost::clustering_coefficient(m_Network,*vertexPair.first) ;
+      if( index < 0 || index >= size )
+      {
+        MITK_ERROR << "Trying to access out of bounds clustering coefficient";
+        continue;
+      }
+
+      const int begin = graph.offsets[ v ];
+      const int end = graph.offsets[ v + 1 ];
+      for( int i = begin; i < end; ++i )
+      {
+        ++multiplicity[ graph.neighbors[ i ] ];
+      }
+
+      // count the connected pairs of neighbors like boost::clustering_coefficient, each unordered pair of
+      // distinct neighbors x < y once and pairs of the same neighbor only if it has a self loop
+      double triangles( 0.0 );
+      for( int i = begin; i < end; ++i )
+      {
+        const int x = graph.neighbors[ i ];
+        if( i > begin && graph.neighbors[ i - 1 ] == x )
+        {
+          continue;
+        }
+
+        const double multiplicityX = multiplicity[ x ];
+        for( int j = graph.offsets[ x ]; j < graph.offsets[ x + 1 ]; ++j )
+        {
+          const int y = graph.neighbors[ j ];
+          if( j > graph.offsets[ x ] && graph.neighbors[ j - 1 ] == y )
+          {
+            continue;
+          }
+
+          if( y > x )
+          {
+            triangles += multiplicityX * multiplicity[ y ];
+          }
+          else if( y == x )
+          {
+            triangles += multiplicityX * ( multiplicityX - 1.0 ) / 2.0;
+          }
+        }
+      }
+
+      for( int i = begin; i < end; ++i )
+      {
+        multiplicity[ graph.neighbors[ i ] ] = 0;
+      }
+
+      const double degree = end - begin;
+      const double routes = degree * ( degree - 1.0 ) / 2.0;
+      vectorOfClusteringCoefficients[ index ] = routes > 0 ? triangles / routes : 0.0;
+    }
   }
 
   return vectorOfClusteringCoefficients;
@@ -442,6 +606,34 @@ double mitk::ConnectomicsNetwork::GetGlobalClusteringCoefficient( )
   return globalClusteringCoefficient;
 }
 
+mitk::ConnectomicsNetwork::CompressedGraph mitk::ConnectomicsNetwork::GetCompressedGraph() const
+{
+  CompressedGraph graph;
+  const int numberOfVertices = boost::num_vertices( m_Network );
+
+  graph.offsets.resize( numberOfVertices + 1, 0 );
+  for( int v = 0; v < numberOfVertices; ++v )
+  {
+    graph.offsets[ v + 1 ] = graph.offsets[ v ] + boost::out_degree( v, m_Network );
+  }
+
+  graph.neighbors.resize( graph.offsets[ numberOfVertices ] );
+  for( int v = 0; v < numberOfVertices; ++v )
+  {
+    boost::graph_traits<NetworkType>::adjacency_iterator adjIter, adjEnd;
+    boost::tie( adjIter, adjEnd ) = boost::adjacent_vertices( v, m_Network );
+
+    int position = graph.offsets[ v ];
+    for( ; adjIter != adjEnd; ++adjIter, ++position )
+    {
+      graph.neighbors[ position ] = *adjIter;
+    }
+    std::sort( graph.neighbors.begin() + graph.offsets[ v ], graph.neighbors.begin() + graph.offsets[ v + 1 ] );
+  }
+
+  return graph;
+}
+
 mitk::ConnectomicsNetwork::NetworkType* mitk::ConnectomicsNetwork::GetBoostGraph()
 {
   return &m_Network;
@@ -628,17 +820,79 @@ void mitk::ConnectomicsNetwork::UpdateIDs()
 
 std::vector< double > mitk::ConnectomicsNetwork::GetNodeBetweennessVector() const
 {
-  std::vector< double > betweennessVector;
+  const CompressedGraph graph = this->GetCompressedGraph();
+  const int numberOfVertices = graph.offsets.size() - 1;
+
+  std::vector< int > sources( numberOfVertices );
+  for( int v = 0; v < numberOfVertices; ++v )
+  {
+    sources[ v ] = v;
+  }
+
+  std::vector< double > dependencies;
+  AccumulateBetweenness( graph, sources, dependencies, nullptr );
+
+  // every shortest path of the undirected graph has been counted from both ends
+  std::vector< double > betweennessVector( this->GetNumberOfVertices(), 0.0 );
+  for( int v = 0; v < numberOfVertices; ++v )
+  {
+    betweennessVector[ m_Network[ v ].id ] = dependencies[ v ] / 2.0;
+  }
+
+  return betweennessVector;
+}
+
+std::vector< double > mitk::ConnectomicsNetwork::GetApproximatedNodeBetweennessVector( unsigned int numberOfSamples, unsigned int seed, std::vector< double >* standardErrors ) const
+{
+  const CompressedGraph graph = this->GetCompressedGraph();
+  const int numberOfVertices = graph.offsets.size() - 1;
+
+  std::vector< double > betweennessVector( this->GetNumberOfVertices(), 0.0 );
+  if( standardErrors )
+  {
+    standardErrors->assign( this->GetNumberOfVertices(), 0.0 );
+  }
+  if( numberOfVertices == 0 || numberOfSamples == 0 )
+  {
+    return betweennessVector;
+  }
 
-  betweennessVector.clear();
-  betweennessVector.resize( this->GetNumberOfVertices() );
+  // sample the source vertices without replacement
+  std::vector< int > sources( numberOfVertices );
+  for( int v = 0; v < numberOfVertices; ++v )
+  {
+    sources[ v ] = v;
+  }
+  const int k = std::min< unsigned int >( numberOfSamples, numberOfVertices );
+  std::mt19937 randomGenerator( seed );
+  std::shuffle( sources.begin(), sources.end(), randomGenerator );
+  sources.resize( k );
+
+  std::vector< double > dependencies;
+  std::vector< double > squaredDependencies;
+  AccumulateBetweenness( graph, sources, dependencies, &squaredDependencies );
+
+  // each sampled source s yields the unbiased estimate n * delta_s(v) / 2 of the betweenness of v,
+  // the standard error of their mean includes the finite population correction for sampling without replacement
+  const double n = numberOfVertices;
+  const double scale = n / 2.0;
+  for( int v = 0; v < numberOfVertices; ++v )
+  {
+    const int index = m_Network[ v ].id;
+    const double mean = dependencies[ v ] / k;
+    betweennessVector[ index ] = scale * mean;
 
-  boost::brandes_betweenness_centrality(
-    m_Network,
-    boost::centrality_map(
-    boost::make_iterator_property_map( betweennessVector.begin(), boost::get( &NetworkNode::id, m_Network ), double() )
-    ).vertex_index_map( boost::get( &NetworkNode::id, m_Network ) )
-    );
+    if( standardErrors && k < numberOfVertices )
+    {
+      if( k < 2 )
+      {
+        ( *standardErrors )[ index ] = std::numeric_limits< double >::infinity();
+        continue;
+      }
+      const double variance = std::max( 0.0, ( squaredDependencies[ v ] - k * mean * mean ) / ( k - 1 ) );
+      ( *standardErrors )[ index ] = scale * std::sqrt( variance / k * ( n - k ) / ( n - 1.0 ) );
+    }
+  }
 
   return betweennessVector;
 }
@@ -78,6 +78,17 @@ namespace mitk {
     typedef boost::graph_traits<NetworkType>::vertex_descriptor VertexDescriptorType;
     typedef boost::graph_traits<NetworkType>::edge_descriptor EdgeDescriptorType;
 
+    /** Compressed sparse row snapshot of the adjacency structure
+    *
+    * The vertices adjacent to vertex v are stored in ascending order in neighbors[ offsets[ v ] ] to
+    * neighbors[ offsets[ v + 1 ] - 1 ]. Parallel edges and self loops appear as often as in the boost graph.
+    */
+    struct CompressedGraph
+    {
+      std::vector< int > offsets;
+      std::vector< int > neighbors;
+    };
+
     // virtual methods that need to be implemented
     void UpdateOutputInformation() override;
     void SetRequestedRegionToLargestPossibleRegion() override;
@@ -170,6 +181,14 @@ namespace mitk {
     /** Get the betweenness centrality for each vertex in form of a vector of length (number vertices)*/
     std::vector< double > GetNodeBetweennessVector() const;
 
+    /** Get an estimate of the betweenness centrality for each vertex using a random sample of source vertices
+    *
+    * The dependencies of numberOfSamples distinct source vertices are extrapolated to the whole network.
+    * If standardErrors is given, it is filled with the standard error of the estimate of each vertex,
+    * which is zero if every vertex is used as source.
+    */
+    std::vector< double > GetApproximatedNodeBetweennessVector( unsigned int numberOfSamples, unsigned int seed = 0, std::vector< double >* standardErrors = nullptr ) const;
+
     /** Get the betweenness centrality for each edge in form of a vector of length (number edges)*/
     std::vector< double > GetEdgeBetweennessVector() const;
 
@@ -179,6 +198,9 @@ namespace mitk {
     /** Get the shortest distance from a specified vertex to all other vertices in form of a vector of length (number vertices)*/
     std::vector< double > GetShortestDistanceVectorFromLabel( std::string targetLabel ) const;
 
+    /** Create a compressed sparse row snapshot of the current network, indexed by vertex descriptor */
+    CompressedGraph GetCompressedGraph() const;
+
     /** Access boost graph directly */
     NetworkType* GetBoostGraph();
 
@@ -385,6 +385,17 @@ int mitkConnectomicsNetworkTest(int, char* [])
     MITK_TEST_CONDITION_REQUIRED( network->GetMaximumWeight() == 2, "Expected maximum weight")
 
     MITK_TEST_CONDITION_REQUIRED( network->GetVectorOfAllVertexDescriptors().size() == vertexVector.size(), "Expected number of vertex descriptors")
+
+    // using every vertex as source the sampled betweenness is exact
+    std::vector< double > betweenness = network->GetNodeBetweennessVector();
+    std::vector< double > standardErrors;
+    std::vector< double > approximatedBetweenness = network->GetApproximatedNodeBetweennessVector( network->GetNumberOfVertices(), 0, &standardErrors );
+    bool approximationExact( betweenness.size() == approximatedBetweenness.size() );
+    for( unsigned int loop(0); approximationExact && loop < betweenness.size(); loop++ )
+    {
+      approximationExact = std::abs( betweenness[loop] - approximatedBetweenness[loop] ) < eps && standardErrors[loop] == 0;
+    }
+    MITK_TEST_CONDITION_REQUIRED( approximationExact, "Expected exact betweenness when sampling all vertices")
   }
   catch (...)
   {
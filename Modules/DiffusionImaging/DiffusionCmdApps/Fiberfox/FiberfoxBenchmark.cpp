@@ -0,0 +1,124 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkIOUtil.h>
+#include <mitkFiberBundle.h>
+#include <mitkFiberfoxParameters.h>
+#include "mitkCommandLineParser.h"
+
+#include <itkTractsToDWIImageFilter.h>
+#include <itkTimeProbe.h>
+#include <omp.h>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace mitk;
+
+typedef itk::TractsToDWIImageFilter< short > FilterType;
+
+/*!
+* \brief Measure the k-space simulation throughput of Fiberfox.
+* Runs the simulation with whole gradient volumes per thread and with one task per gradient volume, slice and coil
+* and reports the run times, the number of simulated slices per second and the difference between both outputs.
+*/
+int main(int argc, char* argv[])
+{
+  mitkCommandLineParser parser;
+  parser.setTitle("Fiberfox Benchmark");
+  parser.setCategory("Diffusion Simulation Tools");
+  parser.setContributor("MIC");
+  parser.setDescription("Measure the throughput of the Fiberfox k-space simulation with the different thread scheduling schemes.");
+  parser.setArgumentPrefix("--", "-");
+  parser.addArgument("", "i", mitkCommandLineParser::String, "Input:", "input tractogram", us::Any(), false, false, false, mitkCommandLineParser::Input);
+  parser.addArgument("parameters", "p", mitkCommandLineParser::String, "Parameter file:", "fiberfox parameter file (.ffp)", us::Any(), false, false, false, mitkCommandLineParser::Input);
+  parser.addArgument("repetitions", "", mitkCommandLineParser::Int, "Repetitions:", "number of simulations per scheduling scheme", 3);
+  parser.addArgument("threads", "", mitkCommandLineParser::Int, "Threads:", "number of threads (0 uses all available threads)", 0);
+
+  std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+  if (parsedArgs.size()==0)
+  {
+    return EXIT_FAILURE;
+  }
+  std::string input = us::any_cast<std::string>(parsedArgs["i"]);
+  std::string paramName = us::any_cast<std::string>(parsedArgs["parameters"]);
+
+  int repetitions = 3;
+  if (parsedArgs.count("repetitions"))
+    repetitions = us::any_cast<int>(parsedArgs["repetitions"]);
+  if (repetitions<1)
+    repetitions = 1;
+
+  int threads = 0;
+  if (parsedArgs.count("threads"))
+    threads = us::any_cast<int>(parsedArgs["threads"]);
+  if (threads>0)
+    omp_set_num_threads(threads);
+
+  FiberfoxParameters parameters;
+  parameters.LoadParameters(paramName, true);
+  parameters.m_Misc.m_OutputAdditionalImages = false;
+  if (!parameters.m_SignalGen.m_SimulateKspaceAcquisition)
+  {
+    MITK_INFO << "Enabling k-space simulation";
+    parameters.m_SignalGen.m_SimulateKspaceAcquisition = true;
+  }
+
+  mitk::FiberBundle::Pointer fib = mitk::IOUtil::Load<mitk::FiberBundle>(input);
+
+  std::vector< FilterType::OutputImageType::Pointer > outputs;
+  std::vector< double > times;
+  for (int scheme=0; scheme<2; ++scheme)
+  {
+    itk::TimeProbe probe;
+    FilterType::OutputImageType::Pointer output;
+    for (int r=0; r<repetitions; ++r)
+    {
+      FilterType::Pointer tractsToDwiFilter = FilterType::New();
+      tractsToDwiFilter->SetParameters(parameters);
+      tractsToDwiFilter->SetFiberBundle(fib);
+      tractsToDwiFilter->SetUseConstantRandSeed(true);
+      tractsToDwiFilter->SetUseSliceTasks(scheme==1);
+
+      probe.Start();
+      tractsToDwiFilter->Update();
+      probe.Stop();
+
+      output = tractsToDwiFilter->GetOutput();
+    }
+    outputs.push_back(output);
+    times.push_back(probe.GetMean());
+  }
+
+  auto size = outputs.at(0)->GetLargestPossibleRegion().GetSize();
+  double slices = static_cast<double>(outputs.at(0)->GetVectorLength())*size[2]*parameters.m_SignalGen.m_NumberOfCoils;
+
+  std::cout << "Threads: " << omp_get_max_threads() << std::endl;
+  std::cout << "Slices per simulation (volumes x slices x coils): " << slices << std::endl;
+  std::cout << "Parallel volumes: " << times.at(0) << " s per simulation, " << slices/times.at(0) << " slices/s" << std::endl;
+  std::cout << "Slice tasks: " << times.at(1) << " s per simulation, " << slices/times.at(1) << " slices/s" << std::endl;
+  std::cout << "Speedup: " << times.at(0)/times.at(1) << std::endl;
+
+  // both schemes use the same random streams and should produce the same image
+  unsigned long num_values = outputs.at(0)->GetLargestPossibleRegion().GetNumberOfPixels()*outputs.at(0)->GetVectorLength();
+  const short* values1 = outputs.at(0)->GetBufferPointer();
+  const short* values2 = outputs.at(1)->GetBufferPointer();
+  int max_diff = 0;
+  for (unsigned long i=0; i<num_values; ++i)
+    max_diff = std::max(max_diff, std::abs(values1[i]-values2[i]));
+  std::cout << "Maximum absolute difference between the outputs: " << max_diff << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -30,6 +30,8 @@ class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
   MITK_TEST(Denoise_NLMr_shouldReturnTrue);
   MITK_TEST(Denoise_NLMv_shouldReturnTrue);
   MITK_TEST(Denoise_NLMvr_shouldReturnTrue);
+  MITK_TEST(Denoise_Blockwise_ZeroSearchRadius_shouldReturnInput);
+  MITK_TEST(Denoise_Blockwise_MultiThreaded_shouldEqualSingleThreaded);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -164,6 +166,73 @@ public:
     MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "NLMvr should always return the same result.");
   }
 
+  void Denoise_Blockwise_ZeroSearchRadius_shouldReturnInput()
+  {
+    // without neighbouring patches every block is restored to its own values
+    m_DenoisingFilter->SetSearchRadius(0);
+    m_DenoisingFilter->SetUseBlockwise(true);
+    m_DenoisingFilter->SetUseRicianAdaption(false);
+    m_DenoisingFilter->SetUseJointInformation(false);
+    try
+    {
+      m_DenoisingFilter->Update();
+    }
+    catch(std::exception& e)
+    {
+      MITK_ERROR << e.what();
+    }
+
+    mitk::GrabItkImageMemory(m_DenoisingFilter->GetOutput(),m_DenoisedImage);
+    m_DenoisedImage->SetPropertyList(m_Image->GetPropertyList()->Clone());
+
+    MITK_ASSERT_EQUAL( m_DenoisedImage, m_Image, "Blockwise NLM with search radius 0 should return the input image.");
+  }
+
+  void Denoise_Blockwise_MultiThreaded_shouldEqualSingleThreaded()
+  {
+    // blocks overlap the region borders of the threads, every voxel has to be restored from the same blocks anyway
+    m_DenoisingFilter->SetSearchRadius(2);
+    m_DenoisingFilter->SetUseBlockwise(true);
+    m_DenoisingFilter->SetUseRicianAdaption(true);
+    m_DenoisingFilter->SetUseJointInformation(true);
+    try
+    {
+      m_DenoisingFilter->Update();
+    }
+    catch(std::exception& e)
+    {
+      MITK_ERROR << e.what();
+    }
+    mitk::Image::Pointer singleThreadedImage = mitk::Image::New();
+    mitk::GrabItkImageMemory(m_DenoisingFilter->GetOutput(),singleThreadedImage);
+    singleThreadedImage->SetPropertyList(m_Image->GetPropertyList()->Clone());
+
+    VectorImagetType::Pointer vectorImage;
+    mitk::CastToItkImage(m_Image,vectorImage);
+    itk::NonLocalMeansDenoisingFilter<short>::Pointer multiThreadedFilter = itk::NonLocalMeansDenoisingFilter<short>::New();
+    multiThreadedFilter->SetInputImage(vectorImage);
+    multiThreadedFilter->SetNumberOfThreads(7);
+    multiThreadedFilter->SetComparisonRadius(1);
+    multiThreadedFilter->SetSearchRadius(2);
+    multiThreadedFilter->SetVariance(500);
+    multiThreadedFilter->SetUseBlockwise(true);
+    multiThreadedFilter->SetUseRicianAdaption(true);
+    multiThreadedFilter->SetUseJointInformation(true);
+    try
+    {
+      multiThreadedFilter->Update();
+    }
+    catch(std::exception& e)
+    {
+      MITK_ERROR << e.what();
+    }
+    mitk::GrabItkImageMemory(multiThreadedFilter->GetOutput(),m_DenoisedImage);
+    m_DenoisedImage->SetPropertyList(m_Image->GetPropertyList()->Clone());
+
+    MITK_ASSERT_EQUAL( m_DenoisedImage, singleThreadedImage, "Multi-threaded blockwise NLM should return the single-threaded result.");
+    MITK_ASSERT_NOT_EQUAL( m_DenoisedImage, m_Image, "Blockwise NLM with search radius 2 should change the input image.");
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkNonLocalMeansDenoising)
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkImageToImageFilter.h"
 #include "itkVectorImage.h"
+#include <vector>
 
 
 namespace itk{
@@ -83,6 +84,15 @@ namespace itk{
      * If this flag is true the filter uses a method which is optimized for Rician distributed noise.
      */
     itkSetMacro(UseRicianAdaption, bool)
+    /**
+     * @brief Set flag to use blockwise denoising
+     *
+     * If this flag is true the filter compares blocks of size (2 * comparisonradius + 1)³ centered on a grid with
+     * spacing 2 * comparisonradius instead of the patches of all voxels. The weighted blocks are aggregated and every voxel is
+     * the weighted mean of all block estimates covering it. This reduces the number of computed weights by the grid spacing³.
+     * Default is false.
+     */
+    itkSetMacro(UseBlockwise, bool)
     /**
      * @brief Get the amount of calculated Voxels
      *
@@ -124,6 +134,42 @@ namespace itk{
      */
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType) override;
 
+    /**
+     * @brief Voxelwise denoising of the region, slice by slice
+     *
+     * For each search offset the patch distances of all voxels of a slice are computed at once (see ComputePatchDistances)
+     * and the weighted neighbours are accumulated for all channels.
+     */
+    void DenoiseVoxelwise(const OutputImageRegionType& region, const std::vector< unsigned char >& mask);
+
+    /**
+     * @brief Blockwise denoising of the region
+     *
+     * Processes the slices of the block center grid in ascending order. The weighted sums of the block voxels are
+     * accumulated in a ring of 2 * comparisonradius + 1 slices which are written as soon as no further block covers them.
+     */
+    void DenoiseBlockwise(const OutputImageRegionType& region, const std::vector< unsigned char >& mask);
+
+    /**
+     * @brief Sums of squared differences between the patches of slice z and the patches shifted by the search offset
+     *
+     * The distances of all channels are computed for the voxels [begin[0],end[0]] x [begin[1],end[1]] of the slice and stored
+     * in distances (x fastest, channels innermost). The squared differences of each voxel pair are summed along z and then
+     * box filtered in x and y with prefix sums instead of comparing every patch separately. Like in the patch comparison only
+     * pairs of voxels that are both inside the image contribute. All buffers are reused between calls.
+     */
+    void ComputePatchDistances(int z, const int offset[3], const int begin[2], const int end[2],
+                               std::vector< double >& squaredDifferences, std::vector< double >& rowSums, std::vector< double >& distances);
+
+    /** @brief Number of voxel pairs along one axis with both voxels of the comparison neighborhood inside the image. */
+    int GetNumberOfValidPairs(int pos, int offset, int size);
+
+    /** @brief Positions of the block centers along one axis whose blocks intersect [begin,end]. */
+    std::vector< int > GetBlockCenters(int size, int begin, int end);
+
+    /** @brief Writes the denoised values of one output voxel. Voxels without accumulated weights are set to 0. */
+    void WriteVoxel(TPixelType* out, const double* numerator, const double* denominator, int numChannels, bool sharedDenominator);
+
 
 
   private:
@@ -132,6 +178,7 @@ namespace itk{
     int m_ComparisonRadius;                           ///< Radius of the comparisonblock.
     bool m_UseJointInformation;                       ///< Flag to use joint information.
     bool m_UseRicianAdaption;                         ///< Flag to use rician adaption.
+    bool m_UseBlockwise;                              ///< Flag to use blockwise denoising.
     unsigned int m_CurrentVoxelCount;                 ///< Amount of processed voxels.
     double m_Variance;                                ///< Estimated noise variance.
     typename MaskImageType::Pointer m_Mask;           ///< Pointer to the mask image.
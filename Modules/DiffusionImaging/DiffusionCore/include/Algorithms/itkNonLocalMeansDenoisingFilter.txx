@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkNeighborhoodIterator.h"
 #include <itkImageRegionIteratorWithIndex.h>
 #include <vector>
+#include <algorithm>
 
 namespace itk {
 
@@ -39,6 +40,7 @@ NonLocalMeansDenoisingFilter< TPixelType >
     m_ComparisonRadius(1),
     m_UseJointInformation(false),
     m_UseRicianAdaption(false),
+    m_UseBlockwise(false),
     m_Variance(1),
     m_Mask(nullptr)
 {
@@ -56,6 +58,7 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "Noisevariance: " << m_Variance;
   MITK_INFO << "Use Rician Adaption: " << std::boolalpha << m_UseRicianAdaption;
   MITK_INFO << "Use Joint Information: " << std::boolalpha << m_UseJointInformation;
+  MITK_INFO << "Use Blockwise Denoising: " << std::boolalpha << m_UseBlockwise;
 
 
   typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
@@ -127,249 +130,463 @@ void
 NonLocalMeansDenoisingFilter< TPixelType >
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType )
 {
+  // mask of the thread region (x fastest)
+  std::vector< unsigned char > mask;
+  mask.reserve(outputRegionForThread.GetNumberOfPixels());
+  ImageRegionConstIterator< MaskImageType > mit(m_Mask, outputRegionForThread);
+  for (mit.GoToBegin(); !mit.IsAtEnd(); ++mit)
+    mask.push_back(mit.Get() != 0);
+
+  if (m_UseBlockwise)
+    DenoiseBlockwise(outputRegionForThread, mask);
+  else
+    DenoiseVoxelwise(outputRegionForThread, mask);
 
+  MITK_INFO << "One Thread finished calculation";
+}
 
-  // initialize iterators
-  typename OutputImageType::Pointer outputImage =
-          static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
-
-  ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
-  oit.GoToBegin();
-
-  ImageRegionIterator< MaskImageType > mit(m_Mask, outputRegionForThread);
-  mit.GoToBegin();
-
-
-
-  typedef ImageRegionIteratorWithIndex <InputImageType> InputIteratorType;
-  typename InputImageType::Pointer inputImagePointer = nullptr;
-  inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
-
-  InputIteratorType git(inputImagePointer, outputRegionForThread );
-  git.GoToBegin();
-
-  // iterate over complete image region
-  while( !git.IsAtEnd() )
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::DenoiseVoxelwise(const OutputImageRegionType& region, const std::vector< unsigned char >& mask)
+{
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+  typename OutputImageType::Pointer outputImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  typename InputImageType::IndexType origin = inputImagePointer->GetLargestPossibleRegion().GetIndex();
+  const int nx = inputImagePointer->GetLargestPossibleRegion().GetSize(0);
+  const int ny = inputImagePointer->GetLargestPossibleRegion().GetSize(1);
+  const int nz = inputImagePointer->GetLargestPossibleRegion().GetSize(2);
+  const int numChannels = inputImagePointer->GetVectorLength();
+  const TPixelType* in = inputImagePointer->GetBufferPointer();
+
+  // region in image coordinates
+  const int width = region.GetSize(0);
+  const int height = region.GetSize(1);
+  const int begin[2] = { static_cast<int>(region.GetIndex(0) - origin[0]), static_cast<int>(region.GetIndex(1) - origin[1]) };
+  const int end[2] = { begin[0] + width - 1, begin[1] + height - 1 };
+  const int z0 = region.GetIndex(2) - origin[2];
+  const int z1 = z0 + static_cast<int>(region.GetSize(2)) - 1;
+  const int R = m_SearchRadius;
+
+  std::vector< double > squaredDifferences;
+  std::vector< double > rowSums;
+  std::vector< double > distances;
+  std::vector< double > numerator(width*height*numChannels);
+  std::vector< double > denominator(width*height*numChannels);
+
+  for (int z = z0; z <= z1; ++z)
   {
-    typename OutputImageType::PixelType outpix;
-    outpix.SetSize (inputImagePointer->GetVectorLength());
+    const unsigned char* sliceMask = mask.data() + (z-z0)*width*height;
+    std::fill(numerator.begin(), numerator.end(), 0.0);
+    std::fill(denominator.begin(), denominator.end(), 0.0);
 
-    if (mit.Get() != 0 && !this->GetAbortGenerateData())
+    // search offsets in the same order as the neighbourhood iteration of the patch comparison
+    for (int dx = -R; dx <= R && !this->GetAbortGenerateData(); ++dx)
     {
-      if(!m_UseJointInformation)
+      for (int dy = -R; dy <= R; ++dy)
       {
-        for (int i = 0; i < (int)inputImagePointer->GetVectorLength(); ++i)
+        for (int dz = -R; dz <= R; ++dz)
         {
-          double summw = 0;
-          double sumj = 0;
-          double w = 0;
-          std::vector<double> wj;
-          std::vector<double> p;
-          typename InputIteratorType::IndexType index;
-          index = git.GetIndex();
-
-          for (int x = index.GetElement(0) - m_SearchRadius; x <= index.GetElement(0) + m_SearchRadius; ++x)
+          if (z+dz < 0 || z+dz >= nz)
+            continue;
+
+          const int offset[3] = {dx, dy, dz};
+          ComputePatchDistances(z, offset, begin, end, squaredDifferences, rowSums, distances);
+          const int pairsZ = GetNumberOfValidPairs(z, dz, nz);
+
+          for (int y = begin[1]; y <= end[1]; ++y)
           {
-            for (int y = index.GetElement(1) - m_SearchRadius; y <= index.GetElement(1) + m_SearchRadius; ++y)
+            if (y+dy < 0 || y+dy >= ny)
+              continue;
+            const int pairsY = GetNumberOfValidPairs(y, dy, ny);
+
+            for (int x = begin[0]; x <= end[0]; ++x)
             {
-              for (int z = index.GetElement(2) - m_SearchRadius; z <= index.GetElement(2) + m_SearchRadius; ++z)
+              const int v = (y-begin[1])*width + x-begin[0];
+              if (!sliceMask[v] || x+dx < 0 || x+dx >= nx)
+                continue;
+
+              const double size = pairsZ*pairsY*GetNumberOfValidPairs(x, dx, nx);
+              const double* dist = distances.data() + v*numChannels;
+              const TPixelType* pixelJ = in + (((z+dz)*ny + y+dy)*nx + x+dx)*numChannels;
+              double* num = numerator.data() + v*numChannels;
+              double* den = denominator.data() + v*numChannels;
+
+              if (!m_UseJointInformation)
               {
-                typename InputIteratorType::IndexType indexV;
-                indexV.SetElement(0, x);
-                indexV.SetElement(1, y);
-                indexV.SetElement(2, z);
-                if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexV))
+                // weight all neighborhoods
+                for (int c = 0; c < numChannels; ++c)
                 {
-                  TPixelType pixelJ = inputImagePointer->GetPixel(indexV)[i];
-                  double sumk = 0;
-                  double size = 0;
-                  for (int xi = index.GetElement(0) - m_ComparisonRadius, xj = x - m_ComparisonRadius; xi <= index.GetElement(0) + m_ComparisonRadius; ++xi, ++xj)
-                  {
-                    for (int yi = index.GetElement(1) - m_ComparisonRadius, yj = y - m_ComparisonRadius; yi <= index.GetElement(1) + m_ComparisonRadius; ++yi, ++yj)
-                    {
-                      for (int zi = index.GetElement(2) - m_ComparisonRadius, zj = z - m_ComparisonRadius; zi <= index.GetElement(2) + m_ComparisonRadius; ++zi, ++zj)
-                      {
-                        typename InputIteratorType::IndexType indexI, indexJ;
-                        indexI.SetElement(0, xi);
-                        indexI.SetElement(1, yi);
-                        indexI.SetElement(2, zi);
-                        indexJ.SetElement(0, xj);
-                        indexJ.SetElement(1, yj);
-                        indexJ.SetElement(2, zj);
-
-
-                        // Compare neighborhoods ni & nj
-                        if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexI) && inputImagePointer->GetLargestPossibleRegion().IsInside(indexJ))
-                        {
-                          int diff = inputImagePointer->GetPixel(indexI)[i] - inputImagePointer->GetPixel(indexJ)[i];
-                          sumk += (double)(diff*diff);
-                          ++size;
-                        }
-                      }
-                    }
-                  }
-                  // weight all neighborhoods
-                  w = std::exp( - sumk / size / m_Variance);
-                  wj.push_back(w);
-                  if (m_UseRicianAdaption)
-                  {
-                    p.push_back((double)(pixelJ*pixelJ));
-                  }
-                  else
-                  {
-                    p.push_back((double)(pixelJ));
-                  }
-                  summw += w;
+                  double w = std::exp( - dist[c] / size / m_Variance);
+                  double p = m_UseRicianAdaption ? (double)(pixelJ[c]*pixelJ[c]) : (double)(pixelJ[c]);
+                  num[c] += w*p;
+                  den[c] += w;
+                }
+              }
+              else
+              {
+                double sumk = 0;
+                for (int c = 0; c < numChannels; ++c)
+                  sumk += dist[c];
+                double w = std::exp( - (sumk / (size*(numChannels + 1))) / m_Variance);
+                den[0] += w;
+
+                if (!m_UseRicianAdaption)
+                {
+                  for (int c = 0; c < numChannels; ++c)
+                    num[c] += w*pixelJ[c];
+                }
+                else
+                {
+                  // The patch comparison pairs the n-th weight with the n-th entry of a list holding the squared and the
+                  // plain value of every neighbour in turn. This pairing is kept to produce the same images.
+                  const int lx = std::max(-R, -x);
+                  const int ly = std::max(-R, -y);
+                  const int lz = std::max(-R, -z);
+                  const int numY = std::min(R, ny-1-y) - ly + 1;
+                  const int numZ = std::min(R, nz-1-z) - lz + 1;
+                  const int n = ((dx-lx)*numY + dy-ly)*numZ + dz-lz;
+                  const int m = n/2;
+                  const TPixelType* pixelM = in + (((z+lz+m%numZ)*ny + y+ly+(m/numZ)%numY)*nx + x+lx+m/(numZ*numY))*numChannels;
+                  for (int c = 0; c < numChannels; ++c)
+                    num[c] += w * (n%2==0 ? (double)(pixelM[c]*pixelM[c]) : (double)(pixelM[c]));
                 }
               }
             }
           }
-          for (unsigned int n = 0; n < wj.size(); ++n)
-          {
-            sumj += (wj[n]/summw) * p[n];
-          }
-          if (m_UseRicianAdaption)
-          {
-            sumj -=2 * m_Variance;
-          }
+        }
+      }
+    }
 
-          if (sumj < 0)
-          {
-            sumj = 0;
-          }
+    if (this->GetAbortGenerateData())
+      std::fill(denominator.begin(), denominator.end(), 0.0);
 
-          TPixelType outval;
-          if (m_UseRicianAdaption)
-          {
-            outval = std::floor(std::sqrt(sumj) + 0.5);
-          }
-          else
-          {
-            outval = std::floor(sumj + 0.5);
-          }
-          outpix.SetElement(i, outval);
-        }
+    for (int y = begin[1]; y <= end[1]; ++y)
+    {
+      typename OutputImageType::IndexType index;
+      index[0] = begin[0] + origin[0];
+      index[1] = y + origin[1];
+      index[2] = z + origin[2];
+      TPixelType* out = outputImage->GetBufferPointer() + outputImage->ComputeOffset(index)*numChannels;
+      const int v = (y-begin[1])*width;
+      for (int x = 0; x < width; ++x)
+        WriteVoxel(out + x*numChannels, numerator.data() + (v+x)*numChannels, denominator.data() + (v+x)*numChannels, numChannels, m_UseJointInformation);
+    }
+    m_CurrentVoxelCount += width*height;
+  }
+}
+
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::DenoiseBlockwise(const OutputImageRegionType& region, const std::vector< unsigned char >& mask)
+{
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+  typename OutputImageType::Pointer outputImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  typename InputImageType::IndexType origin = inputImagePointer->GetLargestPossibleRegion().GetIndex();
+  const int nx = inputImagePointer->GetLargestPossibleRegion().GetSize(0);
+  const int ny = inputImagePointer->GetLargestPossibleRegion().GetSize(1);
+  const int nz = inputImagePointer->GetLargestPossibleRegion().GetSize(2);
+  const int numChannels = inputImagePointer->GetVectorLength();
+  const TPixelType* in = inputImagePointer->GetBufferPointer();
+
+  // region in image coordinates
+  const int width = region.GetSize(0);
+  const int height = region.GetSize(1);
+  const int x0 = region.GetIndex(0) - origin[0];
+  const int y0 = region.GetIndex(1) - origin[1];
+  const int z0 = region.GetIndex(2) - origin[2];
+  const int x1 = x0 + width - 1;
+  const int y1 = y0 + height - 1;
+  const int z1 = z0 + static_cast<int>(region.GetSize(2)) - 1;
+  const int R = m_SearchRadius;
+  const int r = m_ComparisonRadius;
+
+  std::vector< int > centersX = GetBlockCenters(nx, x0, x1);
+  std::vector< int > centersY = GetBlockCenters(ny, y0, y1);
+  std::vector< int > centersZ = GetBlockCenters(nz, z0, z1);
+  const int begin[2] = { centersX.front(), centersY.front() };
+  const int end[2] = { centersX.back(), centersY.back() };
+  const int centerWidth = end[0] - begin[0] + 1;
+
+  // the slices covered by the blocks of one center slice
+  const int ringSize = 2*r + 1;
+  const int sliceSize = width*height*numChannels;
+  std::vector< double > numerator(ringSize*sliceSize, 0.0);
+  std::vector< double > denominator(ringSize*sliceSize, 0.0);
+
+  std::vector< double > squaredDifferences;
+  std::vector< double > rowSums;
+  std::vector< double > distances;
+  std::vector< double > weights(numChannels);
+
+  for (std::size_t k = 0; k < centersZ.size(); ++k)
+  {
+    const int zb = centersZ[k];
+    const int zBegin = std::max(zb-r, z0);
+    const int zEnd = std::min(zb+r, z1);
+
+    // only blocks containing masked voxels of the region are denoised
+    std::vector< std::pair< int, int > > activeCenters;
+    for (int yb : centersY)
+    {
+      for (int xb : centersX)
+      {
+        bool active = false;
+        for (int z = zBegin; z <= zEnd && !active; ++z)
+          for (int y = std::max(yb-r, y0); y <= std::min(yb+r, y1) && !active; ++y)
+            for (int x = std::max(xb-r, x0); x <= std::min(xb+r, x1) && !active; ++x)
+              active = mask[((z-z0)*height + y-y0)*width + x-x0] != 0;
+        if (active)
+          activeCenters.push_back(std::make_pair(xb, yb));
       }
+    }
 
-      else
+    for (int dx = -R; dx <= R && !this->GetAbortGenerateData() && !activeCenters.empty(); ++dx)
+    {
+      for (int dy = -R; dy <= R; ++dy)
       {
-        // same procedure for vektoranalysis
-
-        double Z = 0;
-        itk::VariableLengthVector<double> sumj;
-        sumj.SetSize(inputImagePointer->GetVectorLength());
-        sumj.Fill(0.0);
-        double w = 0;
-        std::vector<double> wj;
-        std::vector<itk::VariableLengthVector <double> > p;
-        typename InputIteratorType::IndexType index;
-        index = git.GetIndex();
-
-        for (int x = index.GetElement(0) - m_SearchRadius; x <= index.GetElement(0) + m_SearchRadius; ++x)
+        for (int dz = -R; dz <= R; ++dz)
         {
-          for (int y = index.GetElement(1) - m_SearchRadius; y <= index.GetElement(1) + m_SearchRadius; ++y)
+          if (zb+dz < 0 || zb+dz >= nz)
+            continue;
+
+          const int offset[3] = {dx, dy, dz};
+          ComputePatchDistances(zb, offset, begin, end, squaredDifferences, rowSums, distances);
+          const int pairsZ = GetNumberOfValidPairs(zb, dz, nz);
+
+          for (const auto& center : activeCenters)
           {
-            for (int z = index.GetElement(2) - m_SearchRadius; z <= index.GetElement(2) + m_SearchRadius; ++z)
+            const int xb = center.first;
+            const int yb = center.second;
+            if (xb+dx < 0 || xb+dx >= nx || yb+dy < 0 || yb+dy >= ny)
+              continue;
+
+            const double size = pairsZ*GetNumberOfValidPairs(yb, dy, ny)*GetNumberOfValidPairs(xb, dx, nx);
+            const double* dist = distances.data() + ((yb-begin[1])*centerWidth + xb-begin[0])*numChannels;
+            if (!m_UseJointInformation)
             {
-              typename InputIteratorType::IndexType indexV;
-              indexV.SetElement(0, x);
-              indexV.SetElement(1, y);
-              indexV.SetElement(2, z);
-              if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexV))
+              for (int c = 0; c < numChannels; ++c)
+                weights[c] = std::exp( - dist[c] / size / m_Variance);
+            }
+            else
+            {
+              double sumk = 0;
+              for (int c = 0; c < numChannels; ++c)
+                sumk += dist[c];
+              std::fill(weights.begin(), weights.end(), std::exp( - (sumk / (size*(numChannels + 1))) / m_Variance));
+            }
+
+            // add the weighted shifted block to all region voxels of the block
+            for (int z = std::max(zBegin, -dz); z <= std::min(zEnd, nz-1-dz); ++z)
+            {
+              double* sliceNumerator = numerator.data() + (z%ringSize)*sliceSize;
+              double* sliceDenominator = denominator.data() + (z%ringSize)*sliceSize;
+              for (int y = std::max(std::max(yb-r, y0), -dy); y <= std::min(std::min(yb+r, y1), ny-1-dy); ++y)
               {
-                typename InputImageType::PixelType pixelJ = inputImagePointer->GetPixel(indexV);
-                double sumk = 0;
-                double size = 0;
-                for (int xi = index.GetElement(0) - m_ComparisonRadius, xj = x - m_ComparisonRadius; xi <= index.GetElement(0) + m_ComparisonRadius; ++xi, ++xj)
-                {
-                  for (int yi = index.GetElement(1) - m_ComparisonRadius, yj = y - m_ComparisonRadius; yi <= index.GetElement(1) + m_ComparisonRadius; ++yi, ++yj)
-                  {
-                    for (int zi = index.GetElement(2) - m_ComparisonRadius, zj = z - m_ComparisonRadius; zi <= index.GetElement(2) + m_ComparisonRadius; ++zi, ++zj)
-                    {
-                      typename InputIteratorType::IndexType indexI, indexJ;
-                      indexI.SetElement(0, xi);
-                      indexI.SetElement(1, yi);
-                      indexI.SetElement(2, zi);
-                      indexJ.SetElement(0, xj);
-                      indexJ.SetElement(1, yj);
-                      indexJ.SetElement(2, zj);
-                      // Compare neighborhoods ni & nj
-                      if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexI) && inputImagePointer->GetLargestPossibleRegion().IsInside(indexJ))
-                      {
-                        typename InputImageType::PixelType diff = inputImagePointer->GetPixel(indexI) - inputImagePointer->GetPixel(indexJ);
-                        sumk += (double)(diff.GetSquaredNorm());
-                        ++size;
-                      }
-                    }
-                  }
-                }
-                // weight all neighborhoods
-                size *= inputImagePointer->GetVectorLength() + 1;
-                w = std::exp( - (sumk / size) / m_Variance);
-                wj.push_back(w);
-                if (m_UseRicianAdaption)
+                for (int x = std::max(std::max(xb-r, x0), -dx); x <= std::min(std::min(xb+r, x1), nx-1-dx); ++x)
                 {
-                  itk::VariableLengthVector <double> m;
-                  m.SetSize(inputImagePointer->GetVectorLength());
-                  for (unsigned int i = 0; i < inputImagePointer->GetVectorLength(); ++i)
+                  const int v = (y-y0)*width + x-x0;
+                  if (!mask[(z-z0)*width*height + v])
+                    continue;
+
+                  const TPixelType* pixelJ = in + (((z+dz)*ny + y+dy)*nx + x+dx)*numChannels;
+                  double* num = sliceNumerator + v*numChannels;
+                  double* den = sliceDenominator + v*numChannels;
+                  for (int c = 0; c < numChannels; ++c)
                   {
-                    double sp = (double)(pixelJ.GetElement(i) * pixelJ.GetElement(i));
-                    m.SetElement(i,sp);
+                    double p = m_UseRicianAdaption ? (double)(pixelJ[c]*pixelJ[c]) : (double)(pixelJ[c]);
+                    num[c] += weights[c]*p;
+                    den[c] += weights[c];
                   }
-                  p.push_back(m);
-                }
-                else
-                  ++size;
-                {
-                  p.push_back(pixelJ);
                 }
-                Z += w;
               }
             }
           }
         }
-        for (unsigned int n = 0; n < wj.size(); ++n)
-        {
-          sumj = sumj + ((wj[n]/Z) * p[n]);
-        }
-        if (m_UseRicianAdaption)
-        {
-          sumj = sumj - (2 * m_Variance);
-        }
+      }
+    }
+
+    // write the slices that are not covered by the blocks of the next center slice
+    int lastSlice = z1;
+    if (k+1 < centersZ.size())
+      lastSlice = std::min(centersZ[k+1]-r-1, z1);
+    for (int z = zBegin; z <= lastSlice; ++z)
+    {
+      double* sliceNumerator = numerator.data() + (z%ringSize)*sliceSize;
+      double* sliceDenominator = denominator.data() + (z%ringSize)*sliceSize;
+      if (this->GetAbortGenerateData())
+        std::fill(sliceDenominator, sliceDenominator + sliceSize, 0.0);
 
-        for (unsigned int i = 0; i < inputImagePointer->GetVectorLength(); ++i)
+      for (int y = y0; y <= y1; ++y)
+      {
+        typename OutputImageType::IndexType index;
+        index[0] = x0 + origin[0];
+        index[1] = y + origin[1];
+        index[2] = z + origin[2];
+        TPixelType* out = outputImage->GetBufferPointer() + outputImage->ComputeOffset(index)*numChannels;
+        const int v = (y-y0)*width;
+        for (int x = 0; x < width; ++x)
+          WriteVoxel(out + x*numChannels, sliceNumerator + (v+x)*numChannels, sliceDenominator + (v+x)*numChannels, numChannels, false);
+      }
+      std::fill(sliceNumerator, sliceNumerator + sliceSize, 0.0);
+      std::fill(sliceDenominator, sliceDenominator + sliceSize, 0.0);
+      m_CurrentVoxelCount += width*height;
+    }
+  }
+}
+
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::ComputePatchDistances(int z, const int offset[3], const int begin[2], const int end[2],
+                        std::vector< double >& squaredDifferences, std::vector< double >& rowSums, std::vector< double >& distances)
+{
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+  const int nx = inputImagePointer->GetLargestPossibleRegion().GetSize(0);
+  const int ny = inputImagePointer->GetLargestPossibleRegion().GetSize(1);
+  const int nz = inputImagePointer->GetLargestPossibleRegion().GetSize(2);
+  const int numChannels = inputImagePointer->GetVectorLength();
+  const TPixelType* in = inputImagePointer->GetBufferPointer();
+  const int r = m_ComparisonRadius;
+
+  // squared differences are needed in the comparison neighborhoods of all requested voxels
+  const int ex0 = std::max(begin[0]-r, 0);
+  const int ex1 = std::min(end[0]+r, nx-1);
+  const int ey0 = std::max(begin[1]-r, 0);
+  const int ey1 = std::min(end[1]+r, ny-1);
+  const int rowLength = (ex1-ex0+2)*numChannels;  // one leading zero column for the prefix sums
+  const int numRows = ey1-ey0+1;
+  const int width = end[0]-begin[0]+1;
+  const int height = end[1]-begin[1]+1;
+
+  // sum the squared differences of the voxel pairs inside the image along z
+  squaredDifferences.assign(numRows*rowLength, 0.0);
+  const int vx0 = std::max(ex0, -offset[0]);
+  const int vx1 = std::min(ex1, nx-1-offset[0]);
+  const int vy0 = std::max(ey0, -offset[1]);
+  const int vy1 = std::min(ey1, ny-1-offset[1]);
+  const int vz0 = std::max(std::max(z-r, 0), -offset[2]);
+  const int vz1 = std::min(std::min(z+r, nz-1), nz-1-offset[2]);
+  if (vx0 <= vx1)
+  {
+    const int n = (vx1-vx0+1)*numChannels;
+    for (int zz = vz0; zz <= vz1; ++zz)
+    {
+      for (int y = vy0; y <= vy1; ++y)
+      {
+        const TPixelType* a = in + ((zz*ny + y)*nx + vx0)*numChannels;
+        const TPixelType* b = in + (((zz+offset[2])*ny + y+offset[1])*nx + vx0+offset[0])*numChannels;
+        double* e = squaredDifferences.data() + (y-ey0)*rowLength + (vx0-ex0+1)*numChannels;
+        for (int i = 0; i < n; ++i)
         {
-          double a = sumj.GetElement(i);
-          if (a < 0)
-          {
-            a = 0;
-          }
-          TPixelType outval;
-          if (m_UseRicianAdaption)
-          {
-            outval = std::floor(std::sqrt(a) + 0.5);
-          }
-          else
-          {
-            outval = std::floor(a + 0.5);
-          }
-          outpix.SetElement(i, outval);
+          double diff = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+          e[i] += diff*diff;
         }
       }
     }
-    else
+  }
+
+  // box sums along x
+  rowSums.assign((numRows+1)*width*numChannels, 0.0);   // one leading zero row for the prefix sums
+  for (int y = 0; y < numRows; ++y)
+  {
+    double* row = squaredDifferences.data() + y*rowLength;
+    for (int x = 1; x <= ex1-ex0+1; ++x)
+      for (int c = 0; c < numChannels; ++c)
+        row[x*numChannels + c] += row[(x-1)*numChannels + c];
+
+    double* sums = rowSums.data() + (y+1)*width*numChannels;
+    for (int x = begin[0]; x <= end[0]; ++x)
     {
-      outpix.Fill(0);
+      const double* hi = row + (std::min(x+r, ex1)-ex0+1)*numChannels;
+      const double* lo = row + (std::max(x-r, ex0)-ex0)*numChannels;
+      double* s = sums + (x-begin[0])*numChannels;
+      for (int c = 0; c < numChannels; ++c)
+        s[c] = hi[c] - lo[c];
     }
+  }
+
+  // box sums along y
+  const int sumLength = width*numChannels;
+  for (int y = 1; y <= numRows; ++y)
+    for (int i = 0; i < sumLength; ++i)
+      rowSums[y*sumLength + i] += rowSums[(y-1)*sumLength + i];
 
-    oit.Set(outpix);
-    ++oit;
-    ++m_CurrentVoxelCount;
-    ++git;
-    ++mit;
+  distances.resize(height*sumLength);
+  for (int y = begin[1]; y <= end[1]; ++y)
+  {
+    const double* hi = rowSums.data() + (std::min(y+r, ey1)-ey0+1)*sumLength;
+    const double* lo = rowSums.data() + (std::max(y-r, ey0)-ey0)*sumLength;
+    double* d = distances.data() + (y-begin[1])*sumLength;
+    for (int i = 0; i < sumLength; ++i)
+      d[i] = hi[i] - lo[i];
   }
+}
 
-  MITK_INFO << "One Thread finished calculation";
+template< class TPixelType >
+int
+NonLocalMeansDenoisingFilter< TPixelType >
+::GetNumberOfValidPairs(int pos, int offset, int size)
+{
+  const int r = m_ComparisonRadius;
+  const int lo = std::max(-r, std::max(-pos, -pos-offset));
+  const int hi = std::min(r, std::min(size-1-pos, size-1-pos-offset));
+  return std::max(0, hi-lo+1);
+}
+
+template< class TPixelType >
+std::vector< int >
+NonLocalMeansDenoisingFilter< TPixelType >
+::GetBlockCenters(int size, int begin, int end)
+{
+  // overlapping blocks on a regular grid, the last voxel is always a center
+  const int step = std::max(1, 2*m_ComparisonRadius);
+  std::vector< int > centers;
+  for (int c = 0; c < size; c += step)
+  {
+    if (c+m_ComparisonRadius >= begin && c-m_ComparisonRadius <= end)
+      centers.push_back(c);
+  }
+  if ((size-1)%step != 0 && size-1-m_ComparisonRadius <= end)
+    centers.push_back(size-1);
+  return centers;
+}
+
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::WriteVoxel(TPixelType* out, const double* numerator, const double* denominator, int numChannels, bool sharedDenominator)
+{
+  for (int c = 0; c < numChannels; ++c)
+  {
+    double den = sharedDenominator ? denominator[0] : denominator[c];
+    if (den <= 0)
+    {
+      out[c] = 0;
+      continue;
+    }
+
+    double sumj = numerator[c] / den;
+    if (m_UseRicianAdaption)
+    {
+      sumj -= 2 * m_Variance;
+    }
+
+    if (sumj < 0)
+    {
+      sumj = 0;
+    }
+
+    if (m_UseRicianAdaption)
+    {
+      out[c] = static_cast<TPixelType>(std::floor(std::sqrt(sumj) + 0.5));
+    }
+    else
+    {
+      out[c] = static_cast<TPixelType>(std::floor(sumj + 0.5));
+    }
+  }
 }
 
 template< class TPixelType >
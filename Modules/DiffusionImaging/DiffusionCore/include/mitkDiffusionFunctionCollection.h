@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkVectorContainer.h>
 #include <itkImage.h>
 #include <itkLinearInterpolateImageFunction.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
 #include <mitkImage.h>
 #include <mitkShImage.h>
 #include <mitkDiffusionPropertyHelper.h>
@@ -122,6 +123,45 @@ public:
     return false;
   }
 
+  /** World bounding box (xmin,xmax,ymin,ymax,zmin,zmax) of all voxels with a value >= threshold, enlarged by margin voxels. Returns false if there is no such voxel. */
+  template< class TPixelType >
+  static bool GetImageBounds(const itk::Image< TPixelType, 3 >* image, float threshold, int margin, double bounds[6])
+  {
+    itk::Index<3> minIdx, maxIdx;
+    bool found = false;
+    itk::ImageRegionConstIteratorWithIndex< itk::Image< TPixelType, 3 > > it(image, image->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      if (static_cast<float>(it.Get())<threshold)
+        continue;
+      const itk::Index<3>& idx = it.GetIndex();
+      for (int k=0; k<3; ++k)
+      {
+        minIdx[k] = found ? std::min(minIdx[k], idx[k]) : idx[k];
+        maxIdx[k] = found ? std::max(maxIdx[k], idx[k]) : idx[k];
+      }
+      found = true;
+    }
+    if (!found)
+      return false;
+
+    // corners of the voxel box, the voxel centers are at integer indices
+    for (int c=0; c<8; ++c)
+    {
+      itk::ContinuousIndex< double, 3 > cIdx;
+      for (int k=0; k<3; ++k)
+        cIdx[k] = (c>>k)&1 ? maxIdx[k] + 0.5 + margin : minIdx[k] - 0.5 - margin;
+      itk::Point< double, 3 > p;
+      image->TransformContinuousIndexToPhysicalPoint(cIdx, p);
+      for (int k=0; k<3; ++k)
+      {
+        bounds[2*k] = c==0 ? p[k] : std::min(bounds[2*k], p[k]);
+        bounds[2*k+1] = c==0 ? p[k] : std::max(bounds[2*k+1], p[k]);
+      }
+    }
+    return true;
+  }
+
   template< class TType=float >
   static vnl_matrix_fixed< TType, 3, 3 > GetRotationMatrixVnl(TType rx, TType ry, TType rz)
   {
@@ -37,6 +37,14 @@ public:
 
   virtual float CalculateDistance(vnl_matrix<float>& s, vnl_matrix<float>& t, bool &flipped) = 0;
 
+  /** Lower bound of CalculateDistance() computed from the mean points of both tracts. Used to skip distance calculations. Metrics without such a bound return 0. */
+  virtual float CalculateLowerBound(const vnl_vector_fixed<float, 3>& s_mean, const vnl_vector_fixed<float, 3>& t_mean)
+  {
+    (void)s_mean;
+    (void)t_mean;
+    return 0;
+  }
+
   float GetScale() const;
   void SetScale(float Scale);
 
@@ -62,6 +62,12 @@ public:
     return m_Scale*d;
   }
 
+  /** The maximum point distance is at least the mean point distance, which is at least the distance of the mean points. */
+  float CalculateLowerBound(const vnl_vector_fixed<float, 3>& s_mean, const vnl_vector_fixed<float, 3>& t_mean) override
+  {
+    return m_Scale*(s_mean-t_mean).magnitude();
+  }
+
 protected:
 
 };
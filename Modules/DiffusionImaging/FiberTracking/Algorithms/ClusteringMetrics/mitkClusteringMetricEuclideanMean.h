@@ -53,6 +53,12 @@ public:
     return m_Scale*d_direct/s.cols();
   }
 
+  /** The mean point distance is at least the distance of the mean points (also for the flipped tract). */
+  float CalculateLowerBound(const vnl_vector_fixed<float, 3>& s_mean, const vnl_vector_fixed<float, 3>& t_mean) override
+  {
+    return m_Scale*(s_mean-t_mean).magnitude();
+  }
+
 protected:
 
 };
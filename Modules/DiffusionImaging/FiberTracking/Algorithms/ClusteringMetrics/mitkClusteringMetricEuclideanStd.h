@@ -68,6 +68,12 @@ public:
     return m_Scale*d/2;
   }
 
+  /** The distance is at least half of the mean point distance, which is at least the distance of the mean points. */
+  float CalculateLowerBound(const vnl_vector_fixed<float, 3>& s_mean, const vnl_vector_fixed<float, 3>& t_mean) override
+  {
+    return m_Scale*(s_mean-t_mean).magnitude()/2;
+  }
+
 protected:
 
 };
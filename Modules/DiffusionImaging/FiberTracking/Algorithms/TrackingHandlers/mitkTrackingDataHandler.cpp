@@ -19,8 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace mitk
 {
 TrackingDataHandler::TrackingDataHandler()
-  : m_RngItk(ItkRngType::New())
-  , m_NeedsDataInit(true)
+  : m_NeedsDataInit(true)
 {
 
 }
@@ -21,10 +21,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkPoint.h>
 #include <itkImage.h>
 #include <deque>
+#include <cmath>
 #include <MitkFiberTrackingExports.h>
 #include <boost/random/discrete_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
 #include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
 #include <mitkDiffusionFunctionCollection.h>
 #include <itkLinearInterpolateImageFunction.h>
 #include <mitkStreamlineTractographyParameters.h>
@@ -52,7 +56,16 @@ public:
   typedef vnl_vector_fixed< float, 3 >  TrackingDirectionType;
   typedef mitk::StreamlineTractographyParameters::MODE MODE;
 
-  virtual TrackingDirectionType ProposeDirection(const itk::Point<float, 3>& pos, std::deque< TrackingDirectionType >& olddirs, itk::Index<3>& oldIndex) = 0;  ///< predicts next progression direction at the given position
+  /**
+   * \brief Predicts the next progression direction at the given position.
+   *
+   * All random decisions are drawn from rng, the random number stream of the seed point that is currently tracked.
+   * The handler itself holds no random state, so several threads may propose directions concurrently.
+   *
+   * \note The rng parameter was added to this public interface. Handlers derived outside of MITK have to add it to
+   * their override and draw from it instead of a member generator.
+   */
+  virtual TrackingDirectionType ProposeDirection(const itk::Point<float, 3>& pos, std::deque< TrackingDirectionType >& olddirs, itk::Index<3>& oldIndex, BoostRngType& rng) = 0;
 
   virtual void InitForTracking() = 0;
   virtual itk::Vector<double, 3> GetSpacing() = 0;
@@ -66,22 +79,29 @@ public:
     m_Parameters = parameters;
 
     if (m_Parameters->m_FixRandomSeed)
-    {
-      m_Rng.seed(0);
       std::srand(0);
-      m_RngItk->SetSeed(0);
-    }
     else
-    {
-      m_Rng.seed();
-      m_RngItk->SetSeed();
       std::srand(std::time(nullptr));
-    }
   }
 
-  double GetRandDouble(const double & a, const double & b)
+  static double GetRandDouble(BoostRngType& rng, const double & a, const double & b)
   {
-    return m_RngItk->GetUniformVariate(a, b);
+    boost::random::uniform_real_distribution<double> dist(a, b);
+    return dist(rng);
+  }
+
+  static int GetRandInt(BoostRngType& rng, const int & a, const int & b)  ///< uniform in [a,b]
+  {
+    boost::random::uniform_int_distribution<int> dist(a, b);
+    return dist(rng);
+  }
+
+  static double GetRandNormal(BoostRngType& rng, const double & mean, const double & variance)
+  {
+    if (variance<=0)
+      return mean;
+    boost::random::normal_distribution<double> dist(mean, std::sqrt(variance));
+    return dist(rng);
   }
 
 protected:
@@ -103,8 +123,6 @@ protected:
     m_Parameters->SetMinVoxelSizeMm(minVoxelSize);
   }
 
-  BoostRngType        m_Rng;
-  ItkRngType::Pointer m_RngItk;
   bool                m_NeedsDataInit;
   std::shared_ptr< mitk::StreamlineTractographyParameters > m_Parameters;
 
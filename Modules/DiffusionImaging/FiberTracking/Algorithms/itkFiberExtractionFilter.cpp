@@ -113,6 +113,17 @@ template< class PixelType >
 void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Pointer fib)
 {
   MITK_INFO << "Extracting fibers (min. overlap " << m_OverlapFraction << ")";
+
+  // fibers outside of the bounding box of the ROI voxels have no overlap with the ROI
+  std::vector< std::vector< unsigned int > > candidate_ids;  // one ID vector per ROI
+  for (auto roi : m_RoiImages)
+  {
+    double bounds[6];
+    if (mitk::imv::GetImageBounds<PixelType>(roi, m_Threshold, 0, bounds))
+      candidate_ids.push_back(fib->GetFiberIdsInBounds(bounds));
+    else
+      candidate_ids.push_back(std::vector< unsigned int >());
+  }
   vtkSmartPointer<vtkPolyData> polydata = fib->GetFiberPolyData();
 
   std::vector< std::vector< unsigned int > > positive_ids;  // one ID vector per ROI
@@ -120,20 +131,23 @@ void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Point
 
   std::vector< unsigned int > negative_ids; // fibers not overlapping with ANY mask
 
-  boost::progress_display disp(m_InputFiberBundle->GetNumFibers());
-  for (unsigned int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
-  {
-    ++disp;
-    vtkCell* cell = polydata->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+  std::vector< float > best_ol(m_InputFiberBundle->GetNumFibers(), 0);
+  std::vector< int > best_ol_idx(m_InputFiberBundle->GetNumFibers(), -1);
 
-    float best_ol = 0;
-    int best_ol_idx = -1;
-    for (unsigned int m=0; m<m_RoiImages.size(); ++m)
+  unsigned long num_candidates = 0;
+  for (const auto& ids : candidate_ids)
+    num_candidates += ids.size();
+  boost::progress_display disp(num_candidates);
+  for (unsigned int m=0; m<m_RoiImages.size(); ++m)
+  {
+    auto roi = m_RoiImages.at(m);
+    for (auto i : candidate_ids.at(m))
     {
-      auto roi = m_RoiImages.at(m);
-      m_Interpolator->SetInputImage(roi);
+      ++disp;
+      vtkCell* cell = polydata->GetCell(i);
+      int numPoints = cell->GetNumberOfPoints();
+      vtkPoints* points = cell->GetPoints();
+
       PixelType inside = 0;
       PixelType outside = 0;
       for (int j=0; j<numPoints-1; j++)
@@ -163,16 +177,20 @@ void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Point
       }
 
       float overlap = (float)inside/(inside+outside);
-      if (overlap > best_ol && overlap >= m_OverlapFraction)
+      if (overlap > best_ol[i] && overlap >= m_OverlapFraction)
       {
-        best_ol_idx = m;
-        best_ol = overlap;
+        best_ol_idx[i] = m;
+        best_ol[i] = overlap;
       }
     }
-    if (best_ol_idx<0)
+  }
+
+  for (unsigned int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
+  {
+    if (best_ol_idx[i]<0)
       negative_ids.push_back(i);
     else
-      positive_ids.at(best_ol_idx).push_back(i);
+      positive_ids.at(best_ol_idx[i]).push_back(i);
   }
 
   if (!m_NoNegatives)
@@ -209,58 +227,75 @@ template< class PixelType >
 void FiberExtractionFilter< PixelType >::ExtractEndpoints(mitk::FiberBundle::Pointer fib)
 {
   MITK_INFO << "Extracting fibers (endpoints in mask)";
+
+  // interpolated ROI values can be positive up to one voxel outside of the ROI voxels
+  std::vector< std::vector< unsigned int > > candidate_ids;  // one ID vector per ROI
+  for (auto roi : m_RoiImages)
+  {
+    double bounds[6];
+    if (mitk::imv::GetImageBounds<PixelType>(roi, m_Threshold, m_Interpolate ? 1 : 0, bounds))
+      candidate_ids.push_back(fib->GetFiberIdsInBounds(bounds));
+    else
+      candidate_ids.push_back(std::vector< unsigned int >());
+  }
   vtkSmartPointer<vtkPolyData> polydata = fib->GetFiberPolyData();
 
   std::vector< std::vector< unsigned int > > positive_ids;  // one ID vector per ROI
   positive_ids.resize(m_RoiImages.size());
 
   std::vector< unsigned int > negative_ids; // fibers not overlapping with ANY mask
+  std::vector< bool > positive(m_InputFiberBundle->GetNumFibers(), false);
 
-  boost::progress_display disp(m_InputFiberBundle->GetNumFibers());
-  for (unsigned int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
+  unsigned long num_candidates = 0;
+  for (const auto& ids : candidate_ids)
+    num_candidates += ids.size();
+  boost::progress_display disp(num_candidates);
+  for (unsigned int m=0; m<m_RoiImages.size(); ++m)
   {
-    ++disp;
-    vtkCell* cell = polydata->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+    auto roi = m_RoiImages.at(m);
+    m_Interpolator->SetInputImage(roi);
 
-    bool positive = false;
-    if (numPoints>1)
-      for (unsigned int m=0; m<m_RoiImages.size(); ++m)
-      {
-        auto roi = m_RoiImages.at(m);
-        m_Interpolator->SetInputImage(roi);
+    for (auto i : candidate_ids.at(m))
+    {
+      ++disp;
+      vtkCell* cell = polydata->GetCell(i);
+      int numPoints = cell->GetNumberOfPoints();
+      vtkPoints* points = cell->GetPoints();
+      if (numPoints<=1)
+        continue;
 
-        int inside = 0;
+      int inside = 0;
 
-        // check first fiber point
-        {
-          double* p = points->GetPoint(0);
-          itk::Point<float, 3> itkP = mitk::imv::GetItkPoint(p);
+      // check first fiber point
+      {
+        double* p = points->GetPoint(0);
+        itk::Point<float, 3> itkP = mitk::imv::GetItkPoint(p);
 
-          if ( IsPositive(itkP) )
-            inside++;
-        }
+        if ( IsPositive(itkP) )
+          inside++;
+      }
 
-        // check second fiber point
-        {
-          double* p = points->GetPoint(numPoints-1);
-          itk::Point<float, 3> itkP = mitk::imv::GetItkPoint(p);
+      // check second fiber point
+      {
+        double* p = points->GetPoint(numPoints-1);
+        itk::Point<float, 3> itkP = mitk::imv::GetItkPoint(p);
 
-          if ( IsPositive(itkP) )
-            inside++;
-        }
+        if ( IsPositive(itkP) )
+          inside++;
+      }
 
-        if (inside==2 || (inside==1 && !m_BothEnds))
-        {
-          positive = true;
-          positive_ids[m].push_back(i);
-        }
+      if (inside==2 || (inside==1 && !m_BothEnds))
+      {
+        positive[i] = true;
+        positive_ids[m].push_back(i);
       }
-    if (!positive)
-      negative_ids.push_back(i);
+    }
   }
 
+  for (unsigned int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
+    if (!positive[i])
+      negative_ids.push_back(i);
+
   if (!m_NoNegatives)
     m_Negatives.push_back(CreateFib(negative_ids));
   if (!m_NoPositives)
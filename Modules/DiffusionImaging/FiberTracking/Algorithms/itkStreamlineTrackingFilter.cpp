@@ -17,6 +17,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
+#include <iterator>
 
 #include <omp.h>
 #include "itkStreamlineTrackingFilter.h"
@@ -56,6 +58,7 @@ StreamlineTrackingFilter
   , m_CurrentTracts(0)
   , m_Progress(0)
   , m_StopTracking(false)
+  , m_RandomSeed(0)
   , m_TrackingPriorHandler(nullptr)
 {
   this->SetNumberOfRequiredInputs(0);
@@ -63,13 +66,18 @@ StreamlineTrackingFilter
 
 std::string StreamlineTrackingFilter::GetStatusText()
 {
-  std::string status = "Seedpoints processed: " + boost::lexical_cast<std::string>(m_Progress) + "/" + boost::lexical_cast<std::string>(m_SeedPoints.size());
+  const unsigned int progress = m_Progress;
+  unsigned int current_tracts = m_CurrentTracts;
+  std::string status = "Seedpoints processed: " + boost::lexical_cast<std::string>(progress) + "/" + boost::lexical_cast<std::string>(m_SeedPoints.size());
   if (m_SeedPoints.size()>0)
-    status += " (" + boost::lexical_cast<std::string>(100*m_Progress/m_SeedPoints.size()) + "%)";
+    status += " (" + boost::lexical_cast<std::string>(100*progress/m_SeedPoints.size()) + "%)";
   if (m_Parameters->m_MaxNumFibers>0)
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts) + "/" + boost::lexical_cast<std::string>(m_Parameters->m_MaxNumFibers);
+  {
+    current_tracts = std::min(current_tracts, static_cast<unsigned int>(m_Parameters->m_MaxNumFibers));
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(current_tracts) + "/" + boost::lexical_cast<std::string>(m_Parameters->m_MaxNumFibers);
+  }
   else
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts);
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(current_tracts);
 
   return status;
 }
@@ -78,6 +86,15 @@ void StreamlineTrackingFilter::BeforeTracking()
 {
   m_StopTracking = false;
   m_TrackingHandler->SetParameters(m_Parameters);
+
+  if (m_Parameters->m_FixRandomSeed)
+    m_RandomSeed = 0;
+  else
+  {
+    mitk::TrackingDataHandler::ItkRngType::Pointer rng = mitk::TrackingDataHandler::ItkRngType::New();
+    rng->SetSeed();
+    m_RandomSeed = rng->GetIntegerVariate();
+  }
   m_TrackingHandler->InitForTracking();
   m_FiberPolyData = PolyDataType::New();
   m_Points = vtkSmartPointer< vtkPoints >::New();
@@ -314,7 +331,7 @@ std::vector< vnl_vector_fixed<float,3> > StreamlineTrackingFilter::CreateDirecti
 }
 
 
-vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::Point<float, 3> &pos, std::deque<vnl_vector_fixed<float, 3> >& olddirs, itk::Index<3> &oldIndex)
+vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::Point<float, 3> &pos, std::deque<vnl_vector_fixed<float, 3> >& olddirs, itk::Index<3> &oldIndex, mitk::TrackingDataHandler::BoostRngType& rng)
 {
   if (m_DemoMode)
   {
@@ -325,7 +342,7 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
   vnl_vector_fixed<float,3> direction; direction.fill(0);
 
   if (mitk::imv::IsInsideMask<float>(pos, m_Parameters->m_InterpolateRoiImages, m_MaskInterpolator) && !mitk::imv::IsInsideMask<float>(pos, m_Parameters->m_InterpolateRoiImages, m_StopInterpolator))
-    direction = m_TrackingHandler->ProposeDirection(pos, olddirs, oldIndex); // get direction proposal at current streamline position
+    direction = m_TrackingHandler->ProposeDirection(pos, olddirs, oldIndex, rng); // get direction proposal at current streamline position
   else
     return direction;
 
@@ -341,13 +358,13 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
     {
       vnl_vector_fixed<float,3> d;
       bool is_stop_voter = false;
-      if (!m_Parameters->m_FixRandomSeed && m_Parameters->m_RandomSampling)
+      if (m_Parameters->m_RandomSampling)
       {
-        d[0] = static_cast<float>(m_TrackingHandler->GetRandDouble(-0.5, 0.5));
-        d[1] = static_cast<float>(m_TrackingHandler->GetRandDouble(-0.5, 0.5));
-        d[2] = static_cast<float>(m_TrackingHandler->GetRandDouble(-0.5, 0.5));
+        d[0] = static_cast<float>(mitk::TrackingDataHandler::GetRandDouble(rng, -0.5, 0.5));
+        d[1] = static_cast<float>(mitk::TrackingDataHandler::GetRandDouble(rng, -0.5, 0.5));
+        d[2] = static_cast<float>(mitk::TrackingDataHandler::GetRandDouble(rng, -0.5, 0.5));
         d.normalize();
-        d *= static_cast<float>(m_TrackingHandler->GetRandDouble(0, static_cast<double>(m_Parameters->GetSamplingDistanceMm())));
+        d *= static_cast<float>(mitk::TrackingDataHandler::GetRandDouble(rng, 0, static_cast<double>(m_Parameters->GetSamplingDistanceMm())));
       }
       else
       {
@@ -369,7 +386,7 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
 
       vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
       if (mitk::imv::IsInsideMask<float>(sample_pos, m_Parameters->m_InterpolateRoiImages, m_MaskInterpolator))
-        tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex); // sample neighborhood
+        tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex, rng); // sample neighborhood
       if (tempDir.magnitude()>static_cast<float>(mitk::eps))
       {
         direction += tempDir;
@@ -397,7 +414,7 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
         alternatives++;
         vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
         if (mitk::imv::IsInsideMask<float>(sample_pos, m_Parameters->m_InterpolateRoiImages, m_MaskInterpolator))
-          tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex); // sample neighborhood
+          tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex, rng); // sample neighborhood
 
         if (tempDir.magnitude()>static_cast<float>(mitk::eps))  // are we back in the white matter?
         {
@@ -435,7 +452,7 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
 
   if (m_TrackingPriorHandler!=nullptr && (m_Parameters->m_NewDirectionsFromPrior || valid))
   {
-    vnl_vector_fixed<float,3> prior = m_TrackingPriorHandler->ProposeDirection(pos, olddirs, oldIndex);
+    vnl_vector_fixed<float,3> prior = m_TrackingPriorHandler->ProposeDirection(pos, olddirs, oldIndex, rng);
     if (prior.magnitude()>0.001f)
     {
       prior.normalize();
@@ -452,7 +469,7 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
 }
 
 
-float StreamlineTrackingFilter::FollowStreamline(itk::Point<float, 3> pos, vnl_vector_fixed<float,3> dir, FiberType* fib, DirectionContainer* container, float tractLength, bool front, bool &exclude)
+float StreamlineTrackingFilter::FollowStreamline(itk::Point<float, 3> pos, vnl_vector_fixed<float,3> dir, FiberType* fib, DirectionContainer* container, float tractLength, bool front, bool &exclude, mitk::TrackingDataHandler::BoostRngType& rng)
 {
   vnl_vector_fixed<float,3> zero_dir; zero_dir.fill(0.0);
   std::deque< vnl_vector_fixed<float,3> > last_dirs;
@@ -513,7 +530,7 @@ float StreamlineTrackingFilter::FollowStreamline(itk::Point<float, 3> pos, vnl_v
     last_dirs.push_back(dir);
     if (last_dirs.size()>m_Parameters->m_NumPreviousDirections)
       last_dirs.pop_front();
-    dir = GetNewDirection(pos, last_dirs, oldIndex);
+    dir = GetNewDirection(pos, last_dirs, oldIndex, rng);
 
     while (m_PauseTracking){}
 
@@ -598,6 +615,12 @@ void StreamlineTrackingFilter::GetSeedPointsFromSeedImage()
   MITK_INFO << "StreamlineTracking - Calculating seed points.";
   m_SeedPoints.clear();
 
+  mitk::TrackingDataHandler::ItkRngType::Pointer rng = mitk::TrackingDataHandler::ItkRngType::New();
+  if (m_Parameters->m_FixRandomSeed)
+    rng->SetSeed(0);
+  else
+    rng->SetSeed();
+
   typedef ImageRegionConstIterator< ItkFloatImgType >     MaskIteratorType;
   MaskIteratorType    sit(m_SeedImage, m_SeedImage->GetLargestPossibleRegion());
   sit.GoToBegin();
@@ -619,9 +642,9 @@ void StreamlineTrackingFilter::GetSeedPointsFromSeedImage()
         m_SeedPoints.push_back(worldPos);
         for (unsigned int s = 1; s < m_Parameters->m_SeedsPerVoxel; s++)
         {
-          start[0] = index[0] + static_cast<float>(m_TrackingHandler->GetRandDouble(-0.5, 0.5));
-          start[1] = index[1] + static_cast<float>(m_TrackingHandler->GetRandDouble(-0.5, 0.5));
-          start[2] = index[2] + static_cast<float>(m_TrackingHandler->GetRandDouble(-0.5, 0.5));
+          start[0] = index[0] + static_cast<float>(rng->GetUniformVariate(-0.5, 0.5));
+          start[1] = index[1] + static_cast<float>(rng->GetUniformVariate(-0.5, 0.5));
+          start[2] = index[2] + static_cast<float>(rng->GetUniformVariate(-0.5, 0.5));
 
           itk::Point<float> worldPos;
           m_SeedImage->TransformContinuousIndexToPhysicalPoint(start, worldPos);
@@ -645,7 +668,6 @@ void StreamlineTrackingFilter::GenerateData()
   int num_seeds = static_cast<int>(m_SeedPoints.size());
   itk::Index<3> zeroIndex; zeroIndex.Fill(0);
   m_Progress = 0;
-  int i = 0;
   int print_interval = num_seeds/100;
   if (print_interval<100)
     m_Verbose=false;
@@ -654,94 +676,161 @@ void StreamlineTrackingFilter::GenerateData()
   if(m_Parameters->m_Mode==mitk::TrackingDataHandler::MODE::PROBABILISTIC)
     trials_per_seed = m_Parameters->m_TrialsPerSeed;
 
-#pragma omp parallel
-  while (i<num_seeds && !m_StopTracking)
-  {
-    int temp_i = 0;
-#pragma omp critical
-    {
-      temp_i = i;
-      i++;
-    }
+  // seeds are handed out in small batches by an atomic counter
+  const int num_threads = m_DemoMode ? 1 : omp_get_max_threads();
+  const int seed_batch_size = m_DemoMode ? 1 : std::max(1, std::min(64, num_seeds/(num_threads*64)));
+  std::atomic<int> next_seed(0);
 
-    if (temp_i>=num_seeds || m_StopTracking)
-      continue;
-    else if (m_Verbose && i%print_interval==0)
-#pragma omp critical
-    {
-      m_Progress += static_cast<unsigned int>(print_interval);
-      std::cout << "                                                                                                     \r";
-      if (m_Parameters->m_MaxNumFibers>0)
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << "/" << m_Parameters->m_MaxNumFibers << '\r';
-      else
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << '\r';
-      cout.flush();
-    }
+  // accepted fibers are collected per thread together with their seed index and merged afterwards
+  std::vector< std::vector< std::pair<int, FiberType> > > thread_tractograms(static_cast<std::size_t>(num_threads));
 
-    const itk::Point<float> worldPos = m_SeedPoints.at(static_cast<unsigned int>(temp_i));
+  // With a fixed seed, the result must not depend on thread scheduling: all valid fibers are kept, ordered by seed
+  // index and only then limited to m_MaxNumFibers. Once enough fibers are found, no new batches are handed out, but
+  // the running ones are finished, so that all seeds before the last kept fiber have been tracked.
+  const bool reproducible = m_Parameters->m_FixRandomSeed && !m_DemoMode;
+  std::atomic<bool> max_fibers_reached(false);
 
-    for (unsigned int trials=0; trials<trials_per_seed; ++trials)
-    {
-      FiberType fib;
-      DirectionContainer direction_container;
-      float tractLength = 0;
-      unsigned long counter = 0;
-
-      // get starting direction
-      vnl_vector_fixed<float,3> dir; dir.fill(0.0);
-      std::deque< vnl_vector_fixed<float,3> > olddirs;
-      dir = GetNewDirection(worldPos, olddirs, zeroIndex) * 0.5f;
-
-      bool exclude = false;
-      if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_Parameters->m_InterpolateRoiImages, m_ExclusionInterpolator))
-        exclude = true;
-
-      bool success = false;
-      if (dir.magnitude()>0.0001f && !exclude)
-      {
-        // forward tracking
-        tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude);
-        fib.push_front(worldPos);
+  // A single thread with a fixed seed draws all seeds from one stream seeded like the former handler generators,
+  // which keeps the existing single-threaded reference tractograms valid.
+  const bool shared_stream = m_Parameters->m_FixRandomSeed && num_threads==1;
+  mitk::TrackingDataHandler::BoostRngType shared_rng(m_RandomSeed);
 
-        // backward tracking
-        if (!exclude)
-          tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude);
+#pragma omp parallel num_threads(num_threads)
+  {
+    std::vector< std::pair<int, FiberType> >& thread_tractogram = thread_tractograms.at(static_cast<std::size_t>(omp_get_thread_num()));
+    mitk::TrackingDataHandler::BoostRngType seed_rng;
 
-        counter = fib.size();
+    while (!m_StopTracking && !max_fibers_reached)
+    {
+      const int first_seed = next_seed.fetch_add(seed_batch_size);
+      if (first_seed>=num_seeds)
+        break;
+      const int last_seed = std::min(num_seeds, first_seed + seed_batch_size);
 
-        if (tractLength>=m_Parameters->m_MinTractLengthMm && counter>=2 && !exclude)
+      for (int temp_i=first_seed; temp_i<last_seed && !m_StopTracking; ++temp_i)
+      {
+        const itk::Point<float> worldPos = m_SeedPoints.at(static_cast<unsigned int>(temp_i));
+        if (!shared_stream)
+          seed_rng.seed(m_RandomSeed + static_cast<unsigned int>(temp_i));
+        mitk::TrackingDataHandler::BoostRngType& rng = shared_stream ? shared_rng : seed_rng;
+
+        for (unsigned int trials=0; trials<trials_per_seed; ++trials)
         {
-#pragma omp critical
-          if ( IsValidFiber(&fib) )
+          FiberType fib;
+          DirectionContainer direction_container;
+          float tractLength = 0;
+          unsigned long counter = 0;
+
+          // get starting direction
+          vnl_vector_fixed<float,3> dir; dir.fill(0.0);
+          std::deque< vnl_vector_fixed<float,3> > olddirs;
+          dir = GetNewDirection(worldPos, olddirs, zeroIndex, rng) * 0.5f;
+
+          bool exclude = false;
+          if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_Parameters->m_InterpolateRoiImages, m_ExclusionInterpolator))
+            exclude = true;
+
+          bool success = false;
+          if (dir.magnitude()>0.0001f && !exclude)
           {
-            if (!m_StopTracking)
-            {
-              if (!m_Parameters->m_OutputProbMap)
-                m_Tractogram.push_back(fib);
-              else
-                FiberToProbmap(&fib);
-              m_CurrentTracts++;
-              success = true;
-            }
-            if (m_Parameters->m_MaxNumFibers > 0 && m_CurrentTracts>=static_cast<unsigned int>(m_Parameters->m_MaxNumFibers))
+            // forward tracking
+            tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude, rng);
+            fib.push_front(worldPos);
+
+            // backward tracking
+            if (!exclude)
+              tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude, rng);
+
+            counter = fib.size();
+
+            if (tractLength>=m_Parameters->m_MinTractLengthMm && counter>=2 && !exclude && IsValidFiber(&fib) && !m_StopTracking)
             {
-              if (!m_StopTracking)
+              // without a fixed seed, the counter decides which fibers are kept if the maximum number of fibers is reached
+              const unsigned int accepted = ++m_CurrentTracts;
+              if (reproducible)
+              {
+                thread_tractogram.push_back(std::make_pair(temp_i, std::move(fib)));
+                success = true;
+              }
+              else if (m_Parameters->m_MaxNumFibers <= 0 || accepted<=static_cast<unsigned int>(m_Parameters->m_MaxNumFibers))
+              {
+                if (m_Parameters->m_OutputProbMap)
+                {
+#pragma omp critical (StreamlineTrackingProbmap)
+                  FiberToProbmap(&fib);
+                }
+                else if (m_DemoMode)
+                  m_Tractogram.push_back(fib);
+                else
+                  thread_tractogram.push_back(std::make_pair(temp_i, std::move(fib)));
+                success = true;
+              }
+
+              if (m_Parameters->m_MaxNumFibers > 0 && accepted==static_cast<unsigned int>(m_Parameters->m_MaxNumFibers))
               {
                 std::cout << "                                                                                                     \r";
-                MITK_INFO << "Reconstructed maximum number of tracts (" << m_CurrentTracts << "). Stopping tractography.";
+                MITK_INFO << "Reconstructed maximum number of tracts (" << accepted << "). Stopping tractography.";
+                if (reproducible)
+                  max_fibers_reached = true;
+                else
+                  m_StopTracking = true;
               }
-              m_StopTracking = true;
             }
           }
-        }
+
+          if (success || m_Parameters->m_Mode!=MODE::PROBABILISTIC)
+            break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
+
+        }// trials per seed
+      }// seed points of batch
+
+      const unsigned int progress = (m_Progress += static_cast<unsigned int>(last_seed - first_seed));
+      if (m_Verbose && progress/print_interval != (progress - (last_seed - first_seed))/print_interval)
+#pragma omp critical (StreamlineTrackingProgress)
+      {
+        std::cout << "                                                                                                     \r";
+        if (m_Parameters->m_MaxNumFibers>0)
+          std::cout << "Tried: " << progress << "/" << num_seeds << " | Accepted: " << std::min(m_CurrentTracts.load(), static_cast<unsigned int>(m_Parameters->m_MaxNumFibers)) << "/" << m_Parameters->m_MaxNumFibers << '\r';
+        else
+          std::cout << "Tried: " << progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << '\r';
+        cout.flush();
       }
+    }
+  }
+
+  if (m_Parameters->m_MaxNumFibers > 0 && m_CurrentTracts>static_cast<unsigned int>(m_Parameters->m_MaxNumFibers))
+    m_CurrentTracts = static_cast<unsigned int>(m_Parameters->m_MaxNumFibers);
 
-      if (success || m_Parameters->m_Mode!=MODE::PROBABILISTIC)
-        break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
+  // merge the per thread tractograms, ordered by seed if the tracking should be reproducible
+  std::vector< std::pair<int, FiberType> > merged;
+  std::size_t num_fibers = 0;
+  for (const auto& thread_tractogram : thread_tractograms)
+    num_fibers += thread_tractogram.size();
+  merged.reserve(num_fibers);
+  for (auto& thread_tractogram : thread_tractograms)
+  {
+    std::move(thread_tractogram.begin(), thread_tractogram.end(), std::back_inserter(merged));
+    thread_tractogram.clear();
+  }
 
-    }// trials per seed
+  if (reproducible)
+  {
+    std::stable_sort(merged.begin(), merged.end(), [](const std::pair<int, FiberType>& a, const std::pair<int, FiberType>& b){ return a.first<b.first; });
+    if (m_Parameters->m_MaxNumFibers > 0 && merged.size()>static_cast<std::size_t>(m_Parameters->m_MaxNumFibers))
+      merged.erase(merged.begin() + m_Parameters->m_MaxNumFibers, merged.end());
+  }
 
-  }// seed points
+  if (reproducible && m_Parameters->m_OutputProbMap)
+  {
+    for (auto& entry : merged)
+      FiberToProbmap(&entry.second);
+  }
+  else
+  {
+    m_Tractogram.reserve(m_Tractogram.size() + merged.size());
+    for (auto& entry : merged)
+      m_Tractogram.push_back(std::move(entry.second));
+  }
 
   this->AfterTracking();
 }
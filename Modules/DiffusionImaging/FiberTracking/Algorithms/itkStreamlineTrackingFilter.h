@@ -32,6 +32,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkSimpleFastMutexLock.h>
 #include <mitkDiffusionPropertyHelper.h>
 #include <mitkPointSet.h>
+#include <atomic>
 #include <chrono>
 #include <TrackingHandlers/mitkTrackingDataHandler.h>
 #include <MitkFiberTrackingExports.h>
@@ -129,8 +130,8 @@ protected:
   void FiberToProbmap(FiberType* fib);
   void GetSeedPointsFromSeedImage();
   void CalculateNewPosition(itk::Point<float, 3>& pos, vnl_vector_fixed<float,3>& dir);    ///< Calculate next integration step.
-  float FollowStreamline(itk::Point<float, 3> start_pos, vnl_vector_fixed<float,3> dir, FiberType* fib, DirectionContainer* container, float tractLength, bool front, bool& exclude);       ///< Start streamline in one direction.
-  vnl_vector_fixed<float,3> GetNewDirection(const itk::Point<float, 3>& pos, std::deque< vnl_vector_fixed<float,3> >& olddirs, itk::Index<3>& oldIndex); ///< Determine new direction by sample voting at the current position taking the last progression direction into account.
+  float FollowStreamline(itk::Point<float, 3> start_pos, vnl_vector_fixed<float,3> dir, FiberType* fib, DirectionContainer* container, float tractLength, bool front, bool& exclude, mitk::TrackingDataHandler::BoostRngType& rng);       ///< Start streamline in one direction.
+  vnl_vector_fixed<float,3> GetNewDirection(const itk::Point<float, 3>& pos, std::deque< vnl_vector_fixed<float,3> >& olddirs, itk::Index<3>& oldIndex, mitk::TrackingDataHandler::BoostRngType& rng); ///< Determine new direction by sample voting at the current position taking the last progression direction into account.
 
   std::vector< vnl_vector_fixed<float,3> > CreateDirections(unsigned int NPoints);
 
@@ -153,9 +154,10 @@ protected:
   bool                                m_Verbose;
   bool                                m_DemoMode;
   std::vector< itk::Point<float> >    m_SeedPoints;
-  unsigned int                        m_CurrentTracts;
-  unsigned int                        m_Progress;
-  bool                                m_StopTracking;
+  std::atomic<unsigned int>           m_CurrentTracts;  ///< Number of accepted fibers, may briefly exceed m_MaxNumFibers while tracking
+  std::atomic<unsigned int>           m_Progress;
+  std::atomic<bool>                   m_StopTracking;
+  unsigned int                        m_RandomSeed;     ///< Seed point i is tracked with its own random number stream, seeded with m_RandomSeed + i. A single thread with a fixed seed uses one stream for all seeds.
 
   void BuildFibers(bool check);
   float CheckCurvature(DirectionContainer *fib, bool front);
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <math.h>
 #include <boost/progress.hpp>
 #include <vnl/vnl_sparse_matrix.h>
+#include <algorithm>
 
 namespace itk{
 
@@ -131,11 +132,76 @@ std::vector<vnl_matrix<float> > TractClusteringFilter::ResampleFibers(mitk::Fibe
   return out_fib;
 }
 
+float TractClusteringFilter::CalcDistance(vnl_matrix<float>& t, vnl_matrix<float>& v, bool& flip)
+{
+  float d = 0;
+  for (auto m : m_Metrics)
+    d += m->CalculateDistance(t, v, flip);
+  return d/m_Metrics.size();
+}
+
+float TractClusteringFilter::CalcLowerBound(const vnl_vector_fixed<float,3>& t_mean, const vnl_vector_fixed<float,3>& v_mean)
+{
+  float b = 0;
+  for (auto m : m_Metrics)
+    b += m->CalculateLowerBound(t_mean, v_mean);
+
+  // slightly loosened, so that rounding never prunes a centroid with equal distance
+  return 0.999f*b/m_Metrics.size();
+}
+
+vnl_vector_fixed<float,3> TractClusteringFilter::GetMeanPoint(const vnl_matrix<float>& t) const
+{
+  vnl_vector_fixed<float,3> mean; mean.fill(0.0);
+  for (unsigned int i=0; i<t.cols(); ++i)
+  {
+    mean[0] += t.get(0,i);
+    mean[1] += t.get(1,i);
+    mean[2] += t.get(2,i);
+  }
+  if (t.cols()>0)
+    mean /= t.cols();
+  return mean;
+}
+
+void TractClusteringFilter::FindClosestCentroid(vnl_matrix<float>& t, const vnl_vector_fixed<float,3>& t_mean, std::vector< vnl_matrix<float> >& centroids, const std::vector< vnl_vector_fixed<float,3> >& centroid_means, const std::vector< int >& indices, float max_distance, int& min_idx, float& min_d, bool& flip)
+{
+  // visit the centroids by increasing lower bound and stop as soon as no closer centroid is possible
+  std::vector< std::pair< float, int > > candidates;
+  candidates.reserve(indices.size());
+  for (auto k : indices)
+  {
+    float b = CalcLowerBound(t_mean, centroid_means.at(k));
+    if (b<max_distance && b<=min_d)
+      candidates.push_back(std::make_pair(b, k));
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  for (const auto& c : candidates)
+  {
+    if (c.first>min_d)
+      break;
+
+    bool f = false;
+    float d = CalcDistance(t, centroids.at(c.second), f);
+
+    // equal distances are resolved in favor of the smaller index, as in a sequential search
+    if (d<min_d || (d==min_d && c.second<min_idx))
+    {
+      min_d = d;
+      min_idx = c.second;
+      flip = f;
+    }
+  }
+}
+
 std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep(std::vector< unsigned int > f_indices, std::vector<float> distances)
 {
   float dist_thres = distances.back();
   distances.pop_back();
   std::vector< Cluster > C;
+  std::vector< vnl_matrix<float> > centroids;             // h/n of each cluster
+  std::vector< vnl_vector_fixed<float,3> > centroid_means;
 
   int N = f_indices.size();
 
@@ -144,64 +210,102 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep
   c1.h = T[f_indices.at(0)];
   c1.n = 1;
   C.push_back(c1);
+  centroids.push_back(c1.h);
+  centroid_means.push_back(m_MeanPoints.at(f_indices.at(0)));
   if (f_indices.size()==1)
     return C;
 
-  for (int i=1; i<N; ++i)
+  // The fibers are assigned in batches. The closest of the clusters existing at the start of a batch is searched
+  // for all fibers of the batch in parallel, the actual assignment runs in fiber order. Clusters that changed
+  // earlier in the same batch are evaluated again, so the result equals the purely sequential assignment.
+  const int batch_size = 256;
+  for (int b=1; b<N; b+=batch_size)
   {
-    vnl_matrix<float> t = T.at(f_indices.at(i));
+    int b_end = std::min(N, b+batch_size);
+    int num_clusters = C.size();
 
-    int min_cluster_index = -1;
-    float min_cluster_distance = 99999;
-    bool flip = false;
+    std::vector< int > snapshot(num_clusters);
+    for (int k=0; k<num_clusters; ++k)
+      snapshot[k] = k;
+
+    std::vector< int > min_cluster_index(b_end-b, -1);
+    std::vector< float > min_cluster_distance(b_end-b, 99999);
+    std::vector< unsigned char > flip(b_end-b, 0);
 
-    for (unsigned int k=0; k<C.size(); ++k)
+#pragma omp parallel for
+    for (int i=b; i<b_end; ++i)
     {
-      vnl_matrix<float> v = C.at(k).h / C.at(k).n;
       bool f = false;
-      float d = 0;
-      for (auto m : m_Metrics)
-        d += m->CalculateDistance(t, v, f);
-      d /= m_Metrics.size();
+      FindClosestCentroid(T.at(f_indices.at(i)), m_MeanPoints.at(f_indices.at(i)), centroids, centroid_means, snapshot, dist_thres, min_cluster_index[i-b], min_cluster_distance[i-b], f);
+      flip[i-b] = f;
+    }
 
-      if (d<min_cluster_distance)
+    std::vector< int > changed;
+    std::vector< bool > is_changed(num_clusters, false);
+    for (int i=b; i<b_end; ++i)
+    {
+      vnl_matrix<float>& t = T.at(f_indices.at(i));
+      const vnl_vector_fixed<float,3>& t_mean = m_MeanPoints.at(f_indices.at(i));
+      int idx = min_cluster_index[i-b];
+      float d = min_cluster_distance[i-b];
+      bool f = flip[i-b];
+
+      if (idx>=0 && is_changed[idx])
       {
-        min_cluster_distance = d;
-        min_cluster_index = k;
-        flip = f;
+        // the closest cluster moved since the start of the batch, search all clusters again
+        std::vector< int > all(C.size());
+        for (unsigned int k=0; k<C.size(); ++k)
+          all[k] = k;
+        idx = -1;
+        d = 99999;
+        f = false;
+        FindClosestCentroid(t, t_mean, centroids, centroid_means, all, dist_thres, idx, d, f);
       }
-    }
+      else
+        FindClosestCentroid(t, t_mean, centroids, centroid_means, changed, dist_thres, idx, d, f);
 
-    if (min_cluster_index>=0 && min_cluster_distance<dist_thres)
-    {
-      C[min_cluster_index].I.push_back(f_indices.at(i));
-      if (!flip)
-        C[min_cluster_index].h += t;
+      if (idx>=0 && d<dist_thres)
+      {
+        C[idx].I.push_back(f_indices.at(i));
+        if (!f)
+          C[idx].h += t;
+        else
+          C[idx].h += t.fliplr();
+        C[idx].n += 1;
+        centroids[idx] = C[idx].h / C[idx].n;
+        centroid_means[idx] = GetMeanPoint(centroids[idx]);
+
+        if (idx<num_clusters && !is_changed[idx])
+        {
+          is_changed[idx] = true;
+          changed.push_back(idx);
+        }
+      }
       else
-        C[min_cluster_index].h += t.fliplr();
-      C[min_cluster_index].n += 1;
-    }
-    else
-    {
-      Cluster c;
-      c.I.push_back(f_indices.at(i));
-      c.h = t;
-      c.n = 1;
-      C.push_back(c);
+      {
+        Cluster c;
+        c.I.push_back(f_indices.at(i));
+        c.h = t;
+        c.n = 1;
+        C.push_back(c);
+        centroids.push_back(t);
+        centroid_means.push_back(t_mean);
+        changed.push_back(C.size()-1);
+      }
     }
   }
 
   if (!distances.empty())
   {
-    std::vector< Cluster > outC;
+    // collected per cluster, so that the order of the output does not depend on the thread scheduling
+    std::vector< std::vector< Cluster > > subC(C.size());
 #pragma omp parallel for
     for (int c=0; c<(int)C.size(); c++)
-    {
+      subC[c] = ClusterStep(C.at(c).I, distances);
 
-      std::vector< Cluster > tempC = ClusterStep(C.at(c).I, distances);
-#pragma omp critical
+    std::vector< Cluster > outC;
+    for (auto& tempC : subC)
       AppendCluster(outC, tempC);
-    }
     return outC;
   }
   else
@@ -224,6 +328,9 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::MergeDuplic
   MITK_INFO << "Merging duplicate clusters with distance threshold " << m_MergeDuplicateThreshold;
 
   std::vector< TractClusteringFilter::Cluster > new_clusters;
+  std::vector< vnl_matrix<float> > centroids;
+  std::vector< vnl_vector_fixed<float,3> > centroid_means;
+  std::vector< int > indices;
   for (Cluster c1 : clusters)
   {
     vnl_matrix<float> t = c1.h / c1.n;
@@ -231,30 +338,15 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::MergeDuplic
     int min_idx = -1;
     float min_d = 99999;
     bool flip = false;
+    FindClosestCentroid(t, GetMeanPoint(t), centroids, centroid_means, indices, m_MergeDuplicateThreshold, min_idx, min_d, flip);
 
-#pragma omp parallel for
-    for (int k2=0; k2<(int)new_clusters.size(); ++k2)
+    if (min_idx<0 || min_d>=m_MergeDuplicateThreshold)
     {
-      Cluster c2 = new_clusters.at(k2);
-      vnl_matrix<float> v = c2.h / c2.n;
-
-      bool f = false;
-      float d = 0;
-      for (auto m : m_Metrics)
-        d += m->CalculateDistance(t, v, f);
-      d /= m_Metrics.size();
-
-#pragma omp critical
-      if (d<min_d && d<m_MergeDuplicateThreshold)
-      {
-        min_d = d;
-        min_idx = k2;
-        flip = f;
-      }
-    }
-
-    if (min_idx<0)
       new_clusters.push_back(c1);
+      centroids.push_back(t);
+      centroid_means.push_back(GetMeanPoint(t));
+      indices.push_back(new_clusters.size()-1);
+    }
     else
     {
       for (int i=0; i<c1.n; ++i)
@@ -266,6 +358,8 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::MergeDuplic
         new_clusters[min_idx].h += c1.h;
       else
         new_clusters[min_idx].h += c1.h.fliplr();
+      centroids[min_idx] = new_clusters[min_idx].h / new_clusters[min_idx].n;
+      centroid_means[min_idx] = GetMeanPoint(centroids[min_idx]);
     }
   }
 
@@ -366,55 +460,54 @@ std::vector<TractClusteringFilter::Cluster> TractClusteringFilter::AddToKnownClu
     C.push_back(c);
   }
 
+  std::vector< vnl_vector_fixed<float,3> > centroid_means;
+  std::vector< int > indices;
+  for (unsigned int i=0; i<centroids.size(); ++i)
+  {
+    centroid_means.push_back(GetMeanPoint(centroids.at(i)));
+    indices.push_back(i);
+  }
+
+  std::vector< int > min_cluster_index(N, -1);
+  std::vector< unsigned char > flip(N, 0);
+
 #pragma omp parallel for
   for (int i=0; i<N; ++i)
   {
-    vnl_matrix<float> t = T.at(f_indices.at(i));
-
-    int min_cluster_index = -1;
-    float min_cluster_distance = 99999;
-    bool flip = false;
+    vnl_matrix<float>& t = T.at(f_indices.at(i));
 
     if (CalcOverlap(t)>=m_OverlapThreshold)
     {
-      int c_idx = 0;
-      for (vnl_matrix<float> centroid : centroids)
+      int idx = -1;
+      float d = 99999;
+      bool f = false;
+      FindClosestCentroid(t, m_MeanPoints.at(f_indices.at(i)), centroids, centroid_means, indices, dist_thres, idx, d, f);
+      if (idx>=0 && d<dist_thres)
       {
-        bool f = false;
-        float d = 0;
-        for (auto m : m_Metrics)
-          d += m->CalculateDistance(t, centroid, f);
-        d /= m_Metrics.size();
-
-        if (d<min_cluster_distance)
-        {
-          min_cluster_distance = d;
-          min_cluster_index = c_idx;
-          flip = f;
-        }
-        ++c_idx;
+        min_cluster_index[i] = idx;
+        flip[i] = f;
       }
     }
+  }
 
-    if (min_cluster_index>=0 && min_cluster_distance<dist_thres)
+  // assign in fiber order, independent of the thread scheduling
+  for (int i=0; i<N; ++i)
+  {
+    int idx = min_cluster_index[i];
+    if (idx>=0)
     {
-#pragma omp critical
-      {
-        C[min_cluster_index].I.push_back(f_indices.at(i));
-        if (!flip)
-          C[min_cluster_index].h += t;
-        else
-          C[min_cluster_index].h += t.fliplr();
-        C[min_cluster_index].n += 1;
-      }
+      vnl_matrix<float>& t = T.at(f_indices.at(i));
+      C[idx].I.push_back(f_indices.at(i));
+      if (!flip[i])
+        C[idx].h += t;
+      else
+        C[idx].h += t.fliplr();
+      C[idx].n += 1;
     }
     else
     {
-#pragma omp critical
-      {
-        no_fit.I.push_back(f_indices.at(i));
-        no_fit.n++;
-      }
+      no_fit.I.push_back(f_indices.at(i));
+      no_fit.n++;
     }
   }
   C.push_back(no_fit);
@@ -442,6 +535,10 @@ void TractClusteringFilter::GenerateData()
     return;
   }
 
+  m_MeanPoints.clear();
+  for (auto& t : T)
+    m_MeanPoints.push_back(GetMeanPoint(t));
+
   std::vector< unsigned int > f_indices;
   for (unsigned int i=0; i<T.size(); ++i)
     f_indices.push_back(i);
@@ -111,6 +111,11 @@ protected:
   std::vector< Cluster > AddToKnownClusters(std::vector< unsigned int > f_indices, std::vector<vnl_matrix<float> > &centroids);
   void AppendCluster(std::vector< Cluster >& a, std::vector< Cluster >&b);
 
+  float CalcDistance(vnl_matrix<float>& t, vnl_matrix<float>& v, bool& flip);  ///< Mean distance over all metrics
+  float CalcLowerBound(const vnl_vector_fixed<float,3>& t_mean, const vnl_vector_fixed<float,3>& v_mean);  ///< Lower bound of CalcDistance() from the mean points of both tracts
+  vnl_vector_fixed<float,3> GetMeanPoint(const vnl_matrix<float>& t) const;
+  void FindClosestCentroid(vnl_matrix<float>& t, const vnl_vector_fixed<float,3>& t_mean, std::vector< vnl_matrix<float> >& centroids, const std::vector< vnl_vector_fixed<float,3> >& centroid_means, const std::vector< int >& indices, float max_distance, int& min_idx, float& min_d, bool& flip);  ///< Updates min_idx, min_d and flip if one of the indexed centroids is closer than min_d. Centroids that cannot be closer than min_d or max_distance are skipped.
+
   TractClusteringFilter();
   virtual ~TractClusteringFilter();
 
@@ -121,6 +126,7 @@ protected:
   std::vector< mitk::FiberBundle::Pointer >   m_OutTractograms;
   std::vector< mitk::FiberBundle::Pointer >   m_OutCentroids;
   std::vector<vnl_matrix<float> >             T;
+  std::vector< vnl_vector_fixed<float,3> >    m_MeanPoints;   ///< mean point of each resampled fiber in T
   unsigned int                                m_MinClusterSize;
   unsigned int                                m_MaxClusters;
   float                                       m_MergeDuplicateThreshold;
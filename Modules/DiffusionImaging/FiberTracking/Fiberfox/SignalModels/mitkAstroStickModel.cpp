@@ -67,7 +67,10 @@ ScalarType AstroStickModel< ScalarType >::SimulateMeasurement(unsigned int dir,
                 dot = GetRandomDirection()*g;
             else
                 dot = m_Sticks[j]*g;
-            signal += std::exp( (double)(b*dot*dot) ); // skip * bVal becaus bVal is already encoded in the dot product (norm of g encodes b-value relative to baseline b-value m_BValue)
+            if (!this->m_ExponentialTable.empty())
+                signal += this->TabulatedExponential( (double)(-b*dot*dot) );
+            else
+                signal += std::exp( (double)(b*dot*dot) ); // skip * bVal becaus bVal is already encoded in the dot product (norm of g encodes b-value relative to baseline b-value m_BValue)
         }
         signal /= m_NumSticks;
     }
@@ -89,34 +92,71 @@ typename AstroStickModel< ScalarType >::GradientType AstroStickModel< ScalarType
 }
 
 template< class ScalarType >
-typename AstroStickModel< ScalarType >::PixelType AstroStickModel< ScalarType >::SimulateMeasurement(GradientType& )
+void AstroStickModel< ScalarType >::SimulateAllMeasurements(GradientType& , ScalarType* signal)
 {
-    PixelType signal;
-    signal.SetSize(this->m_GradientList.size());
-    ScalarType b = -this->m_BValue*m_Diffusivity;
+    const unsigned int n = this->m_GradientList.size();
+    const double* gx = this->m_GradientX.data();
+    const double* gy = this->m_GradientY.data();
+    const double* gz = this->m_GradientZ.data();
+    const double b = this->m_BValue*m_Diffusivity;
+    const bool useTable = !this->m_ExponentialTable.empty();
 
     if (m_RandomizeSticks)
-        m_NumSticks = 30 + this->m_RandGen->GetIntegerVariate()%31;
-
-    for( unsigned int i=0; i<this->m_GradientList.size(); i++)
     {
-        GradientType g = this->m_GradientList[i];
-        if (g.GetNorm()>0.0001)
+        // random stick directions are drawn per gradient direction
+        m_NumSticks = 30 + this->m_RandGen->GetIntegerVariate()%31;
+        for( unsigned int i=0; i<n; i++)
         {
+            signal[i] = 1;
+            if (this->m_GradientList[i].GetNorm()<=0.0001)  // is baseline direction
+                continue;
+
+            signal[i] = 0;
             for (unsigned int j=0; j<m_NumSticks; j++)
             {
-                ScalarType dot = 0;
-                if(m_RandomizeSticks)
-                    dot = GetRandomDirection()*g;
-                else
-                    dot = m_Sticks[j]*g;
-                signal[i] += std::exp( (double)(b*dot*dot) ); // skip * bVal becaus bVal is already encoded in the dot product (norm of g encodes b-value relative to baseline b-value m_BValue)
+                GradientType stick = GetRandomDirection();
+                double dot = stick[0]*gx[i] + stick[1]*gy[i] + stick[2]*gz[i];
+                signal[i] += useTable ? this->TabulatedExponential(b*dot*dot) : std::exp(-b*dot*dot);
             }
             signal[i] /= m_NumSticks;
         }
+        return;
+    }
+
+    // accumulate stick by stick over the contiguous gradient arrays (baseline directions are zero vectors and yield 1)
+    for( unsigned int i=0; i<n; i++)
+        signal[i] = 0;
+    for (unsigned int j=0; j<m_NumSticks; j++)
+    {
+        const double x = m_Sticks[j][0];
+        const double y = m_Sticks[j][1];
+        const double z = m_Sticks[j][2];
+        if (useTable)
+        {
+            for( unsigned int i=0; i<n; i++)
+            {
+                double dot = x*gx[i] + y*gy[i] + z*gz[i];
+                signal[i] += this->TabulatedExponential(b*dot*dot);
+            }
+        }
         else
-            signal[i] = 1;
+        {
+            for( unsigned int i=0; i<n; i++)
+            {
+                double dot = x*gx[i] + y*gy[i] + z*gz[i];
+                signal[i] += std::exp(-b*dot*dot);
+            }
+        }
     }
+    for( unsigned int i=0; i<n; i++)
+        signal[i] /= m_NumSticks;
+}
 
+template< class ScalarType >
+typename AstroStickModel< ScalarType >::PixelType AstroStickModel< ScalarType >::SimulateMeasurement(GradientType& fiberDirection)
+{
+    PixelType signal;
+    signal.SetSize(this->m_GradientList.size());
+    SimulateAllMeasurements(fiberDirection, signal.GetDataPointer());
     return signal;
 }
@@ -38,7 +38,7 @@ public:
     this->m_CompartmentId = model->m_CompartmentId;
     this->m_T1 = model->GetT1();
     this->m_T2 = model->GetT2();
-    this->m_GradientList = model->GetGradientList();
+    this->SetGradientList(model->GetGradientList());
     this->m_VolumeFractionImage = model->GetVolumeFractionImage();
     this->m_RandGen = model->GetRandomGenerator();
 
@@ -47,6 +47,7 @@ public:
     this->m_Sticks = model->GetSticks();
     this->m_NumSticks = model->GetNumSticks();
     this->m_RandomizeSticks = model->GetRandomizeSticks();
+    this->SetLookupTableTolerance(model->GetLookupTableTolerance());
   }
   ~AstroStickModel();
 
@@ -57,6 +58,7 @@ public:
   /** Actual signal generation **/
   PixelType SimulateMeasurement(GradientType& fiberDirection) override;
   ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) override;
+  void SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal) override;
 
   void SetRandomizeSticks(bool randomize=true){ m_RandomizeSticks=randomize; } ///< Random stick configuration in each voxel
   bool GetRandomizeSticks() { return m_RandomizeSticks; }
@@ -64,6 +66,9 @@ public:
   void SetDiffusivity(double diffusivity) { m_Diffusivity = diffusivity; } ///< Scalar diffusion constant
   double GetDiffusivity() { return m_Diffusivity; }
 
+  void SetLookupTableTolerance(double tolerance) { this->InitializeExponentialTable(tolerance); } ///< Use a lookup table with the given maximum signal error instead of exact exponentials (<=0: exact)
+  double GetLookupTableTolerance() { return this->m_ExponentialTableTolerance; }
+
   void SetNumSticks(unsigned int order)
   {
     vnl_matrix<double> sticks;
@@ -52,21 +52,20 @@ ScalarType BallModel< ScalarType >::SimulateMeasurement(unsigned int dir, Gradie
 }
 
 template< class ScalarType >
-typename BallModel< ScalarType >::PixelType BallModel< ScalarType >::SimulateMeasurement(GradientType& )
+void BallModel< ScalarType >::SimulateAllMeasurements(GradientType& , ScalarType* signal)
+{
+    const unsigned int n = this->m_GradientList.size();
+    const double* bVal = this->m_GradientSquaredNorm.data();
+    const double d = this->m_BValue * m_Diffusivity;
+    for( unsigned int i=0; i<n; i++)
+        signal[i] = bVal[i]>0.0001 ? std::exp( -d * bVal[i] ) : 1;
+}
+
+template< class ScalarType >
+typename BallModel< ScalarType >::PixelType BallModel< ScalarType >::SimulateMeasurement(GradientType& fiberDirection)
 {
     PixelType signal;
     signal.SetSize(this->m_GradientList.size());
-
-    for( unsigned int i=0; i<this->m_GradientList.size(); i++)
-    {
-        GradientType g = this->m_GradientList[i];
-        ScalarType bVal = g.GetNorm(); bVal *= bVal;
-
-        if (bVal>0.0001)
-            signal[i] = std::exp( -this->m_BValue * bVal * m_Diffusivity );
-        else
-            signal[i] = 1;
-    }
-
+    SimulateAllMeasurements(fiberDirection, signal.GetDataPointer());
     return signal;
 }
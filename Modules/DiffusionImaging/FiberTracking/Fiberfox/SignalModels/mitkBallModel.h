@@ -37,7 +37,7 @@ public:
     this->m_CompartmentId = model->m_CompartmentId;
     this->m_T1 = model->GetT1();
     this->m_T2 = model->GetT2();
-    this->m_GradientList = model->GetGradientList();
+    this->SetGradientList(model->GetGradientList());
     this->m_VolumeFractionImage = model->GetVolumeFractionImage();
     this->m_RandGen = model->GetRandomGenerator();
 
@@ -54,6 +54,7 @@ public:
   /** Actual signal generation **/
   PixelType SimulateMeasurement(GradientType& fiberDirection) override;
   ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) override;
+  void SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal) override;
 
   void SetDiffusivity(double D) { m_Diffusivity = D; }
   double GetDiffusivity() { return m_Diffusivity; }
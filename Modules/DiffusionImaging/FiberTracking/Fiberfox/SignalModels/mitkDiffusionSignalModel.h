@@ -24,6 +24,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkMersenneTwisterRandomVariateGenerator.h>
 #include <vnl/vnl_vector_fixed.h>
 #include <mitkDiffusionPropertyHelper.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 
 namespace mitk {
 
@@ -41,6 +44,8 @@ public:
         : m_T2(100)
         , m_T1(0)
         , m_BValue(1000)
+        , m_ExponentialTableScale(0)
+        , m_ExponentialTableTolerance(0)
     {}
     ~DiffusionSignalModel(){}
 
@@ -55,6 +60,14 @@ public:
     virtual PixelType SimulateMeasurement(GradientType& fiberDirection) = 0;
     virtual ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) = 0;
 
+    /** Generates the signal of all gradient directions at once and writes it to the contiguous array signal (one value per gradient direction).
+     *  Subclasses override this with loops over the contiguous gradient component arrays. **/
+    virtual void SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal)
+    {
+      for (unsigned int i=0; i<m_GradientList.size(); ++i)
+        signal[i] = SimulateMeasurement(i, fiberDirection);
+    }
+
     void SetGradientList(DPH::GradientDirectionsContainerType* gradients)
     {
       m_GradientList.clear();
@@ -67,9 +80,14 @@ public:
         g_itk[2] = g_vnl[2];
         m_GradientList.push_back(g_itk);
       }
+      UpdateGradientArrays();
     }
 
-    void SetGradientList(GradientListType gradientList) { this->m_GradientList = gradientList; }
+    void SetGradientList(GradientListType gradientList)
+    {
+      this->m_GradientList = gradientList;
+      UpdateGradientArrays();
+    }
     GradientListType GetGradientList(){ return m_GradientList; }
     GradientType GetGradientDirection(int i) { return m_GradientList.at(i); }
 
@@ -99,12 +117,68 @@ public:
 
 protected:
 
+    /** Copies the gradient directions into separate contiguous component arrays. Baseline directions are stored as zero vectors. **/
+    void UpdateGradientArrays()
+    {
+      unsigned int n = m_GradientList.size();
+      m_GradientX.assign(n, 0.0);
+      m_GradientY.assign(n, 0.0);
+      m_GradientZ.assign(n, 0.0);
+      m_GradientSquaredNorm.assign(n, 0.0);
+      for (unsigned int i=0; i<n; ++i)
+      {
+        const GradientType& g = m_GradientList[i];
+        m_GradientSquaredNorm[i] = g.GetSquaredNorm();
+        if (g.GetNorm()>0.0001)
+        {
+          m_GradientX[i] = g[0];
+          m_GradientY[i] = g[1];
+          m_GradientZ[i] = g[2];
+        }
+      }
+    }
+
+    /** Tabulates e^(-x) for the lookup table accelerated models. The table is sampled densely enough for the linear interpolation error
+     *  to stay below the given tolerance and ends where e^(-x) drops below the tolerance. A tolerance <=0 clears the table. **/
+    void InitializeExponentialTable(double tolerance)
+    {
+      m_ExponentialTable.clear();
+      m_ExponentialTableTolerance = tolerance;
+      if (tolerance<=0)
+        return;
+
+      // linear interpolation error <= step²/8 * max|(e^(-x))''| = step²/8
+      double step = std::sqrt(8.0*tolerance);
+      unsigned int n = static_cast<unsigned int>(std::ceil(-std::log(std::min(tolerance, 0.5))/step)) + 2;
+      m_ExponentialTableScale = 1.0/step;
+      for (unsigned int i=0; i<n; ++i)
+        m_ExponentialTable.push_back(std::exp(-static_cast<double>(i)*step));
+    }
+
+    /** Linearly interpolated e^(-x) for x>=0 from the table created by InitializeExponentialTable. **/
+    double TabulatedExponential(double x) const
+    {
+      double pos = x*m_ExponentialTableScale;
+      if (pos>=m_ExponentialTable.size()-1)
+        return 0;
+      unsigned int i = static_cast<unsigned int>(pos);
+      double w = pos-i;
+      return m_ExponentialTable[i] + w*(m_ExponentialTable[i+1]-m_ExponentialTable[i]);
+    }
+
     GradientListType            m_GradientList;         ///< Diffusion gradient direction container
     double                      m_T2;                   ///< Tissue specific transversal relaxation time
     double                      m_T1;                   ///< Tissue specific longitudinal relaxation time
     ItkDoubleImgType::Pointer   m_VolumeFractionImage;  ///< Tissue specific volume fraction for each voxel (only relevant for non fiber compartments)
     ItkRandGenType::Pointer     m_RandGen;              ///< Random number generator
     double                      m_BValue;
+    std::vector< double >       m_GradientX;            ///< x-components of the gradient directions (zero for baseline directions)
+    std::vector< double >       m_GradientY;            ///< y-components of the gradient directions (zero for baseline directions)
+    std::vector< double >       m_GradientZ;            ///< z-components of the gradient directions (zero for baseline directions)
+    std::vector< double >       m_GradientSquaredNorm;  ///< Squared norm of the gradient directions (b-value relative to m_BValue)
+    std::vector< double >       m_ExponentialTable;     ///< Samples of e^(-x) used by the lookup table accelerated models
+    double                      m_ExponentialTableScale;    ///< Inverse sample distance of m_ExponentialTable
+    double                      m_ExponentialTableTolerance;  ///< Maximum error of the tabulated exponential (<=0: no table)
 };
 
 }
@@ -37,7 +37,7 @@ public:
     this->m_CompartmentId = model->m_CompartmentId;
     this->m_T1 = model->GetT1();
     this->m_T2 = model->GetT2();
-    this->m_GradientList = model->GetGradientList();
+    this->SetGradientList(model->GetGradientList());
     this->m_VolumeFractionImage = model->GetVolumeFractionImage();
     this->m_RandGen = model->GetRandomGenerator();
   }
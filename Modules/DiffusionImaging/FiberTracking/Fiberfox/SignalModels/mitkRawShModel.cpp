@@ -339,6 +339,15 @@ ScalarType RawShModel< ScalarType >::SimulateMeasurement(unsigned int dir, Gradi
   return signal;
 }
 
+template< class ScalarType >
+void RawShModel< ScalarType >::SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal)
+{
+  // the per-direction SimulateMeasurement draws a new kernel for every direction
+  PixelType allSignals = SimulateMeasurement(fiberDirection);
+  for (unsigned int i=0; i<allSignals.GetSize(); ++i)
+    signal[i] = allSignals[i];
+}
+
 template< class ScalarType >
 typename RawShModel< ScalarType >::PixelType RawShModel< ScalarType >::SimulateMeasurement(GradientType& fiberDirection)
 {
@@ -39,7 +39,7 @@ public:
     this->m_CompartmentId = model->m_CompartmentId;
     this->m_T1 = model->GetT1();
     this->m_T2 = model->GetT2();
-    this->m_GradientList = model->GetGradientList();
+    this->SetGradientList(model->GetGradientList());
     this->m_VolumeFractionImage = model->GetVolumeFractionImage();
     this->m_RandGen = model->GetRandomGenerator();
 
@@ -65,6 +65,7 @@ public:
   /** Actual signal generation **/
   PixelType SimulateMeasurement(GradientType& fiberDirection) override;
   ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) override;
+  void SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal) override;  ///< uses one random kernel for all gradient directions
 
   bool SetShCoefficients(vnl_vector< double > shCoefficients, double b0);
   vnl_matrix<double> SetFiberDirection(GradientType& fiberDirection);
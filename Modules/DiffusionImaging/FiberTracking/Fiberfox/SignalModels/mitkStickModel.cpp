@@ -44,6 +44,8 @@ ScalarType StickModel< ScalarType >::SimulateMeasurement(unsigned int dir, Gradi
   if (g.GetNorm()>0.0001)
   {
     ScalarType dot = fiberDirection*g;
+    if (!this->m_ExponentialTable.empty())
+      return this->TabulatedExponential( this->m_BValue*m_Diffusivity*dot*dot );
     signal = std::exp( -this->m_BValue*m_Diffusivity*dot*dot ); // skip * bVal becaus bVal is already encoded in the dot product (norm of g encodes b-value relative to baseline b-value m_BValue)
   }
   else
@@ -53,22 +55,41 @@ ScalarType StickModel< ScalarType >::SimulateMeasurement(unsigned int dir, Gradi
 }
 
 template< class ScalarType >
-typename StickModel< ScalarType >::PixelType StickModel< ScalarType >::SimulateMeasurement(GradientType &fiberDirection)
+void StickModel< ScalarType >::SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal)
 {
-  PixelType signal;
-  signal.SetSize(this->m_GradientList.size());
-
-  for( unsigned int i=0; i<this->m_GradientList.size(); i++)
+  const unsigned int n = this->m_GradientList.size();
+  const double* gx = this->m_GradientX.data();
+  const double* gy = this->m_GradientY.data();
+  const double* gz = this->m_GradientZ.data();
+  const double x = fiberDirection[0];
+  const double y = fiberDirection[1];
+  const double z = fiberDirection[2];
+  const double b = this->m_BValue*m_Diffusivity;
+
+  // baseline directions are zero vectors in the component arrays and yield e^0 = 1
+  if (this->m_ExponentialTable.empty())
   {
-    GradientType g = this->m_GradientList[i];
-    if (g.GetNorm()>0.0001)
+    for (unsigned int i=0; i<n; ++i)
     {
-      ScalarType dot = fiberDirection*g;
-      signal[i] = std::exp( -this->m_BValue*m_Diffusivity*dot*dot ); // skip * bVal becaus bVal is already encoded in the dot product (norm of g encodes b-value relative to baseline b-value m_BValue)
+      double dot = x*gx[i] + y*gy[i] + z*gz[i];
+      signal[i] = std::exp( -b*dot*dot );
     }
-    else
-      signal[i] = 1;
   }
+  else
+  {
+    for (unsigned int i=0; i<n; ++i)
+    {
+      double dot = x*gx[i] + y*gy[i] + z*gz[i];
+      signal[i] = this->TabulatedExponential( b*dot*dot );
+    }
+  }
+}
 
+template< class ScalarType >
+typename StickModel< ScalarType >::PixelType StickModel< ScalarType >::SimulateMeasurement(GradientType &fiberDirection)
+{
+  PixelType signal;
+  signal.SetSize(this->m_GradientList.size());
+  SimulateAllMeasurements(fiberDirection, signal.GetDataPointer());
   return signal;
 }
@@ -37,12 +37,13 @@ public:
     this->m_CompartmentId = model->m_CompartmentId;
     this->m_T1 = model->GetT1();
     this->m_T2 = model->GetT2();
-    this->m_GradientList = model->GetGradientList();
+    this->SetGradientList(model->GetGradientList());
     this->m_VolumeFractionImage = model->GetVolumeFractionImage();
     this->m_RandGen = model->GetRandomGenerator();
 
     this->m_BValue = model->GetBvalue();
     this->m_Diffusivity = model->GetDiffusivity();
+    this->SetLookupTableTolerance(model->GetLookupTableTolerance());
   }
   ~StickModel();
 
@@ -53,10 +54,14 @@ public:
   /** Actual signal generation **/
   PixelType SimulateMeasurement(GradientType& fiberDirection) override;
   ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) override;
+  void SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal) override;
 
   void SetDiffusivity(double diffusivity) { m_Diffusivity = diffusivity; } ///< Scalar diffusion constant
   double GetDiffusivity() { return m_Diffusivity; }
 
+  void SetLookupTableTolerance(double tolerance) { this->InitializeExponentialTable(tolerance); } ///< Use a lookup table with the given maximum signal error instead of exact exponentials (<=0: exact)
+  double GetLookupTableTolerance() { return this->m_ExponentialTableTolerance; }
+
 protected:
 
   double   m_Diffusivity;  ///< Scalar diffusion constant
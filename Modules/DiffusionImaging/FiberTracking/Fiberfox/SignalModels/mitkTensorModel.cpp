@@ -80,45 +80,41 @@ ScalarType TensorModel< ScalarType >::SimulateMeasurement(unsigned int dir, Grad
 }
 
 template< class ScalarType >
-typename TensorModel< ScalarType >::PixelType TensorModel< ScalarType >::SimulateMeasurement(GradientType& fiberDirection)
+void TensorModel< ScalarType >::SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal)
 {
-  PixelType signal; signal.SetSize(this->m_GradientList.size()); signal.Fill(0.0);
-
-  ItkTensorType tensor; tensor.Fill(0.0);
   vnl_vector_fixed<double, 3> axis = itk::CrossProduct(m_KernelDirection, fiberDirection).GetVnlVector(); axis.normalize();
   vnl_quaternion<double> rotation(axis, acos(m_KernelDirection*fiberDirection));
   rotation.normalize();
   vnl_matrix_fixed<double, 3, 3> matrix = rotation.rotation_matrix_transpose();
 
   vnl_matrix_fixed<double, 3, 3> tensorMatrix = matrix.transpose()*m_KernelTensorMatrix*matrix;
-  tensor[0] = tensorMatrix[0][0]; tensor[1] = tensorMatrix[0][1]; tensor[2] = tensorMatrix[0][2];
-  tensor[3] = tensorMatrix[1][1]; tensor[4] = tensorMatrix[1][2]; tensor[5] = tensorMatrix[2][2];
-
-  for( unsigned int i=0; i<this->m_GradientList.size(); i++)
+  const double dxx = tensorMatrix[0][0];
+  const double dxy = 2*tensorMatrix[0][1];
+  const double dxz = 2*tensorMatrix[0][2];
+  const double dyy = tensorMatrix[1][1];
+  const double dyz = 2*tensorMatrix[1][2];
+  const double dzz = tensorMatrix[2][2];
+
+  const unsigned int n = this->m_GradientList.size();
+  const double* gx = this->m_GradientX.data();
+  const double* gy = this->m_GradientY.data();
+  const double* gz = this->m_GradientZ.data();
+  for( unsigned int i=0; i<n; i++)
   {
-    GradientType g = this->m_GradientList[i];
-    if (g.GetNorm()>0.0001)
-    {
-      // calc g^T * D * g
-      itk::DiffusionTensor3D< ScalarType > S;
-      S[0] = g[0]*g[0];
-      S[1] = g[1]*g[0];
-      S[2] = g[2]*g[0];
-      S[3] = g[1]*g[1];
-      S[4] = g[2]*g[1];
-      S[5] = g[2]*g[2];
-
-      ScalarType D_scalar = tensor[0]*S[0] + tensor[1]*S[1] + tensor[2]*S[2] +
-                     tensor[1]*S[1] + tensor[3]*S[3] + tensor[4]*S[4] +
-                     tensor[2]*S[2] + tensor[4]*S[4] + tensor[5]*S[5];
-
-      // check for corrupted tensor and generate signal
-      if (D_scalar>=0)
-        signal[i] = std::exp ( -this->m_BValue * D_scalar ); // skip * bVal becaus bVal is already encoded in g^T*g (norm of g encodes b-value relative to baseline b-value m_BValue)
-    }
-    else
-      signal[i] = 1;
+    // g^T * D * g, baseline directions are zero vectors and yield e^0 = 1
+    double D_scalar = dxx*gx[i]*gx[i] + dyy*gy[i]*gy[i] + dzz*gz[i]*gz[i] +
+                      dxy*gx[i]*gy[i] + dxz*gx[i]*gz[i] + dyz*gy[i]*gz[i];
+
+    // check for corrupted tensor and generate signal
+    signal[i] = D_scalar>=0 ? std::exp( -this->m_BValue * D_scalar ) : 0;
   }
+}
 
+template< class ScalarType >
+typename TensorModel< ScalarType >::PixelType TensorModel< ScalarType >::SimulateMeasurement(GradientType& fiberDirection)
+{
+  PixelType signal;
+  signal.SetSize(this->m_GradientList.size());
+  SimulateAllMeasurements(fiberDirection, signal.GetDataPointer());
   return signal;
 }
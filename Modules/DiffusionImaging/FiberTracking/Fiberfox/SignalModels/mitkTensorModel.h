@@ -38,7 +38,7 @@ public:
     this->m_CompartmentId = model->m_CompartmentId;
     this->m_T1 = model->GetT1();
     this->m_T2 = model->GetT2();
-    this->m_GradientList = model->GetGradientList();
+    this->SetGradientList(model->GetGradientList());
     this->m_VolumeFractionImage = model->GetVolumeFractionImage();
     this->m_RandGen = model->GetRandomGenerator();
 
@@ -56,6 +56,7 @@ public:
   /** Actual signal generation **/
   PixelType SimulateMeasurement(GradientType& fiberDirection) override;
   ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) override;
+  void SimulateAllMeasurements(GradientType& fiberDirection, ScalarType* signal) override;
 
   void SetDiffusivity1(double d1){ m_KernelTensorMatrix[0][0] = d1; }
   void SetDiffusivity2(double d2){ m_KernelTensorMatrix[1][1] = d2; }
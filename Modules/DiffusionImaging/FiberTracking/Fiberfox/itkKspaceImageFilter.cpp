@@ -22,6 +22,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cstdio>
 #include <cstdlib>
 #include <math.h>
+#include <cmath>
+#include <algorithm>
+#include <complex>
 
 #include "itkKspaceImageFilter.h"
 #include <itkImageRegionConstIterator.h>
@@ -32,6 +35,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkFastSpinEcho.h>
 #include <mitkDiffusionFunctionCollection.h>
 #include <itkImageFileWriter.h>
+#include <vnl/algo/vnl_fft_1d.h>
 
 namespace itk {
 
@@ -42,6 +46,8 @@ namespace itk {
     , m_SpikesPerSlice(0)
     , m_IsBaseline(true)
     , m_StoreTimings(false)
+    , m_UseExactDft(false)
+    , m_KspaceEngine(EXACT_DFT)
   {
     m_DiffusionGradientDirection.Fill(0.0);
     m_CoilPosition.Fill(0.0);
@@ -70,6 +76,25 @@ namespace itk {
     yMaxFov_half = (yMaxFov-1)/2;
     numPix = kxMax*kyMax;
 
+    // precalculate shifts for DFT
+    if (static_cast<int>(xMax)%2==1)
+        x_shift = (xMax-1)/2;
+    else
+        x_shift = xMax/2;
+    if (static_cast<int>(yMax)%2==1)
+        y_shift = (yMax-1)/2;
+    else
+        y_shift = yMax/2;
+
+    if (static_cast<int>(kxMax)%2==1)
+        kx_shift = (kxMax-1)/2;
+    else
+        kx_shift = kxMax/2;
+    if (static_cast<int>(kyMax)%2==1)
+        ky_shift = (kyMax-1)/2;
+    else
+        ky_shift = kyMax/2;
+
     float ringing_factor = static_cast<float>(m_Parameters->m_SignalGen.m_ZeroRinging)/100.0;
     ringing_lines_x = static_cast<int>(ceil(kxMax/2 * ringing_factor));
     ringing_lines_y = static_cast<int>(ceil(kyMax/2 * ringing_factor));
@@ -233,6 +258,538 @@ namespace itk {
 
         m_T1Relax.push_back(relaxation);
       }
+
+    // choose how the k-space samples are calculated
+    m_RowTransforms.clear();
+    m_LinePhases.clear();
+    m_NufftSamples.clear();
+    bool eddy = m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline;
+    bool distortions = m_Parameters->m_Misc.m_DoAddDistortions && (m_MovedFmap.IsNotNull() || m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull());
+    if (m_UseExactDft)
+      m_KspaceEngine = EXACT_DFT;
+    else if (!eddy && !distortions)
+      InitializeSeparableDft();
+    else
+      InitializeNufft();
+  }
+
+  template< class ScalarType >
+  void KspaceImageFilter< ScalarType >
+  ::GetSampleParameters(int& tick, itk::Index< 2 >& kIdx, float& t, float& tRf, float& eddyDecay, float& kx, float& ky, std::vector< float >& relaxFactor)
+  {
+    // get current k-space index (depends on the chosen k-space readout scheme)
+    kIdx = m_ReadoutScheme->GetActualKspaceIndex(tick);
+
+    // we have to adjust the ticks to obtain correct times since the DFT is not completely symmetric in the even  number of lines case
+    if (static_cast<int>(kyMax)%2 == 0 && !m_Parameters->m_SignalGen.m_ReversePhase)
+    {
+      tick += kxMax;
+      tick %= static_cast<int>(numPix);
+    }
+
+    // time from maximum echo
+    t = m_ReadoutScheme->GetTimeFromMaxEcho(tick);
+
+    // calculate eddy current decay factor
+    eddyDecay = 0;
+    if ( m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline)
+    {
+      // time passed since k-space readout started
+      float tRead = m_ReadoutScheme->GetTimeFromLastDiffusionGradient(tick);
+      eddyDecay = std::exp(-tRead/m_Parameters->m_SignalGen.m_Tau ) * t/1000; // time in seconds here
+    }
+
+    // calcualte signal relaxation factors
+    tRf = 0;
+    relaxFactor.clear();
+    if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
+    {
+      // time passes since application of the RF pulse
+      tRf = m_ReadoutScheme->GetTimeFromRf(tick);
+
+      for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
+      {
+        // account for T2 relaxation (how much transverse magnetization is left since applicatiohn of RF pulse?)
+        relaxFactor.push_back(m_T1Relax[i] * std::exp(-tRf/m_T2[i] -fabs(t)/ m_Parameters->m_SignalGen.m_tInhom));
+      }
+    }
+
+    // shift k for DFT: (0 -- N) --> (-N/2 -- N/2)
+    kx = kIdx[0] - kx_shift;
+    ky = kIdx[1] - ky_shift;
+
+    // add ghosting by adding gradient delay induced offset
+    if (m_Parameters->m_Misc.m_DoAddGhosts)
+    {
+      if (kIdx[1]%2 == 1)
+        kx -= m_Parameters->m_SignalGen.m_KspaceLineOffset;
+      else
+        kx += m_Parameters->m_SignalGen.m_KspaceLineOffset;
+    }
+
+    // pull stuff out of inner loop
+    t /= 1000; // time in seconds
+    kx /= xMax;
+    ky /= yMaxFov;
+  }
+
+  template< class ScalarType >
+  std::vector< std::vector< double > > KspaceImageFilter< ScalarType >::GetWeightedCompartmentSignals()
+  {
+    int nx = static_cast<int>(xMax);
+    int ny = static_cast<int>(yMax);
+    unsigned int numSignals = m_Parameters->m_SignalGen.m_DoSimulateRelaxation ? m_CompartmentImages.size() : 1;
+    std::vector< std::vector< double > > signals(numSignals, std::vector< double >(nx*ny, 0));
+
+    for (int y=0; y<ny; ++y)
+      for (int x=0; x<nx; ++x)
+      {
+        typename InputImageType::IndexType input_idx;
+        input_idx[0] = x;
+        input_idx[1] = y;
+
+        double weight = m_Parameters->m_SignalGen.m_SignalScale;
+        if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
+        {
+          VectorType pos;
+          pos[0] = x - x_shift; pos[1] = y - y_shift; pos[2] = m_Z;
+          pos = m_Transform*pos;
+          weight *= CoilSensitivity(pos);
+        }
+
+        for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
+          signals[i % numSignals][y*nx + x] += m_CompartmentImages[i]->GetPixel(input_idx) * weight;
+      }
+
+    return signals;
+  }
+
+  template< class ScalarType >
+  void KspaceImageFilter< ScalarType >::InitializeSeparableDft()
+  {
+    // without per-pixel phase, exp(i2pi(kx*x+ky*y)) factorizes and the DFT of each image row can be shared by all k-space lines
+    // (a plain FFT does not fit since the k-space is cropped, the phase FOV may be reduced and ghosts shift kx off the grid)
+    m_KspaceEngine = SEPARABLE_DFT;
+    std::vector< std::vector< double > > signals = GetWeightedCompartmentSignals();
+    int nx = static_cast<int>(xMax);
+    int ny = static_cast<int>(yMax);
+    int nkx = static_cast<int>(kxMax);
+    int nky = static_cast<int>(kyMax);
+    int parities = m_Parameters->m_Misc.m_DoAddGhosts ? 2 : 1;
+
+    m_RowTransforms.assign(signals.size()*parities, std::vector< std::complex<double> >(nkx*ny));
+    for (int p=0; p<parities; ++p)
+    {
+      // ghosts: even lines are shifted by +offset, odd lines by -offset
+      double offset = 0;
+      if (m_Parameters->m_Misc.m_DoAddGhosts)
+        offset = p==0 ? m_Parameters->m_SignalGen.m_KspaceLineOffset : -m_Parameters->m_SignalGen.m_KspaceLineOffset;
+
+#pragma omp parallel for
+      for (int k=0; k<nkx; ++k)
+      {
+        double kx = (k - kx_shift + offset)/xMax;
+        std::vector< std::complex<double> > phases(nx);
+        for (int x=0; x<nx; ++x)
+          phases[x] = std::exp(std::complex<double>(0, itk::Math::twopi * kx * (x - x_shift)));
+
+        for (unsigned int i=0; i<signals.size(); ++i)
+          for (int y=0; y<ny; ++y)
+          {
+            std::complex<double> r(0,0);
+            const double* row = &signals[i][y*nx];
+            for (int x=0; x<nx; ++x)
+              r += row[x]*phases[x];
+            m_RowTransforms[i*parities + p][k*ny + y] = r;
+          }
+      }
+    }
+
+    // aliasing (folding y into the reduced FOV) does not change exp(i2pi*ky*y) since ky*yMaxFov is an integer
+    m_LinePhases.resize(nky*ny);
+    for (int k=0; k<nky; ++k)
+    {
+      double ky = (k - ky_shift)/yMaxFov;
+      for (int y=0; y<ny; ++y)
+        m_LinePhases[k*ny + y] = std::exp(std::complex<double>(0, itk::Math::twopi * ky * (y - y_shift)));
+    }
+  }
+
+  template< class ScalarType >
+  vcl_complex<ScalarType> KspaceImageFilter< ScalarType >::CalculateSeparableDftSample(const itk::Index< 2 >& kIdx, const std::vector< float >& relaxFactor)
+  {
+    int ny = static_cast<int>(yMax);
+    int parities = m_Parameters->m_Misc.m_DoAddGhosts ? 2 : 1;
+    int p = parities==2 ? kIdx[1]%2 : 0;
+    unsigned int numSignals = m_RowTransforms.size()/parities;
+    const std::complex<double>* lines = &m_LinePhases[kIdx[1]*ny];
+
+    std::complex<double> s(0,0);
+    for (unsigned int i=0; i<numSignals; ++i)
+    {
+      const std::complex<double>* rows = &m_RowTransforms[i*parities + p][kIdx[0]*ny];
+      std::complex<double> r(0,0);
+      for (int y=0; y<ny; ++y)
+        r += rows[y]*lines[y];
+
+      if (relaxFactor.empty())
+        s += r;
+      else
+        s += r*static_cast<double>(relaxFactor[i]);
+    }
+    return vcl_complex<ScalarType>(s.real(), s.imag());
+  }
+
+  template< class ScalarType >
+  vcl_complex<ScalarType> KspaceImageFilter< ScalarType >::CalculateDftSample(float kx, float ky, float t, float eddyDecay, const std::vector< float >& relaxFactor)
+  {
+    typedef ImageRegionConstIterator< InputImageType > InputIteratorType;
+
+    vcl_complex<ScalarType> s(0,0);
+    InputIteratorType it(m_CompartmentImages[0], m_CompartmentImages[0]->GetLargestPossibleRegion() );
+    while( !it.IsAtEnd() )
+    {
+      typename InputImageType::IndexType input_idx = it.GetIndex();
+
+      // shift x,y for DFT: (0 -- N) --> (-N/2 -- N/2)
+      float x = input_idx[0] - x_shift;
+      float y = input_idx[1] - y_shift;
+
+      // sum compartment signals and simulate relaxation
+      ScalarType f_real = 0;
+      for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
+        if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
+          f_real += m_CompartmentImages[i]->GetPixel(input_idx) * relaxFactor[i];
+        else
+          f_real += m_CompartmentImages[i]->GetPixel(input_idx);
+
+      // vector from image center to current position (in meter)
+      // only necessary for eddy currents and non-constant coil sensitivity
+      VectorType pos;
+      if ((m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline) ||
+          m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
+      {
+        pos[0] = x; pos[1] = y; pos[2] = m_Z;
+        pos = m_Transform*pos;
+      }
+
+      if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
+        f_real *= CoilSensitivity(pos);
+
+      // simulate eddy currents and other distortions
+      float phi = 0;   // phase shift
+      if (  m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline)
+      {
+        // duration (tRead) already included in "eddyDecay"
+        phi += (m_DiffusionGradientDirection[0]*pos[0]+m_DiffusionGradientDirection[1]*pos[1]+m_DiffusionGradientDirection[2]*pos[2]) * eddyDecay;
+      }
+
+      // simulate distortions
+      if (m_Parameters->m_Misc.m_DoAddDistortions)
+      {
+        if (m_MovedFmap.IsNotNull())    // if we have headmotion, use moved map
+          phi += m_MovedFmap->GetPixel(input_idx) * t;
+        else if (m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull())
+        {
+          itk::Image<float, 3>::IndexType index; index[0] = input_idx[0]; index[1] = input_idx[1]; index[2] = m_Zidx;
+          phi += m_Parameters->m_SignalGen.m_FrequencyMap->GetPixel(index) * t;
+        }
+      }
+
+      // if signal comes from outside FOV, mirror it back (wrap-around artifact - aliasing
+      if (m_Parameters->m_Misc.m_DoAddAliasing)
+      {
+        if (y<-yMaxFov_half)
+          y += yMaxFov;
+        else if (y>yMaxFov_half)
+          y -= yMaxFov;
+      }
+
+      // actual DFT term
+      vcl_complex<ScalarType> f(f_real * m_Parameters->m_SignalGen.m_SignalScale, 0);
+      s += f * std::exp( std::complex<ScalarType>(0, itk::Math::twopi * (kx*x + ky*y + phi )) );
+
+      ++it;
+    }
+    return s;
+  }
+
+  template< class ScalarType >
+  double KspaceImageFilter< ScalarType >::BesselI0(double x)
+  {
+    // power series, converges quickly for the arguments used by the gridding kernel
+    double sum = 1;
+    double term = 1;
+    for (int k=1; k<100; ++k)
+    {
+      term *= (x/(2*k))*(x/(2*k));
+      sum += term;
+      if (term < 1e-17*sum)
+        break;
+    }
+    return sum;
+  }
+
+  template< class ScalarType >
+  double KspaceImageFilter< ScalarType >::KaiserBessel(double u, int width, double beta)
+  {
+    double r = 2*u/width;
+    if (r*r > 1)
+      return 0;
+    return BesselI0(beta*std::sqrt(1-r*r));
+  }
+
+  template< class ScalarType >
+  double KspaceImageFilter< ScalarType >::KaiserBesselTransform(double nu, int width, double beta)
+  {
+    // continuous Fourier transform of the kernel (nu in cycles per grid point)
+    double z = beta*beta - (itk::Math::pi*width*nu)*(itk::Math::pi*width*nu);
+    if (z>0)
+    {
+      z = std::sqrt(z);
+      return width*std::sinh(z)/z;
+    }
+    else if (z<0)
+    {
+      z = std::sqrt(-z);
+      return width*std::sin(z)/z;
+    }
+    return width;
+  }
+
+  template< class ScalarType >
+  int KspaceImageFilter< ScalarType >::GetFftSize(int n)
+  {
+    for (;; ++n)
+    {
+      int r = n;
+      while (r%2==0) r /= 2;
+      while (r%3==0) r /= 3;
+      while (r%5==0) r /= 5;
+      if (r==1)
+        return n;
+    }
+  }
+
+  template< class ScalarType >
+  void KspaceImageFilter< ScalarType >::InitializeNufft()
+  {
+    typedef std::complex<double> ComplexType;
+
+    // Kaiser-Bessel gridding on a twofold oversampled grid (kernel parameters after Beatty et al., IEEE TMI 24(6), 2005)
+    const int width = 6;
+    const int taps = width+1;
+    const double oversampling = 2;
+    const double beta = itk::Math::pi*std::sqrt(width*width/(oversampling*oversampling)*(oversampling-0.5)*(oversampling-0.5)-0.8);
+
+    int nx = static_cast<int>(xMax);
+    int ny = static_cast<int>(yMax);
+    int numSamples = static_cast<int>(numPix);
+    int gx = GetFftSize(static_cast<int>(oversampling*nx));
+    int gy = GetFftSize(static_cast<int>(oversampling*ny));
+
+    // the eddy current phase is linear in x and y and thus only shifts the k-space position of each sample (plus a constant phase)
+    double eddyX = 0;
+    double eddyY = 0;
+    double eddyZ = 0;
+    if (m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline)
+      for (int r=0; r<3; ++r)
+      {
+        eddyX += m_DiffusionGradientDirection[r]*m_Transform[r][0];
+        eddyY += m_DiffusionGradientDirection[r]*m_Transform[r][1];
+        eddyZ += m_DiffusionGradientDirection[r]*m_Transform[r][2]*m_Z;
+      }
+
+    // off-resonance frequencies, centered so that only their spread has to be interpolated over time
+    std::vector< double > frequencies;
+    double centerFrequency = 0;
+    double frequencySpread = 0;
+    if (m_Parameters->m_Misc.m_DoAddDistortions && (m_MovedFmap.IsNotNull() || m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull()))
+    {
+      frequencies.resize(nx*ny);
+      for (int y=0; y<ny; ++y)
+        for (int x=0; x<nx; ++x)
+        {
+          if (m_MovedFmap.IsNotNull())    // if we have headmotion, use moved map
+          {
+            typename InputImageType::IndexType index; index[0] = x; index[1] = y;
+            frequencies[y*nx + x] = m_MovedFmap->GetPixel(index);
+          }
+          else
+          {
+            itk::Image<float, 3>::IndexType index; index[0] = x; index[1] = y; index[2] = m_Zidx;
+            frequencies[y*nx + x] = m_Parameters->m_SignalGen.m_FrequencyMap->GetPixel(index);
+          }
+        }
+      double minFrequency = *std::min_element(frequencies.begin(), frequencies.end());
+      double maxFrequency = *std::max_element(frequencies.begin(), frequencies.end());
+      centerFrequency = (minFrequency+maxFrequency)/2;
+      frequencySpread = (maxFrequency-minFrequency)/2;
+    }
+
+    // sample positions on the oversampled grid and interpolation kernel weights
+    std::vector< int > sampleIndices(numSamples);
+    std::vector< double > sampleTimes(numSamples);
+    std::vector< double > samplePhases(numSamples);
+    std::vector< std::vector< float > > sampleRelaxation(numSamples);
+    std::vector< int > gridStartX(numSamples);
+    std::vector< int > gridStartY(numSamples);
+    std::vector< double > kernelX(numSamples*taps);
+    std::vector< double > kernelY(numSamples*taps);
+    for (int i=0; i<numSamples; ++i)
+    {
+      int tick = i;
+      itk::Index< 2 > kIdx;
+      float t, tRf, eddyDecay, kx, ky;
+      GetSampleParameters(tick, kIdx, t, tRf, eddyDecay, kx, ky, sampleRelaxation[i]);
+
+      sampleIndices[i] = static_cast<int>(kIdx[1]*kxMax + kIdx[0]);
+      sampleTimes[i] = t;
+      samplePhases[i] = eddyDecay*eddyZ + t*centerFrequency;
+
+      double u = (kx + eddyDecay*eddyX)*gx;
+      double v = (ky + eddyDecay*eddyY)*gy;
+      gridStartX[i] = static_cast<int>(std::ceil(u - width/2.0));
+      gridStartY[i] = static_cast<int>(std::ceil(v - width/2.0));
+      for (int j=0; j<taps; ++j)
+      {
+        kernelX[i*taps + j] = KaiserBessel(u - gridStartX[i] - j, width, beta);
+        kernelY[i*taps + j] = KaiserBessel(v - gridStartY[i] - j, width, beta);
+      }
+    }
+
+    // Chebyshev nodes in time, the off-resonance phase exp(i2pi*t*f) is interpolated between them (barycentric formula)
+    double tMin = *std::min_element(sampleTimes.begin(), sampleTimes.end());
+    double tMax = *std::max_element(sampleTimes.begin(), sampleTimes.end());
+    double bandwidth = itk::Math::pi*(tMax-tMin)*frequencySpread;   // maximum phase deviation from the center of the readout
+    int numNodes = 1;
+    if (bandwidth>1e-6)
+      numNodes = static_cast<int>(std::ceil(bandwidth + 2*std::cbrt(bandwidth))) + 4;
+
+    std::vector< std::vector< double > > signals = GetWeightedCompartmentSignals();
+
+    // the gridding cost grows with the number of time nodes; for large off-resonance spreads the explicit DFT is cheaper
+    // (rough operation count, each DFT term needs a complex exponential)
+    double gridCost = numNodes*signals.size()*(gx*gy*std::log2(gx*gy) + numSamples*taps*taps);
+    if (gridCost > 10.0*numSamples*nx*ny)
+    {
+      m_KspaceEngine = EXACT_DFT;
+      return;
+    }
+    m_KspaceEngine = NUFFT;
+
+    std::vector< double > nodeTimes(numNodes);
+    std::vector< double > nodeWeights(numNodes);
+    for (int l=0; l<numNodes; ++l)
+    {
+      double angle = itk::Math::pi*(2*l+1)/(2*numNodes);
+      nodeTimes[l] = (tMin+tMax)/2 + (tMax-tMin)/2*std::cos(angle);
+      nodeWeights[l] = (l%2==0 ? 1 : -1)*std::sin(angle);
+    }
+    std::vector< double > barycentricSums(numSamples, 0);
+    std::vector< int > exactNodes(numSamples, -1);
+    if (numNodes>1)
+      for (int i=0; i<numSamples; ++i)
+        for (int l=0; l<numNodes; ++l)
+        {
+          if (sampleTimes[i]==nodeTimes[l])
+            exactNodes[i] = l;
+          else
+            barycentricSums[i] += nodeWeights[l]/(sampleTimes[i]-nodeTimes[l]);
+        }
+
+    // deapodization: divide by the transform of the kernel in image space
+    std::vector< double > deapodizationX(nx);
+    std::vector< double > deapodizationY(ny);
+    for (int x=0; x<nx; ++x)
+      deapodizationX[x] = 1.0/KaiserBesselTransform((x - x_shift)/gx, width, beta);
+    for (int y=0; y<ny; ++y)
+      deapodizationY[y] = 1.0/KaiserBesselTransform((y - y_shift)/gy, width, beta);
+
+    std::vector< ComplexType > samples(numSamples, ComplexType(0,0));
+    std::vector< ComplexType > grid(gx*gy);
+    vnl_vector< ComplexType > column(gy);
+    vnl_fft_1d< double > fftX(gx);
+    vnl_fft_1d< double > fftY(gy);
+    std::vector< ComplexType > offResonance(frequencies.size());
+    for (int l=0; l<numNodes; ++l)
+    {
+      for (unsigned int p=0; p<frequencies.size(); ++p)
+        offResonance[p] = std::exp(ComplexType(0, itk::Math::twopi * nodeTimes[l] * (frequencies[p]-centerFrequency)));
+
+      for (unsigned int c=0; c<signals.size(); ++c)
+      {
+        // image (shifted to the grid origin) --> oversampled grid
+        std::fill(grid.begin(), grid.end(), ComplexType(0,0));
+        for (int y=0; y<ny; ++y)
+        {
+          int gridY = ((y - static_cast<int>(y_shift))%gy + gy)%gy;
+          for (int x=0; x<nx; ++x)
+          {
+            int gridX = ((x - static_cast<int>(x_shift))%gx + gx)%gx;
+            ComplexType value(signals[c][y*nx + x]*deapodizationX[x]*deapodizationY[y], 0);
+            if (!offResonance.empty())
+              value *= offResonance[y*nx + x];
+            grid[gridY*gx + gridX] = value;
+          }
+        }
+
+        // unnormalized transform with positive exponent (vnl direction +1), rows first (only rows containing image data)
+        for (int y=0; y<ny; ++y)
+        {
+          int gridY = ((y - static_cast<int>(y_shift))%gy + gy)%gy;
+          fftX.transform(&grid[gridY*gx], +1);
+        }
+        for (int x=0; x<gx; ++x)
+        {
+          for (int y=0; y<gy; ++y)
+            column[y] = grid[y*gx + x];
+          fftY.transform(column.data_block(), +1);
+          for (int y=0; y<gy; ++y)
+            grid[y*gx + x] = column[y];
+        }
+
+        // interpolate grid at the sample positions
+#pragma omp parallel for
+        for (int i=0; i<numSamples; ++i)
+        {
+          double weight = 1;
+          if (numNodes>1)
+          {
+            if (exactNodes[i]>=0)
+              weight = exactNodes[i]==l ? 1 : 0;
+            else
+              weight = nodeWeights[l]/(sampleTimes[i]-nodeTimes[l])/barycentricSums[i];
+          }
+          if (!sampleRelaxation[i].empty())
+            weight *= sampleRelaxation[i][c];
+          if (weight==0)
+            continue;
+
+          ComplexType s(0,0);
+          for (int jy=0; jy<taps; ++jy)
+          {
+            double wy = kernelY[i*taps + jy];
+            if (wy==0)
+              continue;
+            int gridY = ((gridStartY[i] + jy)%gy + gy)%gy;
+            for (int jx=0; jx<taps; ++jx)
+            {
+              int gridX = ((gridStartX[i] + jx)%gx + gx)%gx;
+              s += grid[gridY*gx + gridX]*(wy*kernelX[i*taps + jx]);
+            }
+          }
+          samples[i] += weight*s;
+        }
+      }
+    }
+
+    m_NufftSamples.assign(numSamples, vcl_complex<ScalarType>(0,0));
+    for (int i=0; i<numSamples; ++i)
+    {
+      ComplexType s = samples[i] * std::exp(ComplexType(0, itk::Math::twopi * samplePhases[i]));
+      m_NufftSamples[sampleIndices[i]] = vcl_complex<ScalarType>(s.real(), s.imag());
+    }
   }
 
   template< class ScalarType >
@@ -272,45 +829,17 @@ namespace itk {
   {
     typename OutputImageType::Pointer outputImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
     ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
-    typedef ImageRegionConstIterator< InputImageType > InputIteratorType;
-
-    // precalculate shifts for DFT
-    float x_shift = 0;
-    float y_shift = 0;
-    if (static_cast<int>(xMax)%2==1)
-        x_shift = (xMax-1)/2;
-    else
-        x_shift = xMax/2;
-    if (static_cast<int>(yMax)%2==1)
-        y_shift = (yMax-1)/2;
-    else
-        y_shift = yMax/2;
-
-    float kx_shift = 0;
-    float ky_shift = 0;
-    if (static_cast<int>(kxMax)%2==1)
-        kx_shift = (kxMax-1)/2;
-    else
-        kx_shift = kxMax/2;
-    if (static_cast<int>(kyMax)%2==1)
-        ky_shift = (kyMax-1)/2;
-    else
-        ky_shift = kyMax/2;
 
     vcl_complex<ScalarType> zero = vcl_complex<ScalarType>(0, 0);
+    std::vector< float > relaxFactor;
     while( !oit.IsAtEnd() )
     {
       int tick = oit.GetIndex()[1] * kxMax + oit.GetIndex()[0];
 
-      // get current k-space index (depends on the chosen k-space readout scheme)
-      itk::Index< 2 > kIdx = m_ReadoutScheme->GetActualKspaceIndex(tick);
-
-      // we have to adjust the ticks to obtain correct times since the DFT is not completely symmetric in the even  number of lines case
-      if (static_cast<int>(kyMax)%2 == 0 && !m_Parameters->m_SignalGen.m_ReversePhase)
-      {
-        tick += kxMax;
-        tick %= static_cast<int>(numPix);
-      }
+      // get current k-space index, timing and position (depends on the chosen k-space readout scheme)
+      itk::Index< 2 > kIdx;
+      float t, tRf, eddyDecay, kx, ky;
+      GetSampleParameters(tick, kIdx, t, tRf, eddyDecay, kx, ky, relaxFactor);
 
       // partial fourier
       // two cases because we always want to skip the "later" parts of k-space
@@ -340,118 +869,21 @@ namespace itk {
         }
       }
 
-      // time from maximum echo
-      float t = m_ReadoutScheme->GetTimeFromMaxEcho(tick);
-
-      // calculate eddy current decay factor
-      float eddyDecay = 0;
-      if ( m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline)
-      {
-        // time passed since k-space readout started
-        float tRead = m_ReadoutScheme->GetTimeFromLastDiffusionGradient(tick);
-        eddyDecay = std::exp(-tRead/m_Parameters->m_SignalGen.m_Tau ) * t/1000; // time in seconds here
-      }
-
-      // calcualte signal relaxation factors
-      std::vector< float > relaxFactor;
-      if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
-      {
-        // time passes since application of the RF pulse
-        float tRf = m_ReadoutScheme->GetTimeFromRf(tick);
-        if (m_StoreTimings)
-            m_RfImage->SetPixel(kIdx, tRf);
-
-        for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
-        {
-          // account for T2 relaxation (how much transverse magnetization is left since applicatiohn of RF pulse?)
-          relaxFactor.push_back(m_T1Relax[i] * std::exp(-tRf/m_T2[i] -fabs(t)/ m_Parameters->m_SignalGen.m_tInhom));
-        }
-      }
-
-      // shift k for DFT: (0 -- N) --> (-N/2 -- N/2)
-      float kx = kIdx[0] - kx_shift;
-      float ky = kIdx[1] - ky_shift;
-
-      // add ghosting by adding gradient delay induced offset
-      if (m_Parameters->m_Misc.m_DoAddGhosts)
-      {
-        if (kIdx[1]%2 == 1)
-          kx -= m_Parameters->m_SignalGen.m_KspaceLineOffset;
-        else
-          kx += m_Parameters->m_SignalGen.m_KspaceLineOffset;
-      }
-
-      // pull stuff out of inner loop
-      t /= 1000; // time in seconds
-      kx /= xMax;
-      ky /= yMaxFov;
+      if (m_StoreTimings && m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
+        m_RfImage->SetPixel(kIdx, tRf);
 
       // calculate signal s at k-space position (kx, ky)
       vcl_complex<ScalarType> s(0,0);
-      InputIteratorType it(m_CompartmentImages[0], m_CompartmentImages[0]->GetLargestPossibleRegion() );
-      while( !it.IsAtEnd() )
+      switch (m_KspaceEngine)
       {
-        typename InputImageType::IndexType input_idx = it.GetIndex();
-
-        // shift x,y for DFT: (0 -- N) --> (-N/2 -- N/2)
-        float x = input_idx[0] - x_shift;
-        float y = input_idx[1] - y_shift;
-
-        // sum compartment signals and simulate relaxation
-        ScalarType f_real = 0;
-        for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
-          if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
-            f_real += m_CompartmentImages[i]->GetPixel(input_idx) * relaxFactor[i];
-          else
-            f_real += m_CompartmentImages[i]->GetPixel(input_idx);
-
-        // vector from image center to current position (in meter)
-        // only necessary for eddy currents and non-constant coil sensitivity
-        VectorType pos;
-        if ((m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline) ||
-            m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
-        {
-          pos[0] = x; pos[1] = y; pos[2] = m_Z;
-          pos = m_Transform*pos;
-        }
-
-        if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
-          f_real *= CoilSensitivity(pos);
-
-        // simulate eddy currents and other distortions
-        float phi = 0;   // phase shift
-        if (  m_Parameters->m_Misc.m_DoAddEddyCurrents && m_Parameters->m_SignalGen.m_EddyStrength>0 && !m_IsBaseline)
-        {
-          // duration (tRead) already included in "eddyDecay"
-          phi += (m_DiffusionGradientDirection[0]*pos[0]+m_DiffusionGradientDirection[1]*pos[1]+m_DiffusionGradientDirection[2]*pos[2]) * eddyDecay;
-        }
-
-        // simulate distortions
-        if (m_Parameters->m_Misc.m_DoAddDistortions)
-        {
-          if (m_MovedFmap.IsNotNull())    // if we have headmotion, use moved map
-            phi += m_MovedFmap->GetPixel(input_idx) * t;
-          else if (m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull())
-          {
-            itk::Image<float, 3>::IndexType index; index[0] = input_idx[0]; index[1] = input_idx[1]; index[2] = m_Zidx;
-            phi += m_Parameters->m_SignalGen.m_FrequencyMap->GetPixel(index) * t;
-          }
-        }
-
-        // if signal comes from outside FOV, mirror it back (wrap-around artifact - aliasing
-        if (m_Parameters->m_Misc.m_DoAddAliasing)
-        {
-          if (y<-yMaxFov_half)
-            y += yMaxFov;
-          else if (y>yMaxFov_half)
-            y -= yMaxFov;
-        }
-
-        // actual DFT term
-        vcl_complex<ScalarType> f(f_real * m_Parameters->m_SignalGen.m_SignalScale, 0);
-        s += f * std::exp( std::complex<ScalarType>(0, itk::Math::twopi * (kx*x + ky*y + phi )) );
-
-        ++it;
+        case SEPARABLE_DFT:
+          s = CalculateSeparableDftSample(kIdx, relaxFactor);
+          break;
+        case NUFFT:
+          s = m_NufftSamples[static_cast<int>(kIdx[1]*kxMax + kIdx[0])];
+          break;
+        default:
+          s = CalculateDftSample(kx, ky, t, eddyDecay, relaxFactor);
       }
       s /= numPix;
 
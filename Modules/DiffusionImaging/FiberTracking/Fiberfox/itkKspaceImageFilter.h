@@ -42,7 +42,9 @@ namespace itk{
 * - Image distortions (off-frequency effects)
 * - Gibbs ringing
 * - Eddy current effects
-* Based on a discrete fourier transformation.
+* Based on a discrete fourier transformation. Without per-pixel phase terms, the DFT is evaluated separably (one transform per image row and kx).
+* Eddy currents shift the k-space sample positions and the off-resonance phase is approximated by Chebyshev interpolation in time, so
+* these cases are evaluated with a Kaiser-Bessel gridding non-uniform FFT. SetUseExactDft(true) evaluates the full DFT sum per sample instead.
 * See "Fiberfox: Facilitating the creation of realistic white matter software phantoms" (DOI: 10.1002/mrm.25045) for details.
 */
 
@@ -82,6 +84,7 @@ namespace itk{
     itkSetMacro( StoreTimings, bool )
     itkSetMacro( FiberBundle, FiberBundle::Pointer )
     itkSetMacro( CoilPosition, VectorType )
+    itkSetMacro( UseExactDft, bool )                ///< Evaluate the full DFT sum for every k-space sample (slow reference implementation).
     itkGetMacro( KSpaceImage, typename InputImageType::Pointer )    ///< k-space magnitude image
     itkGetMacro( TickImage, typename InputImageType::Pointer )    ///< k-space readout ordering encoded in the voxels
     itkGetMacro( RfImage, typename InputImageType::Pointer )    ///< time passed since last RF pulse encoded per voxel
@@ -98,8 +101,27 @@ namespace itk{
     KspaceImageFilter();
     ~KspaceImageFilter() override {}
 
+    enum KSPACE_ENGINE {
+      EXACT_DFT,
+      SEPARABLE_DFT,
+      NUFFT
+    };
+
     float CoilSensitivity(VectorType& pos);
 
+    /** Acquisition parameters of the k-space sample read at the given tick. The tick is adjusted to the timing tick, t (time from maximum echo) is returned in seconds, kx and ky in cycles per pixel. */
+    void GetSampleParameters(int& tick, itk::Index< 2 >& kIdx, float& t, float& tRf, float& eddyDecay, float& kx, float& ky, std::vector< float >& relaxFactor);
+    std::vector< std::vector< double > > GetWeightedCompartmentSignals();  ///< Compartment signals multiplied with coil sensitivity and signal scale. Summed to a single signal if no relaxation is simulated.
+    vcl_complex<ScalarType> CalculateDftSample(float kx, float ky, float t, float eddyDecay, const std::vector< float >& relaxFactor);
+    vcl_complex<ScalarType> CalculateSeparableDftSample(const itk::Index< 2 >& kIdx, const std::vector< float >& relaxFactor);
+    void InitializeSeparableDft();
+    void InitializeNufft();
+
+    static double BesselI0(double x);
+    static double KaiserBessel(double u, int width, double beta);
+    static double KaiserBesselTransform(double nu, int width, double beta);
+    static int GetFftSize(int n);   ///< smallest size >= n supported by vnl_fft (factors 2, 3 and 5)
+
     void BeforeThreadedGenerateData() override;
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType threadID) override;
     void AfterThreadedGenerateData() override;
@@ -146,6 +168,16 @@ namespace itk{
     float                                   yMaxFov_half;
     float                                   numPix;
     bool                                    m_StoreTimings;
+    bool                                    m_UseExactDft;
+
+    float                                   x_shift;
+    float                                   y_shift;
+    float                                   kx_shift;
+    float                                   ky_shift;
+    KSPACE_ENGINE                           m_KspaceEngine;
+    std::vector< std::vector< std::complex<double> > > m_RowTransforms;  ///< per signal and line parity: DFT of every image row for every kx (indexed kx*yMax+y)
+    std::vector< std::complex<double> >     m_LinePhases;    ///< exp(i*2pi*ky*y) for every ky (indexed ky*yMax+y)
+    std::vector< vcl_complex<ScalarType> >  m_NufftSamples;  ///< signal of every k-space index, precalculated by the non-uniform FFT
 
   private:
 
@@ -56,6 +56,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <omp.h>
 #include <cmath>
 #include <thread>
+#include <algorithm>
 
 namespace itk
 {
@@ -64,6 +65,7 @@ template< class PixelType >
 TractsToDWIImageFilter< PixelType >::TractsToDWIImageFilter()
   : m_StatusText("")
   , m_UseConstantRandSeed(false)
+  , m_UseSliceTasks(true)
   , m_RandGen(itk::Statistics::MersenneTwisterRandomVariateGenerator::New())
 {
   m_DoubleInterpolator = itk::LinearInterpolateImageFunction< ItkDoubleImgType, float >::New();
@@ -80,15 +82,6 @@ template< class PixelType >
 TractsToDWIImageFilter< PixelType >::DoubleDwiType::Pointer TractsToDWIImageFilter< PixelType >::
 SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_images )
 {
-  unsigned int numFiberCompartments = m_Parameters.m_FiberModelList.size();
-  // create slice object
-  ImageRegion<2> sliceRegion;
-  sliceRegion.SetSize(0, m_WorkingImageRegion.GetSize()[0]);
-  sliceRegion.SetSize(1, m_WorkingImageRegion.GetSize()[1]);
-  Vector< double, 2 > sliceSpacing;
-  sliceSpacing[0] = m_WorkingSpacing[0];
-  sliceSpacing[1] = m_WorkingSpacing[1];
-
   DoubleDwiType::PixelType nullPix; nullPix.SetSize(compartment_images.at(0)->GetVectorLength()); nullPix.Fill(0.0);
   auto magnitudeDwiImage = DoubleDwiType::New();
   magnitudeDwiImage->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
@@ -153,28 +146,24 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
 
   auto num_slices = compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2);
   auto num_gradient_volumes = static_cast<int>(compartment_images.at(0)->GetVectorLength());
+  auto num_coils = m_Parameters.m_SignalGen.m_NumberOfCoils;
   auto max_threads = omp_get_max_threads();
-  int out_threads = Math::ceil(std::sqrt(max_threads));
-  int in_threads = Math::floor(std::sqrt(max_threads));
-  if (out_threads > num_gradient_volumes)
-  {
-    out_threads = num_gradient_volumes;
-    in_threads = Math::floor(static_cast<float>(max_threads/out_threads));
-  }
-  PrintToLog("Parallel volumes: " + boost::lexical_cast<std::string>(out_threads), false, true, true);
-  PrintToLog("Threads per slice: " + boost::lexical_cast<std::string>(in_threads), false, true, true);
 
-  std::list< std::tuple<unsigned int, unsigned int, unsigned int> > spikes;
+  // one work item per gradient volume, slice and coil, items of the same volume are adjacent
+  int num_items = num_gradient_volumes*num_slices*num_coils;
+
+  // spikes are drawn before the simulation so that they do not depend on the order in which the items are processed
+  std::vector< int > item_spikes(num_items, 0);
   if (m_Parameters.m_Misc.m_DoAddSpikes)
     for (unsigned int i=0; i<m_Parameters.m_SignalGen.m_Spikes; i++)
     {
-      // gradient volume and slice index
-      auto spike = std::tuple<unsigned int, unsigned int, unsigned int>(
-            m_RandGen->GetIntegerVariate()%num_gradient_volumes,
-            m_RandGen->GetIntegerVariate()%num_slices,
-            m_RandGen->GetIntegerVariate()%m_Parameters.m_SignalGen.m_NumberOfCoils);
-      spikes.push_back(spike);
+      // gradient volume, slice and coil index
+      int g = m_RandGen->GetIntegerVariate()%num_gradient_volumes;
+      int z = m_RandGen->GetIntegerVariate()%num_slices;
+      int c = m_RandGen->GetIntegerVariate()%num_coils;
+      ++item_spikes.at((g*num_slices + z)*num_coils + c);
     }
+  std::vector< std::string > item_spike_logs(num_items);
 
   bool output_timing = m_Parameters.m_Misc.m_OutputAdditionalImages;
 
@@ -182,148 +171,100 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
   PrintToLog("|----|----|----|----|----|----|----|----|----|----|\n*", false, false, false);
   unsigned long lastTick = 0;
 
-  boost::progress_display disp(static_cast<unsigned long>(num_gradient_volumes)*compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2));
+  boost::progress_display disp(static_cast<unsigned long>(num_items));
 
-#pragma omp parallel for num_threads(out_threads)
-  for (int g=0; g<num_gradient_volumes; g++)
+  if (m_UseSliceTasks)
   {
-    if (this->GetAbortGenerateData())
-      continue;
+    // dynamic scheduling balances the items over all threads, independent of the number of volumes and of the cost of individual slices
+    // the k-space filters only get additional threads if there are less items than threads
+    int in_threads = std::max(1, max_threads/num_items);
+    PrintToLog("Parallel slice tasks: " + boost::lexical_cast<std::string>(num_items), false, true, true);
+    PrintToLog("Threads per slice: " + boost::lexical_cast<std::string>(in_threads), false, true, true);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int i=0; i<num_items; i++)
+    {
+      if (this->GetAbortGenerateData())
+        continue;
+
+      int g = i/(num_slices*num_coils);
+      unsigned int z = (i/num_coils)%num_slices;
+      unsigned int c = i%num_coils;
+      SimulateKspaceSlice(compartment_images, coilPositions, g, z, c, item_spikes.at(i), in_threads, output_timing && i==0, item_spike_logs.at(i));
 
-    std::list< std::tuple<unsigned int, unsigned int> > spikeSlice;
 #pragma omp critical
+      {
+        ++disp;
+        unsigned long newTick = 50*disp.count()/disp.expected_count();
+        for (unsigned long tick = 0; tick<(newTick-lastTick); tick++)
+          PrintToLog("*", false, false, false);
+        lastTick = newTick;
+      }
+    }
+  }
+  else
+  {
+    // whole gradient volumes in parallel, remaining threads are used inside each slice
+    int out_threads = Math::ceil(std::sqrt(max_threads));
+    int in_threads = Math::floor(std::sqrt(max_threads));
+    if (out_threads > num_gradient_volumes)
     {
-
-      for (auto spike : spikes)
-        if (std::get<0>(spike) == static_cast<unsigned int>(g))
-          spikeSlice.push_back(std::tuple<unsigned int, unsigned int>(std::get<1>(spike), std::get<2>(spike)));
+      out_threads = num_gradient_volumes;
+      in_threads = Math::floor(static_cast<float>(max_threads/out_threads));
     }
+    PrintToLog("Parallel volumes: " + boost::lexical_cast<std::string>(out_threads), false, true, true);
+    PrintToLog("Threads per slice: " + boost::lexical_cast<std::string>(in_threads), false, true, true);
 
-    for (unsigned int z=0; z<num_slices; z++)
+#pragma omp parallel for num_threads(out_threads)
+    for (int g=0; g<num_gradient_volumes; g++)
     {
-      std::vector< Float2DImageType::Pointer > compartment_slices;
-      std::vector< float > t2Vector;
-      std::vector< float > t1Vector;
+      for (unsigned int z=0; z<num_slices; z++)
+        for (unsigned int c=0; c<num_coils; c++)
+        {
+          if (this->GetAbortGenerateData())
+            continue;
 
-      for (unsigned int i=0; i<compartment_images.size(); i++)
-      {
-        DiffusionSignalModel<double>* signalModel;
-        if (i<numFiberCompartments)
-          signalModel = m_Parameters.m_FiberModelList.at(i);
-        else
-          signalModel = m_Parameters.m_NonFiberModelList.at(i-numFiberCompartments);
-
-        auto slice = Float2DImageType::New();
-        slice->SetLargestPossibleRegion( sliceRegion );
-        slice->SetBufferedRegion( sliceRegion );
-        slice->SetRequestedRegion( sliceRegion );
-        slice->SetSpacing(sliceSpacing);
-        slice->Allocate();
-        slice->FillBuffer(0.0);
-
-        // extract slice from channel g
-        for (unsigned int y=0; y<compartment_images.at(0)->GetLargestPossibleRegion().GetSize(1); y++)
-          for (unsigned int x=0; x<compartment_images.at(0)->GetLargestPossibleRegion().GetSize(0); x++)
-          {
-            Float2DImageType::IndexType index2D; index2D[0]=x; index2D[1]=y;
-            DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
+          int i = (g*num_slices + z)*num_coils + c;
+          SimulateKspaceSlice(compartment_images, coilPositions, g, z, c, item_spikes.at(i), in_threads, output_timing && i==0, item_spike_logs.at(i));
 
-            slice->SetPixel(index2D, compartment_images.at(i)->GetPixel(index3D)[g]);
+#pragma omp critical
+          {
+            ++disp;
+            unsigned long newTick = 50*disp.count()/disp.expected_count();
+            for (unsigned long tick = 0; tick<(newTick-lastTick); tick++)
+              PrintToLog("*", false, false, false);
+            lastTick = newTick;
           }
+        }
+    }
+  }
 
-        compartment_slices.push_back(slice);
-        t2Vector.push_back(signalModel->GetT2());
-        t1Vector.push_back(signalModel->GetT1());
-      }
-
-      if (this->GetAbortGenerateData())
-        continue;
+  for (auto log : item_spike_logs)
+    m_SpikeLog += log;
 
-      for (unsigned int c=0; c<m_Parameters.m_SignalGen.m_NumberOfCoils; c++)
+  // combine coils: magnitude and phase images (sum of squares for multiple coils)
+#pragma omp parallel for
+  for (int z=0; z<static_cast<int>(num_slices); z++)
+    for (unsigned int y=0; y<magnitudeDwiImage->GetLargestPossibleRegion().GetSize(1); y++)
+      for (unsigned int x=0; x<magnitudeDwiImage->GetLargestPossibleRegion().GetSize(0); x++)
       {
-        int numSpikes = 0;
-        for (auto ss : spikeSlice)
-          if (std::get<0>(ss) == z && std::get<1>(ss) == c)
-            ++numSpikes;
-
-        // create k-sapce (inverse fourier transform slices)
-        auto idft = itk::KspaceImageFilter< Float2DImageType::PixelType >::New();
-        idft->SetCompartmentImages(compartment_slices);
-        idft->SetT2(t2Vector);
-        idft->SetT1(t1Vector);
-        if (m_UseConstantRandSeed)
-        {
-          int linear_seed = g + num_gradient_volumes*z + num_gradient_volumes*compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2)*c;
-          idft->SetRandSeed(linear_seed);
-        }
-        idft->SetParameters(&m_Parameters);
-        idft->SetZ((float)z-(float)( compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2)
-                                     -compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2)%2 ) / 2.0);
-        idft->SetZidx(z);
-        idft->SetCoilPosition(coilPositions.at(c));
-        idft->SetFiberBundle(m_FiberBundle);
-        idft->SetTranslation(m_Translations.at(g));
-        idft->SetRotationMatrix(m_RotationsInv.at(g));
-        idft->SetDiffusionGradientDirection(m_Parameters.m_SignalGen.GetGradientDirection(g)*m_Parameters.m_SignalGen.GetBvalue()/1000.0);
-        idft->SetSpikesPerSlice(numSpikes);
-        idft->SetNumberOfThreads(in_threads);
-#pragma omp critical
-        if (output_timing)
-        {
-            idft->SetStoreTimings(true);
-            output_timing = false;
-        }
-        idft->Update();
+        DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
+        DoubleDwiType::PixelType dwiPix = magnitudeDwiImage->GetPixel(index3D);
+        DoubleDwiType::PixelType phasePix = m_PhaseImage->GetPixel(index3D);
 
-#pragma omp critical
-        if (numSpikes>0)
+        for (unsigned int c=0; c<num_coils; c++)
         {
-          m_SpikeLog += "Volume " + boost::lexical_cast<std::string>(g) + " Coil " + boost::lexical_cast<std::string>(c) + "\n";
-          m_SpikeLog += idft->GetSpikeLog();
-        }
-
-        Complex2DImageType::Pointer fSlice;
-        fSlice = idft->GetOutput();
-
-        if (idft->GetTickImage().IsNotNull())
-            m_TickImage = idft->GetTickImage();
-        if (idft->GetRfImage().IsNotNull())
-            m_RfImage = idft->GetRfImage();
-
-        // fourier transform slice
-        Complex2DImageType::Pointer newSlice;
-        auto dft = itk::DftImageFilter< Float2DImageType::PixelType >::New();
-        dft->SetInput(fSlice);
-        dft->SetParameters(m_Parameters);
-        dft->SetNumberOfThreads(in_threads);
-        dft->Update();
-        newSlice = dft->GetOutput();
-
-        // put slice back into channel g
-        for (unsigned int y=0; y<fSlice->GetLargestPossibleRegion().GetSize(1); y++)
-          for (unsigned int x=0; x<fSlice->GetLargestPossibleRegion().GetSize(0); x++)
+          DoubleDwiType::PixelType real_pix = m_OutputImagesReal.at(c)->GetPixel(index3D);
+          DoubleDwiType::PixelType imag_pix = m_OutputImagesImag.at(c)->GetPixel(index3D);
+          for (int g=0; g<num_gradient_volumes; g++)
           {
-            DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
-            Complex2DImageType::IndexType index2D; index2D[0]=x; index2D[1]=y;
-
-            Complex2DImageType::PixelType cPix = newSlice->GetPixel(index2D);
+            Complex2DImageType::PixelType cPix(real_pix[g], imag_pix[g]);
             double magn = sqrt(cPix.real()*cPix.real()+cPix.imag()*cPix.imag());
             double phase = 0;
             if (cPix.real()!=0)
               phase = atan( cPix.imag()/cPix.real() );
 
-            DoubleDwiType::PixelType real_pix = m_OutputImagesReal.at(c)->GetPixel(index3D);
-            real_pix[g] = cPix.real();
-            m_OutputImagesReal.at(c)->SetPixel(index3D, real_pix);
-
-            DoubleDwiType::PixelType imag_pix = m_OutputImagesImag.at(c)->GetPixel(index3D);
-            imag_pix[g] = cPix.imag();
-            m_OutputImagesImag.at(c)->SetPixel(index3D, imag_pix);
-
-            DoubleDwiType::PixelType dwiPix = magnitudeDwiImage->GetPixel(index3D);
-            DoubleDwiType::PixelType phasePix = m_PhaseImage->GetPixel(index3D);
-
-            if (m_Parameters.m_SignalGen.m_NumberOfCoils>1)
+            if (num_coils>1)
             {
               dwiPix[g] += magn*magn;
               phasePix[g] += phase*phase;
@@ -333,54 +274,146 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
               dwiPix[g] = magn;
               phasePix[g] = phase;
             }
+          }
+        }
 
-            //#pragma omp critical
-            {
-              magnitudeDwiImage->SetPixel(index3D, dwiPix);
-              m_PhaseImage->SetPixel(index3D, phasePix);
-
-              // k-space image
-              if (g==0)
-              {
-                DoubleDwiType::PixelType kspacePix = m_KspaceImage->GetPixel(index3D);
-                kspacePix[c] = idft->GetKSpaceImage()->GetPixel(index2D);
-                m_KspaceImage->SetPixel(index3D, kspacePix);
-              }
-            }
+        if (num_coils>1)
+          for (int g=0; g<num_gradient_volumes; g++)
+          {
+            dwiPix[g] = sqrt(dwiPix[g]/num_coils);
+            phasePix[g] = sqrt(phasePix[g]/num_coils);
           }
+
+        magnitudeDwiImage->SetPixel(index3D, dwiPix);
+        m_PhaseImage->SetPixel(index3D, phasePix);
       }
 
-      if (m_Parameters.m_SignalGen.m_NumberOfCoils>1)
-      {
-        for (int y=0; y<static_cast<int>(magnitudeDwiImage->GetLargestPossibleRegion().GetSize(1)); y++)
-          for (int x=0; x<static_cast<int>(magnitudeDwiImage->GetLargestPossibleRegion().GetSize(0)); x++)
-          {
-            DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
-            DoubleDwiType::PixelType magPix = magnitudeDwiImage->GetPixel(index3D);
-            magPix[g] = sqrt(magPix[g]/m_Parameters.m_SignalGen.m_NumberOfCoils);
+  PrintToLog("\n", false);
+  return magnitudeDwiImage;
+}
 
-            DoubleDwiType::PixelType phasePix = m_PhaseImage->GetPixel(index3D);
-            phasePix[g] = sqrt(phasePix[g]/m_Parameters.m_SignalGen.m_NumberOfCoils);
+template< class PixelType >
+void TractsToDWIImageFilter< PixelType >::
+SimulateKspaceSlice( std::vector< DoubleDwiType::Pointer >& compartment_images, const std::vector< itk::Vector<double, 3> >& coilPositions,
+                     int g, unsigned int z, unsigned int c, int numSpikes, int numThreads, bool storeTimings, std::string& spikeLog )
+{
+  unsigned int numFiberCompartments = m_Parameters.m_FiberModelList.size();
+  auto num_gradient_volumes = static_cast<int>(compartment_images.at(0)->GetVectorLength());
+  auto num_slices = compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2);
 
-            //#pragma omp critical
-            {
-              magnitudeDwiImage->SetPixel(index3D, magPix);
-              m_PhaseImage->SetPixel(index3D, phasePix);
-            }
-          }
+  // create slice object
+  ImageRegion<2> sliceRegion;
+  sliceRegion.SetSize(0, m_WorkingImageRegion.GetSize()[0]);
+  sliceRegion.SetSize(1, m_WorkingImageRegion.GetSize()[1]);
+  Vector< double, 2 > sliceSpacing;
+  sliceSpacing[0] = m_WorkingSpacing[0];
+  sliceSpacing[1] = m_WorkingSpacing[1];
+
+  std::vector< Float2DImageType::Pointer > compartment_slices;
+  std::vector< float > t2Vector;
+  std::vector< float > t1Vector;
+
+  for (unsigned int i=0; i<compartment_images.size(); i++)
+  {
+    DiffusionSignalModel<double>* signalModel;
+    if (i<numFiberCompartments)
+      signalModel = m_Parameters.m_FiberModelList.at(i);
+    else
+      signalModel = m_Parameters.m_NonFiberModelList.at(i-numFiberCompartments);
+
+    auto slice = Float2DImageType::New();
+    slice->SetLargestPossibleRegion( sliceRegion );
+    slice->SetBufferedRegion( sliceRegion );
+    slice->SetRequestedRegion( sliceRegion );
+    slice->SetSpacing(sliceSpacing);
+    slice->Allocate();
+    slice->FillBuffer(0.0);
+
+    // extract slice from channel g
+    for (unsigned int y=0; y<compartment_images.at(0)->GetLargestPossibleRegion().GetSize(1); y++)
+      for (unsigned int x=0; x<compartment_images.at(0)->GetLargestPossibleRegion().GetSize(0); x++)
+      {
+        Float2DImageType::IndexType index2D; index2D[0]=x; index2D[1]=y;
+        DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
+
+        slice->SetPixel(index2D, compartment_images.at(i)->GetPixel(index3D)[g]);
       }
 
-      ++disp;
-      unsigned long newTick = 50*disp.count()/disp.expected_count();
-      for (unsigned long tick = 0; tick<(newTick-lastTick); tick++)
-        PrintToLog("*", false, false, false);
-      lastTick = newTick;
-    }
+    compartment_slices.push_back(slice);
+    t2Vector.push_back(signalModel->GetT2());
+    t1Vector.push_back(signalModel->GetT1());
   }
 
+  // create k-sapce (inverse fourier transform slices)
+  auto idft = itk::KspaceImageFilter< Float2DImageType::PixelType >::New();
+  idft->SetCompartmentImages(compartment_slices);
+  idft->SetT2(t2Vector);
+  idft->SetT1(t1Vector);
+  if (m_UseConstantRandSeed)
+  {
+    // one random stream per item, the result does not depend on the scheduling
+    int linear_seed = g + num_gradient_volumes*z + num_gradient_volumes*num_slices*c;
+    idft->SetRandSeed(linear_seed);
+  }
+  idft->SetParameters(&m_Parameters);
+  idft->SetZ((float)z-(float)( num_slices - num_slices%2 ) / 2.0);
+  idft->SetZidx(z);
+  idft->SetCoilPosition(coilPositions.at(c));
+  idft->SetFiberBundle(m_FiberBundle);
+  idft->SetTranslation(m_Translations.at(g));
+  idft->SetRotationMatrix(m_RotationsInv.at(g));
+  idft->SetDiffusionGradientDirection(m_Parameters.m_SignalGen.GetGradientDirection(g)*m_Parameters.m_SignalGen.GetBvalue()/1000.0);
+  idft->SetSpikesPerSlice(numSpikes);
+  idft->SetNumberOfThreads(numThreads);
+  idft->SetStoreTimings(storeTimings);
+  idft->Update();
+
+  if (numSpikes>0)
+  {
+    spikeLog = "Volume " + boost::lexical_cast<std::string>(g) + " Coil " + boost::lexical_cast<std::string>(c) + "\n";
+    spikeLog += idft->GetSpikeLog();
+  }
 
-  PrintToLog("\n", false);
-  return magnitudeDwiImage;
+  Complex2DImageType::Pointer fSlice;
+  fSlice = idft->GetOutput();
+
+  if (storeTimings)
+  {
+    m_TickImage = idft->GetTickImage();
+    m_RfImage = idft->GetRfImage();
+  }
+
+  // fourier transform slice
+  Complex2DImageType::Pointer newSlice;
+  auto dft = itk::DftImageFilter< Float2DImageType::PixelType >::New();
+  dft->SetInput(fSlice);
+  dft->SetParameters(m_Parameters);
+  dft->SetNumberOfThreads(numThreads);
+  dft->Update();
+  newSlice = dft->GetOutput();
+
+  // put slice back into channel g of coil c
+  // only the own vector component is written, other items concurrently write the other volumes and coils of the same voxels
+  double* real_buffer = m_OutputImagesReal.at(c)->GetBufferPointer();
+  double* imag_buffer = m_OutputImagesImag.at(c)->GetBufferPointer();
+  double* kspace_buffer = m_KspaceImage->GetBufferPointer();
+  auto real_length = m_OutputImagesReal.at(c)->GetVectorLength();
+  auto kspace_length = m_KspaceImage->GetVectorLength();
+  for (unsigned int y=0; y<fSlice->GetLargestPossibleRegion().GetSize(1); y++)
+    for (unsigned int x=0; x<fSlice->GetLargestPossibleRegion().GetSize(0); x++)
+    {
+      DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
+      Complex2DImageType::IndexType index2D; index2D[0]=x; index2D[1]=y;
+
+      Complex2DImageType::PixelType cPix = newSlice->GetPixel(index2D);
+      auto offset = m_OutputImagesReal.at(c)->ComputeOffset(index3D);
+      real_buffer[offset*real_length + g] = cPix.real();
+      imag_buffer[offset*real_length + g] = cPix.imag();
+
+      // k-space image
+      if (g==0)
+        kspace_buffer[m_KspaceImage->ComputeOffset(index3D)*kspace_length + c] = idft->GetKSpaceImage()->GetPixel(index2D);
+    }
 }
 
 template< class PixelType >
@@ -1007,6 +1040,18 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
     PrintToLog("0%   10   20   30   40   50   60   70   80   90   100%", false, true, false);
     PrintToLog("|----|----|----|----|----|----|----|----|----|----|\n*", false, false, false);
 
+    // Without head motion the fibers are at the same position in every volume. The fiber compartment signal of all
+    // volumes is then generated in a single pass over the fibers, evaluating the fiber models for all gradient directions at once.
+    // Randomized astrosticks draw a new stick configuration per volume and segment, so they keep the per-volume path.
+    bool all_gradients = !m_Parameters.m_SignalGen.m_DoAddMotion;
+    for (auto model : m_Parameters.m_FiberModelList)
+    {
+      auto astrosticks = dynamic_cast< mitk::AstroStickModel<double>* >(model);
+      if (astrosticks!=nullptr && astrosticks->GetRandomizeSticks())
+        all_gradients = false;
+    }
+    ItkDoubleImgType::Pointer intraAxonalVolumeImage;
+
     for (unsigned int g=0; g<num_gradients; ++g)
     {
       // move fibers
@@ -1019,16 +1064,20 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
         m_Parameters.m_NonFiberModelList.at(i)->SetSeed(signalModelSeed);
 
       // storing voxel-wise intra-axonal volume in mm³
-      auto intraAxonalVolumeImage = ItkDoubleImgType::New();
-      intraAxonalVolumeImage->SetSpacing( m_WorkingSpacing );
-      intraAxonalVolumeImage->SetOrigin( m_WorkingOrigin );
-      intraAxonalVolumeImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
-      intraAxonalVolumeImage->SetLargestPossibleRegion( m_WorkingImageRegion );
-      intraAxonalVolumeImage->SetBufferedRegion( m_WorkingImageRegion );
-      intraAxonalVolumeImage->SetRequestedRegion( m_WorkingImageRegion );
-      intraAxonalVolumeImage->Allocate();
-      intraAxonalVolumeImage->FillBuffer(0);
-      maxVolume = 0;
+      bool simulate_fibers = g==0 || !all_gradients;
+      if (simulate_fibers)
+      {
+        intraAxonalVolumeImage = ItkDoubleImgType::New();
+        intraAxonalVolumeImage->SetSpacing( m_WorkingSpacing );
+        intraAxonalVolumeImage->SetOrigin( m_WorkingOrigin );
+        intraAxonalVolumeImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
+        intraAxonalVolumeImage->SetLargestPossibleRegion( m_WorkingImageRegion );
+        intraAxonalVolumeImage->SetBufferedRegion( m_WorkingImageRegion );
+        intraAxonalVolumeImage->SetRequestedRegion( m_WorkingImageRegion );
+        intraAxonalVolumeImage->Allocate();
+        intraAxonalVolumeImage->FillBuffer(0);
+        maxVolume = 0;
+      }
       double* intraAxBuffer = intraAxonalVolumeImage->GetBufferPointer();
 
       if (this->GetAbortGenerateData())
@@ -1036,7 +1085,7 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
 
       vtkPolyData* fiberPolyData = m_FiberBundleTransformed->GetFiberPolyData();
       // generate fiber signal (if there are any fiber models present)
-      if (!m_Parameters.m_FiberModelList.empty())
+      if (!m_Parameters.m_FiberModelList.empty() && simulate_fibers)
       {
         std::vector< double* > buffers;
         for (unsigned int i=0; i<m_CompartmentImages.size(); ++i)
@@ -1064,6 +1113,7 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
             continue;
 
           double seg_volume = fiberWeight*itk::Math::pi*m_mmRadius*m_mmRadius;
+          std::vector< double > fiber_signal(all_gradients ? num_gradients : 1);
           for( int j=0; j<numPoints - 1; ++j)
           {
             if (this->GetAbortGenerateData())
@@ -1096,19 +1146,35 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
             // generate signal for each fiber compartment
             for (int k=0; k<numFiberCompartments; ++k)
             {
-              double signal_add = m_Parameters.m_FiberModelList[k]->SimulateMeasurement(g, dir)*seg_volume;
+              if (all_gradients)
+                m_Parameters.m_FiberModelList[k]->SimulateAllMeasurements(dir, fiber_signal.data());
+              else
+                fiber_signal[0] = m_Parameters.m_FiberModelList[k]->SimulateMeasurement(g, dir);
+              for (auto& signal_add : fiber_signal)
+                signal_add *= seg_volume;
+
               for (std::pair< itk::Index<3>, double > seg : segments)
               {
                 if (!m_TransformedMaskImage->GetLargestPossibleRegion().IsInside(seg.first) || m_TransformedMaskImage->GetPixel(seg.first)<=0)
                   continue;
 
-                double seg_signal = seg.second*signal_add;
-
-                unsigned int linear_index = g + num_gradients*seg.first[0] + num_gradients*image_size_x*seg.first[1] + num_gradients*image_size_x*region_size_y*seg.first[2];
+                // the gradient directions of a voxel are stored contiguously
+                unsigned int linear_index = num_gradients*seg.first[0] + num_gradients*image_size_x*seg.first[1] + num_gradients*image_size_x*region_size_y*seg.first[2];
 
                 // update dMRI volume
+                if (all_gradients)
+                {
+                  for (unsigned int d=0; d<num_gradients; ++d)
+                  {
 #pragma omp atomic
-                buffers[k][linear_index] += seg_signal;
+                    buffers[k][linear_index+d] += seg.second*fiber_signal[d];
+                  }
+                }
+                else
+                {
+#pragma omp atomic
+                  buffers[k][linear_index+g] += seg.second*fiber_signal[0];
+                }
 
                 // update fiber volume image
                 if (k==0)
@@ -1127,7 +1193,7 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
 #pragma omp critical
           {
             // progress report
-            ++disp;
+            disp += all_gradients ? num_gradients : 1;
             unsigned long newTick = 50*disp.count()/disp.expected_count();
             for (unsigned int tick = 0; tick<(newTick-lastTick); ++tick)
               PrintToLog("*", false, false, false);
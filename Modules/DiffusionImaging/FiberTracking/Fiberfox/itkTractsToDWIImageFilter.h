@@ -66,6 +66,7 @@ public:
     itkSetMacro( FiberBundle, FiberBundleType )             ///< Input fiber bundle
     itkSetMacro( InputImage, typename OutputImageType::Pointer )     ///< Input diffusion-weighted image. If no fiber bundle is set, then the acquisition is simulated for this image without a new diffusion simulation.
     itkSetMacro( UseConstantRandSeed, bool )                ///< Seed for random generator.
+    itkSetMacro( UseSliceTasks, bool )                      ///< Schedule each gradient volume, slice and coil of the k-space simulation as separate task (default). Otherwise whole volumes are distributed over a fixed number of threads.
     void SetParameters( FiberfoxParameters param )  ///< Simulation parameters.
     { m_Parameters = param; }
 
@@ -107,6 +108,10 @@ protected:
     /** Transform generated image compartment by compartment, channel by channel and slice by slice using DFT and add k-space artifacts/effects. */
     DoubleDwiType::Pointer SimulateKspaceAcquisition(std::vector< DoubleDwiType::Pointer >& images);
 
+    /** Simulate k-space acquisition of gradient volume g, slice z and coil c and write the result into the real and imaginary coil images. */
+    void SimulateKspaceSlice(std::vector< DoubleDwiType::Pointer >& images, const std::vector< itk::Vector<double, 3> >& coilPositions,
+                             int g, unsigned int z, unsigned int c, int numSpikes, int numThreads, bool storeTimings, std::string& spikeLog);
+
     /** Generate signal of non-fiber compartments. */
     void SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<float, 3>& volume_fraction_point, double intraAxonalVolume, int g);
 
@@ -137,6 +142,7 @@ protected:
     // MISC
     itk::TimeProbe                              m_TimeProbe;
     bool                                        m_UseConstantRandSeed;
+    bool                                        m_UseSliceTasks;
     bool                                        m_MaskImageSet;
     ofstream                                    m_Logfile;
     std::string                                 m_MotionLog;
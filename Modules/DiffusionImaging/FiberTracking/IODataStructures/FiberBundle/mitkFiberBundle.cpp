@@ -28,7 +28,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolyLine.h>
 #include <vtkCellArray.h>
 #include <vtkCellData.h>
-#include <vtkIdFilter.h>
 #include <vtkClipPolyData.h>
 #include <vtkPlane.h>
 #include <vtkDoubleArray.h>
@@ -36,7 +35,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkParametricFunctionSource.h>
 #include <vtkParametricSpline.h>
 #include <vtkPolygon.h>
-#include <vtkCleanPolyData.h>
 #include <boost/progress.hpp>
 #include <vtkTransformPolyDataFilter.h>
 #include <mitkTransferFunction.h>
@@ -44,26 +42,30 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkLookupTable.h>
 #include <vtkCardinalSpline.h>
 #include <vtkAppendPolyData.h>
+#include <vtkIdTypeArray.h>
+#include <algorithm>
+#include <array>
 
 const char* mitk::FiberBundle::FIBER_ID_ARRAY = "Fiber_IDs";
 
 mitk::FiberBundle::FiberBundle( vtkPolyData* fiberPolyData )
-  : m_NumFibers(0)
+  : m_FiberPointOffsets(1, 0)
+  , m_FiberPolyDataOutdated(true)
+  , m_FiberPolyDataTime(0)
+  , m_FiberGridSpacing(1.0)
+  , m_FiberGridTime(0)
+  , m_NumFibers(0)
 {
   m_FiberWeights = vtkSmartPointer<vtkFloatArray>::New();
   m_FiberWeights->SetName("FIBER_WEIGHTS");
 
+  m_FiberPointData = vtkSmartPointer<vtkPointData>::New();
+  m_FiberCellData = vtkSmartPointer<vtkCellData>::New();
   m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
   if (fiberPolyData != nullptr)
-    m_FiberPolyData = fiberPolyData;
-  else
-  {
-    this->m_FiberPolyData->SetPoints(vtkSmartPointer<vtkPoints>::New());
-    this->m_FiberPolyData->SetLines(vtkSmartPointer<vtkCellArray>::New());
-  }
+    this->ImportFiberPolyData(fiberPolyData);
 
   this->UpdateFiberGeometry();
-  this->GenerateFiberIds();
   this->ColorFibersByOrientation();
 }
 
@@ -74,7 +76,7 @@ mitk::FiberBundle::~FiberBundle()
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::GetDeepCopy()
 {
-  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(m_FiberPolyData);
+  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(this->GetFiberPolyData());
   newFib->SetFiberColors(this->m_FiberColors);
   newFib->SetFiberWeights(this->m_FiberWeights);
   return newFib;
@@ -82,6 +84,8 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::GetDeepCopy()
 
 vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vector<unsigned int> fiberIds, vtkSmartPointer<vtkFloatArray> weights)
 {
+  this->UpdateFiberStorage();
+
   vtkSmartPointer<vtkPolyData> newFiberPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> newLineSet = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> newPointSet = vtkSmartPointer<vtkPoints>::New();
@@ -91,20 +95,21 @@ vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vecto
   auto finIt = fiberIds.begin();
   while ( finIt != fiberIds.end() )
   {
-    if (*finIt>GetNumFibers()){
+    if (*finIt>=GetNumFibers()){
       MITK_INFO << "FiberID can not be negative or >NumFibers!!! check id Extraction!" << *finIt;
       break;
     }
 
-    vtkSmartPointer<vtkCell> fiber = m_FiberIdDataSet->GetCell(*finIt);//->DeepCopy(fiber);
-    vtkSmartPointer<vtkPoints> fibPoints = fiber->GetPoints();
+    const vtkIdType first = m_FiberPointOffsets[*finIt];
+    const vtkIdType numPoints = m_FiberPointOffsets[*finIt+1] - first;
     vtkSmartPointer<vtkPolyLine> newFiber = vtkSmartPointer<vtkPolyLine>::New();
-    newFiber->GetPointIds()->SetNumberOfIds( fibPoints->GetNumberOfPoints() );
+    newFiber->GetPointIds()->SetNumberOfIds( numPoints );
 
-    for(int i=0; i<fibPoints->GetNumberOfPoints(); i++)
+    for(vtkIdType i=0; i<numPoints; i++)
     {
+      const float* p = m_FiberPoints.data() + 3*(first+i);
       newFiber->GetPointIds()->SetId(i, newPointSet->GetNumberOfPoints());
-      newPointSet->InsertNextPoint(fibPoints->GetPoint(i)[0], fibPoints->GetPoint(i)[1], fibPoints->GetPoint(i)[2]);
+      newPointSet->InsertNextPoint(p[0], p[1], p[2]);
     }
 
     weights->InsertValue(counter, this->GetFiberWeight(*finIt));
@@ -121,6 +126,7 @@ vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vecto
 // merge two fiber bundles
 mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundles(std::vector< mitk::FiberBundle::Pointer > fibs)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
@@ -134,9 +140,9 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundles(std::vector< mitk::Fibe
   weights->SetNumberOfValues(num_weights);
 
   unsigned int counter = 0;
-  for (unsigned int i=0; i<m_FiberPolyData->GetNumberOfCells(); ++i)
+  for (unsigned int i=0; i<fiberPolyData->GetNumberOfCells(); ++i)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -191,6 +197,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundles(std::vector< mitk::Fibe
 // merge two fiber bundles
 mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   if (fib==nullptr)
     return this->GetDeepCopy();
 
@@ -205,9 +212,9 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
   weights->SetNumberOfValues(this->GetNumFibers()+fib->GetNumFibers());
 
   unsigned int counter = 0;
-  for (unsigned int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  for (unsigned int i=0; i<fiberPolyData->GetNumberOfCells(); i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -259,6 +266,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
 // Only retain fibers with a weight larger than the specified threshold
 mitk::FiberBundle::Pointer mitk::FiberBundle::FilterByWeights(float weight_thr, bool invert)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
@@ -270,7 +278,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::FilterByWeights(float weight_thr,
     if ( (invert && this->GetFiberWeight(i)>weight_thr) || (!invert && this->GetFiberWeight(i)<=weight_thr))
       continue;
 
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -301,6 +309,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::FilterByWeights(float weight_thr,
 // Only retain a subsample of the fibers
 mitk::FiberBundle::Pointer mitk::FiberBundle::SubsampleFibers(float factor, bool random_seed)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
@@ -324,7 +333,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubsampleFibers(float factor, bool
   unsigned int counter = 0;
   for (unsigned int i=0; i<new_num_fibs; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(ids.at(i));
+    vtkCell* cell = fiberPolyData->GetCell(ids.at(i));
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -355,6 +364,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubsampleFibers(float factor, bool
 // subtract two fiber bundles
 mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle* fib)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   if (fib==nullptr)
     return this->GetDeepCopy();
 
@@ -366,7 +376,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
   std::vector< std::vector< itk::Point<float, 3> > > points1;
   for(unsigned int i=0; i<m_NumFibers; i++ )
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -454,7 +464,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
 
   for( int i : ids )
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -485,23 +495,28 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
 void mitk::FiberBundle::SetFiberPolyData(vtkSmartPointer<vtkPolyData> fiberPD, bool updateGeometry)
 {
   if (fiberPD == nullptr)
-    this->m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  else
-    m_FiberPolyData->DeepCopy(fiberPD);
+    fiberPD = vtkSmartPointer<vtkPolyData>::New();
+  this->ImportFiberPolyData(fiberPD);
 
-  m_NumFibers = static_cast<unsigned int>(m_FiberPolyData->GetNumberOfLines());
+  m_NumFibers = static_cast<unsigned int>(m_FiberPointOffsets.size() - 1);
 
   if (updateGeometry)
     UpdateFiberGeometry();
-  GenerateFiberIds();
   ColorFibersByOrientation();
 }
 
 /*
- * return vtkPolyData
+ * return vtkPolyData, generated from the fiber storage if it changed since the last call
  */
 vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GetFiberPolyData() const
 {
+  if (m_FiberPolyDataOutdated)
+  {
+    // the returned object stays the same, only its content is replaced
+    m_FiberPolyData->ShallowCopy(this->GeneratePolyDataFromStorage());
+    m_FiberPolyDataTime = GetFiberGeometryMTime(m_FiberPolyData);
+    m_FiberPolyDataOutdated = false;
+  }
   return m_FiberPolyData;
 }
 
@@ -510,16 +525,16 @@ void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
   if (m_MaxFiberLength<=0)
     return;
 
-  auto numOfPoints = this->GetNumberOfPoints();
+  this->UpdateFiberStorage();
+  auto numOfPoints = m_FiberPointOffsets.back();
 
   //colors and alpha value for each single point, RGBA = 4 components
-  unsigned char rgba[4] = {0,0,0,0};
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(numOfPoints * 4);
   m_FiberColors->SetNumberOfComponents(4);
+  m_FiberColors->SetNumberOfTuples(numOfPoints);
   m_FiberColors->SetName("FIBER_COLORS");
 
-  auto numOfFibers = m_FiberPolyData->GetNumberOfLines();
+  auto numOfFibers = static_cast<int>(m_FiberPointOffsets.size()) - 1;
   if (numOfFibers < 1)
     return;
 
@@ -530,35 +545,40 @@ void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
   mitkLookup->SetVtkLookupTable(lookupTable);
   mitkLookup->SetType(mitk::LookupTable::JET);
 
-  unsigned int count = 0;
-  for (unsigned int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  // one color per fiber, looked up sequentially since the lookup table is not thread safe
+  std::vector< std::array<unsigned char, 4> > fiberColors(static_cast<std::size_t>(numOfFibers));
+  for (int i=0; i<numOfFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-
-    float l = m_FiberLengths.at(i)/m_MaxFiberLength;
+    float l = m_FiberLengths.at(static_cast<unsigned int>(i))/m_MaxFiberLength;
     if (!normalize)
     {
-      l = m_FiberLengths.at(i)/255.0f;
+      l = m_FiberLengths.at(static_cast<unsigned int>(i))/255.0f;
       if (l > 1.0f)
         l = 1.0;
     }
-    for (int j=0; j<numPoints; j++)
-    {
-      double color[3];
-      lookupTable->GetColor(1.0 - static_cast<double>(l), color);
 
-      rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
-      rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
-      rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
-      if (opacity)
-        rgba[3] = static_cast<unsigned char>(255.0f * l);
-      else
-        rgba[3] = static_cast<unsigned char>(255.0);
-      m_FiberColors->InsertTypedTuple(cell->GetPointId(j), rgba);
-      count++;
-    }
+    double color[3];
+    lookupTable->GetColor(1.0 - static_cast<double>(l), color);
+
+    auto& rgba = fiberColors[static_cast<std::size_t>(i)];
+    rgba[0] = static_cast<unsigned char>(255.0 * color[0]);
+    rgba[1] = static_cast<unsigned char>(255.0 * color[1]);
+    rgba[2] = static_cast<unsigned char>(255.0 * color[2]);
+    if (opacity)
+      rgba[3] = static_cast<unsigned char>(255.0f * l);
+    else
+      rgba[3] = static_cast<unsigned char>(255.0);
   }
+
+  unsigned char* colors = m_FiberColors->GetPointer(0);
+#pragma omp parallel for
+  for (int i=0; i<numOfFibers; i++)
+  {
+    const auto& rgba = fiberColors[static_cast<std::size_t>(i)];
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]; j++)
+      std::copy(rgba.begin(), rgba.end(), colors + 4*j);
+  }
+
   m_UpdateTime3D.Modified();
   m_UpdateTime2D.Modified();
 }
@@ -573,92 +593,52 @@ void mitk::FiberBundle::ColorFibersByOrientation()
   //  + one fiber with 0 points
   //=================================================
 
-  vtkPoints* extrPoints = m_FiberPolyData->GetPoints();
-  vtkIdType numOfPoints = 0;
-  if (extrPoints!=nullptr)
-    numOfPoints = extrPoints->GetNumberOfPoints();
+  this->UpdateFiberStorage();
+  vtkIdType numOfPoints = m_FiberPointOffsets.back();
 
   //colors and alpha value for each single point, RGBA = 4 components
-  unsigned char rgba[4] = {0,0,0,0};
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(numOfPoints * 4);
   m_FiberColors->SetNumberOfComponents(4);
+  m_FiberColors->SetNumberOfTuples(numOfPoints);
   m_FiberColors->SetName("FIBER_COLORS");
+  if (numOfPoints > 0)
+    std::fill(m_FiberColors->GetPointer(0), m_FiberColors->GetPointer(0) + 4*numOfPoints, 0);  // fibers with less than two points remain transparent
 
-  auto numOfFibers = m_FiberPolyData->GetNumberOfLines();
+  auto numOfFibers = static_cast<int>(m_FiberPointOffsets.size()) - 1;
   if (numOfFibers < 1)
     return;
 
-  /* extract single fibers of fiberBundle */
-  vtkCellArray* fiberList = m_FiberPolyData->GetLines();
-  fiberList->InitTraversal();
-  for (int fi=0; fi<numOfFibers; ++fi) {
+  unsigned char* colors = m_FiberColors->GetPointer(0);
+  const float* points = m_FiberPoints.data();
 
-    vtkIdType* idList; // contains the point id's of the line
-    vtkIdType pointsPerFiber; // number of points for current line
-    fiberList->GetNextCell(pointsPerFiber, idList);
+#pragma omp parallel for
+  for (int fi=0; fi<numOfFibers; ++fi)
+  {
+    const vtkIdType first = m_FiberPointOffsets[fi];
+    const vtkIdType pointsPerFiber = m_FiberPointOffsets[fi+1] - first;
 
     /* single fiber checkpoints: is number of points valid */
     if (pointsPerFiber > 1)
     {
       /* operate on points of single fiber */
-      for (int i=0; i <pointsPerFiber; ++i)
+      for (vtkIdType i=0; i<pointsPerFiber; ++i)
       {
-        /* process all points elastV[0]ept starting and endpoint for calculating color value take current point, previous point and next point */
-        if (i<pointsPerFiber-1 && i > 0)
-        {
-          /* The color value of the current point is influenced by the previous point and next point. */
-          vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-          vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
-          vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
-
-          vnl_vector_fixed< double, 3 > diff1;
-          diff1 = currentPntvtk - nextPntvtk;
-
-          vnl_vector_fixed< double, 3 > diff2;
-          diff2 = currentPntvtk - prevPntvtk;
-
-          vnl_vector_fixed< double, 3 > diff;
-          diff = (diff1 - diff2) / 2.0;
-          diff.normalize();
-
-          rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff[0]));
-          rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff[1]));
-          rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff[2]));
-          rgba[3] = static_cast<unsigned char>(255.0);
-        }
-        else if (i==0)
-        {
-          /* First point has no previous point, therefore only diff1 is taken */
-
-          vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-          vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
-
-          vnl_vector_fixed< double, 3 > diff1;
-          diff1 = currentPntvtk - nextPntvtk;
-          diff1.normalize();
-
-          rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff1[0]));
-          rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff1[1]));
-          rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff1[2]));
-          rgba[3] = static_cast<unsigned char>(255.0);
-        }
-        else if (i==pointsPerFiber-1)
-        {
-          /* Last point has no next point, therefore only diff2 is taken */
-          vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-          vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
-
-          vnl_vector_fixed< double, 3 > diff2;
-          diff2 = currentPntvtk - prevPntvtk;
-          diff2.normalize();
-
-          rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff2[0]));
-          rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff2[1]));
-          rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff2[2]));
-          rgba[3] = static_cast<unsigned char>(255.0);
-        }
-        m_FiberColors->InsertTypedTuple(idList[i], rgba);
+        /* the color of inner points is given by the direction from the previous to the next point,
+           first and last point only use the direction to their neighbor */
+        const float* prev = points + 3*(first + std::max<vtkIdType>(i-1, 0));
+        const float* next = points + 3*(first + std::min<vtkIdType>(i+1, pointsPerFiber-1));
+
+        vnl_vector_fixed< double, 3 > diff;
+        diff[0] = static_cast<double>(next[0]) - prev[0];
+        diff[1] = static_cast<double>(next[1]) - prev[1];
+        diff[2] = static_cast<double>(next[2]) - prev[2];
+        diff.normalize();
+
+        unsigned char* rgba = colors + 4*(first + i);
+        rgba[0] = static_cast<unsigned char>(255.0 * std::fabs(diff[0]));
+        rgba[1] = static_cast<unsigned char>(255.0 * std::fabs(diff[1]));
+        rgba[2] = static_cast<unsigned char>(255.0 * std::fabs(diff[2]));
+        rgba[3] = static_cast<unsigned char>(255.0);
       }
     }
     else if (pointsPerFiber == 1)
@@ -678,12 +658,13 @@ void mitk::FiberBundle::ColorFibersByOrientation()
 
 void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   double window = 5;
 
   //colors and alpha value for each single point, RGBA = 4 components
   unsigned char rgba[4] = {0,0,0,0};
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
+  m_FiberColors->Allocate(fiberPolyData->GetNumberOfPoints() * 4);
   m_FiberColors->SetNumberOfComponents(4);
   m_FiberColors->SetName("FIBER_COLORS");
 
@@ -698,11 +679,11 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
   double min = 1;
   double max = 0;
   MITK_INFO << "Coloring fibers by curvature";
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  boost::progress_display disp(static_cast<unsigned long>(fiberPolyData->GetNumberOfCells()));
+  for (int i=0; i<fiberPolyData->GetNumberOfCells(); i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -773,9 +754,9 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
     }
   }
   unsigned int count = 0;
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  for (int i=0; i<fiberPolyData->GetNumberOfCells(); i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     for (int j=0; j<numPoints; j++)
     {
@@ -829,15 +810,16 @@ void mitk::FiberBundle::ColorFibersByScalarMap(mitk::Image::Pointer FAimage, boo
 template <typename TPixel>
 void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Image::Pointer image, bool opacity, bool normalize)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
+  m_FiberColors->Allocate(fiberPolyData->GetNumberOfPoints() * 4);
   m_FiberColors->SetNumberOfComponents(4);
   m_FiberColors->SetName("FIBER_COLORS");
 
   mitk::ImagePixelReadAccessor<TPixel,3> readimage(image, image->GetVolumeData(0));
 
   unsigned char rgba[4] = {0,0,0,0};
-  vtkPoints* pointSet = m_FiberPolyData->GetPoints();
+  vtkPoints* pointSet = fiberPolyData->GetPoints();
 
   mitk::LookupTable::Pointer mitkLookup = mitk::LookupTable::New();
   vtkSmartPointer<vtkLookupTable> lookupTable = vtkSmartPointer<vtkLookupTable>::New();
@@ -848,7 +830,7 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
 
   double min = 999999;
   double max = -999999;
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+  for(long i=0; i<fiberPolyData->GetNumberOfPoints(); ++i)
   {
     Point3D px;
     px[0] = pointSet->GetPoint(i)[0];
@@ -861,7 +843,7 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
       min = pixelValue;
   }
 
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+  for(long i=0; i<fiberPolyData->GetNumberOfPoints(); ++i)
   {
     Point3D px;
     px[0] = pointSet->GetPoint(i)[0];
@@ -893,8 +875,9 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
 
 void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
+  m_FiberColors->Allocate(fiberPolyData->GetNumberOfPoints() * 4);
   m_FiberColors->SetNumberOfComponents(4);
   m_FiberColors->SetName("FIBER_COLORS");
 
@@ -926,7 +909,7 @@ void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     auto weight = this->GetFiberWeight(i);
 
@@ -959,13 +942,15 @@ void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 
 void mitk::FiberBundle::SetFiberColors(float r, float g, float b, float alpha)
 {
+  this->UpdateFiberStorage();
+  const vtkIdType numPoints = m_FiberPointOffsets.back();
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
+  m_FiberColors->Allocate(numPoints * 4);
   m_FiberColors->SetNumberOfComponents(4);
   m_FiberColors->SetName("FIBER_COLORS");
 
   unsigned char rgba[4] = {0,0,0,0};
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+  for(vtkIdType i=0; i<numPoints; ++i)
   {
     rgba[0] = static_cast<unsigned char>(r);
     rgba[1] = static_cast<unsigned char>(g);
@@ -977,26 +962,9 @@ void mitk::FiberBundle::SetFiberColors(float r, float g, float b, float alpha)
   m_UpdateTime2D.Modified();
 }
 
-void mitk::FiberBundle::GenerateFiberIds()
-{
-  if (m_FiberPolyData == nullptr)
-    return;
-
-  vtkSmartPointer<vtkIdFilter> idFiberFilter = vtkSmartPointer<vtkIdFilter>::New();
-  idFiberFilter->SetInputData(m_FiberPolyData);
-  idFiberFilter->CellIdsOn();
-  //  idFiberFilter->PointIdsOn(); // point id's are not needed
-  idFiberFilter->SetIdsArrayName(FIBER_ID_ARRAY);
-  idFiberFilter->FieldDataOn();
-  idFiberFilter->Update();
-
-  m_FiberIdDataSet = idFiberFilter->GetOutput();
-
-}
-
 float mitk::FiberBundle::GetNumEpFractionInMask(ItkUcharImgType* mask, bool different_label)
 {
-  vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
+  vtkSmartPointer<vtkPolyData> PolyData = this->GetFiberPolyData();
 
   MITK_INFO << "Calculating EP-Fraction";
 
@@ -1038,7 +1006,7 @@ float mitk::FiberBundle::GetNumEpFractionInMask(ItkUcharImgType* mask, bool diff
 
 std::tuple<float, float> mitk::FiberBundle::GetDirectionalOverlap(ItkUcharImgType* mask, mitk::PeakImage::ItkPeakImageType* peak_image)
 {
-  vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
+  vtkSmartPointer<vtkPolyData> PolyData = this->GetFiberPolyData();
 
   MITK_INFO << "Calculating overlap";
   auto spacing = mask->GetSpacing();
@@ -1114,9 +1082,16 @@ std::tuple<float, float> mitk::FiberBundle::GetDirectionalOverlap(ItkUcharImgTyp
 
 float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask)
 {
-  vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
-
   MITK_INFO << "Calculating overlap";
+
+  // only fibers close to the mask voxels can overlap, all others only contribute their length
+  std::vector< bool > candidate(m_NumFibers, false);
+  double bounds[6];
+  if (mitk::imv::GetImageBounds<unsigned char>(mask, 1, 0, bounds))
+    for (auto i : this->GetFiberIdsInBounds(bounds))
+      candidate[i] = true;
+  this->UpdateFiberStorage();
+
   auto spacing = mask->GetSpacing();
   boost::progress_display disp(m_NumFibers);
   double length_sum = 0;
@@ -1124,19 +1099,24 @@ float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask)
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp;
-    vtkCell* cell = PolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    for (int j=0; j<numPoints-1; j++)
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]-1; j++)
     {
-      itk::Point<float, 3> startVertex =mitk::imv::GetItkPoint(points->GetPoint(j));
+      const float* p1 = m_FiberPoints.data() + 3*j;
+      const float* p2 = p1 + 3;
+
+      if (!candidate[i])
+      {
+        length_sum += std::sqrt( (p2[0]-p1[0])*(p2[0]-p1[0]) + (p2[1]-p1[1])*(p2[1]-p1[1]) + (p2[2]-p1[2])*(p2[2]-p1[2]) );
+        continue;
+      }
+
+      itk::Point<float, 3> startVertex(p1);
       itk::Index<3> startIndex;
       itk::ContinuousIndex<float, 3> startIndexCont;
       mask->TransformPhysicalPointToIndex(startVertex, startIndex);
       mask->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
 
-      itk::Point<float, 3> endVertex =mitk::imv::GetItkPoint(points->GetPoint(j + 1));
+      itk::Point<float, 3> endVertex(p2);
       itk::Index<3> endIndex;
       itk::ContinuousIndex<float, 3> endIndexCont;
       mask->TransformPhysicalPointToIndex(endVertex, endIndex);
@@ -1167,29 +1147,41 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::RemoveFibersOutside(ItkUcharImgTyp
 
   std::vector< float > fib_weights;
 
+  // fibers that do not pass the bounding box of the mask voxels are completely outside of the mask
+  std::vector< bool > candidate(m_NumFibers, false);
+  double bounds[6];
+  if (mitk::imv::GetImageBounds<unsigned char>(mask, 1, 0, bounds))
+    for (auto i : this->GetFiberIdsInBounds(bounds))
+      candidate[i] = true;
+  this->UpdateFiberStorage();
+
   MITK_INFO << "Cutting fibers";
   boost::progress_display disp(m_NumFibers);
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp;
+    if (!candidate[i] && !invert)
+      continue;
 
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+    const vtkIdType offset = m_FiberPointOffsets[i];
+    auto numPoints = m_FiberPointOffsets[i+1] - offset;
 
     vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
     int newNumPoints = 0;
     if (numPoints>1)
     {
-      for (int j=0; j<numPoints; j++)
+      for (vtkIdType j=0; j<numPoints; j++)
       {
-        itk::Point<float, 3> itkP =mitk::imv::GetItkPoint(points->GetPoint(j));
-        itk::Index<3> idx;
-        mask->TransformPhysicalPointToIndex(itkP, idx);
+        itk::Point<float, 3> itkP(m_FiberPoints.data() + 3*(offset+j));
 
         bool inside = false;
-        if ( mask->GetLargestPossibleRegion().IsInside(idx) && mask->GetPixel(idx)!=0 )
-          inside = true;
+        if (candidate[i])
+        {
+          itk::Index<3> idx;
+          mask->TransformPhysicalPointToIndex(itkP, idx);
+          if ( mask->GetLargestPossibleRegion().IsInside(idx) && mask->GetPixel(idx)!=0 )
+            inside = true;
+        }
 
         if (inside && !invert)
         {
@@ -1360,23 +1352,27 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
         polygonVtk->GetPointIds()->InsertNextId(id);
       }
 
+      double tolerance = 0.001;
+      double bounds[6];
+      polygonVtk->GetPoints()->GetBounds(bounds);
+      for (int k=0; k<3; ++k)
+      {
+        bounds[2*k] -= tolerance;
+        bounds[2*k+1] += tolerance;
+      }
+      std::vector<unsigned int> candidates = this->GetFiberIdsInBounds(bounds);
+
       MITK_INFO << "Extracting with polygon";
-      boost::progress_display disp(m_NumFibers);
-      for (unsigned int i=0; i<m_NumFibers; i++)
+      boost::progress_display disp(candidates.size());
+      for (auto i : candidates)
       {
         ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        auto numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        for (int j=0; j<numPoints-1; j++)
+        for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]-1; j++)
         {
           // Inputs
-          double p1[3] = {0,0,0};
-          points->GetPoint(j, p1);
-          double p2[3] = {0,0,0};
-          points->GetPoint(j+1, p2);
-          double tolerance = 0.001;
+          const float* p = m_FiberPoints.data() + 3*j;
+          double p1[3] = {p[0], p[1], p[2]};
+          double p2[3] = {p[3], p[4], p[5]};
 
           // Outputs
           double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
@@ -1404,24 +1400,26 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
       mitk::Point3D V2w  = planarFigure->GetWorldControlPoint(1); //radiusPoint
 
       double radius = V1w.EuclideanDistanceTo(V2w);
+      double bounds[6];
+      for (int k=0; k<3; ++k)
+      {
+        bounds[2*k] = V1w[k] - radius;
+        bounds[2*k+1] = V1w[k] + radius;
+      }
+      std::vector<unsigned int> candidates = this->GetFiberIdsInBounds(bounds);
       radius *= radius;
 
       MITK_INFO << "Extracting with circle";
-      boost::progress_display disp(m_NumFibers);
-      for (unsigned int i=0; i<m_NumFibers; i++)
+      boost::progress_display disp(candidates.size());
+      for (auto i : candidates)
       {
         ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        auto numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        for (int j=0; j<numPoints-1; j++)
+        for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]-1; j++)
         {
           // Inputs
-          double p1[3] = {0,0,0};
-          points->GetPoint(j, p1);
-          double p2[3] = {0,0,0};
-          points->GetPoint(j+1, p2);
+          const float* p = m_FiberPoints.data() + 3*j;
+          double p1[3] = {p[0], p[1], p[2]};
+          double p2[3] = {p[3], p[4], p[5]};
 
           // Outputs
           double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
@@ -1447,21 +1445,320 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
   return result;
 }
 
+void mitk::FiberBundle::ImportFiberPolyData(vtkPolyData* polyData)
+{
+  std::vector< float > fiberPoints;
+  std::vector< vtkIdType > fiberPointOffsets(1, 0);
+
+  vtkPoints* points = polyData->GetPoints();
+  vtkCellArray* lines = polyData->GetLines();
+
+  bool consecutive = true;
+  std::vector< vtkIdType > pointIds;
+  if (points!=nullptr && lines!=nullptr)
+  {
+    const vtkIdType numPoints = lines->GetNumberOfConnectivityEntries() - lines->GetNumberOfCells();
+    fiberPoints.reserve(static_cast<std::size_t>(3*numPoints));
+    fiberPointOffsets.reserve(static_cast<std::size_t>(lines->GetNumberOfCells()+1));
+    pointIds.reserve(static_cast<std::size_t>(numPoints));
+
+    // float points are copied directly from the data array, everything else is converted point by point
+    const float* data = nullptr;
+    if (points->GetDataType()==VTK_FLOAT)
+      data = static_cast<vtkFloatArray*>(points->GetData())->GetPointer(0);
+
+    vtkIdType* idList;
+    vtkIdType pointsPerFiber;
+    lines->InitTraversal();
+    while (lines->GetNextCell(pointsPerFiber, idList))
+    {
+      for (vtkIdType j=0; j<pointsPerFiber; ++j)
+      {
+        const vtkIdType id = idList[j];
+        if (id!=static_cast<vtkIdType>(pointIds.size()))
+          consecutive = false;
+        pointIds.push_back(id);
+
+        if (data!=nullptr)
+          fiberPoints.insert(fiberPoints.end(), data + 3*id, data + 3*id + 3);
+        else
+        {
+          double p[3];
+          points->GetPoint(id, p);
+          fiberPoints.push_back(static_cast<float>(p[0]));
+          fiberPoints.push_back(static_cast<float>(p[1]));
+          fiberPoints.push_back(static_cast<float>(p[2]));
+        }
+      }
+      fiberPointOffsets.push_back(static_cast<vtkIdType>(pointIds.size()));
+    }
+
+    if (points->GetNumberOfPoints()!=static_cast<vtkIdType>(pointIds.size()))
+      consecutive = false;
+  }
+
+  // point data is stored in the order of the storage, shared or unused points are duplicated or dropped with their values
+  vtkSmartPointer<vtkPointData> pointData = vtkSmartPointer<vtkPointData>::New();
+  if (consecutive)
+    pointData->DeepCopy(polyData->GetPointData());
+  else
+  {
+    pointData->CopyAllocate(polyData->GetPointData(), static_cast<vtkIdType>(pointIds.size()));
+    for (std::size_t i=0; i<pointIds.size(); ++i)
+      pointData->CopyData(polyData->GetPointData(), pointIds[i], static_cast<vtkIdType>(i));
+
+    if (m_FiberColors!=nullptr && points!=nullptr && m_FiberColors->GetNumberOfTuples()==points->GetNumberOfPoints())
+    {
+      vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+      colors->SetNumberOfComponents(4);
+      colors->SetNumberOfTuples(static_cast<vtkIdType>(pointIds.size()));
+      colors->SetName("FIBER_COLORS");
+      for (std::size_t i=0; i<pointIds.size(); ++i)
+        colors->SetTypedTuple(static_cast<vtkIdType>(i), m_FiberColors->GetPointer(4*pointIds[i]));
+      m_FiberColors = colors;
+    }
+  }
+
+  // cell data of the lines, which follow the vertices in the cell ids of vtkPolyData
+  vtkSmartPointer<vtkCellData> cellData = vtkSmartPointer<vtkCellData>::New();
+  const vtkIdType numLines = static_cast<vtkIdType>(fiberPointOffsets.size()) - 1;
+  if (polyData->GetNumberOfCells()==numLines)
+    cellData->DeepCopy(polyData->GetCellData());
+  else
+  {
+    const vtkIdType firstLine = polyData->GetNumberOfVerts();
+    cellData->CopyAllocate(polyData->GetCellData(), numLines);
+    for (vtkIdType i=0; i<numLines; ++i)
+      cellData->CopyData(polyData->GetCellData(), firstLine + i, i);
+  }
+
+  m_FiberPoints.swap(fiberPoints);
+  m_FiberPointOffsets.swap(fiberPointOffsets);
+  m_FiberPointData = pointData;
+  m_FiberCellData = cellData;
+  this->FiberStorageModified();
+}
+
+void mitk::FiberBundle::FiberStorageModified()
+{
+  m_FiberStorageTime.Modified();
+  m_FiberPolyDataOutdated = true;
+}
+
+vtkMTimeType mitk::FiberBundle::GetFiberGeometryMTime(vtkPolyData* polyData)
+{
+  vtkMTimeType time = 0;
+  if (polyData->GetPoints()!=nullptr)
+    time = polyData->GetPoints()->GetMTime();
+  if (polyData->GetLines()!=nullptr)
+    time = std::max(time, polyData->GetLines()->GetMTime());
+  return time;
+}
+
+void mitk::FiberBundle::UpdateFiberStorage()
+{
+  // points or lines of the polydata were modified from outside
+  if (!m_FiberPolyDataOutdated && GetFiberGeometryMTime(m_FiberPolyData)!=m_FiberPolyDataTime)
+    this->ImportFiberPolyData(m_FiberPolyData);
+}
+
+void mitk::FiberBundle::GetFiberStorageBounds(double bounds[6]) const
+{
+  std::fill(bounds, bounds+6, 0.0);
+  if (m_FiberPoints.empty())
+    return;
+
+  const float* points = m_FiberPoints.data();
+  for (int k=0; k<3; ++k)
+    bounds[2*k] = bounds[2*k+1] = points[k];
+  for (std::size_t i=0; i<m_FiberPoints.size(); i+=3)
+    for (int k=0; k<3; ++k)
+    {
+      bounds[2*k] = std::min(bounds[2*k], static_cast<double>(points[i+k]));
+      bounds[2*k+1] = std::max(bounds[2*k+1], static_cast<double>(points[i+k]));
+    }
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataFromStorage() const
+{
+  const vtkIdType numPoints = m_FiberPointOffsets.back();
+  const auto numFibers = static_cast<int>(m_FiberPointOffsets.size()) - 1;
+
+  vtkSmartPointer<vtkFloatArray> pointData = vtkSmartPointer<vtkFloatArray>::New();
+  pointData->SetNumberOfComponents(3);
+  pointData->SetNumberOfTuples(numPoints);
+  std::copy(m_FiberPoints.begin(), m_FiberPoints.end(), pointData->GetPointer(0));
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetData(pointData);
+
+  // legacy cell layout: number of points followed by the point ids of each fiber
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(numPoints + numFibers);
+  vtkIdType* ids = connectivity->GetPointer(0);
+#pragma omp parallel for
+  for (int i=0; i<numFibers; i++)
+  {
+    vtkIdType* cell = ids + m_FiberPointOffsets[i] + i;
+    *cell++ = m_FiberPointOffsets[i+1] - m_FiberPointOffsets[i];
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]; j++)
+      *cell++ = j;
+  }
+
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  lines->SetCells(numFibers, connectivity);
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetLines(lines);
+  polyData->GetPointData()->ShallowCopy(m_FiberPointData);
+  polyData->GetCellData()->ShallowCopy(m_FiberCellData);
+  return polyData;
+}
+
+void mitk::FiberBundle::TransformFiberPoints(const vnl_matrix_fixed<double,3,3>& matrix, const vnl_vector_fixed<double,3>& offset)
+{
+  this->UpdateFiberStorage();
+
+  float* points = m_FiberPoints.data();
+  const auto numPoints = static_cast<long>(m_FiberPointOffsets.back());
+#pragma omp parallel for
+  for (long i=0; i<numPoints; i++)
+  {
+    float* p = points + 3*i;
+    const double x = p[0], y = p[1], z = p[2];
+    p[0] = static_cast<float>(matrix[0][0]*x + matrix[0][1]*y + matrix[0][2]*z + offset[0]);
+    p[1] = static_cast<float>(matrix[1][0]*x + matrix[1][1]*y + matrix[1][2]*z + offset[1]);
+    p[2] = static_cast<float>(matrix[2][0]*x + matrix[2][1]*y + matrix[2][2]*z + offset[2]);
+  }
+
+  this->FiberStorageModified();
+  this->UpdateFiberGeometry();
+  this->ColorFibersByOrientation();
+}
+
+void mitk::FiberBundle::UpdateFiberGrid()
+{
+  this->UpdateFiberStorage();
+  if (m_FiberGridTime==m_FiberStorageTime.GetMTime())
+    return;
+
+  // number of cells along the longest side of the bundle
+  const double cellsPerSide = 64;
+
+  const auto numFibers = static_cast<int>(m_FiberPointOffsets.size()) - 1;
+  const float* points = m_FiberPoints.data();
+
+  double bounds[6];
+  this->GetFiberStorageBounds(bounds);
+
+  double maxExtent = std::max(bounds[1]-bounds[0], std::max(bounds[3]-bounds[2], bounds[5]-bounds[4]));
+  m_FiberGridSpacing = maxExtent>0 ? maxExtent/cellsPerSide : 1.0;
+  for (int k=0; k<3; ++k)
+  {
+    m_FiberGridOrigin[k] = bounds[2*k];
+    m_FiberGridSize[k] = std::max(1, static_cast<int>(std::ceil((bounds[2*k+1]-bounds[2*k])/m_FiberGridSpacing)));
+  }
+
+  auto cellIndex = [this](double x, int k)
+  {
+    auto idx = static_cast<int>(std::floor((x-m_FiberGridOrigin[k])/m_FiberGridSpacing));
+    return std::min(std::max(idx, 0), m_FiberGridSize[k]-1);
+  };
+
+  // cells touched by the bounding box of each segment (or of the single point of a fiber)
+  std::vector< std::vector< unsigned int > > fiberCells(static_cast<std::size_t>(std::max(numFibers, 0)));
+#pragma omp parallel for
+  for (int i=0; i<numFibers; i++)
+  {
+    std::vector< unsigned int >& cells = fiberCells[i];
+    const vtkIdType first = m_FiberPointOffsets[i];
+    const vtkIdType end = m_FiberPointOffsets[i+1];
+    if (end<=first)
+      continue;
+    for (vtkIdType j=first; j==first || j<end-1; j++)
+    {
+      const float* p1 = points + 3*j;
+      const float* p2 = j+1<end ? p1 + 3 : p1;
+      int minIdx[3], maxIdx[3];
+      for (int k=0; k<3; ++k)
+      {
+        minIdx[k] = cellIndex(std::min(p1[k], p2[k]), k);
+        maxIdx[k] = cellIndex(std::max(p1[k], p2[k]), k);
+      }
+      for (int z=minIdx[2]; z<=maxIdx[2]; ++z)
+        for (int y=minIdx[1]; y<=maxIdx[1]; ++y)
+          for (int x=minIdx[0]; x<=maxIdx[0]; ++x)
+            cells.push_back(static_cast<unsigned int>(x + m_FiberGridSize[0]*(y + m_FiberGridSize[1]*z)));
+    }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+  }
+
+  // counting sort by cell; fibers are visited in ascending order, so the ids of each cell stay sorted
+  const std::size_t numCells = static_cast<std::size_t>(m_FiberGridSize[0])*m_FiberGridSize[1]*m_FiberGridSize[2];
+  m_FiberGridOffsets.assign(numCells+1, 0);
+  for (const auto& cells : fiberCells)
+    for (auto c : cells)
+      ++m_FiberGridOffsets[c+1];
+  for (std::size_t c=0; c<numCells; ++c)
+    m_FiberGridOffsets[c+1] += m_FiberGridOffsets[c];
+
+  m_FiberGridIds.resize(m_FiberGridOffsets.back());
+  std::vector< std::size_t > fill(m_FiberGridOffsets.begin(), m_FiberGridOffsets.end()-1);
+  for (int i=0; i<numFibers; i++)
+  {
+    for (auto c : fiberCells[i])
+      m_FiberGridIds[fill[c]++] = static_cast<unsigned int>(i);
+    std::vector< unsigned int >().swap(fiberCells[i]);
+  }
+
+  m_FiberGridTime = m_FiberStorageTime.GetMTime();
+}
+
+std::vector<unsigned int> mitk::FiberBundle::GetFiberIdsInBounds(const double bounds[6])
+{
+  this->UpdateFiberGrid();
+
+  std::vector<unsigned int> ids;
+  if (m_FiberGridIds.empty())
+    return ids;
+
+  int minIdx[3], maxIdx[3];
+  for (int k=0; k<3; ++k)
+  {
+    const double lower = std::floor((bounds[2*k]-m_FiberGridOrigin[k])/m_FiberGridSpacing);
+    const double upper = std::floor((bounds[2*k+1]-m_FiberGridOrigin[k])/m_FiberGridSpacing);
+    if (upper<0 || lower>=m_FiberGridSize[k] || upper<lower)
+      return ids;
+    minIdx[k] = static_cast<int>(std::max(lower, 0.0));
+    maxIdx[k] = static_cast<int>(std::min(upper, static_cast<double>(m_FiberGridSize[k]-1)));
+  }
+
+  for (int z=minIdx[2]; z<=maxIdx[2]; ++z)
+    for (int y=minIdx[1]; y<=maxIdx[1]; ++y)
+    {
+      // cells along x are adjacent, so the ids of a row are one contiguous range
+      const std::size_t row = static_cast<std::size_t>(m_FiberGridSize[0])*(y + static_cast<std::size_t>(m_FiberGridSize[1])*z);
+      ids.insert(ids.end(), m_FiberGridIds.begin() + m_FiberGridOffsets[row+minIdx[0]], m_FiberGridIds.begin() + m_FiberGridOffsets[row+maxIdx[0]+1]);
+    }
+
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return ids;
+}
+
 void mitk::FiberBundle::UpdateFiberGeometry()
 {
-  vtkSmartPointer<vtkCleanPolyData> cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
-  cleaner->SetInputData(m_FiberPolyData);
-  cleaner->PointMergingOff();
-  cleaner->Update();
-  m_FiberPolyData = cleaner->GetOutput();
+  this->UpdateFiberStorage();
 
   m_FiberLengths.clear();
   m_MeanFiberLength = 0;
   m_MedianFiberLength = 0;
   m_LengthStDev = 0;
-  m_NumFibers = static_cast<unsigned int>(m_FiberPolyData->GetNumberOfCells());
+  m_NumFibers = static_cast<unsigned int>(m_FiberPointOffsets.size() - 1);
 
-  if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=m_FiberPolyData->GetNumberOfPoints())
+  if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=m_FiberPointOffsets.back())
     this->ColorFibersByOrientation();
 
   if (m_FiberWeights->GetNumberOfValues()!=m_NumFibers)
@@ -1484,39 +1781,35 @@ void mitk::FiberBundle::UpdateFiberGeometry()
     return;
   }
   double b[6];
-  m_FiberPolyData->GetBounds(b);
+  this->GetFiberStorageBounds(b);
 
   // calculate statistics
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  m_FiberLengths.assign(m_NumFibers, 0.0f);
+  const float* points = m_FiberPoints.data();
+  const auto numLines = static_cast<int>(m_NumFibers);
+#pragma omp parallel for
+  for (int i=0; i<numLines; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto p = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
     float length = 0;
-    for (int j=0; j<p-1; j++)
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]-1; j++)
     {
-      double p1[3];
-      points->GetPoint(j, p1);
-      double p2[3];
-      points->GetPoint(j+1, p2);
-
-      double dist = std::sqrt((p1[0]-p2[0])*(p1[0]-p2[0])+(p1[1]-p2[1])*(p1[1]-p2[1])+(p1[2]-p2[2])*(p1[2]-p2[2]));
+      const float* p1 = points + 3*j;
+      const float* p2 = p1 + 3;
+      double dist = std::sqrt(static_cast<double>((p1[0]-p2[0])*(p1[0]-p2[0])+(p1[1]-p2[1])*(p1[1]-p2[1])+(p1[2]-p2[2])*(p1[2]-p2[2])));
       length += static_cast<float>(dist);
     }
-    m_FiberLengths.push_back(length);
+    m_FiberLengths[static_cast<unsigned int>(i)] = length;
+  }
+
+  m_MinFiberLength = m_FiberLengths.front();
+  m_MaxFiberLength = m_FiberLengths.front();
+  for (auto length : m_FiberLengths)
+  {
     m_MeanFiberLength += length;
-    if (i==0)
-    {
+    if (length<m_MinFiberLength)
       m_MinFiberLength = length;
+    if (length>m_MaxFiberLength)
       m_MaxFiberLength = length;
-    }
-    else
-    {
-      if (length<m_MinFiberLength)
-        m_MinFiberLength = length;
-      if (length>m_MaxFiberLength)
-        m_MaxFiberLength = length;
-    }
   }
   m_MeanFiberLength /= m_NumFibers;
 
@@ -1571,7 +1864,8 @@ void mitk::FiberBundle::SetFiberWeight(unsigned int fiber, float weight)
 
 void mitk::FiberBundle::SetFiberColors(vtkSmartPointer<vtkUnsignedCharArray> fiberColors)
 {
-  for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+  this->UpdateFiberStorage();
+  for(vtkIdType i=0; i<m_FiberPointOffsets.back(); ++i)
   {
     unsigned char source[4] = {0,0,0,0};
     fiberColors->GetTypedTuple(i, source);
@@ -1620,30 +1914,9 @@ itk::Matrix< double, 3, 3 > mitk::FiberBundle::TransformMatrix(itk::Matrix< doub
 
 void mitk::FiberBundle::TransformFibers(itk::ScalableAffineTransform< mitk::ScalarType >::Pointer transform)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
-  for (unsigned int i=0; i<m_NumFibers; i++)
-  {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      itk::Point<float, 3> p =mitk::imv::GetItkPoint(points->GetPoint(j));
-      p = transform->TransformPoint(p);
-      vtkIdType id = vtkNewPoints->InsertNextPoint(p.GetDataPointer());
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
-  }
-
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vnl_matrix_fixed< double, 3, 3 > matrix = transform->GetMatrix().GetVnlMatrix();
+  vnl_vector_fixed< double, 3 > offset = transform->GetOffset().GetVnlVector();
+  this->TransformFiberPoints(matrix, offset);
 }
 
 void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double tx, double ty, double tz)
@@ -1653,37 +1926,10 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
   mitk::BaseGeometry::Pointer geom = this->GetGeometry();
   mitk::Point3D center = geom->GetCenter();
 
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
-  for (unsigned int i=0; i<m_NumFibers; i++)
-  {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double* p = points->GetPoint(j);
-      vnl_vector_fixed< double, 3 > dir;
-      dir[0] = p[0]-center[0];
-      dir[1] = p[1]-center[1];
-      dir[2] = p[2]-center[2];
-      dir = rot*dir;
-      dir[0] += center[0]+tx;
-      dir[1] += center[1]+ty;
-      dir[2] += center[2]+tz;
-      vtkIdType id = vtkNewPoints->InsertNextPoint(dir.data_block());
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
-  }
-
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  // rotate around the center, then translate
+  vnl_vector_fixed< double, 3 > c = center.GetVnlVector();
+  vnl_vector_fixed< double, 3 > t; t[0] = tx; t[1] = ty; t[2] = tz;
+  this->TransformFiberPoints(rot, c + t - rot*c);
 }
 
 void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
@@ -1713,112 +1959,38 @@ void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
   mitk::BaseGeometry::Pointer geom = this->GetGeometry();
   mitk::Point3D center = geom->GetCenter();
 
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
-  for (unsigned int i=0; i<m_NumFibers; i++)
-  {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double* p = points->GetPoint(j);
-      vnl_vector_fixed< double, 3 > dir;
-      dir[0] = p[0]-center[0];
-      dir[1] = p[1]-center[1];
-      dir[2] = p[2]-center[2];
-      dir = rotZ*rotY*rotX*dir;
-      dir[0] += center[0];
-      dir[1] += center[1];
-      dir[2] += center[2];
-      vtkIdType id = vtkNewPoints->InsertNextPoint(dir.data_block());
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
-  }
-
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vnl_vector_fixed< double, 3 > c = center.GetVnlVector();
+  vnl_matrix_fixed< double, 3, 3 > rot = rotZ*rotY*rotX;
+  this->TransformFiberPoints(rot, c - rot*c);
 }
 
 void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractCenter)
 {
   MITK_INFO << "Scaling fibers";
-  boost::progress_display disp(m_NumFibers);
 
   mitk::BaseGeometry* geom = this->GetGeometry();
-  mitk::Point3D c = geom->GetCenter();
+  mitk::Point3D center = geom->GetCenter();
 
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+  vnl_matrix_fixed< double, 3, 3 > scale; scale.set_identity();
+  scale[0][0] = x;
+  scale[1][1] = y;
+  scale[2][2] = z;
 
-  for (unsigned int i=0; i<m_NumFibers; i++)
+  vnl_vector_fixed< double, 3 > offset; offset.fill(0.0);
+  if (subtractCenter)
   {
-    ++disp ;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double* p = points->GetPoint(j);
-      if (subtractCenter)
-      {
-        p[0] -= c[0]; p[1] -= c[1]; p[2] -= c[2];
-      }
-      p[0] *= x;
-      p[1] *= y;
-      p[2] *= z;
-      if (subtractCenter)
-      {
-        p[0] += c[0]; p[1] += c[1]; p[2] += c[2];
-      }
-      vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
+    vnl_vector_fixed< double, 3 > c = center.GetVnlVector();
+    offset = c - scale*c;
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  this->TransformFiberPoints(scale, offset);
 }
 
 void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
-  for (unsigned int i=0; i<m_NumFibers; i++)
-  {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double* p = points->GetPoint(j);
-      p[0] += x;
-      p[1] += y;
-      p[2] += z;
-      vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
-  }
-
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vnl_matrix_fixed< double, 3, 3 > identity; identity.set_identity();
+  vnl_vector_fixed< double, 3 > offset; offset[0] = x; offset[1] = y; offset[2] = z;
+  this->TransformFiberPoints(identity, offset);
 }
 
 void mitk::FiberBundle::MirrorFibers(unsigned int axis)
@@ -1827,46 +1999,25 @@ void mitk::FiberBundle::MirrorFibers(unsigned int axis)
     return;
 
   MITK_INFO << "Mirroring fibers";
-  boost::progress_display disp(m_NumFibers);
-
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
-  for (unsigned int i=0; i<m_NumFibers; i++)
-  {
-    ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
 
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double* p = points->GetPoint(j);
-      p[axis] = -p[axis];
-      vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
-  }
-
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vnl_matrix_fixed< double, 3, 3 > mirror; mirror.set_identity();
+  mirror[axis][axis] = -1;
+  vnl_vector_fixed< double, 3 > offset; offset.fill(0.0);
+  this->TransformFiberPoints(mirror, offset);
 }
 
 void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double threshold)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   dir.normalize();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  boost::progress_display disp(static_cast<unsigned long>(fiberPolyData->GetNumberOfCells()));
+  for (int i=0; i<fiberPolyData->GetNumberOfCells(); i++)
   {
     ++disp ;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1909,11 +2060,11 @@ void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double thresho
     }
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
 
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  this->SetFiberPolyData(newPolyData, true);
 
   //    UpdateColorCoding();
   //    UpdateFiberGeometry();
@@ -1921,6 +2072,7 @@ void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double thresho
 
 bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibers)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   if (minRadius<0)
     return true;
 
@@ -1928,11 +2080,11 @@ bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibe
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
   MITK_INFO << "Applying curvature threshold";
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  boost::progress_display disp(static_cast<unsigned long>(fiberPolyData->GetNumberOfCells()));
+  for (int i=0; i<fiberPolyData->GetNumberOfCells(); i++)
   {
     ++disp ;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -1992,15 +2144,16 @@ bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibe
   if (vtkNewCells->GetNumberOfCells()<=0)
     return false;
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
   return true;
 }
 
 bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   MITK_INFO << "Removing short fibers";
   if (lengthInMM<=0 || lengthInMM<m_MinFiberLength)
   {
@@ -2022,7 +2175,7 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -2044,15 +2197,16 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
   if (vtkNewCells->GetNumberOfCells()<=0)
     return false;
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
   return true;
 }
 
 bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   if (lengthInMM<=0 || lengthInMM>m_MaxFiberLength)
     return true;
 
@@ -2067,7 +2221,7 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -2087,10 +2241,10 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
   if (vtkNewCells->GetNumberOfCells()<=0)
     return false;
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  newPolyData->SetPoints(vtkNewPoints);
+  newPolyData->SetLines(vtkNewCells);
+  this->SetFiberPolyData(newPolyData, true);
   return true;
 }
 
@@ -2099,35 +2253,20 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
   if (pointDistance<=0)
     return;
 
-  vtkSmartPointer<vtkPoints> vtkSmoothPoints = vtkSmartPointer<vtkPoints>::New(); //in smoothpoints the interpolated points representing a fiber are stored.
-
-  //in vtkcells all polylines are stored, actually all id's of them are stored
-  vtkSmartPointer<vtkCellArray> vtkSmoothCells = vtkSmartPointer<vtkCellArray>::New(); //cellcontainer for smoothed lines
-
   MITK_INFO << "Smoothing fibers";
-  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-  newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(m_NumFibers);
+  this->UpdateFiberStorage();
 
-  std::vector< vtkSmartPointer<vtkPolyLine> > resampled_streamlines;
-  resampled_streamlines.resize(m_NumFibers);
+  const auto numFibers = static_cast<int>(m_FiberPointOffsets.size()) - 1;
+  std::vector< std::vector< float > > resampled_streamlines(static_cast<std::size_t>(numFibers));
 
-  boost::progress_display disp(m_NumFibers);
+  boost::progress_display disp(static_cast<unsigned long>(numFibers));
 #pragma omp parallel for
-  for (int i=0; i<static_cast<int>(m_NumFibers); i++)
+  for (int i=0; i<numFibers; i++)
   {
     vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
-    float length = 0;
-#pragma omp critical
-    {
-      length = m_FiberLengths.at(static_cast<unsigned int>(i));
-      ++disp;
-      vtkCell* cell = m_FiberPolyData->GetCell(i);
-      auto numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
-      for (int j=0; j<numPoints; j++)
-        newPoints->InsertNextPoint(points->GetPoint(j));
-    }
+    float length = m_FiberLengths.at(static_cast<unsigned int>(i));
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]; j++)
+      newPoints->InsertNextPoint(m_FiberPoints.data() + 3*j);
 
     int sampling = static_cast<int>(std::ceil(length/pointDistance));
 
@@ -2154,29 +2293,34 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
     vtkPolyData* outputFunction = functionSource->GetOutput();
     vtkPoints* tmpSmoothPnts = outputFunction->GetPoints(); //smoothPoints of current fiber
 
-    vtkSmartPointer<vtkPolyLine> smoothLine = vtkSmartPointer<vtkPolyLine>::New();
-
-#pragma omp critical
+    std::vector< float >& smoothLine = resampled_streamlines[static_cast<std::size_t>(i)];
+    smoothLine.reserve(static_cast<std::size_t>(3*tmpSmoothPnts->GetNumberOfPoints()));
+    for (int j=0; j<tmpSmoothPnts->GetNumberOfPoints(); j++)
     {
-      for (int j=0; j<tmpSmoothPnts->GetNumberOfPoints(); j++)
-      {
-        vtkIdType id = vtkSmoothPoints->InsertNextPoint(tmpSmoothPnts->GetPoint(j));
-        smoothLine->GetPointIds()->InsertNextId(id);
-      }
-
-      resampled_streamlines[static_cast<unsigned long>(i)] = smoothLine;
+      double p[3];
+      tmpSmoothPnts->GetPoint(j, p);
+      smoothLine.push_back(static_cast<float>(p[0]));
+      smoothLine.push_back(static_cast<float>(p[1]));
+      smoothLine.push_back(static_cast<float>(p[2]));
     }
+
+#pragma omp critical
+    ++disp;
   }
 
-  for (auto container : resampled_streamlines)
+  m_FiberPoints.clear();
+  m_FiberPointOffsets.assign(1, 0);
+  for (const auto& smoothLine : resampled_streamlines)
   {
-    vtkSmoothCells->InsertNextCell(container);
+    m_FiberPoints.insert(m_FiberPoints.end(), smoothLine.begin(), smoothLine.end());
+    m_FiberPointOffsets.push_back(static_cast<vtkIdType>(m_FiberPoints.size()/3));
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkSmoothPoints);
-  m_FiberPolyData->SetLines(vtkSmoothCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  // the per-point values do not match the new points, the fibers and their cell data are unchanged
+  m_FiberPointData->Initialize();
+  this->FiberStorageModified();
+  this->UpdateFiberGeometry();
+  this->ColorFibersByOrientation();
 }
 
 void mitk::FiberBundle::ResampleSpline(float pointDistance)
@@ -2186,29 +2330,24 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance)
 
 unsigned int mitk::FiberBundle::GetNumberOfPoints() const
 {
-  unsigned int points = 0;
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
-  {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    points += cell->GetNumberOfPoints();
-  }
-  return points;
+  return static_cast<unsigned int>(m_FiberPointOffsets.back());
 }
 
 void mitk::FiberBundle::Compress(float error)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
   MITK_INFO << "Compressing fibers";
   unsigned int numRemovedPoints = 0;
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
+  boost::progress_display disp(static_cast<unsigned long>(fiberPolyData->GetNumberOfCells()));
   vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
   newFiberWeights->SetName("FIBER_WEIGHTS");
   newFiberWeights->SetNumberOfValues(m_NumFibers);
 
 #pragma omp parallel for
-  for (int i=0; i<static_cast<int>(m_FiberPolyData->GetNumberOfCells()); i++)
+  for (int i=0; i<static_cast<int>(fiberPolyData->GetNumberOfCells()); i++)
   {
 
     std::vector< vnl_vector_fixed< double, 3 > > vertices;
@@ -2218,7 +2357,7 @@ void mitk::FiberBundle::Compress(float error)
     {
       ++disp;
       weight = m_FiberWeights->GetValue(i);
-      vtkCell* cell = m_FiberPolyData->GetCell(i);
+      vtkCell* cell = fiberPolyData->GetCell(i);
       auto numPoints = cell->GetNumberOfPoints();
       vtkPoints* points = cell->GetPoints();
 
@@ -2321,15 +2460,16 @@ void mitk::FiberBundle::Compress(float error)
   {
     MITK_INFO << "Removed points: " << numRemovedPoints;
     SetFiberWeights(newFiberWeights);
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
   }
 }
 
 void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   if (targetPoints<2)
     mitkThrow() << "Minimum two points required for resampling!";
 
@@ -2346,7 +2486,7 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
     newFiberWeights->SetNumberOfValues(m_NumFibers);
 
     unequal_fibs = false;
-    for (unsigned int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    for (unsigned int i=0; i<fiberPolyData->GetNumberOfCells(); i++)
     {
 
       std::vector< vnl_vector_fixed< double, 3 > > vertices;
@@ -2355,7 +2495,7 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
 
       {
         weight = m_FiberWeights->GetValue(i);
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = fiberPolyData->GetCell(i);
         auto numPoints = cell->GetNumberOfPoints();
         if (numPoints!=targetPoints)
           seg_len = static_cast<double>(this->GetFiberLength(i)/(targetPoints-1));
@@ -2443,59 +2583,49 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
     if (vtkNewCells->GetNumberOfCells()>0)
     {
       SetFiberWeights(newFiberWeights);
-      m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-      m_FiberPolyData->SetPoints(vtkNewPoints);
-      m_FiberPolyData->SetLines(vtkNewCells);
-      this->SetFiberPolyData(m_FiberPolyData, true);
+      vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+      newPolyData->SetPoints(vtkNewPoints);
+      newPolyData->SetLines(vtkNewCells);
+      this->SetFiberPolyData(newPolyData, true);
     }
   }
 }
 
 void mitk::FiberBundle::ResampleLinear(double pointDistance)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
   MITK_INFO << "Resampling fibers (linear)";
-  boost::progress_display disp(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
-  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-  newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(m_NumFibers);
+  this->UpdateFiberStorage();
+
+  const auto numFibers = static_cast<int>(m_FiberPointOffsets.size()) - 1;
+  boost::progress_display disp(static_cast<unsigned long>(numFibers));
 
-  std::vector< vtkSmartPointer<vtkPolyLine> > resampled_streamlines;
-  resampled_streamlines.resize(static_cast<unsigned long>(m_FiberPolyData->GetNumberOfCells()));
+  std::vector< std::vector< float > > resampled_streamlines(static_cast<std::size_t>(numFibers));
 
 #pragma omp parallel for
-  for (int i=0; i<static_cast<int>(m_FiberPolyData->GetNumberOfCells()); i++)
+  for (int i=0; i<numFibers; i++)
   {
-
     std::vector< vnl_vector_fixed< double, 3 > > vertices;
-
-#pragma omp critical
+    for (vtkIdType j=m_FiberPointOffsets[i]; j<m_FiberPointOffsets[i+1]; j++)
     {
-      ++disp;
-      vtkCell* cell = m_FiberPolyData->GetCell(i);
-      auto numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
-
-      for (int j=0; j<numPoints; j++)
-      {
-        double cand[3];
-        points->GetPoint(j, cand);
-        vnl_vector_fixed< double, 3 > candV;
-        candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
-        vertices.push_back(candV);
-      }
+      const float* cand = m_FiberPoints.data() + 3*j;
+      vnl_vector_fixed< double, 3 > candV;
+      candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
+      vertices.push_back(candV);
     }
 
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+    if (vertices.empty())
+      continue;
+
+    std::vector< float >& container = resampled_streamlines[static_cast<std::size_t>(i)];
+    auto add_point = [&container](const vnl_vector_fixed< double, 3 >& v){
+      container.push_back(static_cast<float>(v[0]));
+      container.push_back(static_cast<float>(v[1]));
+      container.push_back(static_cast<float>(v[2]));
+    };
+
     vnl_vector_fixed< double, 3 > lastV = vertices.at(0);
+    add_point(lastV);
 
-#pragma omp critical
-    {
-      vtkIdType id = vtkNewPoints->InsertNextPoint(lastV.data_block());
-      container->GetPointIds()->InsertNextId(id);
-    }
     for (unsigned int j=1; j<vertices.size(); j++)
     {
       vnl_vector_fixed< double, 3 > vec = vertices.at(j) - lastV;
@@ -2532,46 +2662,41 @@ void mitk::FiberBundle::ResampleLinear(double pointDistance)
           j--;
         }
 
-#pragma omp critical
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(newV.data_block());
-          container->GetPointIds()->InsertNextId(id);
-        }
+        add_point(newV);
         lastV = newV;
       }
       else if (j==vertices.size()-1 && new_dist>0.0001)
       {
-#pragma omp critical
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(vertices.at(j).data_block());
-          container->GetPointIds()->InsertNextId(id);
-        }
+        add_point(vertices.at(j));
       }
     }
 
 #pragma omp critical
-    {
-      resampled_streamlines[static_cast<unsigned int>(i)] = container;
-    }
+    ++disp;
   }
 
-  for (auto container : resampled_streamlines)
+  if (numFibers>0)
   {
-    vtkNewCells->InsertNextCell(container);
-  }
+    m_FiberPoints.clear();
+    m_FiberPointOffsets.assign(1, 0);
+    for (const auto& container : resampled_streamlines)
+    {
+      m_FiberPoints.insert(m_FiberPoints.end(), container.begin(), container.end());
+      m_FiberPointOffsets.push_back(static_cast<vtkIdType>(m_FiberPoints.size()/3));
+    }
 
-  if (vtkNewCells->GetNumberOfCells()>0)
-  {
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    // the per-point values do not match the new points, the fibers and their cell data are unchanged
+    m_FiberPointData->Initialize();
+    this->FiberStorageModified();
+    this->UpdateFiberGeometry();
+    this->ColorFibersByOrientation();
   }
 }
 
 // reapply selected colorcoding in case PolyData structure has changed
 bool mitk::FiberBundle::Equals(mitk::FiberBundle* fib, double eps)
 {
+  vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetFiberPolyData();
   if (fib==nullptr)
   {
     MITK_INFO << "Reference bundle is nullptr!";
@@ -2587,7 +2712,7 @@ bool mitk::FiberBundle::Equals(mitk::FiberBundle* fib, double eps)
 
   for (unsigned int i=0; i<m_NumFibers; i++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
+    vtkCell* cell = fiberPolyData->GetCell(i);
     auto numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
@@ -35,20 +35,35 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkDataSet.h>
 #include <vtkTransform.h>
 #include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkCellData.h>
 #include <itkScalableAffineTransform.h>
 #include <mitkDiffusionFunctionCollection.h>
 
 namespace mitk {
 
 /**
-   * \brief Base Class for Fiber Bundles;   */
+   * \brief Base Class for Fiber Bundles;
+   *
+   * The fibers are owned by compact arrays: all fiber points (float x,y,z triples, fiber by fiber), a table with
+   * the index of the first point of each fiber and the point and cell data in the same order. Transformations,
+   * resampling, length computation and color coding run in parallel on these arrays. The vtkPolyData returned by
+   * GetFiberPolyData() is generated from them on demand, with the points of each fiber stored consecutively and
+   * all point and cell data attached. If its points or lines are modified from outside, the arrays are imported
+   * from it again before the next operation; arrays added to it by mappers or writers are ignored.
+   *
+   * ROI and mask queries use a uniform grid over the fiber segments that lists the fibers passing each grid cell.
+   * The grid is built from the compact arrays on first use and rebuilt whenever they change, so only fibers close
+   * to the ROI have to be tested point by point.   */
 class MITKFIBERTRACKING_EXPORT FiberBundle : public BaseData
 {
 public:
 
     typedef itk::Image<unsigned char, 3> ItkUcharImgType;
 
-    // fiber colorcodings
+    /**
+     * \deprecatedSince{2018_04} The fiber polydata no longer carries an id array, fibers are identified by their index.
+     */
     static const char* FIBER_ID_ARRAY;
 
     void UpdateOutputInformation() override;
@@ -140,6 +155,7 @@ public:
     float                          GetOverlap(ItkUcharImgType* mask);
     std::tuple<float, float>       GetDirectionalOverlap(ItkUcharImgType* mask, mitk::PeakImage::ItkPeakImageType* peak_image);
     float                          GetNumEpFractionInMask(ItkUcharImgType* mask, bool different_label);
+    std::vector<unsigned int>      GetFiberIdsInBounds(const double bounds[6]);  ///< Ascending ids of all fibers that may have a segment inside of the world bounds (xmin,xmax,ymin,ymax,zmin,zmax). Superset of the intersecting fibers, exact tests are left to the caller.
     mitk::FiberBundle::Pointer     SubsampleFibers(float factor, bool random_seed);
 
     // get/set data
@@ -182,17 +198,39 @@ protected:
     FiberBundle( vtkPolyData* fiberPolyData = nullptr );
     ~FiberBundle() override;
 
-    void                            GenerateFiberIds();
     void                            UpdateFiberGeometry();
+    void                            ImportFiberPolyData(vtkPolyData* polyData);  ///< Replace the fiber storage by the lines, point data and line cell data of the polydata
+    void                            FiberStorageModified();  ///< Call after the fiber storage was modified in place
+    void                            UpdateFiberStorage();    ///< Import the generated polydata again if its points or lines were modified from outside
+    vtkSmartPointer<vtkPolyData>    GeneratePolyDataFromStorage() const;
+    void                            GetFiberStorageBounds(double bounds[6]) const;
+    void                            UpdateFiberGrid();       ///< Rebuild the segment grid if the compact point storage changed
+    void                            TransformFiberPoints(const vnl_matrix_fixed<double,3,3>& matrix, const vnl_vector_fixed<double,3>& offset);  ///< p' = matrix*p + offset for all points
     void                    PrintSelf(std::ostream &os, itk::Indent indent) const override;
 
 private:
 
-    // actual fiber container
-    vtkSmartPointer<vtkPolyData>  m_FiberPolyData;
+    static vtkMTimeType             GetFiberGeometryMTime(vtkPolyData* polyData);
+
+    // actual fiber container: fiber points (x,y,z fiber by fiber), offsets of the first point of each fiber (plus the total number of points), point data in the same order and cell data of the fibers
+    std::vector< float >          m_FiberPoints;
+    std::vector< vtkIdType >      m_FiberPointOffsets;
+    vtkSmartPointer<vtkPointData> m_FiberPointData;
+    vtkSmartPointer<vtkCellData>  m_FiberCellData;
+    itk::TimeStamp                m_FiberStorageTime;
 
-    // contains fiber ids
-    vtkSmartPointer<vtkDataSet>   m_FiberIdDataSet;
+    // polydata generated from the fiber container on demand, and the modification time of its points and lines after generation
+    vtkSmartPointer<vtkPolyData>  m_FiberPolyData;
+    mutable bool                  m_FiberPolyDataOutdated;
+    mutable vtkMTimeType          m_FiberPolyDataTime;
+
+    // uniform grid over the fiber segments: ascending ids of the fibers passing each cell, stored cell by cell, and offsets of the first id of each cell (plus the total number of ids)
+    std::vector< unsigned int >   m_FiberGridIds;
+    std::vector< std::size_t >    m_FiberGridOffsets;
+    double                        m_FiberGridOrigin[3];
+    double                        m_FiberGridSpacing;
+    int                           m_FiberGridSize[3];
+    unsigned long                 m_FiberGridTime;
 
     unsigned int m_NumFibers;
 
@@ -449,6 +449,7 @@ void mitk::FiberfoxParameters::SaveParameters(std::string filename)
       parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".d", model->GetDiffusivity());
       parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".t2", model->GetT2());
       parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".t1", model->GetT1());
+      parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".lut_tolerance", model->GetLookupTableTolerance());
     }
     else  if (dynamic_cast<mitk::TensorModel<>*>(signalModel))
     {
@@ -497,6 +498,7 @@ void mitk::FiberfoxParameters::SaveParameters(std::string filename)
       parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".t2", model->GetT2());
       parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".t1", model->GetT1());
       parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".randomize", model->GetRandomizeSticks());
+      parameters.put("fiberfox.image.compartments.c"+boost::lexical_cast<std::string>(i)+".lut_tolerance", model->GetLookupTableTolerance());
     }
     else  if (dynamic_cast<mitk::DotModel<>*>(signalModel))
     {
@@ -907,6 +909,7 @@ void mitk::FiberfoxParameters::LoadParameters(std::string filename, bool fix_see
         {
           mitk::StickModel<>* model = new mitk::StickModel<>();
           model->SetDiffusivity(ReadVal<double>(v2,"d",model->GetDiffusivity()));
+          model->SetLookupTableTolerance(ReadVal<double>(v2,"lut_tolerance",model->GetLookupTableTolerance()));
           model->SetT2(ReadVal<double>(v2,"t2",model->GetT2()));
           model->SetT1(ReadVal<double>(v2,"t1",model->GetT1()));
           model->SetBvalue(m_SignalGen.m_Bvalue);
@@ -955,6 +958,7 @@ void mitk::FiberfoxParameters::LoadParameters(std::string filename, bool fix_see
           model->SetT1(ReadVal<double>(v2,"t1",model->GetT1()));
           model->SetBvalue(m_SignalGen.m_Bvalue);
           model->SetRandomizeSticks(ReadVal<bool>(v2,"randomize",model->GetRandomizeSticks()));
+          model->SetLookupTableTolerance(ReadVal<double>(v2,"lut_tolerance",model->GetLookupTableTolerance()));
           model->m_CompartmentId = ReadVal<unsigned int>(v2,"ID",0,true);
           if (ReadVal<std::string>(v2,"type","",true)=="fiber")
             m_FiberModelList.push_back(model);
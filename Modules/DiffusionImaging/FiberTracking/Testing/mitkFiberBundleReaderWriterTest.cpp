@@ -23,11 +23,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkTestFixture.h"
 
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+
 class mitkFiberBundleReaderWriterTestSuite : public mitk::TestFixture
 {
 
   CPPUNIT_TEST_SUITE(mitkFiberBundleReaderWriterTestSuite);
   MITK_TEST(Equal_SaveLoad_ReturnsTrue);
+  MITK_TEST(NonConsecutivePointIds_KeepsPointAndCellData);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -66,6 +72,77 @@ public:
     //MITK_ASSERT_EQUAL(fib1, fib2, "A saved and re-loaded file should be equal");
   }
 
+  void NonConsecutivePointIds_KeepsPointAndCellData()
+  {
+    // two fibers whose points are stored in reverse order, with one unused point in between
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkFloatArray> values = vtkSmartPointer<vtkFloatArray>::New();
+    values->SetName("TEST_VALUES");
+    for (int i=0; i<6; ++i)
+    {
+      points->InsertNextPoint(i, 2*i, 3*i);
+      values->InsertNextValue(10.0f*i);
+    }
+
+    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+    vtkIdType fiber1[] = {5, 4, 3};
+    vtkIdType fiber2[] = {1, 0};
+    lines->InsertNextCell(3, fiber1);
+    lines->InsertNextCell(2, fiber2);
+
+    vtkSmartPointer<vtkFloatArray> fiberValues = vtkSmartPointer<vtkFloatArray>::New();
+    fiberValues->SetName("TEST_FIBER_VALUES");
+    fiberValues->InsertNextValue(1.5f);
+    fiberValues->InsertNextValue(2.5f);
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(lines);
+    polyData->GetPointData()->AddArray(values);
+    polyData->GetCellData()->AddArray(fiberValues);
+
+    fib1 = mitk::FiberBundle::New(polyData);
+    CPPUNIT_ASSERT_EQUAL(2u, fib1->GetNumFibers());
+    CPPUNIT_ASSERT_EQUAL(5u, fib1->GetNumberOfPoints());
+
+    // points are stored fiber by fiber, and the point data follows them
+    vtkSmartPointer<vtkPolyData> generated = fib1->GetFiberPolyData();
+    vtkDataArray* generatedValues = generated->GetPointData()->GetArray("TEST_VALUES");
+    CPPUNIT_ASSERT_MESSAGE("Point data should be kept", generatedValues!=nullptr);
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(5), generatedValues->GetNumberOfTuples());
+
+    vtkIdType order[] = {5, 4, 3, 1, 0};
+    for (vtkIdType i=0; i<5; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0*order[i], generatedValues->GetTuple1(i), mitk::eps);
+      double p[3];
+      generated->GetPoint(i, p);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(static_cast<double>(order[i]), p[0], mitk::eps);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0*order[i], p[1], mitk::eps);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0*order[i], p[2], mitk::eps);
+    }
+
+    vtkDataArray* generatedFiberValues = generated->GetCellData()->GetArray("TEST_FIBER_VALUES");
+    CPPUNIT_ASSERT_MESSAGE("Cell data should be kept", generatedFiberValues!=nullptr);
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(2), generatedFiberValues->GetNumberOfTuples());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, generatedFiberValues->GetTuple1(0), mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, generatedFiberValues->GetTuple1(1), mitk::eps);
+
+    // moving the points keeps the data
+    fib1->TranslateFibers(1, 0, 0);
+    generated = fib1->GetFiberPolyData();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(6.0, generated->GetPoint(0)[0], mitk::eps);
+    CPPUNIT_ASSERT_MESSAGE("Point data should be kept after a transformation", generated->GetPointData()->GetArray("TEST_VALUES")!=nullptr);
+    CPPUNIT_ASSERT_MESSAGE("Cell data should be kept after a transformation", generated->GetCellData()->GetArray("TEST_FIBER_VALUES")!=nullptr);
+
+    // a generated polydata that is modified from outside is imported again
+    generated->GetPoints()->SetPoint(0, 7, 0, 0);
+    generated->GetPoints()->Modified();
+    fib1->TranslateFibers(1, 0, 0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(8.0, fib1->GetFiberPolyData()->GetPoint(0)[0], mitk::eps);
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(5), fib1->GetFiberPolyData()->GetPointData()->GetArray("TEST_VALUES")->GetNumberOfTuples());
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberBundleReaderWriter)
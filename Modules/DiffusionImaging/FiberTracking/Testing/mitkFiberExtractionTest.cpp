@@ -133,6 +133,16 @@ int mitkFiberExtractionTest(int argc, char* argv[])
 
       MITK_TEST_CONDITION_REQUIRED(ending->Equals(testFibs),"check ending in mask extraction");
     }
+
+    {
+      double bounds[6];
+      groundTruthFibs->GetFiberPolyData()->GetBounds(bounds);
+      MITK_TEST_CONDITION_REQUIRED(groundTruthFibs->GetFiberIdsInBounds(bounds).size()==groundTruthFibs->GetNumFibers(),"check fiber grid query covering the whole bundle");
+
+      bounds[0] = bounds[1] + 1;
+      bounds[1] = bounds[0] + 1;
+      MITK_TEST_CONDITION_REQUIRED(groundTruthFibs->GetFiberIdsInBounds(bounds).empty(),"check fiber grid query outside of the bundle");
+    }
   }
   catch(...) {
     return EXIT_FAILURE;
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIOUtil.h>
 #include <mitkFiberBundle.h>
 #include <itkTractsToDWIImageFilter.h>
+#include <itkKspaceImageFilter.h>
 #include <mitkFiberfoxParameters.h>
 #include <mitkStickModel.h>
 #include <mitkTensorModel.h>
@@ -36,7 +37,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageCast.h>
 
 #include <itkVectorImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
 #include <omp.h>
+#include <algorithm>
+#include <cmath>
 
 #include "mitkTestFixture.h"
 
@@ -53,9 +57,15 @@ class mitkFiberfoxSignalGenerationTestSuite : public mitk::TestFixture
   MITK_TEST(Test7);
   MITK_TEST(Test8);
   MITK_TEST(Test9);
+  MITK_TEST(TestSignalModelLookupTable);
+  MITK_TEST(TestSeparableDftSlice);
+  MITK_TEST(TestNufftSlice);
   CPPUNIT_TEST_SUITE_END();
 
   typedef itk::VectorImage< short, 3>   ItkDwiType;
+  typedef itk::KspaceImageFilter< float > KspaceFilterType;
+  typedef KspaceFilterType::InputImageType SliceType;
+  typedef KspaceFilterType::OutputImageType KspaceType;
 
 private:
 
@@ -221,6 +231,169 @@ public:
     StartSimulation(parameters, refImage, "param9.dwi");
   }
 
+  void TestSignalModelLookupTable()
+  {
+    FiberfoxParameters parameters;
+    parameters.LoadParameters(GetTestDataFilePath("DiffusionImaging/Fiberfox/params/param1.ffp"), true);
+    mitk::SignalGenerationParameters::GradientListType gradients = parameters.m_SignalGen.GetGradientDirections();
+
+    mitk::StickModel<> stick;
+    stick.SetGradientList(gradients);
+    stick.SetBvalue(parameters.m_SignalGen.GetBvalue());
+    mitk::AstroStickModel<> astrosticks;
+    astrosticks.SetGradientList(gradients);
+    astrosticks.SetBvalue(parameters.m_SignalGen.GetBvalue());
+
+    mitk::DiffusionSignalModel<>::GradientType fiberDirection;
+    fiberDirection[0] = 1; fiberDirection[1] = 2; fiberDirection[2] = -0.5;
+    fiberDirection.Normalize();
+
+    mitk::DiffusionSignalModel<>::PixelType exactStick = stick.SimulateMeasurement(fiberDirection);
+    mitk::DiffusionSignalModel<>::PixelType exactAstrosticks = astrosticks.SimulateMeasurement(fiberDirection);
+    for (unsigned int i=0; i<gradients.size(); ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(stick.SimulateMeasurement(i, fiberDirection), exactStick[i], 1e-12);
+
+    double tolerance = 0.0001;
+    stick.SetLookupTableTolerance(tolerance);
+    astrosticks.SetLookupTableTolerance(tolerance);
+    mitk::DiffusionSignalModel<>::PixelType tableStick = stick.SimulateMeasurement(fiberDirection);
+    mitk::DiffusionSignalModel<>::PixelType tableAstrosticks = astrosticks.SimulateMeasurement(fiberDirection);
+    for (unsigned int i=0; i<gradients.size(); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(exactStick[i], tableStick[i], tolerance);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(exactAstrosticks[i], tableAstrosticks[i], tolerance);
+    }
+  }
+
+  /** Parameters of a single 32x32 slice, 2 mm voxels, two compartments with T2 relaxation. */
+  FiberfoxParameters GetSliceParameters()
+  {
+    FiberfoxParameters parameters;
+    itk::ImageRegion<3> region;
+    region.SetSize(0, 32);
+    region.SetSize(1, 32);
+    region.SetSize(2, 1);
+    parameters.m_SignalGen.m_ImageRegion = region;
+    parameters.m_SignalGen.m_CroppedRegion = region;
+    parameters.m_SignalGen.m_ImageSpacing.Fill(2.0);
+    parameters.m_SignalGen.m_ImageOrigin.Fill(0.0);
+    parameters.m_SignalGen.m_ImageDirection.SetIdentity();
+    parameters.m_SignalGen.m_tLine = 0.5;
+    parameters.m_SignalGen.m_tEcho = 50;
+    return parameters;
+  }
+
+  std::vector< SliceType::Pointer > GetCompartmentSlices()
+  {
+    std::vector< SliceType::Pointer > slices;
+    for (int c=0; c<2; ++c)
+    {
+      SliceType::RegionType region;
+      region.SetSize(0, 32);
+      region.SetSize(1, 32);
+      SliceType::Pointer slice = SliceType::New();
+      slice->SetRegions(region);
+      slice->Allocate();
+
+      // smooth blobs with sharp edges, so that all spatial frequencies are present
+      itk::ImageRegionIteratorWithIndex< SliceType > it(slice, region);
+      for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+        double x = it.GetIndex()[0] - 12.0 - 6*c;
+        double y = it.GetIndex()[1] - 14.0 + 3*c;
+        double value = 100.0*std::exp(-(x*x+y*y)/40.0);
+        if (std::fabs(x)<5 && std::fabs(y)<3)
+          value += 50;
+        it.Set(static_cast<float>(value));
+      }
+      slices.push_back(slice);
+    }
+    return slices;
+  }
+
+  KspaceType::Pointer SimulateSlice(FiberfoxParameters parameters, bool exactDft)
+  {
+    std::vector< float > t2 = {110, 80};
+    std::vector< float > t1 = {900, 1200};
+    itk::Vector<double,3> gradient;
+    gradient[0] = 0.8; gradient[1] = -0.5; gradient[2] = 0.3;
+
+    KspaceFilterType::Pointer filter = KspaceFilterType::New();
+    filter->SetCompartmentImages(GetCompartmentSlices());
+    filter->SetT2(t2);
+    filter->SetT1(t1);
+    filter->SetRandSeed(0);
+    filter->SetParameters(&parameters);
+    filter->SetZ(0.5);
+    filter->SetZidx(0);
+    filter->SetDiffusionGradientDirection(gradient);
+    filter->SetUseExactDft(exactDft);
+    filter->Update();
+    return filter->GetOutput();
+  }
+
+  /** Maximum deviation of the k-space samples relative to the largest reference sample. */
+  double GetRelativeKspaceError(KspaceType* kspace, KspaceType* reference)
+  {
+    double maxError = 0;
+    double maxReference = 0;
+    itk::ImageRegionConstIterator< KspaceType > it1(kspace, kspace->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator< KspaceType > it2(reference, reference->GetLargestPossibleRegion());
+    for (; !it1.IsAtEnd(); ++it1, ++it2)
+    {
+      maxError = std::max(maxError, static_cast<double>(std::abs(it1.Get()-it2.Get())));
+      maxReference = std::max(maxReference, static_cast<double>(std::abs(it2.Get())));
+    }
+    CPPUNIT_ASSERT(maxReference>0);
+    return maxError/maxReference;
+  }
+
+  void TestSeparableDftSlice()
+  {
+    // no eddy currents and no frequency map: the row transforms are shared by all k-space lines
+    FiberfoxParameters parameters = GetSliceParameters();
+    parameters.m_Misc.m_DoAddGhosts = true;
+    parameters.m_SignalGen.m_KspaceLineOffset = 0.2f;
+
+    KspaceType::Pointer separable = SimulateSlice(parameters, false);
+    KspaceType::Pointer exact = SimulateSlice(parameters, true);
+
+    // the exact DFT is summed in single precision
+    double error = GetRelativeKspaceError(separable, exact);
+    MITK_INFO << "Relative k-space error of the separable DFT: " << error;
+    CPPUNIT_ASSERT_MESSAGE("Separable DFT should match the exact DFT within 1e-4 of the k-space maximum", error<1e-4);
+  }
+
+  void TestNufftSlice()
+  {
+    // eddy currents shift the sample positions and the frequency map needs several Chebyshev nodes in time
+    FiberfoxParameters parameters = GetSliceParameters();
+    parameters.m_Misc.m_DoAddEddyCurrents = true;
+    parameters.m_SignalGen.m_EddyStrength = 0.02f;
+    parameters.m_Misc.m_DoAddDistortions = true;
+
+    itk::Image<float, 3>::Pointer fmap = itk::Image<float, 3>::New();
+    fmap->SetRegions(parameters.m_SignalGen.m_ImageRegion);
+    fmap->Allocate();
+    itk::ImageRegionIteratorWithIndex< itk::Image<float, 3> > it(fmap, fmap->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      // +-60 Hz, about +-0.5 cycles over the readout
+      double x = it.GetIndex()[0] - 16.0;
+      double y = it.GetIndex()[1] - 16.0;
+      it.Set(static_cast<float>(60.0*std::sin(x/6.0)*std::cos(y/9.0)));
+    }
+    parameters.m_SignalGen.m_FrequencyMap = fmap;
+
+    KspaceType::Pointer nufft = SimulateSlice(parameters, false);
+    KspaceType::Pointer exact = SimulateSlice(parameters, true);
+
+    // Kaiser-Bessel gridding with width 6 and twofold oversampling is accurate to about 1e-4
+    double error = GetRelativeKspaceError(nufft, exact);
+    MITK_INFO << "Relative k-space error of the non-uniform FFT: " << error;
+    CPPUNIT_ASSERT_MESSAGE("Non-uniform FFT should match the exact DFT within 1e-3 of the k-space maximum", error<1e-3);
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberfoxSignalGeneration)
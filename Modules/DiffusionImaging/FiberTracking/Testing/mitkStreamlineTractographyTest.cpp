@@ -30,6 +30,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestFixture.h>
 #include <mitkFiberBundle.h>
 #include <omp.h>
+#include <algorithm>
 #include <itksys/SystemTools.hxx>
 #include <mitkEqual.h>
 #include <mitkStreamlineTractographyParameters.h>
@@ -49,6 +50,7 @@ class mitkStreamlineTractographyTestSuite : public mitk::TestFixture
   MITK_TEST(Test_Odf4);
   MITK_TEST(Test_Odf5);
   MITK_TEST(Test_Odf6);
+  MITK_TEST(Test_FixedSeedThreadCount);
   CPPUNIT_TEST_SUITE_END();
 
   typedef itk::VectorImage< short, 3>   ItkDwiType;
@@ -433,6 +435,50 @@ public:
     delete handler;
   }
 
+  void Test_FixedSeedThreadCount()
+  {
+    mitk::TrackingHandlerOdf* handler = new mitk::TrackingHandlerOdf();
+    handler->SetOdfImage(itk_odf_image);
+
+    params->m_Cutoff = gfa_threshold;
+    params->m_OdfCutoff = 0;
+    params->m_SharpenOdfs = true;
+    params->m_SeedsPerVoxel = 3;
+    params->m_Mode = mitk::TrackingDataHandler::MODE::PROBABILISTIC;
+    params->m_RandomSampling = true;
+
+    // probabilistic tracking with a fixed seed has to be independent of the number of threads
+    // (a single thread keeps the former random stream, so it is not compared here)
+    omp_set_num_threads(2);
+    SetupTracker(handler);
+    tracker->Update();
+    mitk::FiberBundle::Pointer twoThreads = mitk::FiberBundle::New(tracker->GetFiberPolyData());
+
+    omp_set_num_threads(4);
+    SetupTracker(handler);
+    tracker->Update();
+    mitk::FiberBundle::Pointer fourThreads = mitk::FiberBundle::New(tracker->GetFiberPolyData());
+
+    // the fibers kept under the maximum number must not depend on scheduling either
+    params->m_MaxNumFibers = 20;
+    SetupTracker(handler);
+    tracker->Update();
+    mitk::FiberBundle::Pointer limitedFourThreads = mitk::FiberBundle::New(tracker->GetFiberPolyData());
+
+    omp_set_num_threads(2);
+    SetupTracker(handler);
+    tracker->Update();
+    mitk::FiberBundle::Pointer limitedTwoThreads = mitk::FiberBundle::New(tracker->GetFiberPolyData());
+    omp_set_num_threads(1);
+
+    CPPUNIT_ASSERT_MESSAGE("Tractogram should not be empty", twoThreads->GetNumFibers()>0);
+    CPPUNIT_ASSERT_MESSAGE("Tractograms of two and four threads should be equal", twoThreads->Equals(fourThreads));
+    CPPUNIT_ASSERT_MESSAGE("Limited tractogram should contain the maximum number of fibers", limitedTwoThreads->GetNumFibers()==std::min(20u, twoThreads->GetNumFibers()));
+    CPPUNIT_ASSERT_MESSAGE("Limited tractograms of two and four threads should be equal", limitedTwoThreads->Equals(limitedFourThreads));
+
+    delete handler;
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkStreamlineTractography)
@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPlanarFigureMaskGenerator.h>
 #include <mitkImageMaskGenerator.h>
 #include <mitkImageStatisticsConstants.h>
+#include <mitkImageWriteAccessor.h>
 
 /**
  * \brief Test class for mitkImageStatisticsCalculator
@@ -58,6 +59,9 @@ class mitkImageStatisticsCalculatorTestSuite : public mitk::TestFixture
   MITK_TEST(TestUS4DCroppedPlanarFigureTimeStep1);
   MITK_TEST(TestUS4DCroppedAllTimesteps);
   MITK_TEST(TestUS4DCropped3DMask);
+  MITK_TEST(TestUS4DCroppedParallelComputation);
+  MITK_TEST(TestUS4DCroppedIncrementalUpdate);
+  MITK_TEST(TestUS4DCroppedIncrementalUpdateConventional);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -88,6 +92,10 @@ public:
   void TestUS4DCroppedPlanarFigureTimeStep1();
   void TestUS4DCroppedAllTimesteps();
   void TestUS4DCropped3DMask();
+
+  void TestUS4DCroppedParallelComputation();
+  void TestUS4DCroppedIncrementalUpdate();
+  void TestUS4DCroppedIncrementalUpdateConventional();
 private:
 	mitk::Image::ConstPointer m_TestImage;
 
@@ -111,7 +119,14 @@ private:
 	const mitk::ImageStatisticsContainer::Pointer ComputeStatistics(mitk::Image::ConstPointer image,
 		mitk::MaskGenerator::Pointer maskGen = nullptr,
 		mitk::MaskGenerator::Pointer secondardMaskGen = nullptr,
-		unsigned short label = 1);
+		unsigned short label = 1,
+		bool parallelComputation = false);
+
+	// modifies one slice of a mask and checks that only the affected statistics are computed again
+	void TestIncrementalUpdate(bool parallelComputation);
+
+	// compares all statistics of all time steps
+	void VerifyStatistics(mitk::ImageStatisticsContainer::ConstPointer expected, mitk::ImageStatisticsContainer::ConstPointer actual);
 
 	void VerifyStatistics(mitk::ImageStatisticsContainer::ImageStatisticsObject stats,
 		mitk::ImageStatisticsContainer::RealType testMean, mitk::ImageStatisticsContainer::RealType testSD, mitk::ImageStatisticsContainer::RealType testMedian = 0);
@@ -1042,14 +1057,150 @@ mitk::PlanarPolygon::Pointer mitkImageStatisticsCalculatorTestSuite::GeneratePla
 	return figure;
 }
 
+void mitkImageStatisticsCalculatorTestSuite::TestUS4DCroppedParallelComputation()
+{
+	MITK_INFO << std::endl << "Test US4D cropped parallel computation:-----------------------------------------------------------------------------------";
+
+	std::string US4DCroppedFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_cropped.nrrd");
+	m_US4DCroppedImage = mitk::IOUtil::Load<mitk::Image>(US4DCroppedFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D_cropped", m_US4DCroppedImage.IsNotNull());
+
+	std::string US4DCroppedMultilabelMaskFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_croppedMultilabelMask.nrrd");
+	m_US4DCroppedMultilabelMask = mitk::IOUtil::Load<mitk::Image>(US4DCroppedMultilabelMaskFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D multilabel mask", m_US4DCroppedMultilabelMask.IsNotNull());
+
+	mitk::ImageStatisticsContainer::Pointer expected;
+	mitk::ImageStatisticsContainer::Pointer actual;
+
+	CPPUNIT_ASSERT_NO_THROW(expected = ComputeStatistics(m_US4DCroppedImage));
+	CPPUNIT_ASSERT_NO_THROW(actual = ComputeStatistics(m_US4DCroppedImage, nullptr, nullptr, 1, true));
+	VerifyStatistics(expected.GetPointer(), actual.GetPointer());
+
+	mitk::ImageMaskGenerator::Pointer multiLabelMaskGen = mitk::ImageMaskGenerator::New();
+	multiLabelMaskGen->SetImageMask(m_US4DCroppedMultilabelMask);
+
+	CPPUNIT_ASSERT_NO_THROW(expected = ComputeStatistics(m_US4DCroppedImage, multiLabelMaskGen.GetPointer(), nullptr, 1));
+	CPPUNIT_ASSERT_NO_THROW(actual = ComputeStatistics(m_US4DCroppedImage, multiLabelMaskGen.GetPointer(), nullptr, 1, true));
+	VerifyStatistics(expected.GetPointer(), actual.GetPointer());
+}
+
+void mitkImageStatisticsCalculatorTestSuite::TestUS4DCroppedIncrementalUpdate()
+{
+	MITK_INFO << std::endl << "Test US4D cropped incremental update:-----------------------------------------------------------------------------------";
+
+	this->TestIncrementalUpdate(true);
+}
+
+void mitkImageStatisticsCalculatorTestSuite::TestUS4DCroppedIncrementalUpdateConventional()
+{
+	MITK_INFO << std::endl << "Test US4D cropped incremental update (conventional computation):-----------------------------------------------------";
+
+	this->TestIncrementalUpdate(false);
+}
+
+void mitkImageStatisticsCalculatorTestSuite::TestIncrementalUpdate(bool parallelComputation)
+{
+	std::string US4DCroppedFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_cropped.nrrd");
+	m_US4DCroppedImage = mitk::IOUtil::Load<mitk::Image>(US4DCroppedFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D_cropped", m_US4DCroppedImage.IsNotNull());
+
+	std::string US4DCroppedMultilabelMaskFile = this->GetTestDataFilePath("ImageStatisticsTestData/US4D_croppedMultilabelMask.nrrd");
+	m_US4DCroppedMultilabelMask = mitk::IOUtil::Load<mitk::Image>(US4DCroppedMultilabelMaskFile);
+	CPPUNIT_ASSERT_MESSAGE("Failed loading US4D multilabel mask", m_US4DCroppedMultilabelMask.IsNotNull());
+
+	mitk::ImageMaskGenerator::Pointer multiLabelMaskGen = mitk::ImageMaskGenerator::New();
+	multiLabelMaskGen->SetImageMask(m_US4DCroppedMultilabelMask);
+
+	const unsigned int numberOfSlices = m_US4DCroppedImage->GetDimension(2);
+	const unsigned int numberOfTimeSteps = m_US4DCroppedImage->GetTimeSteps();
+
+	mitk::ImageStatisticsCalculator::Pointer imgStatCalc = mitk::ImageStatisticsCalculator::New();
+	imgStatCalc->SetInputImage(m_US4DCroppedImage);
+	imgStatCalc->SetMask(multiLabelMaskGen.GetPointer());
+	imgStatCalc->SetParallelComputation(parallelComputation);
+	imgStatCalc->SetNumberOfThreads(3);
+	CPPUNIT_ASSERT_NO_THROW(imgStatCalc->GetStatistics(1));
+	CPPUNIT_ASSERT_EQUAL(numberOfSlices * numberOfTimeSteps, imgStatCalc->GetNumberOfSlicesComputedInLastUpdate());
+
+	// An update without any modified voxel does not visit any slice again in parallel computation mode,
+	// the conventional mode always computes all time steps
+	multiLabelMaskGen->Modified();
+	CPPUNIT_ASSERT_NO_THROW(imgStatCalc->GetStatistics(1));
+	CPPUNIT_ASSERT_EQUAL(parallelComputation ? 0u : numberOfSlices * numberOfTimeSteps, imgStatCalc->GetNumberOfSlicesComputedInLastUpdate());
+
+	// Relabel the first row of the last slice of the first time step of the mask, as an interactive segmentation tool would do
+	{
+		mitk::ImageWriteAccessor accessor(m_US4DCroppedMultilabelMask, m_US4DCroppedMultilabelMask->GetVolumeData(0));
+		auto *data = static_cast<unsigned short *>(accessor.GetData());
+		const auto sliceSize = m_US4DCroppedMultilabelMask->GetDimension(0) * m_US4DCroppedMultilabelMask->GetDimension(1);
+		const auto lastSlice = m_US4DCroppedMultilabelMask->GetDimension(2) - 1;
+
+		for (unsigned int x = 0; x < m_US4DCroppedMultilabelMask->GetDimension(0); ++x)
+			data[lastSlice * sliceSize + x] = 1 == data[lastSlice * sliceSize + x] ? 2 : 1;
+	}
+	m_US4DCroppedMultilabelMask->Modified();
+	multiLabelMaskGen->Modified();
+
+	mitk::ImageStatisticsContainer::Pointer expected;
+	mitk::ImageStatisticsContainer::Pointer actual;
+
+	CPPUNIT_ASSERT_NO_THROW(actual = imgStatCalc->GetStatistics(1));
+
+	// Only the modified slice is computed again in parallel computation mode. A 3D mask is shared by all time steps.
+	const unsigned int numberOfModifiedTimeSteps = m_US4DCroppedMultilabelMask->GetTimeSteps() > 1 ? 1 : numberOfTimeSteps;
+	CPPUNIT_ASSERT_EQUAL(parallelComputation ? numberOfModifiedTimeSteps : numberOfSlices * numberOfTimeSteps, imgStatCalc->GetNumberOfSlicesComputedInLastUpdate());
+
+	// Modifying the image invalidates all cached slices
+	m_US4DCroppedImage->Modified();
+	CPPUNIT_ASSERT_NO_THROW(imgStatCalc->GetStatistics(1));
+	CPPUNIT_ASSERT_EQUAL(numberOfSlices * numberOfTimeSteps, imgStatCalc->GetNumberOfSlicesComputedInLastUpdate());
+
+	CPPUNIT_ASSERT_NO_THROW(expected = ComputeStatistics(m_US4DCroppedImage, multiLabelMaskGen.GetPointer(), nullptr, 1, parallelComputation));
+	VerifyStatistics(expected.GetPointer(), actual.GetPointer());
+}
+
+void mitkImageStatisticsCalculatorTestSuite::VerifyStatistics(mitk::ImageStatisticsContainer::ConstPointer expected, mitk::ImageStatisticsContainer::ConstPointer actual)
+{
+	typedef mitk::ImageStatisticsContainer::RealType RealType;
+
+	CPPUNIT_ASSERT_EQUAL(expected->GetNumberOfTimeSteps(), actual->GetNumberOfTimeSteps());
+
+	for (unsigned int timeStep = 0; timeStep < expected->GetNumberOfTimeSteps(); ++timeStep)
+	{
+		const auto &expectedStats = expected->GetStatisticsForTimeStep(timeStep);
+		const auto &actualStats = actual->GetStatisticsForTimeStep(timeStep);
+
+		for (const auto &name : { mitk::ImageStatisticsConstants::MEAN(), mitk::ImageStatisticsConstants::MINIMUM(),
+			mitk::ImageStatisticsConstants::MAXIMUM(), mitk::ImageStatisticsConstants::STANDARDDEVIATION(),
+			mitk::ImageStatisticsConstants::VARIANCE(), mitk::ImageStatisticsConstants::SKEWNESS(),
+			mitk::ImageStatisticsConstants::KURTOSIS(), mitk::ImageStatisticsConstants::RMS(),
+			mitk::ImageStatisticsConstants::MPP(), mitk::ImageStatisticsConstants::MEDIAN(),
+			mitk::ImageStatisticsConstants::ENTROPY(), mitk::ImageStatisticsConstants::UNIFORMITY(),
+			mitk::ImageStatisticsConstants::UPP() })
+		{
+			CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(name, expectedStats.GetValueConverted<RealType>(name), actualStats.GetValueConverted<RealType>(name), 1e-6);
+		}
+
+		CPPUNIT_ASSERT_EQUAL(expectedStats.GetValueConverted<mitk::ImageStatisticsContainer::VoxelCountType>(mitk::ImageStatisticsConstants::NUMBEROFVOXELS()),
+			actualStats.GetValueConverted<mitk::ImageStatisticsContainer::VoxelCountType>(mitk::ImageStatisticsConstants::NUMBEROFVOXELS()));
+		CPPUNIT_ASSERT(expectedStats.GetValueConverted<mitk::ImageStatisticsContainer::IndexType>(mitk::ImageStatisticsConstants::MINIMUMPOSITION()) ==
+			actualStats.GetValueConverted<mitk::ImageStatisticsContainer::IndexType>(mitk::ImageStatisticsConstants::MINIMUMPOSITION()));
+		CPPUNIT_ASSERT(expectedStats.GetValueConverted<mitk::ImageStatisticsContainer::IndexType>(mitk::ImageStatisticsConstants::MAXIMUMPOSITION()) ==
+			actualStats.GetValueConverted<mitk::ImageStatisticsContainer::IndexType>(mitk::ImageStatisticsConstants::MAXIMUMPOSITION()));
+	}
+}
+
 const mitk::ImageStatisticsContainer::Pointer
 mitkImageStatisticsCalculatorTestSuite::ComputeStatistics(mitk::Image::ConstPointer image,
 	mitk::MaskGenerator::Pointer maskGen,
 	mitk::MaskGenerator::Pointer secondardMaskGen,
-	unsigned short label)
+	unsigned short label,
+	bool parallelComputation)
 {
 	mitk::ImageStatisticsCalculator::Pointer imgStatCalc = mitk::ImageStatisticsCalculator::New();
 	imgStatCalc->SetInputImage(image);
+	imgStatCalc->SetParallelComputation(parallelComputation);
+	imgStatCalc->SetNumberOfThreads(3);
 
 	if (maskGen.IsNotNull())
 	{
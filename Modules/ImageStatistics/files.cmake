@@ -33,6 +33,7 @@ set(H_FILES
   mitkMultiLabelMaskGenerator.h
   mitkImageMaskGenerator.h
   mitkHistogramStatisticsCalculator.h
+  mitkLabelStatisticsAccumulator.h
   mitkMaskUtilities.h
   mitkitkMaskImageFilter.h
   mitkIgnorePixelMaskGenerator.h
@@ -21,13 +21,23 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkImageStatisticsConstants.h>
+#include <mitkImageReadAccessor.h>
 #include <mitkImageTimeSelector.h>
 #include <mitkImageToItk.h>
+#include <mitkHistogramStatisticsCalculator.h>
+#include <mitkLabelStatisticsAccumulator.h>
 #include <mitkMaskUtilities.h>
 #include <mitkMinMaxImageFilterWithIndex.h>
 #include <mitkMinMaxLabelmageFilterWithIndex.h>
+#include <mitkParallelFor.h>
+#include <mitkPixelTypeMultiplex.h>
 #include <mitkitkMaskImageFilter.h>
 
+#include <itkMultiThreader.h>
+
+#include <cstring>
+#include <memory>
+
 namespace mitk
 {
   void ImageStatisticsCalculator::SetInputImage(const mitk::Image *image)
@@ -35,6 +45,7 @@ namespace mitk
     if (image != m_Image)
     {
       m_Image = image;
+      m_StatisticsCache.clear();
       this->Modified();
     }
   }
@@ -44,6 +55,7 @@ namespace mitk
     if (mask != m_MaskGenerator)
     {
       m_MaskGenerator = mask;
+      m_StatisticsCache.clear();
       this->Modified();
     }
   }
@@ -53,6 +65,7 @@ namespace mitk
     if (mask != m_SecondaryMaskGenerator)
     {
       m_SecondaryMaskGenerator = mask;
+      m_StatisticsCache.clear();
       this->Modified();
     }
   }
@@ -108,66 +121,758 @@ namespace mitk
 
     if (IsUpdateRequired(label))
     {
-      auto timeGeometry = m_Image->GetTimeGeometry();
-      // always compute statistics on all timesteps
-      for (unsigned int timeStep = 0; timeStep < m_Image->GetTimeSteps(); timeStep++)
+      m_NumberOfSlicesComputedInLastUpdate = 0;
+
+      if (m_ParallelComputation)
+      {
+        this->CalculateStatisticsInParallel();
+      }
+      else
       {
-        if (m_MaskGenerator.IsNotNull())
+        auto timeGeometry = m_Image->GetTimeGeometry();
+        const unsigned int numberOfSlices = m_Image->GetDimension() > 2 ? m_Image->GetDimension(2) : 1;
+
+        // always compute statistics on all timesteps
+        for (unsigned int timeStep = 0; timeStep < m_Image->GetTimeSteps(); timeStep++)
         {
-          m_MaskGenerator->SetTimeStep(timeStep);
-          //See T25625: otherwise, the mask is not computed again after setting a different time step
-          m_MaskGenerator->Modified();
-          m_InternalMask = m_MaskGenerator->GetMask();
-          if (m_MaskGenerator->GetReferenceImage().IsNotNull())
-          {
-            m_InternalImageForStatistics = m_MaskGenerator->GetReferenceImage();
-          }
-          else
-          {
-            m_InternalImageForStatistics = m_Image;
-          }
+          this->UpdateMasksForTimeStep(timeStep);
+          this->CalculateStatisticsForTimeStep(timeGeometry, timeStep);
+          m_NumberOfSlicesComputedInLastUpdate += numberOfSlices;
         }
-        else
+      }
+    }
+
+    auto it = m_StatisticContainers.find(label);
+    if (it != m_StatisticContainers.end())
+    {
+      return (it->second).GetPointer();
+    }
+    else
+    {
+      mitkThrow() << "unknown label";
+      return nullptr;
+    }
+  }
+
+  void ImageStatisticsCalculator::SetParallelComputation(bool parallelComputation)
+  {
+    if (parallelComputation != m_ParallelComputation)
+    {
+      m_ParallelComputation = parallelComputation;
+      this->Modified();
+    }
+  }
+
+  bool ImageStatisticsCalculator::GetParallelComputation() const { return m_ParallelComputation; }
+
+  void ImageStatisticsCalculator::SetNumberOfThreads(unsigned int numberOfThreads)
+  {
+    if (numberOfThreads != m_NumberOfThreads)
+    {
+      m_NumberOfThreads = numberOfThreads;
+      this->Modified();
+    }
+  }
+
+  unsigned int ImageStatisticsCalculator::GetNumberOfThreads() const { return m_NumberOfThreads; }
+
+  unsigned int ImageStatisticsCalculator::GetNumberOfSlicesComputedInLastUpdate() const
+  {
+    return m_NumberOfSlicesComputedInLastUpdate;
+  }
+
+  unsigned int ImageStatisticsCalculator::GetEffectiveNumberOfThreads() const
+  {
+    return 0 != m_NumberOfThreads ? m_NumberOfThreads : std::max(1u, static_cast<unsigned int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads()));
+  }
+
+  void ImageStatisticsCalculator::UpdateMasksForTimeStep(TimeStepType timeStep)
+  {
+    if (m_MaskGenerator.IsNotNull())
+    {
+      m_MaskGenerator->SetTimeStep(timeStep);
+      //See T25625: otherwise, the mask is not computed again after setting a different time step
+      m_MaskGenerator->Modified();
+      m_InternalMask = m_MaskGenerator->GetMask();
+      if (m_MaskGenerator->GetReferenceImage().IsNotNull())
+      {
+        m_InternalImageForStatistics = m_MaskGenerator->GetReferenceImage();
+      }
+      else
+      {
+        m_InternalImageForStatistics = m_Image;
+      }
+    }
+    else
+    {
+      m_InternalImageForStatistics = m_Image;
+    }
+
+    if (m_SecondaryMaskGenerator.IsNotNull())
+    {
+      m_SecondaryMaskGenerator->SetTimeStep(timeStep);
+      m_SecondaryMask = m_SecondaryMaskGenerator->GetMask();
+    }
+  }
+
+  void ImageStatisticsCalculator::CalculateStatisticsForTimeStep(const TimeGeometry *timeGeometry, TimeStepType timeStep)
+  {
+    ImageTimeSelector::Pointer imgTimeSel = ImageTimeSelector::New();
+    imgTimeSel->SetInput(m_InternalImageForStatistics);
+    imgTimeSel->SetTimeNr(timeStep);
+    imgTimeSel->UpdateLargestPossibleRegion();
+    imgTimeSel->Update();
+    m_ImageTimeSlice = imgTimeSel->GetOutput();
+
+    // Calculate statistics with/without mask
+    if (m_MaskGenerator.IsNull() && m_SecondaryMaskGenerator.IsNull())
+    {
+      // 1) calculate statistics unmasked:
+      AccessByItk_2(m_ImageTimeSlice, InternalCalculateStatisticsUnmasked, timeGeometry, timeStep)
+    }
+    else
+    {
+      // 2) calculate statistics masked
+      AccessByItk_2(m_ImageTimeSlice, InternalCalculateStatisticsMasked, timeGeometry, timeStep)
+    }
+  }
+
+  namespace
+  {
+    bool IsMaskSupportedInParallelComputation(const mitk::Image *mask, const mitk::Image *image)
+    {
+      if (nullptr == mask)
+        return true;
+
+      const auto pixelType = mask->GetPixelType();
+
+      return itk::ImageIOBase::USHORT == pixelType.GetComponentType() && 1 == pixelType.GetNumberOfComponents() &&
+             mask->GetDimension() == std::min(image->GetDimension(), 3u);
+    }
+
+    /** Part of an image volume covered by a mask, given as offset of the mask within the volume. */
+    struct MaskView
+    {
+      const unsigned short *Data = nullptr;
+      itk::Index<3> Offset;
+      itk::Size<3> Size;
+    };
+
+    MaskView CreateMaskView(const mitk::Image *mask, const void *data, const mitk::BaseGeometry *imageGeometry, const itk::Size<3> &volumeSize)
+    {
+      MaskView view;
+      view.Data = static_cast<const unsigned short *>(data);
+
+      itk::Index<3> offset;
+      imageGeometry->WorldToIndex(mask->GetGeometry()->GetOrigin(), offset);
+
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        view.Offset[i] = i < mask->GetDimension() ? offset[i] : 0;
+        view.Size[i] = i < mask->GetDimension() ? mask->GetDimension(i) : 1;
+
+        if (view.Offset[i] < 0 || view.Offset[i] + static_cast<itk::IndexValueType>(view.Size[i]) > static_cast<itk::IndexValueType>(volumeSize[i]))
+          mitkThrow() << "Mask is not located within the image.";
+      }
+
+      return view;
+    }
+
+    /** Zero-copy view of the voxels of one time step within the region covered by its masks. */
+    struct RegionView
+    {
+      std::unique_ptr<ImageReadAccessor> ImageAccess;
+      std::unique_ptr<ImageReadAccessor> MaskAccess;
+      std::unique_ptr<ImageReadAccessor> SecondaryMaskAccess;
+      const unsigned char *Voxels = nullptr;
+      std::size_t PixelSize = 0;
+      itk::Size<3> VolumeSize;
+      itk::Index<3> RegionIndex;
+      itk::Size<3> RegionSize;
+      MaskView Mask;
+      MaskView SecondaryMask;
+    };
+
+    void InitializeRegionView(RegionView &view, const mitk::Image *image, unsigned int timeStep, const mitk::Image *mask, const mitk::Image *secondaryMask)
+    {
+      const auto imageDimension = std::min(image->GetDimension(), 3u);
+      const auto *geometry = image->GetGeometry(timeStep);
+
+      for (unsigned int i = 0; i < 3; ++i)
+        view.VolumeSize[i] = i < imageDimension ? image->GetDimension(i) : 1;
+
+      view.ImageAccess.reset(new ImageReadAccessor(image, image->GetVolumeData(timeStep)));
+      view.Voxels = static_cast<const unsigned char *>(view.ImageAccess->GetData());
+      view.PixelSize = image->GetPixelType().GetSize();
+      view.RegionIndex.Fill(0);
+      view.RegionSize = view.VolumeSize;
+
+      if (nullptr != mask)
+      {
+        view.MaskAccess.reset(new ImageReadAccessor(mask, mask->GetVolumeData()));
+        view.Mask = CreateMaskView(mask, view.MaskAccess->GetData(), geometry, view.VolumeSize);
+        view.RegionIndex = view.Mask.Offset;
+        view.RegionSize = view.Mask.Size;
+      }
+
+      if (nullptr != secondaryMask)
+      {
+        view.SecondaryMaskAccess.reset(new ImageReadAccessor(secondaryMask, secondaryMask->GetVolumeData()));
+        view.SecondaryMask = CreateMaskView(secondaryMask, view.SecondaryMaskAccess->GetData(), geometry, view.VolumeSize);
+
+        for (unsigned int d = 0; d < 3; ++d)
         {
-          m_InternalImageForStatistics = m_Image;
+          if (view.SecondaryMask.Offset[d] > view.RegionIndex[d] ||
+              view.SecondaryMask.Offset[d] + static_cast<itk::IndexValueType>(view.SecondaryMask.Size[d]) <
+                view.RegionIndex[d] + static_cast<itk::IndexValueType>(view.RegionSize[d]))
+            mitkThrow() << "Secondary mask does not cover the primary mask.";
         }
+      }
+    }
 
-        if (m_SecondaryMaskGenerator.IsNotNull())
+    inline std::size_t GetRowOffset(const RegionView &view, itk::SizeValueType y, itk::SizeValueType z)
+    {
+      return ((z + view.RegionIndex[2]) * view.VolumeSize[1] + y + view.RegionIndex[1]) * view.VolumeSize[0] + view.RegionIndex[0];
+    }
+
+    inline std::size_t GetSecondaryMaskRowOffset(const RegionView &view, itk::SizeValueType y, itk::SizeValueType z)
+    {
+      const auto &secondaryMask = view.SecondaryMask;
+
+      return ((z + view.RegionIndex[2] - secondaryMask.Offset[2]) * secondaryMask.Size[1] + y + view.RegionIndex[1] - secondaryMask.Offset[1]) * secondaryMask.Size[0] +
+             view.RegionIndex[0] - secondaryMask.Offset[0];
+    }
+
+    /** Compares the mask rows of a slice to their copy in \a maskVoxels and updates the copy. Returns true if any
+     *  mask voxel of the slice changed. */
+    bool UpdateMaskSlice(const RegionView &view, itk::SizeValueType z, std::vector<unsigned short> &maskVoxels)
+    {
+      const auto rowLength = view.RegionSize[0];
+      const auto rowSize = rowLength * sizeof(unsigned short);
+      const auto numberOfMasks = (nullptr != view.Mask.Data ? 1 : 0) + (nullptr != view.SecondaryMask.Data ? 1 : 0);
+      auto *copy = maskVoxels.data() + z * view.RegionSize[1] * numberOfMasks * rowLength;
+      bool isModified = false;
+
+      auto updateRow = [&](const unsigned short *row) {
+        if (0 != std::memcmp(copy, row, rowSize))
         {
-          m_SecondaryMaskGenerator->SetTimeStep(timeStep);
-          m_SecondaryMask = m_SecondaryMaskGenerator->GetMask();
+          std::memcpy(copy, row, rowSize);
+          isModified = true;
         }
 
-        ImageTimeSelector::Pointer imgTimeSel = ImageTimeSelector::New();
-        imgTimeSel->SetInput(m_InternalImageForStatistics);
-        imgTimeSel->SetTimeNr(timeStep);
-        imgTimeSel->UpdateLargestPossibleRegion();
-        imgTimeSel->Update();
-        m_ImageTimeSlice = imgTimeSel->GetOutput();
+        copy += rowLength;
+      };
 
-        // Calculate statistics with/without mask
-        if (m_MaskGenerator.IsNull() && m_SecondaryMaskGenerator.IsNull())
+      for (itk::SizeValueType y = 0; y < view.RegionSize[1]; ++y)
+      {
+        if (nullptr != view.Mask.Data)
+          updateRow(view.Mask.Data + (z * view.Mask.Size[1] + y) * view.Mask.Size[0]);
+
+        if (nullptr != view.SecondaryMask.Data)
+          updateRow(view.SecondaryMask.Data + GetSecondaryMaskRowOffset(view, y, z));
+      }
+
+      return isModified;
+    }
+  }
+
+  /** Tracks which slices of the image region covered by the mask of one time step changed since the last update.
+   *  All slices are invalidated by a modification of the image. Masks are usually regenerated for every update, so
+   *  their voxels are kept and compared instead. */
+  struct ImageStatisticsCalculator::StatisticsCacheBase
+  {
+    StatisticsCacheBase(const itk::Index<3> &regionIndex, const itk::Size<3> &regionSize, bool isMasked, bool hasSecondaryMask)
+      : RegionIndex(regionIndex),
+        RegionSize(regionSize),
+        IsMasked(isMasked),
+        HasSecondaryMask(hasSecondaryMask),
+        ImageMTime(0),
+        MaskVoxels(regionSize[0] * regionSize[1] * regionSize[2] * ((isMasked ? 1 : 0) + (hasSecondaryMask ? 1 : 0)), 0),
+        IsSliceValid(regionSize[2], false)
+    {
+    }
+
+    virtual ~StatisticsCacheBase() = default;
+
+    bool IsCompatible(const RegionView &view) const
+    {
+      return RegionIndex == view.RegionIndex && RegionSize == view.RegionSize && IsMasked == (nullptr != view.Mask.Data) &&
+             HasSecondaryMask == (nullptr != view.SecondaryMask.Data);
+    }
+
+    /** Returns the slices that are modified since the last update and marks all slices as valid. */
+    std::vector<itk::SizeValueType> UpdateModifiedSlices(const RegionView &view, itk::ModifiedTimeType imageMTime, unsigned int numberOfThreads)
+    {
+      const bool isImageModified = imageMTime != ImageMTime;
+      std::vector<char> isMaskModified(RegionSize[2], 0);
+
+      if (IsMasked || HasSecondaryMask)
+      {
+        mitk::ParallelFor(RegionSize[2], [&](std::size_t z) {
+          isMaskModified[z] = UpdateMaskSlice(view, z, MaskVoxels);
+        }, numberOfThreads);
+      }
+
+      std::vector<itk::SizeValueType> modifiedSlices;
+
+      for (itk::SizeValueType z = 0; z < RegionSize[2]; ++z)
+      {
+        if (!IsSliceValid[z] || isImageModified || isMaskModified[z])
+          modifiedSlices.push_back(z);
+
+        IsSliceValid[z] = true;
+      }
+
+      ImageMTime = imageMTime;
+
+      return modifiedSlices;
+    }
+
+    itk::Index<3> RegionIndex;
+    itk::Size<3> RegionSize;
+    bool IsMasked;
+    bool HasSecondaryMask;
+    itk::ModifiedTimeType ImageMTime;
+    std::vector<unsigned short> MaskVoxels;
+    std::vector<bool> IsSliceValid;
+  };
+
+  /** Partial statistics of each slice of the image region covered by the mask of one time step. */
+  template <typename TPixel>
+  struct ImageStatisticsCalculator::SliceStatisticsCache : public StatisticsCacheBase
+  {
+    typedef std::map<MaskPixelType, LabelStatisticsAccumulator<TPixel>> AccumulatorMapType;
+    typedef std::map<MaskPixelType, std::vector<double>> BinCountMapType;
+
+    struct HistogramParameters
+    {
+      unsigned int NumberOfBins;
+      double LowerBound;
+      double UpperBound;
+
+      bool operator==(const HistogramParameters &other) const
+      {
+        return NumberOfBins == other.NumberOfBins && LowerBound == other.LowerBound && UpperBound == other.UpperBound;
+      }
+
+      bool operator!=(const HistogramParameters &other) const { return !(*this == other); }
+    };
+
+    SliceStatisticsCache(const itk::Index<3> &regionIndex, const itk::Size<3> &regionSize, bool isMasked, bool hasSecondaryMask)
+      : StatisticsCacheBase(regionIndex, regionSize, isMasked, hasSecondaryMask),
+        SliceAccumulators(regionSize[2]),
+        SliceBinCounts(regionSize[2])
+    {
+    }
+
+    std::vector<AccumulatorMapType> SliceAccumulators;
+    std::vector<BinCountMapType> SliceBinCounts;
+    std::map<MaskPixelType, HistogramParameters> HistogramParametersOfLabels;
+  };
+
+  struct ImageStatisticsCalculator::TimeStepInput
+  {
+    TimeStepType TimeStep;
+    mitk::Image::ConstPointer Mask;
+    mitk::Image::ConstPointer SecondaryMask;
+  };
+
+  void ImageStatisticsCalculator::CalculateStatisticsInParallel()
+  {
+    const auto pixelType = m_Image->GetPixelType();
+    const auto numberOfTimeSteps = m_Image->GetTimeSteps();
+    const auto numberOfThreads = this->GetEffectiveNumberOfThreads();
+    const bool isPixelTypeSupported = 1 == pixelType.GetNumberOfComponents();
+    const unsigned int numberOfSlices = m_Image->GetDimension() > 2 ? m_Image->GetDimension(2) : 1;
+    auto timeGeometry = m_Image->GetTimeGeometry();
+
+    std::vector<TimeStepInput> batch;
+
+    for (unsigned int timeStep = 0; timeStep < numberOfTimeSteps; ++timeStep)
+    {
+      this->UpdateMasksForTimeStep(timeStep);
+
+      mitk::Image::ConstPointer mask = m_InternalMask.GetPointer();
+      mitk::Image::ConstPointer secondaryMask = m_SecondaryMask.GetPointer();
+
+      // see InternalCalculateStatisticsMasked(): a secondary mask without primary mask is used as primary mask
+      if (mask.IsNull() && secondaryMask.IsNotNull())
+        std::swap(mask, secondaryMask);
+
+      if (isPixelTypeSupported && m_InternalImageForStatistics == m_Image &&
+          IsMaskSupportedInParallelComputation(mask, m_Image) &&
+          IsMaskSupportedInParallelComputation(secondaryMask, m_Image))
+      {
+        TimeStepInput input;
+        input.TimeStep = timeStep;
+
+        // Mask generators may reuse their mask image for the next time step. Keep a copy of the masks
+        // if further time steps are prepared before this one is processed.
+        if (numberOfThreads > 1)
         {
-          // 1) calculate statistics unmasked:
-          AccessByItk_2(m_ImageTimeSlice, InternalCalculateStatisticsUnmasked, timeGeometry, timeStep)
+          input.Mask = mask.IsNotNull() ? mask->Clone().GetPointer() : nullptr;
+          input.SecondaryMask = secondaryMask.IsNotNull() ? secondaryMask->Clone().GetPointer() : nullptr;
         }
         else
         {
-          // 2) calculate statistics masked
-          AccessByItk_2(m_ImageTimeSlice, InternalCalculateStatisticsMasked, timeGeometry, timeStep)
+          input.Mask = mask;
+          input.SecondaryMask = secondaryMask;
         }
+
+        batch.push_back(input);
+      }
+      else
+      {
+        this->CalculateStatisticsForTimeStep(timeGeometry, timeStep);
+        m_NumberOfSlicesComputedInLastUpdate += numberOfSlices;
+      }
+
+      if (!batch.empty() && (batch.size() >= numberOfThreads || timeStep + 1 == numberOfTimeSteps))
+      {
+        try
+        {
+          mitkPixelTypeMultiplex1(InternalCalculateStatisticsInParallel, pixelType, batch);
+        }
+        catch (...)
+        {
+          // the mask copies of the batch may already be updated while their partial results are not
+          for (const auto &input : batch)
+            m_StatisticsCache.erase(input.TimeStep);
+
+          throw;
+        }
+
+        batch.clear();
       }
     }
+  }
 
-    auto it = m_StatisticContainers.find(label);
-    if (it != m_StatisticContainers.end())
+  template <typename TPixel>
+  void ImageStatisticsCalculator::InternalCalculateStatisticsInParallel(const mitk::PixelType &,
+                                                                        std::vector<TimeStepInput> &timeSteps)
+  {
+    typedef LabelStatisticsAccumulator<TPixel> AccumulatorType;
+    typedef std::map<MaskPixelType, AccumulatorType> AccumulatorMapType;
+
+    struct Volume : public RegionView
     {
-      return (it->second).GetPointer();
+      const TPixel *Data = nullptr;
+      AccumulatorMapType Accumulators;
+    };
+
+    struct WorkItem
+    {
+      std::size_t VolumeIndex;
+      itk::SizeValueType SlabBegin;
+      itk::SizeValueType SlabEnd;
+    };
+
+    const auto imageDimension = std::min(m_Image->GetDimension(), 3u);
+    const auto numberOfThreads = this->GetEffectiveNumberOfThreads();
+
+    itk::Size<3> volumeSize;
+    for (unsigned int i = 0; i < 3; ++i)
+      volumeSize[i] = i < imageDimension ? m_Image->GetDimension(i) : 1;
+
+    // Set up zero-copy views of the time steps and their masks
+    std::vector<Volume> volumes(timeSteps.size());
+
+    for (std::size_t i = 0; i < timeSteps.size(); ++i)
+    {
+      InitializeRegionView(volumes[i], m_Image, timeSteps[i].TimeStep, timeSteps[i].Mask, timeSteps[i].SecondaryMask);
+      volumes[i].Data = reinterpret_cast<const TPixel *>(volumes[i].Voxels);
+    }
+
+    // Every slice of a region is a work item. Partial results are kept per slice in the statistics cache
+    // of the time step, so that only slices modified since the last computation are visited again.
+    typedef SliceStatisticsCache<TPixel> CacheType;
+
+    std::vector<CacheType *> caches(volumes.size());
+    std::vector<WorkItem> workItems;
+    std::vector<std::size_t> modifiedItems;
+
+    for (std::size_t i = 0; i < volumes.size(); ++i)
+    {
+      const auto &volume = volumes[i];
+      auto &cachePointer = m_StatisticsCache[timeSteps[i].TimeStep];
+      auto cache = dynamic_cast<CacheType *>(cachePointer.get());
+
+      if (nullptr == cache || !cache->IsCompatible(volume))
+      {
+        cachePointer = std::make_shared<CacheType>(volume.RegionIndex, volume.RegionSize, nullptr != volume.Mask.Data, nullptr != volume.SecondaryMask.Data);
+        cache = static_cast<CacheType *>(cachePointer.get());
+      }
+
+      caches[i] = cache;
+
+      const auto firstItem = workItems.size();
+
+      for (itk::SizeValueType z = 0; z < volume.RegionSize[2]; ++z)
+        workItems.push_back({ i, z, z + 1 });
+
+      for (const auto z : cache->UpdateModifiedSlices(volume, m_Image->GetMTime(), numberOfThreads))
+        modifiedItems.push_back(firstItem + z);
+    }
+
+    m_NumberOfSlicesComputedInLastUpdate += static_cast<unsigned int>(modifiedItems.size());
+
+    // Calls function(volumeOffset, label, value) for every voxel of a work item
+    auto forEachVoxel = [&](const WorkItem &item, auto function) {
+      const auto &volume = volumes[item.VolumeIndex];
+      const auto &region = volume.RegionSize;
+      const auto &mask = volume.Mask;
+      const auto &secondaryMask = volume.SecondaryMask;
+
+      for (itk::SizeValueType z = item.SlabBegin; z < item.SlabEnd; ++z)
+      {
+        for (itk::SizeValueType y = 0; y < region[1]; ++y)
+        {
+          const std::size_t rowOffset = GetRowOffset(volume, y, z);
+          const TPixel *row = volume.Data + rowOffset;
+
+          const MaskPixelType *maskRow = nullptr != mask.Data
+            ? mask.Data + (z * mask.Size[1] + y) * mask.Size[0]
+            : nullptr;
+
+          const MaskPixelType *secondaryMaskRow = nullptr != secondaryMask.Data
+            ? secondaryMask.Data + GetSecondaryMaskRowOffset(volume, y, z)
+            : nullptr;
+
+          for (itk::SizeValueType x = 0; x < region[0]; ++x)
+          {
+            MaskPixelType label = nullptr != maskRow ? maskRow[x] : 1;
+
+            // voxels excluded by the secondary mask are assigned to the background, see itk::MaskImageFilter2
+            if (nullptr != secondaryMaskRow && 1 != secondaryMaskRow[x])
+              label = 0;
+
+            function(rowOffset + x, label, row[x]);
+          }
+        }
+      }
+    };
+
+    // First pass: extrema, moments and (for 8 bit types) value counts of all labels of the modified slices
+    mitk::ParallelFor(modifiedItems.size(), [&](std::size_t i) {
+      const auto &item = workItems[modifiedItems[i]];
+      auto &accumulators = caches[item.VolumeIndex]->SliceAccumulators[item.SlabBegin];
+      MaskPixelType lastLabel = 0;
+      AccumulatorType *accumulator = nullptr;
+
+      accumulators.clear();
+
+      forEachVoxel(item, [&](std::size_t offset, MaskPixelType label, TPixel value) {
+        if (nullptr == accumulator || label != lastLabel)
+        {
+          accumulator = &accumulators[label];
+          lastLabel = label;
+        }
+
+        accumulator->Add(value, offset);
+      });
+    }, numberOfThreads);
+
+    for (std::size_t i = 0; i < volumes.size(); ++i)
+    {
+      for (const auto &sliceAccumulators : caches[i]->SliceAccumulators)
+      {
+        for (const auto &labelAccumulator : sliceAccumulators)
+          volumes[i].Accumulators[labelAccumulator.first].Merge(labelAccumulator.second);
+      }
+    }
+
+    // Histogram parameters per label (min/max may be different for each label)
+    auto getHistogramParameters = [this](const AccumulatorType &accumulator) {
+      typename CacheType::HistogramParameters parameters;
+      parameters.LowerBound = accumulator.GetMinimum();
+      parameters.UpperBound = accumulator.GetMaximum();
+
+      if (m_UseBinSizeOverNBins)
+      {
+        parameters.NumberOfBins = std::max(static_cast<double>(std::ceil(accumulator.GetMaximum() - accumulator.GetMinimum())) /
+                                             m_binSizeForHistogramStatistics,
+                                           10.); // do not allow less than 10 bins
+      }
+      else
+      {
+        parameters.NumberOfBins = m_nBinsForHistogramStatistics;
+      }
+
+      return parameters;
+    };
+
+    std::vector<std::map<MaskPixelType, HistogramType::Pointer>> histograms(volumes.size());
+
+    if (AccumulatorType::HasValueHistogram)
+    {
+      for (std::size_t i = 0; i < volumes.size(); ++i)
+      {
+        for (const auto &labelAccumulator : volumes[i].Accumulators)
+        {
+          histograms[i][labelAccumulator.first] =
+            labelAccumulator.second.CreateHistogramFromValueCounts(getHistogramParameters(labelAccumulator.second).NumberOfBins);
+        }
+      }
     }
     else
     {
-      mitkThrow() << "unknown label";
-      return nullptr;
+      // Second pass: the histogram range is only known after the first pass. The partial histograms of
+      // unmodified slices stay valid as long as the histogram parameters of all labels are unchanged.
+      std::vector<bool> isHistogramModified(volumes.size(), false);
+
+      for (std::size_t i = 0; i < volumes.size(); ++i)
+      {
+        std::map<MaskPixelType, typename CacheType::HistogramParameters> parameters;
+
+        for (const auto &labelAccumulator : volumes[i].Accumulators)
+          parameters[labelAccumulator.first] = getHistogramParameters(labelAccumulator.second);
+
+        if (parameters != caches[i]->HistogramParametersOfLabels)
+        {
+          caches[i]->HistogramParametersOfLabels = parameters;
+          isHistogramModified[i] = true;
+        }
+      }
+
+      std::vector<std::size_t> histogramItems;
+
+      for (std::size_t i = 0, j = 0; i < workItems.size(); ++i)
+      {
+        const bool isModified = j < modifiedItems.size() && modifiedItems[j] == i;
+
+        if (isModified)
+          ++j;
+
+        if (isModified || isHistogramModified[workItems[i].VolumeIndex])
+          histogramItems.push_back(i);
+      }
+
+      mitk::ParallelFor(histogramItems.size(), [&](std::size_t i) {
+        const auto &item = workItems[histogramItems[i]];
+        const auto &parameters = caches[item.VolumeIndex]->HistogramParametersOfLabels;
+        auto &binCounts = caches[item.VolumeIndex]->SliceBinCounts[item.SlabBegin];
+        MaskPixelType lastLabel = 0;
+        std::vector<double> *counts = nullptr;
+        const typename CacheType::HistogramParameters *labelParameters = nullptr;
+
+        binCounts.clear();
+
+        forEachVoxel(item, [&](std::size_t, MaskPixelType label, TPixel value) {
+          if (nullptr == counts || label != lastLabel)
+          {
+            labelParameters = &parameters.find(label)->second;
+            counts = &binCounts[label];
+            counts->resize(labelParameters->NumberOfBins, 0.0);
+            lastLabel = label;
+          }
+
+          ++(*counts)[AccumulatorType::GetBin(value, labelParameters->NumberOfBins, labelParameters->LowerBound, labelParameters->UpperBound)];
+        });
+      }, numberOfThreads);
+
+      for (std::size_t i = 0; i < volumes.size(); ++i)
+      {
+        auto &volumeHistograms = histograms[i];
+
+        for (const auto &labelParameters : caches[i]->HistogramParametersOfLabels)
+        {
+          volumeHistograms[labelParameters.first] = AccumulatorType::CreateHistogram(
+            labelParameters.second.NumberOfBins, labelParameters.second.LowerBound, labelParameters.second.UpperBound);
+        }
+
+        for (const auto &sliceBinCounts : caches[i]->SliceBinCounts)
+        {
+          for (const auto &labelBinCounts : sliceBinCounts)
+          {
+            auto &histogram = volumeHistograms[labelBinCounts.first];
+
+            for (std::size_t bin = 0; bin < labelBinCounts.second.size(); ++bin)
+              histogram->IncreaseFrequency(bin, labelBinCounts.second[bin]);
+          }
+        }
+      }
+    }
+
+    // Store the results
+    auto timeGeometry = m_Image->GetTimeGeometry();
+    const bool isMasked = nullptr != volumes.front().Mask.Data;
+
+    for (std::size_t i = 0; i < volumes.size(); ++i)
+    {
+      const auto timeStep = timeSteps[i].TimeStep;
+      const auto spacing = m_Image->GetGeometry(timeStep)->GetSpacing();
+
+      double voxelVolume = 1.;
+      for (unsigned int d = 0; d < imageDimension; ++d)
+        voxelVolume *= spacing[d];
+
+      for (const auto &labelAccumulator : volumes[i].Accumulators)
+      {
+        const auto label = labelAccumulator.first;
+        const auto &accumulator = labelAccumulator.second;
+
+        ImageStatisticsContainer::Pointer statisticContainer;
+        auto containerIt = m_StatisticContainers.find(label);
+        if (containerIt != m_StatisticContainers.end())
+        {
+          statisticContainer = containerIt->second;
+        }
+        else
+        {
+          statisticContainer = ImageStatisticsContainer::New();
+          statisticContainer->SetTimeGeometry(const_cast<mitk::TimeGeometry *>(timeGeometry));
+          m_StatisticContainers.emplace(label, statisticContainer);
+        }
+
+        // positions are reported as 3D indices for masked and in image dimension for unmasked statistics
+        const unsigned int indexDimension = isMasked ? 3 : imageDimension;
+        vnl_vector<int> minIndex(indexDimension, 0);
+        vnl_vector<int> maxIndex(indexDimension, 0);
+
+        auto minOffset = accumulator.GetMinimumOffset();
+        auto maxOffset = accumulator.GetMaximumOffset();
+
+        for (unsigned int d = 0; d < imageDimension; ++d)
+        {
+          minIndex[d] = static_cast<int>(minOffset % volumeSize[d]);
+          maxIndex[d] = static_cast<int>(maxOffset % volumeSize[d]);
+          minOffset /= volumeSize[d];
+          maxOffset /= volumeSize[d];
+        }
+
+        const auto variance = accumulator.GetVariance();
+        const auto mean = accumulator.GetMean();
+        const auto &histogram = histograms[i][label];
+
+        mitk::HistogramStatisticsCalculator histStatCalc;
+        histStatCalc.SetHistogram(histogram);
+        histStatCalc.CalculateStatistics();
+
+        ImageStatisticsContainer::ImageStatisticsObject statObj;
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MINIMUMPOSITION(), minIndex);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MAXIMUMPOSITION(), maxIndex);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::NUMBEROFVOXELS(),
+                             static_cast<ImageStatisticsContainer::VoxelCountType>(accumulator.GetCount()));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::VOLUME(), static_cast<double>(accumulator.GetCount()) * voxelVolume);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MEAN(), mean);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MINIMUM(),
+                             static_cast<ImageStatisticsContainer::RealType>(accumulator.GetMinimum()));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MAXIMUM(),
+                             static_cast<ImageStatisticsContainer::RealType>(accumulator.GetMaximum()));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::STANDARDDEVIATION(), std::sqrt(variance));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::VARIANCE(), variance);
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::SKEWNESS(), accumulator.GetSkewness());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::KURTOSIS(), accumulator.GetKurtosis());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::RMS(), std::sqrt(mean * mean + variance));
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MPP(), accumulator.GetMPP());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::ENTROPY(), histStatCalc.GetEntropy());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::MEDIAN(), histStatCalc.GetMedian());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::UNIFORMITY(), histStatCalc.GetUniformity());
+        statObj.AddStatistic(mitk::ImageStatisticsConstants::UPP(), histStatCalc.GetUPP());
+        statObj.m_Histogram = histogram.GetPointer();
+
+        statisticContainer->SetStatisticsForTimeStep(timeStep, statObj);
+      }
     }
   }
 
@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkMaskGenerator.h>
 #include <mitkImageStatisticsContainer.h>
 
+#include <memory>
+
 namespace mitk
 {
     class MITKIMAGESTATISTICS_EXPORT ImageStatisticsCalculator: public itk::Object
@@ -82,11 +84,41 @@ namespace mitk
          */
         ImageStatisticsContainer* GetStatistics(LabelIndex label=1);
 
+        /**Documentation
+        @brief Enable the parallel computation mode. Time steps and their slices are then processed concurrently,
+        the voxels of each time step are read in place instead of being extracted with an ImageTimeSelector, and
+        extrema with their positions, moments and histogram of all labels are gathered in one fused pass (a second pass is
+        only needed for the histogram of pixel types wider than 8 bit). Time steps that require special mask handling
+        (e.g. planar figure masks) are still computed the conventional way. Disabled by default.
+
+        In parallel computation mode, partial results are cached per slice. A modification of the image (its MTime changed)
+        invalidates all slices. Masks are compared voxel by voxel to their state at the last computation, so that only slices
+        with a changed mask (e.g. after a segmentation was edited on a single slice) are processed again. The cache is
+        dropped when the input image or one of the mask generators is replaced. The conventional mode always computes
+        all time steps.*/
+        void SetParallelComputation(bool parallelComputation);
+        bool GetParallelComputation() const;
+
+        /**Documentation
+        @brief Number of slices (summed over all time steps) whose statistics were computed during the last update.
+        Slices that were skipped because they are unchanged since the previous update are not counted. Mainly useful
+        to profile and verify incremental updates.*/
+        unsigned int GetNumberOfSlicesComputedInLastUpdate() const;
+
+        /**Documentation
+        @brief Set the number of threads used in parallel computation mode. 0 (default) uses the global default number of
+        threads of ITK.*/
+        void SetNumberOfThreads(unsigned int numberOfThreads);
+        unsigned int GetNumberOfThreads() const;
+
     protected:
         ImageStatisticsCalculator(){
             m_nBinsForHistogramStatistics = 100;
             m_binSizeForHistogramStatistics = 10;
             m_UseBinSizeOverNBins = false;
+            m_ParallelComputation = false;
+            m_NumberOfThreads = 0;
+            m_NumberOfSlicesComputedInLastUpdate = 0;
         };
 
 
@@ -99,6 +131,24 @@ namespace mitk
                 typename itk::Image< TPixel, VImageDimension >* image, const TimeGeometry* timeGeometry,
                 unsigned int timeStep);
 
+        //Updates m_InternalMask, m_SecondaryMask and m_InternalImageForStatistics for the given time step
+        void UpdateMasksForTimeStep(TimeStepType timeStep);
+
+        //Calculates statistics of the current m_InternalImageForStatistics and masks for a single time step
+        void CalculateStatisticsForTimeStep(const TimeGeometry* timeGeometry, TimeStepType timeStep);
+
+        //Calculates statistics of all time steps in parallel, see SetParallelComputation()
+        void CalculateStatisticsInParallel();
+
+        struct TimeStepInput;
+        struct StatisticsCacheBase;
+        template < typename TPixel > struct SliceStatisticsCache;
+
+        template < typename TPixel > void InternalCalculateStatisticsInParallel(
+                const mitk::PixelType& pixelType, std::vector<TimeStepInput>& timeSteps);
+
+        unsigned int GetEffectiveNumberOfThreads() const;
+
         template < typename TPixel, unsigned int VImageDimension >
         double GetVoxelVolume(typename itk::Image<TPixel, VImageDimension>* image) const;
 
@@ -117,8 +167,12 @@ namespace mitk
         unsigned int m_nBinsForHistogramStatistics;
         double m_binSizeForHistogramStatistics;
         bool m_UseBinSizeOverNBins;
+        bool m_ParallelComputation;
+        unsigned int m_NumberOfThreads;
+        unsigned int m_NumberOfSlicesComputedInLastUpdate;
 
         std::map<LabelIndex,ImageStatisticsContainer::Pointer> m_StatisticContainers;
+        std::map<TimeStepType, std::shared_ptr<StatisticsCacheBase>> m_StatisticsCache;
     };
 
 }
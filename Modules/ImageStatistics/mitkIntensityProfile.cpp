@@ -19,38 +19,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkPolyLineParametricPath.h>
 #include <itkWindowedSincInterpolateImageFunction.h>
 #include <mitkImageAccessByItk.h>
-#include <mitkImagePixelReadAccessor.h>
-#include <mitkPixelTypeMultiplex.h>
 #include <mitkImageStatisticsContainer.h>
 #include "mitkIntensityProfile.h"
 
 using namespace mitk;
 
-template <class T>
-static void ReadPixel(const PixelType&, Image::Pointer image, const itk::Index<3>& index, ScalarType* returnValue)
-{
-  switch (image->GetDimension())
-  {
-  case 2:
-    {
-      ImagePixelReadAccessor<T, 2> readAccess(image, image->GetSliceData(0));
-      *returnValue = readAccess.GetPixelByIndex(reinterpret_cast<const itk::Index<2>&>(index));
-      break;
-    }
-
-  case 3:
-    {
-      ImagePixelReadAccessor<T, 3> readAccess(image, image->GetVolumeData(0));
-      *returnValue = readAccess.GetPixelByIndex(index);
-      break;
-    }
-
-  default:
-    *returnValue = 0;
-    break;
-  }
-}
-
 static IntensityProfile::Pointer ComputeIntensityProfile(Image::Pointer image, itk::PolyLineParametricPath<3>::Pointer path)
 {
   if (image->GetDimension() == 4)
@@ -58,28 +31,25 @@ static IntensityProfile::Pointer ComputeIntensityProfile(Image::Pointer image, i
     mitkThrow() << "computation of intensity profiles not supported for 4D images";
   }
 
-  IntensityProfile::Pointer intensityProfile = IntensityProfile::New();
   itk::PolyLineParametricPath<3>::InputType input = path->StartOfInput();
   BaseGeometry* imageGeometry = image->GetGeometry();
-  const PixelType pixelType = image->GetPixelType();
 
-  IntensityProfile::MeasurementVectorType measurementVector;
   itk::PolyLineParametricPath<3>::OffsetType offset;
   Point3D worldPoint;
-  itk::Index<3> index;
+  std::vector<itk::Index<3>> indices;
 
   do
   {
     imageGeometry->IndexToWorld(path->Evaluate(input), worldPoint);
-    imageGeometry->WorldToIndex(worldPoint, index);
-
-    mitkPixelTypeMultiplex3(ReadPixel, pixelType, image, index, measurementVector.GetDataPointer());
-    intensityProfile->PushBack(measurementVector);
+    indices.push_back(itk::Index<3>());
+    imageGeometry->WorldToIndex(worldPoint, indices.back());
 
     offset = path->IncrementInput(input);
   } while ((offset[0] | offset[1] | offset[2]) != 0);
 
-  return intensityProfile;
+  const std::vector<IntensityProfile::MeasurementType> values = image->GetPixelValuesByIndex(indices);
+
+  return CreateIntensityProfileFromVector(values);
 }
 
 template <class TInputImage>
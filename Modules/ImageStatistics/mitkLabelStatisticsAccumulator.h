@@ -0,0 +1,251 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKLABELSTATISTICSACCUMULATOR_H
+#define MITKLABELSTATISTICSACCUMULATOR_H
+
+#include <itkHistogram.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * @brief Accumulates the first-order statistics of the voxels of one label in a single pass.
+   *
+   * Collects the voxel count, the sums of the first four powers, the sum and count of positive
+   * voxels and the extrema together with the linear offset of the voxel they were found at.
+   * For 8 bit pixel types an exact per-value histogram is collected as well, so that a binned
+   * histogram of any range can be derived without another pass over the voxels. For all other
+   * pixel types the histogram has to be filled in a second pass once the extrema are known.
+   *
+   * Accumulators of disjoint sets of voxels (e.g. slabs processed by different threads) can be
+   * combined with Merge(). The result does not depend on the order in which voxels are added,
+   * except for the offsets of ties of the extrema, for which the smallest offset is kept.
+   */
+  template <typename TPixel>
+  class LabelStatisticsAccumulator
+  {
+  public:
+    typedef itk::Statistics::Histogram<double> HistogramType;
+    typedef double RealType;
+    typedef unsigned long SizeValueType;
+
+    /** Pixel types for which an exact per-value histogram is kept. */
+    static const bool HasValueHistogram = std::numeric_limits<TPixel>::is_integer && 1 == sizeof(TPixel);
+
+    LabelStatisticsAccumulator()
+      : m_Count(0),
+        m_PositivePixelCount(0),
+        m_Sum(0.0),
+        m_SumOfPositivePixels(0.0),
+        m_SumOfSquares(0.0),
+        m_SumOfCubes(0.0),
+        m_SumOfQuadruples(0.0),
+        m_Minimum(std::numeric_limits<TPixel>::max()),
+        m_Maximum(std::numeric_limits<TPixel>::lowest()),
+        m_MinimumOffset(std::numeric_limits<std::size_t>::max()),
+        m_MaximumOffset(std::numeric_limits<std::size_t>::max())
+    {
+      if (HasValueHistogram)
+        m_ValueCounts.resize(static_cast<std::size_t>(1) << (8 * sizeof(TPixel)), 0);
+    }
+
+    void Add(TPixel value, std::size_t offset)
+    {
+      const RealType realValue = static_cast<RealType>(value);
+      const RealType square = realValue * realValue;
+
+      ++m_Count;
+      m_Sum += realValue;
+      m_SumOfSquares += square;
+      m_SumOfCubes += square * realValue;
+      m_SumOfQuadruples += square * square;
+
+      if (value > 0)
+      {
+        ++m_PositivePixelCount;
+        m_SumOfPositivePixels += realValue;
+      }
+
+      if (value < m_Minimum || (value == m_Minimum && offset < m_MinimumOffset))
+      {
+        m_Minimum = value;
+        m_MinimumOffset = offset;
+      }
+
+      if (value > m_Maximum || (value == m_Maximum && offset < m_MaximumOffset))
+      {
+        m_Maximum = value;
+        m_MaximumOffset = offset;
+      }
+
+      if (HasValueHistogram)
+        ++m_ValueCounts[ValueToSlot(value)];
+    }
+
+    void Merge(const LabelStatisticsAccumulator& other)
+    {
+      if (0 == other.m_Count)
+        return;
+
+      m_Count += other.m_Count;
+      m_PositivePixelCount += other.m_PositivePixelCount;
+      m_Sum += other.m_Sum;
+      m_SumOfPositivePixels += other.m_SumOfPositivePixels;
+      m_SumOfSquares += other.m_SumOfSquares;
+      m_SumOfCubes += other.m_SumOfCubes;
+      m_SumOfQuadruples += other.m_SumOfQuadruples;
+
+      if (other.m_Minimum < m_Minimum || (other.m_Minimum == m_Minimum && other.m_MinimumOffset < m_MinimumOffset))
+      {
+        m_Minimum = other.m_Minimum;
+        m_MinimumOffset = other.m_MinimumOffset;
+      }
+
+      if (other.m_Maximum > m_Maximum || (other.m_Maximum == m_Maximum && other.m_MaximumOffset < m_MaximumOffset))
+      {
+        m_Maximum = other.m_Maximum;
+        m_MaximumOffset = other.m_MaximumOffset;
+      }
+
+      if (HasValueHistogram)
+      {
+        for (std::size_t i = 0; i < m_ValueCounts.size(); ++i)
+          m_ValueCounts[i] += other.m_ValueCounts[i];
+      }
+    }
+
+    SizeValueType GetCount() const { return m_Count; }
+    SizeValueType GetPositivePixelCount() const { return m_PositivePixelCount; }
+    RealType GetSum() const { return m_Sum; }
+    TPixel GetMinimum() const { return m_Minimum; }
+    TPixel GetMaximum() const { return m_Maximum; }
+    std::size_t GetMinimumOffset() const { return m_MinimumOffset; }
+    std::size_t GetMaximumOffset() const { return m_MaximumOffset; }
+
+    RealType GetMean() const { return m_Sum / static_cast<RealType>(m_Count); }
+    RealType GetMPP() const { return m_SumOfPositivePixels / static_cast<RealType>(m_PositivePixelCount); }
+
+    /** Biased variance estimate, identical to the one of itk::ExtendedStatisticsImageFilter. */
+    RealType GetVariance() const
+    {
+      const RealType count = static_cast<RealType>(m_Count);
+      return (m_SumOfSquares - m_Sum * m_Sum / count) / count;
+    }
+
+    RealType GetSkewness() const
+    {
+      const RealType count = static_cast<RealType>(m_Count);
+      const RealType mean = this->GetMean();
+      const RealType secondMoment = m_SumOfSquares / count;
+      const RealType thirdMoment = m_SumOfCubes / count;
+
+      return (thirdMoment - 3. * secondMoment * mean + 2. * std::pow(mean, 3.)) / std::pow(secondMoment - std::pow(mean, 2.), 1.5);
+    }
+
+    RealType GetKurtosis() const
+    {
+      const RealType count = static_cast<RealType>(m_Count);
+      const RealType mean = this->GetMean();
+      const RealType secondMoment = m_SumOfSquares / count;
+      const RealType thirdMoment = m_SumOfCubes / count;
+      const RealType fourthMoment = m_SumOfQuadruples / count;
+
+      return (fourthMoment - 4. * thirdMoment * mean + 6. * secondMoment * std::pow(mean, 2.) - 3. * std::pow(mean, 4.)) / std::pow(secondMoment - std::pow(mean, 2.), 2.);
+    }
+
+    /** @brief Create an empty histogram spanning [lowerBound, upperBound] with @a nBins bins. */
+    static HistogramType::Pointer CreateHistogram(unsigned int nBins, RealType lowerBound, RealType upperBound)
+    {
+      auto histogram = HistogramType::New();
+      HistogramType::SizeType size(1);
+      HistogramType::MeasurementVectorType lb(1);
+      HistogramType::MeasurementVectorType ub(1);
+      size[0] = nBins;
+      lb[0] = lowerBound;
+      ub[0] = upperBound;
+      histogram->SetMeasurementVectorSize(1);
+      histogram->Initialize(size, lb, ub);
+      return histogram;
+    }
+
+    /** @brief Bin of @a value in a histogram created by CreateHistogram(). Values equal to the upper bound fall
+     * into the last bin, just like in itk::Statistics::Histogram::GetIndex(). */
+    static unsigned int GetBin(RealType value, unsigned int nBins, RealType lowerBound, RealType upperBound)
+    {
+      if (upperBound <= lowerBound)
+        return nBins - 1;
+
+      const RealType position = (value - lowerBound) * nBins / (upperBound - lowerBound);
+
+      if (position <= 0.0)
+        return 0;
+
+      return std::min(static_cast<unsigned int>(position), nBins - 1);
+    }
+
+    /** @brief Derive a histogram over [GetMinimum(), GetMaximum()] from the exact per-value counts.
+     * @pre HasValueHistogram */
+    HistogramType::Pointer CreateHistogramFromValueCounts(unsigned int nBins) const
+    {
+      const RealType lowerBound = static_cast<RealType>(m_Minimum);
+      const RealType upperBound = static_cast<RealType>(m_Maximum);
+      auto histogram = CreateHistogram(nBins, lowerBound, upperBound);
+
+      for (std::size_t slot = 0; slot < m_ValueCounts.size(); ++slot)
+      {
+        if (0 != m_ValueCounts[slot])
+        {
+          const RealType value = static_cast<RealType>(SlotToValue(slot));
+          histogram->IncreaseFrequency(GetBin(value, nBins, lowerBound, upperBound), m_ValueCounts[slot]);
+        }
+      }
+
+      return histogram;
+    }
+
+  private:
+    static std::size_t ValueToSlot(TPixel value)
+    {
+      return static_cast<std::size_t>(static_cast<long>(value) - static_cast<long>(std::numeric_limits<TPixel>::lowest()));
+    }
+
+    static TPixel SlotToValue(std::size_t slot)
+    {
+      return static_cast<TPixel>(static_cast<long>(slot) + static_cast<long>(std::numeric_limits<TPixel>::lowest()));
+    }
+
+    SizeValueType m_Count;
+    SizeValueType m_PositivePixelCount;
+    RealType m_Sum;
+    RealType m_SumOfPositivePixels;
+    RealType m_SumOfSquares;
+    RealType m_SumOfCubes;
+    RealType m_SumOfQuadruples;
+    TPixel m_Minimum;
+    TPixel m_Maximum;
+    std::size_t m_MinimumOffset;
+    std::size_t m_MaximumOffset;
+    std::vector<SizeValueType> m_ValueCounts;
+  };
+}
+
+#endif
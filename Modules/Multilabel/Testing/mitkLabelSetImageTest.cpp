@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include <mitkIOUtil.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
 #include <mitkImageStatisticsHolder.h>
 #include <mitkLabelSetImage.h>
 #include <mitkTestFixture.h>
@@ -36,13 +38,15 @@ class mitkLabelSetImageTestSuite : public mitk::TestFixture
   MITK_TEST(TestExistsLabelSet);
   MITK_TEST(TestSetActiveLayer);
   MITK_TEST(TestRemoveLayer);
+  MITK_TEST(TestSparseLayerStorage);
+  MITK_TEST(TestInactiveLayerAccess);
   MITK_TEST(TestRemoveLabels);
   MITK_TEST(TestMergeLabel);
+  MITK_TEST(TestUpdateCentersOfMass);
   // TODO check it these functionalities can be moved into a process object
   //  MITK_TEST(TestMergeLabels);
   //  MITK_TEST(TestConcatenate);
   //  MITK_TEST(TestClearBuffer);
-  //  MITK_TEST(TestUpdateCenterOfMass);
   //  MITK_TEST(TestGetVectorImage);
   //  MITK_TEST(TestSetVectorImage);
   //  MITK_TEST(TestGetLayerImage);
@@ -385,6 +389,107 @@ public:
                            m_LabelSetImage->GetActiveLabelSet() == nullptr);
   }
 
+  void TestSparseLayerStorage()
+  {
+    itk::Index<3> index;
+    index[0] = 100;
+    index[1] = 40;
+    index[2] = 300;
+
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+      accessor.SetPixelByIndex(index, 5);
+    }
+
+    m_LabelSetImage->AddLayer();
+
+    CPPUNIT_ASSERT_MESSAGE("New layer is not empty", m_LabelSetImage->GetLayerStorage(1)->IsEmpty());
+    CPPUNIT_ASSERT_MESSAGE("Inactive layer allocates more than the tile containing the label",
+                           m_LabelSetImage->GetLayerStorage(0)->GetNumberOfAllocatedTiles() == 1);
+
+    {
+      mitk::ImagePixelReadAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+      CPPUNIT_ASSERT_MESSAGE("Active layer was not cleared", accessor.GetPixelByIndex(index) == 0);
+    }
+
+    {
+      mitk::ImagePixelReadAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage->GetLayerImage(0));
+      CPPUNIT_ASSERT_MESSAGE("Wrong pixel value in layer image", accessor.GetPixelByIndex(index) == 5);
+    }
+
+    m_LabelSetImage->SetActiveLayer(0);
+
+    {
+      mitk::ImagePixelReadAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+      CPPUNIT_ASSERT_MESSAGE("Label was not restored after switching layers", accessor.GetPixelByIndex(index) == 5);
+    }
+  }
+
+  void TestInactiveLayerAccess()
+  {
+    itk::Index<3> index;
+    index[0] = 100;
+    index[1] = 40;
+    index[2] = 300;
+
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+      accessor.SetPixelByIndex(index, 5);
+    }
+
+    m_LabelSetImage->AddLayer();
+
+    // region crossing a tile border, the label is at index (2, 1, 4) of the region
+    itk::ImageRegion<3> region;
+    region.SetIndex(0, 98);
+    region.SetIndex(1, 39);
+    region.SetIndex(2, 296);
+    region.SetSize(0, 5);
+    region.SetSize(1, 3);
+    region.SetSize(2, 6);
+
+    mitk::Image::Pointer regionImage = m_LabelSetImage->GetLayerImageRegion(0, 0, region);
+
+    CPPUNIT_ASSERT_MESSAGE("Wrong size of the layer region", regionImage->GetDimension(0) == 5 &&
+                                                              regionImage->GetDimension(1) == 3 &&
+                                                              regionImage->GetDimension(2) == 6);
+
+    {
+      mitk::ImagePixelReadAccessor<mitk::Label::PixelType, 3> accessor(regionImage);
+      itk::Index<3> regionIndex;
+      regionIndex[0] = 2;
+      regionIndex[1] = 1;
+      regionIndex[2] = 4;
+
+      CPPUNIT_ASSERT_MESSAGE("Wrong pixel value in layer region", accessor.GetPixelByIndex(regionIndex) == 5);
+
+      regionIndex.Fill(0);
+      CPPUNIT_ASSERT_MESSAGE("Layer region contains other labels", accessor.GetPixelByIndex(regionIndex) == 0);
+    }
+
+    mitk::Point3D labelPosition;
+    mitk::Point3D labelPositionInRegion;
+    m_LabelSetImage->GetGeometry()->IndexToWorld(index, labelPosition);
+    mitk::Point3D regionIndexPoint;
+    mitk::FillVector3D(regionIndexPoint, 2, 1, 4);
+    regionImage->GetGeometry()->IndexToWorld(regionIndexPoint, labelPositionInRegion);
+
+    CPPUNIT_ASSERT_MESSAGE("Layer region is not located at the position of the region",
+                           mitk::Equal(labelPosition, labelPositionInRegion));
+
+    CPPUNIT_ASSERT_THROW(m_LabelSetImage->GetLayerImageRegion(0, 1, region), mitk::Exception);
+    region.SetSize(2, 20);
+    CPPUNIT_ASSERT_THROW(m_LabelSetImage->GetLayerImageRegion(0, 0, region), mitk::Exception);
+
+    // labels of inactive layers are removed in their sparse storage
+    std::vector<mitk::Label::PixelType> labelsToBeErased(1, 5);
+    m_LabelSetImage->EraseLabels(labelsToBeErased, 0);
+
+    CPPUNIT_ASSERT_MESSAGE("Erased label still occupies a tile", m_LabelSetImage->GetLayerStorage(0)->IsEmpty());
+    CPPUNIT_ASSERT_MESSAGE("Erasing a label of an inactive layer changed the active layer",
+                           m_LabelSetImage->GetActiveLayer() == 1);
+  }
+
   void TestRemoveLabels()
   {
     mitk::Image::Pointer image =
@@ -443,6 +548,70 @@ public:
     // Check if merge label has 507 + 823 = 1330 pixels
     CPPUNIT_ASSERT_MESSAGE("Label with value 7 was not remove from the image", m_LabelSetImage->GetStatistics()->GetCountOfMaxValuedVoxels() == 1330);
   }
+
+  void TestUpdateCentersOfMass()
+  {
+    mitk::Label::Pointer label = mitk::Label::New();
+    label->SetValue(3);
+    m_LabelSetImage->GetActiveLabelSet()->AddLabel(label);
+
+    itk::Index<3> first = {{10, 20, 30}};
+    itk::Index<3> second = {{20, 40, 31}};
+
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+      accessor.SetPixelByIndex(first, 3);
+      accessor.SetPixelByIndex(second, 3);
+    }
+
+    m_LabelSetImage->UpdateCentersOfMass();
+
+    mitk::Point3D expectedCenter;
+    mitk::FillVector3D(expectedCenter, 15.0, 30.0, 30.5);
+    CPPUNIT_ASSERT_MESSAGE("Wrong center of mass",
+                           mitk::Equal(m_LabelSetImage->GetLabel(3)->GetCenterOfMassIndex(), expectedCenter));
+
+    // merging updates the center of mass of the target label
+    mitk::Label::Pointer sourceLabel = mitk::Label::New();
+    sourceLabel->SetValue(4);
+    m_LabelSetImage->GetActiveLabelSet()->AddLabel(sourceLabel);
+
+    itk::Index<3> third = {{30, 60, 32}};
+
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+      accessor.SetPixelByIndex(third, 4);
+    }
+
+    m_LabelSetImage->MergeLabel(3, 4);
+
+    mitk::FillVector3D(expectedCenter, 20.0, 40.0, 31.0);
+    CPPUNIT_ASSERT_MESSAGE("Center of mass was not updated by merging",
+                           mitk::Equal(m_LabelSetImage->GetLabel(3)->GetCenterOfMassIndex(), expectedCenter));
+
+    // inactive layers are read in their sparse storage
+    m_LabelSetImage->AddLayer();
+    mitk::Point3D staleCenter;
+    staleCenter.Fill(-1.0);
+    m_LabelSetImage->GetLabel(3, 0)->SetCenterOfMassIndex(staleCenter);
+    m_LabelSetImage->UpdateCentersOfMass(0);
+    CPPUNIT_ASSERT_MESSAGE("Wrong center of mass in inactive layer",
+                           mitk::Equal(m_LabelSetImage->GetLabel(3, 0)->GetCenterOfMassIndex(), expectedCenter));
+
+    std::vector<mitk::Label::PixelType> labelsToBeErased(1, 3);
+    m_LabelSetImage->EraseLabels(labelsToBeErased, 0);
+
+    mitk::FillVector3D(expectedCenter, 0.0, 0.0, 0.0);
+    CPPUNIT_ASSERT_MESSAGE("Center of mass was not updated by erasing",
+                           mitk::Equal(m_LabelSetImage->GetLabel(3, 0)->GetCenterOfMassIndex(), expectedCenter));
+
+    m_LabelSetImage->SetActiveLayer(0);
+
+    mitk::ImagePixelReadAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Label was not erased",
+                           accessor.GetPixelByIndex(first) == 0 && accessor.GetPixelByIndex(second) == 0 &&
+                             accessor.GetPixelByIndex(third) == 0);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImage)
@@ -0,0 +1,210 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkLabelSetImage.h>
+#include <mitkLabelSetImageToSurfaceFilter.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+class mitkLabelSetImageToSurfaceFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLabelSetImageToSurfaceFilterTestSuite);
+
+  MITK_TEST(TestAllLabelsStitchedSlabs);
+  MITK_TEST(TestAllLabelsIncrementalUpdate);
+  MITK_TEST(TestAllLabelsTimeSteps);
+  MITK_TEST(TestAllLabelsSmoothedStitchedSlabs);
+  MITK_TEST(TestAllLabelsSingleSlice);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::LabelSetImage::Pointer m_LabelSetImage;
+
+  void FillBox(const itk::Index<3> &begin,
+               const itk::Index<3> &end,
+               mitk::Label::PixelType value,
+               unsigned int timeStep = 0)
+  {
+    mitk::ImagePixelWriteAccessor<mitk::Label::PixelType, 3> accessor(m_LabelSetImage.GetPointer(),
+                                                                    m_LabelSetImage->GetVolumeData(timeStep));
+    itk::Index<3> index;
+
+    for (index[2] = begin[2]; index[2] < end[2]; ++index[2])
+      for (index[1] = begin[1]; index[1] < end[1]; ++index[1])
+        for (index[0] = begin[0]; index[0] < end[0]; ++index[0])
+          accessor.SetPixelByIndex(index, value);
+  }
+
+  mitk::LabelSetImageToSurfaceFilter::Pointer CreateFilter(unsigned int slabThickness)
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_LabelSetImage);
+    filter->GenerateAllLabelsOn();
+    filter->SetSlabThickness(slabThickness);
+    return filter;
+  }
+
+public:
+  void setUp() override
+  {
+    m_LabelSetImage = mitk::LabelSetImage::New();
+    mitk::Image::Pointer regularImage = mitk::Image::New();
+    unsigned int dimensions[3] = {20, 20, 40};
+    regularImage->Initialize(mitk::MakeScalarPixelType<int>(), 3, dimensions);
+    m_LabelSetImage->Initialize(regularImage);
+
+    this->FillBox({{4, 4, 5}}, {{9, 9, 31}}, 1);
+    this->FillBox({{12, 12, 10}}, {{17, 17, 15}}, 2);
+    m_LabelSetImage->Modified();
+  }
+
+  void tearDown() override { m_LabelSetImage = nullptr; }
+
+  void TestAllLabelsStitchedSlabs()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer slabFilter = this->CreateFilter(8);
+    slabFilter->Update();
+
+    mitk::LabelSetImageToSurfaceFilter::Pointer singleSlabFilter = this->CreateFilter(100);
+    singleSlabFilter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(5u, slabFilter->GetNumberOfUpdatedSlabs());
+    CPPUNIT_ASSERT_EQUAL(1u, singleSlabFilter->GetNumberOfUpdatedSlabs());
+
+    vtkPolyData *stitched = slabFilter->GetOutput()->GetVtkPolyData();
+    vtkPolyData *reference = singleSlabFilter->GetOutput()->GetVtkPolyData();
+
+    CPPUNIT_ASSERT_MESSAGE("No surface was generated", stitched->GetNumberOfCells() > 0);
+    CPPUNIT_ASSERT_EQUAL(reference->GetNumberOfCells(), stitched->GetNumberOfCells());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Points at the slab borders were not merged",
+                                 reference->GetNumberOfPoints(),
+                                 stitched->GetNumberOfPoints());
+
+    vtkDataArray *labels = stitched->GetCellData()->GetArray("Label");
+    CPPUNIT_ASSERT_MESSAGE("Label scalars are missing", labels != nullptr);
+
+    double range[2];
+    labels->GetRange(range);
+    CPPUNIT_ASSERT_EQUAL(1.0, range[0]);
+    CPPUNIT_ASSERT_EQUAL(2.0, range[1]);
+  }
+
+  void TestAllLabelsIncrementalUpdate()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = this->CreateFilter(8);
+    filter->Update();
+    const vtkIdType numberOfCells = filter->GetOutput()->GetVtkPolyData()->GetNumberOfCells();
+
+    // slices 34 to 36 are only covered by the last slab
+    this->FillBox({{2, 2, 34}}, {{6, 6, 37}}, 3);
+    m_LabelSetImage->Modified();
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(1u, filter->GetNumberOfUpdatedSlabs());
+    CPPUNIT_ASSERT_MESSAGE("Surface of the new label is missing",
+                           filter->GetOutput()->GetVtkPolyData()->GetNumberOfCells() > numberOfCells);
+
+    filter->Modified();
+    filter->Update();
+    CPPUNIT_ASSERT_EQUAL(0u, filter->GetNumberOfUpdatedSlabs());
+  }
+
+  void TestAllLabelsTimeSteps()
+  {
+    m_LabelSetImage = mitk::LabelSetImage::New();
+    mitk::Image::Pointer regularImage = mitk::Image::New();
+    unsigned int dimensions[4] = {20, 20, 40, 2};
+    regularImage->Initialize(mitk::MakeScalarPixelType<int>(), 4, dimensions);
+    m_LabelSetImage->Initialize(regularImage);
+
+    this->FillBox({{4, 4, 5}}, {{9, 9, 31}}, 1, 0);
+    this->FillBox({{12, 12, 10}}, {{17, 17, 15}}, 2, 1);
+    m_LabelSetImage->Modified();
+
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = this->CreateFilter(8);
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(10u, filter->GetNumberOfUpdatedSlabs());
+    CPPUNIT_ASSERT_EQUAL(2u, filter->GetOutput()->GetTimeSteps());
+
+    for (unsigned int timeStep = 0; timeStep < 2; ++timeStep)
+    {
+      vtkPolyData *polyData = filter->GetOutput()->GetVtkPolyData(timeStep);
+      CPPUNIT_ASSERT_MESSAGE("No surface was generated for a time step",
+                             polyData != nullptr && polyData->GetNumberOfCells() > 0);
+
+      double range[2];
+      polyData->GetCellData()->GetArray("Label")->GetRange(range);
+      CPPUNIT_ASSERT_EQUAL(timeStep + 1.0, range[0]);
+      CPPUNIT_ASSERT_EQUAL(timeStep + 1.0, range[1]);
+    }
+
+    // editing the second time step leaves the slabs of the first one untouched
+    this->FillBox({{2, 2, 34}}, {{6, 6, 37}}, 3, 1);
+    m_LabelSetImage->Modified();
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(1u, filter->GetNumberOfUpdatedSlabs());
+  }
+
+  void TestAllLabelsSmoothedStitchedSlabs()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer slabFilter = this->CreateFilter(8);
+    slabFilter->SetUseSmoothing(1);
+    slabFilter->Update();
+
+    mitk::LabelSetImageToSurfaceFilter::Pointer singleSlabFilter = this->CreateFilter(100);
+    singleSlabFilter->SetUseSmoothing(1);
+    singleSlabFilter->Update();
+
+    vtkPolyData *stitched = slabFilter->GetOutput()->GetVtkPolyData();
+    vtkPolyData *reference = singleSlabFilter->GetOutput()->GetVtkPolyData();
+
+    CPPUNIT_ASSERT_EQUAL(reference->GetNumberOfCells(), stitched->GetNumberOfCells());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Smoothed points at the slab borders were not merged",
+                                 reference->GetNumberOfPoints(),
+                                 stitched->GetNumberOfPoints());
+    CPPUNIT_ASSERT_MESSAGE("Normals are missing", stitched->GetPointData()->GetNormals() != nullptr);
+  }
+
+  void TestAllLabelsSingleSlice()
+  {
+    m_LabelSetImage = mitk::LabelSetImage::New();
+    mitk::Image::Pointer regularImage = mitk::Image::New();
+    unsigned int dimensions[3] = {20, 20, 1};
+    regularImage->Initialize(mitk::MakeScalarPixelType<int>(), 3, dimensions);
+    m_LabelSetImage->Initialize(regularImage);
+
+    this->FillBox({{4, 4, 0}}, {{9, 9, 1}}, 1);
+    m_LabelSetImage->Modified();
+
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = this->CreateFilter(8);
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(1u, filter->GetNumberOfUpdatedSlabs());
+    CPPUNIT_ASSERT_MESSAGE("No surface was generated for a single slice",
+                           filter->GetOutput()->GetVtkPolyData()->GetNumberOfCells() > 0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImageToSurfaceFilter)
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkInteractionConst.h"
 #include "mitkLookupTableProperty.h"
 #include "mitkPadImageFilter.h"
+#include "mitkParallelFor.h"
 #include "mitkRenderingManager.h"
 #include "mitkDICOMSegmentationPropertyHelper.h"
 #include "mitkDICOMQIPropertyHelper.h"
@@ -37,6 +38,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include <itkRelabelComponentImageFilter.h>
 
 #include <itkCommand.h>
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <numeric>
 
 template <typename TPixel, unsigned int VDimensions>
 void SetToZero(itk::Image<TPixel, VDimensions> *source)
@@ -44,6 +52,173 @@ void SetToZero(itk::Image<TPixel, VDimensions> *source)
   source->FillBuffer(0);
 }
 
+namespace
+{
+  /** Calls function(firstSlice, endSlice) for slabs of consecutive slices in [0, numberOfSlices), see
+   * mitk::ParallelFor(). A few slabs per thread balance the load without splitting the volume too finely. */
+  template <typename TFunction>
+  void ParallelForSlabs(std::size_t numberOfSlices, const TFunction &function)
+  {
+    const std::size_t numberOfThreads =
+      std::max(1, static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads()));
+    const std::size_t numberOfSlabs = std::min(numberOfSlices, 4 * numberOfThreads);
+
+    mitk::ParallelFor(numberOfSlabs, [&](std::size_t slab) {
+      function(slab * numberOfSlices / numberOfSlabs, (slab + 1) * numberOfSlices / numberOfSlabs);
+    });
+  }
+
+  std::vector<mitk::Label::PixelType> CreateIdentityLookupTable()
+  {
+    std::vector<mitk::Label::PixelType> lookupTable(
+      static_cast<std::size_t>(std::numeric_limits<mitk::Label::PixelType>::max()) + 1);
+    std::iota(lookupTable.begin(), lookupTable.end(), mitk::Label::PixelType(0));
+    return lookupTable;
+  }
+
+  /** Returns the values of the labels of a label set whose voxels are changed by a lookup table, i.e. the labels
+   * that are remapped and the labels they are remapped to. */
+  std::vector<mitk::Label::PixelType> GetRemappedLabels(const std::vector<mitk::Label::PixelType> &lookupTable,
+                                                        const mitk::LabelSet *labelSet)
+  {
+    std::vector<mitk::Label::PixelType> pixelValues;
+    if (nullptr == labelSet)
+      return pixelValues;
+
+    std::vector<bool> isTarget(lookupTable.size(), false);
+    for (std::size_t value = 0; value < lookupTable.size(); ++value)
+    {
+      if (lookupTable[value] != value)
+        isTarget[lookupTable[value]] = true;
+    }
+
+    for (auto it = labelSet->IteratorConstBegin(); it != labelSet->IteratorConstEnd(); ++it)
+    {
+      if (lookupTable[it->first] != it->first || isTarget[it->first])
+        pixelValues.push_back(it->first);
+    }
+
+    return pixelValues;
+  }
+
+  /** Gathers voxel counts and index sums of a set of labels to compute their centers of mass. Partial sums are
+   * collected per slab or tile and merged at the end. */
+  class CenterOfMassAccumulator
+  {
+  public:
+    typedef mitk::Label::PixelType PixelType;
+
+    struct Sums
+    {
+      std::uint64_t Count = 0;
+      std::uint64_t Sum[3] = {0, 0, 0};
+    };
+    typedef std::vector<Sums> PartialSums;
+
+    explicit CenterOfMassAccumulator(const std::vector<PixelType> &pixelValues)
+      : m_PixelValues(pixelValues),
+        m_Slots(static_cast<std::size_t>(std::numeric_limits<PixelType>::max()) + 1, -1),
+        m_Sums(pixelValues.size())
+    {
+      // map each label of interest to a slot of the sums, -1 for all other values
+      for (std::size_t i = 0; i < pixelValues.size(); ++i)
+        m_Slots[pixelValues[i]] = static_cast<int>(i);
+    }
+
+    bool IsEmpty() const { return m_PixelValues.empty(); }
+
+    PartialSums CreatePartialSums() const { return PartialSums(m_PixelValues.size()); }
+
+    /** Adds the row of @a length pixels whose first pixel has the index (x, y, z). */
+    void AddRow(PartialSums &sums, const PixelType *row, std::size_t length, std::size_t x, std::size_t y, std::size_t z) const
+    {
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        const int slot = m_Slots[row[i]];
+        if (slot < 0)
+          continue;
+
+        Sums &labelSums = sums[slot];
+        ++labelSums.Count;
+        labelSums.Sum[0] += x + i;
+        labelSums.Sum[1] += y;
+        labelSums.Sum[2] += z;
+      }
+    }
+
+    /** Adds a tile of a mitk::TiledLabelStorage, see mitk::TiledLabelStorage::TileFunction. */
+    void AddTile(PartialSums &sums, const PixelType *tile, const unsigned int *begin, const unsigned int *size) const
+    {
+      const unsigned int tileSize = mitk::TiledLabelStorage::TileSize;
+
+      if (nullptr != tile)
+      {
+        for (unsigned int z = 0; z < size[2]; ++z)
+          for (unsigned int y = 0; y < size[1]; ++y)
+            this->AddRow(sums, tile + (z * tileSize + y) * tileSize, size[0], begin[0], begin[1] + y, begin[2] + z);
+
+        return;
+      }
+
+      // an empty tile only contains the exterior label
+      const int slot = m_Slots[0];
+      if (slot < 0)
+        return;
+
+      const std::uint64_t count = static_cast<std::uint64_t>(size[0]) * size[1] * size[2];
+      sums[slot].Count += count;
+
+      for (int d = 0; d < 3; ++d)
+      {
+        // sum of the indices begin[d], ..., begin[d] + size[d] - 1, times the pixels of each of the other axes
+        const std::uint64_t indexSum = static_cast<std::uint64_t>(size[d]) * (2 * static_cast<std::uint64_t>(begin[d]) + size[d] - 1) / 2;
+        sums[slot].Sum[d] += indexSum * (count / size[d]);
+      }
+    }
+
+    void Merge(const PartialSums &sums)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      for (std::size_t i = 0; i < m_Sums.size(); ++i)
+      {
+        m_Sums[i].Count += sums[i].Count;
+        for (int d = 0; d < 3; ++d)
+          m_Sums[i].Sum[d] += sums[i].Sum[d];
+      }
+    }
+
+    /** Sets the centroids as centers of mass of the labels. Labels without any voxel are centered at the origin. */
+    void SetCentersOfMass(mitk::LabelSet *labelSet, const mitk::BaseGeometry *geometry) const
+    {
+      for (std::size_t i = 0; i < m_PixelValues.size(); ++i)
+      {
+        mitk::Label *label = labelSet->GetLabel(m_PixelValues[i]);
+        if (nullptr == label)
+          continue;
+
+        mitk::Point3D pos;
+        pos.Fill(0.0);
+
+        if (0 != m_Sums[i].Count)
+        {
+          for (int d = 0; d < 3; ++d)
+            pos[d] = static_cast<double>(m_Sums[i].Sum[d]) / m_Sums[i].Count;
+        }
+
+        label->SetCenterOfMassIndex(pos);
+        geometry->IndexToWorld(pos, pos); // TODO: TimeGeometry?
+        label->SetCenterOfMassCoordinates(pos);
+      }
+    }
+
+  private:
+    std::vector<PixelType> m_PixelValues;
+    std::vector<int> m_Slots;
+    std::vector<Sums> m_Sums;
+    std::mutex m_Mutex;
+  };
+}
+
 template <unsigned int VImageDimension = 3>
 void CreateLabelMaskProcessing(mitk::Image *layerImage, mitk::Image *mask, mitk::LabelSet::PixelType index)
 {
@@ -97,9 +272,8 @@ mitk::LabelSetImage::LabelSetImage(const mitk::LabelSetImage &other)
     lsClone->AddObserver(itk::ModifiedEvent(), command);
     m_LabelSetContainer.push_back(lsClone);
 
-    // clone layer Image data
-    mitk::Image::Pointer liClone = other.GetLayerImage(i)->Clone();
-    m_LayerContainer.push_back(liClone);
+    // clone layer data, the tiles are shared with the other image until they are modified
+    m_LayerContainer.push_back(other.m_LayerContainer[i]->Clone());
   }
 
   // Add some DICOM Tags as properties to segmentation image
@@ -164,12 +338,87 @@ mitk::LabelSetImage::~LabelSetImage()
   m_LabelSetContainer.clear();
 }
 
-mitk::Image *mitk::LabelSetImage::GetLayerImage(unsigned int layer)
+mitk::Image::Pointer mitk::LabelSetImage::GetLayerImage(unsigned int layer)
 {
-  return m_LayerContainer[layer];
+  return const_cast<mitk::Image *>(static_cast<const Self *>(this)->GetLayerImage(layer).GetPointer());
 }
 
-const mitk::Image *mitk::LabelSetImage::GetLayerImage(unsigned int layer) const
+mitk::Image::ConstPointer mitk::LabelSetImage::GetLayerImage(unsigned int layer) const
+{
+  if (layer == this->GetActiveLayer())
+    return this;
+
+  // the copy is not kept, a displayed segmentation would otherwise hold a dense image per layer
+  mitk::Image::Pointer layerImage = mitk::Image::New();
+  layerImage->Initialize(this->GetPixelType(), this->GetDimension(), this->GetDimensions());
+  layerImage->SetTimeGeometry(this->GetTimeGeometry()->Clone());
+  m_LayerContainer[layer]->Unpack(layerImage);
+
+  return layerImage.GetPointer();
+}
+
+mitk::Image::Pointer mitk::LabelSetImage::GetLayerImageRegion(unsigned int layer,
+                                                             unsigned int timeStep,
+                                                             const itk::ImageRegion<3> &region) const
+{
+  if (layer >= this->GetNumberOfLayers())
+    mitkThrow() << "Layer " << layer << " does not exist.";
+
+  if (timeStep >= this->GetTimeSteps())
+    mitkThrow() << "Time step " << timeStep << " does not exist.";
+
+  unsigned int begin[3];
+  unsigned int size[3];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (region.GetIndex(i) < 0 || region.GetSize(i) == 0 ||
+        region.GetIndex(i) + region.GetSize(i) > this->GetDimension(i))
+      mitkThrow() << "Region is not located within the image.";
+
+    begin[i] = static_cast<unsigned int>(region.GetIndex(i));
+    size[i] = static_cast<unsigned int>(region.GetSize(i));
+  }
+
+  mitk::Image::Pointer regionImage = mitk::Image::New();
+  regionImage->Initialize(this->GetPixelType(), 3, size);
+
+  const mitk::BaseGeometry *geometry = this->GetGeometry(timeStep);
+  mitk::Point3D origin;
+  mitk::FillVector3D(origin, begin[0], begin[1], begin[2]);
+  geometry->IndexToWorld(origin, origin);
+
+  regionImage->GetGeometry()->SetIndexToWorldTransform(geometry->GetIndexToWorldTransform());
+  regionImage->GetGeometry()->SetOrigin(origin);
+
+  ImageWriteAccessor regionAccessor(regionImage);
+  auto regionData = static_cast<PixelType *>(regionAccessor.GetData());
+
+  if (layer != this->GetActiveLayer())
+  {
+    m_LayerContainer[layer]->UnpackRegion(regionData, begin, size, timeStep);
+  }
+  else
+  {
+    ImageReadAccessor accessor(this, this->GetVolumeData(timeStep));
+    auto data = static_cast<const PixelType *>(accessor.GetData());
+
+    const std::size_t lineStride = this->GetDimension(0);
+    const std::size_t sliceStride = lineStride * this->GetDimension(1);
+
+    for (unsigned int z = 0; z < size[2]; ++z)
+    {
+      for (unsigned int y = 0; y < size[1]; ++y)
+      {
+        const PixelType *line = data + (z + begin[2]) * sliceStride + (y + begin[1]) * lineStride + begin[0];
+        std::copy(line, line + size[0], regionData + (static_cast<std::size_t>(z) * size[1] + y) * size[0]);
+      }
+    }
+  }
+
+  return regionImage;
+}
+
+const mitk::TiledLabelStorage *mitk::LabelSetImage::GetLayerStorage(unsigned int layer) const
 {
   return m_LayerContainer[layer];
 }
@@ -215,28 +464,24 @@ void mitk::LabelSetImage::RemoveLayer()
 
 unsigned int mitk::LabelSetImage::AddLayer(mitk::LabelSet::Pointer lset)
 {
-  mitk::Image::Pointer newImage = mitk::Image::New();
-  newImage->Initialize(this->GetPixelType(),
-                       this->GetDimension(),
-                       this->GetDimensions(),
-                       this->GetImageDescriptor()->GetNumberOfChannels());
-  newImage->SetTimeGeometry(this->GetTimeGeometry()->Clone());
+  // an empty layer does not allocate any tiles
+  TiledLabelStorage::Pointer layerStorage = TiledLabelStorage::New();
+  layerStorage->Initialize(this);
 
-  if (newImage->GetDimension() < 4)
-  {
-    AccessByItk(newImage, SetToZero);
-  }
-  else
-  {
-    AccessFixedDimensionByItk(newImage, SetToZero, 4);
-  }
+  return this->AddLayerStorage(layerStorage, lset);
+}
 
-  unsigned int newLabelSetId = this->AddLayer(newImage, lset);
+unsigned int mitk::LabelSetImage::AddLayer(mitk::Image::Pointer layerImage, mitk::LabelSet::Pointer lset)
+{
+  TiledLabelStorage::Pointer layerStorage = TiledLabelStorage::New();
+  layerStorage->Initialize(this);
+  layerStorage->Pack(layerImage);
 
-  return newLabelSetId;
+  return this->AddLayerStorage(layerStorage, lset);
 }
 
-unsigned int mitk::LabelSetImage::AddLayer(mitk::Image::Pointer layerImage, mitk::LabelSet::Pointer lset)
+unsigned int mitk::LabelSetImage::AddLayerStorage(TiledLabelStorage::Pointer layerStorage,
+                                                  mitk::LabelSet::Pointer lset)
 {
   unsigned int newLabelSetId = m_LayerContainer.size();
 
@@ -257,8 +502,8 @@ unsigned int mitk::LabelSetImage::AddLayer(mitk::Image::Pointer layerImage, mitk
   // Add exterior Label to label set
   // mitk::Label::Pointer exteriorLabel = CreateExteriorLabel();
 
-  // push a new working image for the new layer
-  m_LayerContainer.push_back(layerImage);
+  // push the label data of the new layer
+  m_LayerContainer.push_back(layerStorage);
 
   // push a new labelset for the new layer
   m_LabelSetContainer.push_back(ls);
@@ -301,54 +546,23 @@ void mitk::LabelSetImage::AddLabelSetToLayer(const unsigned int layerIdx, const
 
 void mitk::LabelSetImage::SetActiveLayer(unsigned int layer)
 {
-  try
+  if ((layer != GetActiveLayer() || m_activeLayerInvalid) && (layer < this->GetNumberOfLayers()))
   {
-    if (4 == this->GetDimension())
-    {
-      if ((layer != GetActiveLayer() || m_activeLayerInvalid) && (layer < this->GetNumberOfLayers()))
-      {
-        BeforeChangeLayerEvent.Send();
-
-        if (m_activeLayerInvalid)
-        {
-          // We should not write the invalid layer back to the vector
-          m_activeLayerInvalid = false;
-        }
-        else
-        {
-          AccessFixedDimensionByItk_n(this, ImageToLayerContainerProcessing, 4, (GetActiveLayer()));
-        }
-        m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
-        AccessFixedDimensionByItk_n(this, LayerContainerToImageProcessing, 4, (GetActiveLayer()));
+    BeforeChangeLayerEvent.Send();
 
-        AfterChangeLayerEvent.Send();
-      }
+    if (m_activeLayerInvalid)
+    {
+      // We should not write the invalid layer back to the vector
+      m_activeLayerInvalid = false;
     }
     else
     {
-      if ((layer != GetActiveLayer() || m_activeLayerInvalid) && (layer < this->GetNumberOfLayers()))
-      {
-        BeforeChangeLayerEvent.Send();
-
-        if (m_activeLayerInvalid)
-        {
-          // We should not write the invalid layer back to the vector
-          m_activeLayerInvalid = false;
-        }
-        else
-        {
-          AccessByItk_1(this, ImageToLayerContainerProcessing, GetActiveLayer());
-        }
-        m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
-        AccessByItk_1(this, LayerContainerToImageProcessing, GetActiveLayer());
-
-        AfterChangeLayerEvent.Send();
-      }
+      m_LayerContainer[GetActiveLayer()]->Pack(this);
     }
-  }
-  catch (itk::ExceptionObject &e)
-  {
-    mitkThrow() << e.GetDescription();
+    m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
+    m_LayerContainer[layer]->Unpack(this);
+
+    AfterChangeLayerEvent.Send();
   }
   this->Modified();
 }
@@ -420,31 +634,18 @@ bool mitk::LabelSetImage::ExistLabelSet(unsigned int layer) const
 
 void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, unsigned int layer)
 {
-  try
-  {
-    AccessByItk_2(this, MergeLabelProcessing, pixelValue, sourcePixelValue);
-  }
-  catch (itk::ExceptionObject &e)
-  {
-    mitkThrow() << e.GetDescription();
-  }
-  GetLabelSet(layer)->SetActiveLabel(pixelValue);
-  Modified();
+  std::vector<PixelType> vectorOfSourcePixelValues(1, sourcePixelValue);
+  this->MergeLabels(pixelValue, vectorOfSourcePixelValues, layer);
 }
 
 void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, unsigned int layer)
 {
-  try
-  {
-    for (unsigned int idx = 0; idx < vectorOfSourcePixelValues.size(); idx++)
-    {
-      AccessByItk_2(this, MergeLabelProcessing, pixelValue, vectorOfSourcePixelValues[idx]);
-    }
-  }
-  catch (itk::ExceptionObject &e)
-  {
-    mitkThrow() << e.GetDescription();
-  }
+  auto lookupTable = CreateIdentityLookupTable();
+  for (auto sourcePixelValue : vectorOfSourcePixelValues)
+    lookupTable[sourcePixelValue] = pixelValue;
+
+  this->RemapLabels(lookupTable, layer);
+
   GetLabelSet(layer)->SetActiveLabel(pixelValue);
   Modified();
 }
@@ -454,29 +655,87 @@ void mitk::LabelSetImage::RemoveLabels(std::vector<PixelType> &VectorOfLabelPixe
   for (unsigned int idx = 0; idx < VectorOfLabelPixelValues.size(); idx++)
   {
     GetLabelSet(layer)->RemoveLabel(VectorOfLabelPixelValues[idx]);
-    EraseLabel(VectorOfLabelPixelValues[idx], layer);
   }
+
+  this->EraseLabels(VectorOfLabelPixelValues, layer);
 }
 
 void mitk::LabelSetImage::EraseLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer)
 {
-  for (unsigned int i = 0; i < VectorOfLabelPixelValues.size(); i++)
-  {
-    this->EraseLabel(VectorOfLabelPixelValues[i], layer);
-  }
+  auto lookupTable = CreateIdentityLookupTable();
+  for (auto pixelValue : VectorOfLabelPixelValues)
+    lookupTable[pixelValue] = 0;
+
+  this->RemapLabels(lookupTable, layer);
+  Modified();
 }
 
 void mitk::LabelSetImage::EraseLabel(PixelType pixelValue, unsigned int layer)
 {
-  try
+  std::vector<PixelType> vectorOfLabelPixelValues(1, pixelValue);
+  this->EraseLabels(vectorOfLabelPixelValues, layer);
+}
+
+void mitk::LabelSetImage::RemapLabels(const std::vector<PixelType> &lookupTable, unsigned int layer)
+{
+  if (layer >= this->GetNumberOfLayers())
+    mitkThrow() << "Layer " << layer << " does not exist.";
+
+  // the centers of mass of the changed labels are gathered in the same pass
+  mitk::LabelSet *labelSet = this->GetLabelSet(layer);
+  CenterOfMassAccumulator accumulator(GetRemappedLabels(lookupTable, labelSet));
+
+  // inactive layers are remapped tile by tile in their sparse storage
+  if (layer != this->GetActiveLayer())
   {
-    AccessByItk_2(this, EraseLabelProcessing, pixelValue, layer);
+    m_LayerContainer[layer]->RemapLabels(
+      lookupTable, [&](const PixelType *tile, const unsigned int *begin, const unsigned int *size, unsigned int timeStep) {
+        if (0 != timeStep || accumulator.IsEmpty())
+          return;
+
+        auto sums = accumulator.CreatePartialSums();
+        accumulator.AddTile(sums, tile, begin, size);
+        accumulator.Merge(sums);
+      });
   }
-  catch (itk::ExceptionObject &e)
+  else
   {
-    mitkThrow() << e.GetDescription();
+    mitk::Image *layerImage = this;
+
+    {
+      ImageWriteAccessor accessor(layerImage);
+      auto data = static_cast<PixelType *>(accessor.GetData());
+
+      const std::size_t dimX = layerImage->GetDimension(0);
+      const std::size_t dimY = layerImage->GetDimension(1);
+      const std::size_t dimZ = layerImage->GetDimension(2);
+      const std::size_t numberOfSlices = dimZ * layerImage->GetDimension(3);
+
+      ParallelForSlabs(numberOfSlices, [&](std::size_t firstSlice, std::size_t endSlice) {
+        auto sums = accumulator.CreatePartialSums();
+
+        for (std::size_t slice = firstSlice; slice < endSlice; ++slice)
+        {
+          for (std::size_t y = 0; y < dimY; ++y)
+          {
+            PixelType *row = data + (slice * dimY + y) * dimX;
+            std::transform(row, row + dimX, row, [&lookupTable](PixelType value) { return lookupTable[value]; });
+
+            // the centers of mass refer to the first time step
+            if (slice < dimZ && !accumulator.IsEmpty())
+              accumulator.AddRow(sums, row, dimX, 0, y, slice);
+          }
+        }
+
+        accumulator.Merge(sums);
+      });
+    }
+
+    layerImage->Modified();
   }
-  Modified();
+
+  if (nullptr != labelSet)
+    accumulator.SetCentersOfMass(labelSet, this->GetSlicedGeometry());
 }
 
 mitk::Label *mitk::LabelSetImage::GetActiveLabel(unsigned int layer)
@@ -521,14 +780,63 @@ mitk::LabelSet *mitk::LabelSetImage::GetActiveLabelSet()
 
 void mitk::LabelSetImage::UpdateCenterOfMass(PixelType pixelValue, unsigned int layer)
 {
-  if (4 == this->GetDimension())
+  this->UpdateCentersOfMass(std::vector<PixelType>(1, pixelValue), layer);
+}
+
+void mitk::LabelSetImage::UpdateCentersOfMass(unsigned int layer)
+{
+  const mitk::LabelSet *labelSet = this->GetLabelSet(layer);
+  if (nullptr == labelSet)
+    return;
+
+  std::vector<PixelType> pixelValues;
+  for (auto it = labelSet->IteratorConstBegin(); it != labelSet->IteratorConstEnd(); ++it)
+    pixelValues.push_back(it->first);
+
+  this->UpdateCentersOfMass(pixelValues, layer);
+}
+
+void mitk::LabelSetImage::UpdateCentersOfMass(const std::vector<PixelType> &pixelValues, unsigned int layer)
+{
+  mitk::LabelSet *labelSet = this->GetLabelSet(layer);
+  if (nullptr == labelSet || pixelValues.empty())
+    return;
+
+  CenterOfMassAccumulator accumulator(pixelValues);
+
+  if (layer != this->GetActiveLayer())
   {
-    AccessFixedDimensionByItk_2(this, CalculateCenterOfMassProcessing, 4, pixelValue, layer);
+    // inactive layers are read tile by tile in their sparse storage
+    m_LayerContainer[layer]->ForEachTile(
+      [&](const PixelType *tile, const unsigned int *begin, const unsigned int *size, unsigned int timeStep) {
+        if (0 != timeStep)
+          return;
+
+        auto sums = accumulator.CreatePartialSums();
+        accumulator.AddTile(sums, tile, begin, size);
+        accumulator.Merge(sums);
+      });
   }
   else
   {
-    AccessByItk_2(this, CalculateCenterOfMassProcessing, pixelValue, layer);
+    ImageReadAccessor accessor(this, this->GetVolumeData(0));
+    auto data = static_cast<const PixelType *>(accessor.GetData());
+
+    const std::size_t dimX = this->GetDimension(0);
+    const std::size_t dimY = this->GetDimension(1);
+
+    ParallelForSlabs(this->GetDimension(2), [&](std::size_t firstSlice, std::size_t endSlice) {
+      auto sums = accumulator.CreatePartialSums();
+
+      for (std::size_t z = firstSlice; z < endSlice; ++z)
+        for (std::size_t y = 0; y < dimY; ++y)
+          accumulator.AddRow(sums, data + (z * dimY + y) * dimX, dimX, 0, y, z);
+
+      accumulator.Merge(sums);
+    });
   }
+
+  accumulator.SetCentersOfMass(labelSet, this->GetSlicedGeometry());
 }
 
 unsigned int mitk::LabelSetImage::GetNumberOfLabels(unsigned int layer) const
@@ -744,48 +1052,6 @@ void mitk::LabelSetImage::MaskStampProcessing(ImageType *itkImage, mitk::Image *
   this->Modified();
 }
 
-template <typename ImageType>
-void mitk::LabelSetImage::CalculateCenterOfMassProcessing(ImageType *itkImage, PixelType pixelValue, unsigned int layer)
-{
-  // for now, we just retrieve the voxel in the middle
-  typedef itk::ImageRegionConstIterator<ImageType> IteratorType;
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
-  iter.GoToBegin();
-
-  std::vector<typename ImageType::IndexType> indexVector;
-
-  while (!iter.IsAtEnd())
-  {
-    // TODO fix comparison warning more effective
-    if (iter.Get() == pixelValue)
-    {
-      indexVector.push_back(iter.GetIndex());
-    }
-    ++iter;
-  }
-
-  mitk::Point3D pos;
-  pos.Fill(0.0);
-
-  if (!indexVector.empty())
-  {
-    typename itk::ImageRegionConstIteratorWithIndex<ImageType>::IndexType centerIndex;
-    centerIndex = indexVector.at(indexVector.size() / 2);
-    if (centerIndex.GetIndexDimension() == 3)
-    {
-      pos[0] = centerIndex[0];
-      pos[1] = centerIndex[1];
-      pos[2] = centerIndex[2];
-    }
-    else
-      return;
-  }
-
-  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassIndex(pos);
-  this->GetSlicedGeometry()->IndexToWorld(pos, pos); // TODO: TimeGeometry?
-  GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassCoordinates(pos);
-}
-
 template <typename ImageType>
 void mitk::LabelSetImage::ClearBufferProcessing(ImageType *itkImage)
 {
@@ -822,95 +1088,6 @@ void mitk::LabelSetImage::ConcatenateProcessing(ImageType *itkTarget, mitk::Labe
   }
 }
 
-template <typename TPixel, unsigned int VImageDimension>
-void mitk::LabelSetImage::LayerContainerToImageProcessing(itk::Image<TPixel, VImageDimension> *target,
-                                                          unsigned int layer)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typename ImageType::Pointer itkSource;
-  // mitk::CastToItkImage(m_LayerContainer[layer], itkSource);
-  itkSource = ImageToItkImage<TPixel, VImageDimension>(m_LayerContainer[layer]);
-  typedef itk::ImageRegionConstIterator<ImageType> SourceIteratorType;
-  typedef itk::ImageRegionIterator<ImageType> TargetIteratorType;
-
-  SourceIteratorType sourceIter(itkSource, itkSource->GetLargestPossibleRegion());
-  sourceIter.GoToBegin();
-
-  TargetIteratorType targetIter(target, target->GetLargestPossibleRegion());
-  targetIter.GoToBegin();
-
-  while (!sourceIter.IsAtEnd())
-  {
-    targetIter.Set(sourceIter.Get());
-    ++sourceIter;
-    ++targetIter;
-  }
-}
-
-template <typename TPixel, unsigned int VImageDimension>
-void mitk::LabelSetImage::ImageToLayerContainerProcessing(itk::Image<TPixel, VImageDimension> *source,
-                                                          unsigned int layer) const
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typename ImageType::Pointer itkTarget;
-  // mitk::CastToItkImage(m_LayerContainer[layer], itkTarget);
-  itkTarget = ImageToItkImage<TPixel, VImageDimension>(m_LayerContainer[layer]);
-
-  typedef itk::ImageRegionConstIterator<ImageType> SourceIteratorType;
-  typedef itk::ImageRegionIterator<ImageType> TargetIteratorType;
-
-  SourceIteratorType sourceIter(source, source->GetLargestPossibleRegion());
-  sourceIter.GoToBegin();
-
-  TargetIteratorType targetIter(itkTarget, itkTarget->GetLargestPossibleRegion());
-  targetIter.GoToBegin();
-
-  while (!sourceIter.IsAtEnd())
-  {
-    targetIter.Set(sourceIter.Get());
-    ++sourceIter;
-    ++targetIter;
-  }
-}
-
-template <typename ImageType>
-void mitk::LabelSetImage::EraseLabelProcessing(ImageType *itkImage, PixelType pixelValue, unsigned int /*layer*/)
-{
-  typedef itk::ImageRegionIterator<ImageType> IteratorType;
-
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
-  iter.GoToBegin();
-
-  while (!iter.IsAtEnd())
-  {
-    PixelType value = iter.Get();
-
-    if (value == pixelValue)
-    {
-      iter.Set(0);
-    }
-    ++iter;
-  }
-}
-
-template <typename ImageType>
-void mitk::LabelSetImage::MergeLabelProcessing(ImageType *itkImage, PixelType pixelValue, PixelType index)
-{
-  typedef itk::ImageRegionIterator<ImageType> IteratorType;
-
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
-  iter.GoToBegin();
-
-  while (!iter.IsAtEnd())
-  {
-    if (iter.Get() == index)
-    {
-      iter.Set(pixelValue);
-    }
-    ++iter;
-  }
-}
-
 bool mitk::Equal(const mitk::LabelSetImage &leftHandSide,
                  const mitk::LabelSetImage &rightHandSide,
                  ScalarType eps,
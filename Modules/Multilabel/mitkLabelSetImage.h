@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkImage.h>
 #include <mitkLabelSet.h>
+#include <mitkTiledLabelStorage.h>
 
 #include <MitkMultilabelExports.h>
 
@@ -86,9 +87,20 @@ namespace mitk
     void MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, unsigned int layer = 0);
 
     /**
-      * \brief  */
+     * @brief Updates the center of mass of a label, i.e. the centroid of its voxels in the first time step.
+     *
+     * @param pixelValue          the value of the label
+     * @param layer               the layer in which the label is located
+     */
     void UpdateCenterOfMass(PixelType pixelValue, unsigned int layer = 0);
 
+    /**
+     * @brief Updates the centers of mass of all labels of a layer in a single pass over the image.
+     *
+     * @param layer               the layer whose labels should be updated
+     */
+    void UpdateCentersOfMass(unsigned int layer = 0);
+
     /**
      * @brief Removes labels from the mitk::LabelSet of given layer.
      *        Calls mitk::LabelSetImage::EraseLabels() which also removes the labels from within the image.
@@ -245,10 +257,32 @@ namespace mitk
     void RemoveLayer();
 
     /**
-      * \brief  */
-    mitk::Image *GetLayerImage(unsigned int layer);
+     * @brief Returns the label image of a layer.
+     *
+     * For the active layer this is the LabelSetImage itself. Inactive layers are kept in a sparse
+     * mitk::TiledLabelStorage, for them a temporary copy is created on each call. Changes to that
+     * copy are not taken over, activate the layer to edit it. Use GetLayerImageRegion() if only a
+     * part of an inactive layer is needed.
+     */
+    mitk::Image::Pointer GetLayerImage(unsigned int layer);
 
-    const mitk::Image *GetLayerImage(unsigned int layer) const;
+    mitk::Image::ConstPointer GetLayerImage(unsigned int layer) const;
+
+    /**
+     * @brief Returns a new 3D image holding the index region @a region of time step @a timeStep of a layer.
+     *
+     * Inactive layers are read directly from their sparse storage, only the tiles intersecting the region
+     * are visited. The geometry of the returned image places the region at its position within the layer.
+     * @throw mitk::Exception if the layer or the time step do not exist or the region is not located within the image.
+     */
+    mitk::Image::Pointer GetLayerImageRegion(unsigned int layer, unsigned int timeStep, const itk::ImageRegion<3> &region) const;
+
+    /**
+     * @brief Returns the sparse storage of a layer.
+     *
+     * The storage of the active layer is only updated when another layer becomes active.
+     */
+    const mitk::TiledLabelStorage *GetLayerStorage(unsigned int layer) const;
 
     void OnLabelSetModified();
 
@@ -276,27 +310,20 @@ namespace mitk
     template <typename ImageType1, typename ImageType2>
     void ChangeLayerProcessing(ImageType1 *source, ImageType2 *target);
 
-    template <typename TPixel, unsigned int VImageDimension>
-    void LayerContainerToImageProcessing(itk::Image<TPixel, VImageDimension> *source, unsigned int layer);
+    unsigned int AddLayerStorage(TiledLabelStorage::Pointer layerStorage, mitk::LabelSet::Pointer lset);
 
-    template <typename TPixel, unsigned int VImageDimension>
-    void ImageToLayerContainerProcessing(itk::Image<TPixel, VImageDimension> *source, unsigned int layer) const;
+    /** Replaces each pixel value v of the layer image by lookupTable[v] in a single, parallel pass. The centers of
+     * mass of all labels whose voxels change are updated in the same pass. */
+    void RemapLabels(const std::vector<PixelType> &lookupTable, unsigned int layer);
 
-    template <typename ImageType>
-    void CalculateCenterOfMassProcessing(ImageType *input, PixelType index, unsigned int layer);
+    void UpdateCentersOfMass(const std::vector<PixelType> &pixelValues, unsigned int layer);
 
     template <typename ImageType>
     void ClearBufferProcessing(ImageType *input);
 
-    template <typename ImageType>
-    void EraseLabelProcessing(ImageType *input, PixelType index, unsigned int layer);
-
     //  template < typename ImageType >
     //  void ReorderLabelProcessing( ImageType* input, int index, int layer);
 
-    template <typename ImageType>
-    void MergeLabelProcessing(ImageType *input, PixelType pixelValue, PixelType index);
-
     template <typename ImageType>
     void ConcatenateProcessing(ImageType *input, mitk::LabelSetImage *other);
 
@@ -307,7 +334,7 @@ namespace mitk
     void InitializeByLabeledImageProcessing(LabelSetImageType *input, ImageType *other);
 
     std::vector<LabelSet::Pointer> m_LabelSetContainer;
-    std::vector<Image::Pointer> m_LayerContainer;
+    std::vector<TiledLabelStorage::Pointer> m_LayerContainer;
 
     int m_ActiveLayer;
 
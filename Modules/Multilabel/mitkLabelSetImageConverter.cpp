@@ -19,46 +19,72 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageCast.h>
 #include <mitkLabelSetImageConverter.h>
 
-#include <itkComposeImageFilter.h>
 #include <itkExtractImageFilter.h>
 #include <itkImageDuplicator.h>
+#include <itkVectorImage.h>
 #include <itkVectorIndexSelectionCastImageFilter.h>
 
 template <typename TPixel, unsigned int VDimension>
-static void ConvertLabelSetImageToImage(const itk::Image<TPixel, VDimension> *,
+static void ConvertLabelSetImageToImage(const itk::Image<TPixel, VDimension> *itkLabelSetImage,
                                         mitk::LabelSetImage::ConstPointer labelSetImage,
                                         mitk::Image::Pointer &image)
 {
   typedef itk::Image<TPixel, VDimension> ImageType;
-  typedef itk::ComposeImageFilter<ImageType> ComposeFilterType;
+  typedef itk::VectorImage<TPixel, VDimension> VectorImageType;
   typedef itk::ImageDuplicator<ImageType> DuplicatorType;
 
   auto numberOfLayers = labelSetImage->GetNumberOfLayers();
 
   if (numberOfLayers > 1)
   {
-    auto vectorImageComposer = ComposeFilterType::New();
+    auto vectorImage = VectorImageType::New();
+    vectorImage->CopyInformation(itkLabelSetImage);
+    vectorImage->SetRegions(itkLabelSetImage->GetLargestPossibleRegion());
+    vectorImage->SetVectorLength(numberOfLayers);
+    vectorImage->Allocate();
+
     auto activeLayer = labelSetImage->GetActiveLayer();
+    auto numberOfTimeSteps = labelSetImage->GetTimeSteps();
+    const std::size_t numberOfPixels = static_cast<std::size_t>(labelSetImage->GetDimension(0)) *
+                                       labelSetImage->GetDimension(1) * labelSetImage->GetDimension(2);
+
+    TPixel *vectorData = vectorImage->GetBufferPointer();
+    const TPixel *activeLayerData = itkLabelSetImage->GetBufferPointer();
+    std::vector<mitk::Label::PixelType> volume;
 
+    // inactive layers are read volume by volume from their sparse storage instead of materializing them
     for (decltype(numberOfLayers) layer = 0; layer < numberOfLayers; ++layer)
     {
-      auto layerImage = mitk::ImageToItkImage<TPixel, VDimension>(
-        layer != activeLayer ? labelSetImage->GetLayerImage(layer) : labelSetImage);
-
-      vectorImageComposer->SetInput(layer, layerImage);
+      for (decltype(numberOfTimeSteps) timeStep = 0; timeStep < numberOfTimeSteps; ++timeStep)
+      {
+        TPixel *target = vectorData + timeStep * numberOfPixels * numberOfLayers + layer;
+
+        if (layer == activeLayer)
+        {
+          const TPixel *source = activeLayerData + timeStep * numberOfPixels;
+
+          for (std::size_t i = 0; i < numberOfPixels; ++i)
+            target[i * numberOfLayers] = source[i];
+        }
+        else
+        {
+          volume.resize(numberOfPixels);
+          labelSetImage->GetLayerStorage(layer)->Unpack(volume.data(), timeStep);
+
+          for (std::size_t i = 0; i < numberOfPixels; ++i)
+            target[i * numberOfLayers] = static_cast<TPixel>(volume[i]);
+        }
+      }
     }
 
-    vectorImageComposer->Update();
     // mitk::GrabItkImageMemory does not support 4D, this will handle 4D correctly
     // and create a memory managed copy
-    image = mitk::ImportItkImage(vectorImageComposer->GetOutput())->Clone();
+    image = mitk::ImportItkImage(vectorImage.GetPointer())->Clone();
   }
   else
   {
-    auto layerImage = mitk::ImageToItkImage<TPixel, VDimension>(labelSetImage);
-
     auto duplicator = DuplicatorType::New();
-    duplicator->SetInputImage(layerImage);
+    duplicator->SetInputImage(itkLabelSetImage);
     duplicator->Update();
 
     // mitk::GrabItkImageMemory does not support 4D, this will handle 4D correctly
@@ -79,7 +105,7 @@ mitk::Image::Pointer mitk::ConvertLabelSetImageToImage(LabelSetImage::ConstPoint
     }
     else
     {
-      AccessByItk_2(labelSetImage->GetLayerImage(0), ::ConvertLabelSetImageToImage, labelSetImage, image);
+      AccessByItk_2(labelSetImage, ::ConvertLabelSetImageToImage, labelSetImage, image);
     }
   }
 
@@ -18,6 +18,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkParallelFor.h>
+#include <mitkPixelTypeMultiplex.h>
 
 // itk
 #include <itkAntiAliasBinaryImageFilter.h>
@@ -31,16 +34,123 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkSmoothingRecursiveGaussianImageFilter.h>
 
 // vtk
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
 #include <vtkCleanPolyData.h>
+#include <vtkDataArray.h>
+#include <vtkDiscreteMarchingCubes.h>
+#include <vtkIdList.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
 #include <vtkMarchingCubes.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataNormals.h>
 #include <vtkSmartPointer.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+
+namespace
+{
+  typedef mitk::LabelSetImageToSurfaceFilter::LabelType LabelType;
+
+  static_assert(std::is_same<LabelType, unsigned short>::value, "Slabs are stored as VTK_UNSIGNED_SHORT images.");
+
+  /** Converts the pixels [begin, end) to the label type and stores them in @a labels. @a isModified is set to
+   * true if they differ from the previous content of @a labels. */
+  template <typename TPixel>
+  void UpdateLabels(const mitk::PixelType &,
+                    const void *data,
+                    std::size_t begin,
+                    std::size_t end,
+                    std::vector<LabelType> &labels,
+                    bool &isModified)
+  {
+    const TPixel *pixels = static_cast<const TPixel *>(data) + begin;
+    const std::size_t numberOfPixels = end - begin;
+
+    isModified = labels.size() != numberOfPixels ||
+                 !std::equal(pixels, pixels + numberOfPixels, labels.begin(), [](TPixel value, LabelType label) {
+                   return static_cast<LabelType>(value) == label;
+                 });
+
+    if (isModified)
+    {
+      labels.resize(numberOfPixels);
+      std::transform(pixels, pixels + numberOfPixels, labels.begin(), [](TPixel value) {
+        return static_cast<LabelType>(value);
+      });
+    }
+  }
+
+  /** Identifies a point of a discrete marching cubes mesh within a slice. Such points are located on the edges
+   * between pixels, so their doubled index coordinates are integers. */
+  std::int64_t GetSlicePointKey(const double *point)
+  {
+    return (static_cast<std::int64_t>(std::llround(2.0 * point[0])) << 32) |
+           static_cast<std::int64_t>(std::llround(2.0 * point[1]));
+  }
+
+  /** Runs discrete marching cubes for all labels but the background label found in @a slab. */
+  vtkSmartPointer<vtkPolyData> ExtractLabelSurfaces(vtkImageData *slab, int backgroundLabel)
+  {
+    const LabelType *labels = static_cast<const LabelType *>(slab->GetScalarPointer());
+    const std::size_t numberOfPixels = static_cast<std::size_t>(slab->GetNumberOfPoints());
+
+    std::vector<bool> isPresent(static_cast<std::size_t>(std::numeric_limits<LabelType>::max()) + 1, false);
+    std::for_each(labels, labels + numberOfPixels, [&isPresent](LabelType label) { isPresent[label] = true; });
+
+    if (backgroundLabel >= 0 && static_cast<std::size_t>(backgroundLabel) < isPresent.size())
+      isPresent[backgroundLabel] = false;
+
+    vtkSmartPointer<vtkDiscreteMarchingCubes> marching = vtkSmartPointer<vtkDiscreteMarchingCubes>::New();
+    marching->ComputeNormalsOff();
+    marching->ComputeGradientsOff();
+    marching->ComputeScalarsOn();
+    marching->SetInputData(slab);
+
+    int numberOfContours = 0;
+    for (std::size_t label = 0; label < isPresent.size(); ++label)
+    {
+      if (isPresent[label])
+        marching->SetValue(numberOfContours++, static_cast<double>(label));
+    }
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+
+    if (0 == numberOfContours)
+      return polyData;
+
+    marching->Update();
+    polyData->ShallowCopy(marching->GetOutput());
+
+    if (vtkDataArray *scalars = polyData->GetCellData()->GetScalars())
+      scalars->SetName("Label");
+
+    return polyData;
+  }
+}
 
 mitk::LabelSetImageToSurfaceFilter::LabelSetImageToSurfaceFilter()
-  : m_GenerateAllLabels(false), m_RequestedLabel(1), m_BackgroundLabel(0), m_UseSmoothing(0), m_Sigma(0.1)
+  : m_GenerateAllLabels(false),
+    m_RequestedLabel(1),
+    m_BackgroundLabel(0),
+    m_UseSmoothing(0),
+    m_Sigma(0.1),
+    m_SlabMeshBackgroundLabel(0),
+    m_SlabMeshInputMTime(0),
+    m_SlabThickness(32),
+    m_NumberOfUpdatedSlabs(0)
 {
+  std::fill(m_SlabMeshDimensions, m_SlabMeshDimensions + 3, 0);
 }
 
 mitk::LabelSetImageToSurfaceFilter::~LabelSetImageToSurfaceFilter()
@@ -83,7 +193,281 @@ void mitk::LabelSetImageToSurfaceFilter::GenerateData()
   if (!outputSurface)
     return;
 
-  AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
+  if (m_GenerateAllLabels)
+    this->GenerateAllLabelsData(inputImage, outputSurface);
+  else
+    AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
+}
+
+void mitk::LabelSetImageToSurfaceFilter::GenerateAllLabelsData(const mitk::Image *input, mitk::Surface *surface)
+{
+  const mitk::PixelType pixelType = input->GetPixelType();
+
+  if (pixelType.GetNumberOfComponents() != 1)
+    mitkThrow() << "Surfaces can only be generated from scalar label images.";
+
+  const unsigned int dimensions[] = {input->GetDimension(0), input->GetDimension(1), input->GetDimension(2)};
+  const unsigned int numberOfTimeSteps = input->GetTimeSteps();
+
+  // slabs share their first and last slice with their neighbours, so the cells are
+  // partitioned between the slabs and stitching only has to merge the points of the shared slices.
+  // A single slice forms a slab of its own.
+  const unsigned int numberOfCellSlices = dimensions[2] - 1;
+  const std::size_t numberOfSlabs =
+    dimensions[2] > 1 ? (numberOfCellSlices + m_SlabThickness - 1) / m_SlabThickness : 1;
+
+  // the slab meshes of all time steps are stored consecutively
+  if (m_SlabMeshes.size() != numberOfSlabs * numberOfTimeSteps || m_SlabMeshBackgroundLabel != m_BackgroundLabel ||
+      !std::equal(dimensions, dimensions + 3, m_SlabMeshDimensions))
+  {
+    m_SlabMeshes.assign(numberOfSlabs * numberOfTimeSteps, SlabMesh());
+    std::copy(dimensions, dimensions + 3, m_SlabMeshDimensions);
+    m_SlabMeshBackgroundLabel = m_BackgroundLabel;
+  }
+
+  surface->Expand(numberOfTimeSteps);
+
+  // the label data are only compared to the data of the slab meshes if the input was modified since the last update
+  const bool isInputModified = input->GetMTime() != m_SlabMeshInputMTime;
+
+  const LabelType paddingLabel =
+    m_BackgroundLabel >= 0 && m_BackgroundLabel <= std::numeric_limits<LabelType>::max() ? m_BackgroundLabel : 0;
+
+  const std::size_t sliceSize = static_cast<std::size_t>(dimensions[0]) * dimensions[1];
+  std::atomic<unsigned int> numberOfUpdatedSlabs(0);
+
+  for (unsigned int timeStep = 0; timeStep < numberOfTimeSteps; ++timeStep)
+  {
+    SlabMesh *slabMeshes = m_SlabMeshes.data() + timeStep * numberOfSlabs;
+    const mitk::BaseGeometry *geometry = input->GetGeometry(timeStep);
+
+    {
+      mitk::ImageReadAccessor accessor(input, input->GetVolumeData(timeStep));
+      const void *data = accessor.GetData();
+
+      mitk::ParallelFor(numberOfSlabs, [&](std::size_t slab) {
+        const unsigned int firstSlice = static_cast<unsigned int>(slab) * m_SlabThickness;
+        const unsigned int lastSlice = std::min(firstSlice + m_SlabThickness, dimensions[2] - 1);
+
+        SlabMesh &slabMesh = slabMeshes[slab];
+
+        if (isInputModified || slabMesh.IndexPolyData.GetPointer() == nullptr)
+        {
+          bool isModified = false;
+          mitkPixelTypeMultiplex5(
+            UpdateLabels, pixelType, data, firstSlice * sliceSize, (lastSlice + 1) * sliceSize, slabMesh.Labels, isModified);
+
+          if (isModified || slabMesh.IndexPolyData.GetPointer() == nullptr)
+          {
+            vtkSmartPointer<vtkImageData> slabImage = vtkSmartPointer<vtkImageData>::New();
+            slabImage->SetSpacing(1.0, 1.0, 1.0);
+
+            if (1 == dimensions[2])
+            {
+              // pad a single slice with background, so that its labels are enclosed by a surface
+              slabImage->SetDimensions(dimensions[0], dimensions[1], 3);
+              slabImage->SetOrigin(0.0, 0.0, -1.0);
+              slabImage->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+
+              auto *scalars = static_cast<LabelType *>(slabImage->GetScalarPointer());
+              std::fill(scalars, scalars + 3 * sliceSize, paddingLabel);
+              std::copy(slabMesh.Labels.begin(), slabMesh.Labels.end(), scalars + sliceSize);
+            }
+            else
+            {
+              slabImage->SetDimensions(dimensions[0], dimensions[1], lastSlice - firstSlice + 1);
+              slabImage->SetOrigin(0.0, 0.0, firstSlice);
+              slabImage->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+              std::copy(slabMesh.Labels.begin(), slabMesh.Labels.end(), static_cast<LabelType *>(slabImage->GetScalarPointer()));
+            }
+
+            slabMesh.IndexPolyData = ExtractLabelSurfaces(slabImage, m_BackgroundLabel);
+            slabMesh.PolyData = nullptr;
+            ++numberOfUpdatedSlabs;
+          }
+        }
+
+        // smoothing, transformation and normals are only computed again for modified slabs
+        if (slabMesh.PolyData.GetPointer() == nullptr || slabMesh.Smoothing != m_UseSmoothing ||
+            slabMesh.GeometryMTime != geometry->GetMTime())
+        {
+          this->PostProcessSlabMesh(slabMesh, firstSlice, lastSlice, slab > 0, slab + 1 < numberOfSlabs, geometry);
+        }
+      });
+    }
+
+    surface->SetVtkPolyData(this->StitchSlabMeshes(slabMeshes, numberOfSlabs), timeStep);
+  }
+
+  m_SlabMeshInputMTime = input->GetMTime();
+  m_NumberOfUpdatedSlabs = numberOfUpdatedSlabs;
+}
+
+void mitk::LabelSetImageToSurfaceFilter::PostProcessSlabMesh(SlabMesh &slabMesh,
+                                                             unsigned int firstSlice,
+                                                             unsigned int lastSlice,
+                                                             bool hasPreviousSlab,
+                                                             bool hasNextSlab,
+                                                             const mitk::BaseGeometry *geometry) const
+{
+  slabMesh.Smoothing = m_UseSmoothing;
+  slabMesh.GeometryMTime = geometry->GetMTime();
+  slabMesh.FirstSlicePoints.clear();
+  slabMesh.LastSlicePoints.clear();
+
+  vtkPolyData *indexPolyData = slabMesh.IndexPolyData;
+
+  if (0 == indexPolyData->GetNumberOfCells())
+  {
+    slabMesh.PolyData = vtkSmartPointer<vtkPolyData>::New();
+    return;
+  }
+
+  // points on the slices shared with the neighbouring slabs, they are merged when stitching
+  const vtkIdType numberOfPoints = indexPolyData->GetNumberOfPoints();
+  double point[3];
+
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    indexPolyData->GetPoint(i, point);
+
+    if (hasPreviousSlab && point[2] == firstSlice)
+      slabMesh.FirstSlicePoints.emplace_back(GetSlicePointKey(point), i);
+    else if (hasNextSlab && point[2] == lastSlice)
+      slabMesh.LastSlicePoints.emplace_back(GetSlicePointKey(point), i);
+  }
+
+  vtkSmartPointer<vtkPolyData> polydata = indexPolyData;
+
+  if (m_UseSmoothing)
+  {
+    vtkSmartPointer<vtkWindowedSincPolyDataFilter> smoothFilter = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+    smoothFilter->SetInputData(indexPolyData);
+    smoothFilter->SetNumberOfIterations(15);
+    smoothFilter->SetPassBand(0.001);
+    smoothFilter->BoundarySmoothingOff();
+    smoothFilter->FeatureEdgeSmoothingOff();
+    smoothFilter->NonManifoldSmoothingOn();
+    smoothFilter->NormalizeCoordinatesOn();
+    smoothFilter->Update();
+    polydata = smoothFilter->GetOutput();
+  }
+
+  // the meshes are extracted in index coordinates
+  vtkSmartPointer<vtkMatrix4x4> vtkmatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  geometry->GetVtkTransform()->GetMatrix(vtkmatrix);
+  double(*matrix)[4] = vtkmatrix->Element;
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->DeepCopy(polydata->GetPoints());
+
+  // the points of the shared slices keep their position, so that they coincide with those of the neighbouring slab
+  for (const auto &slicePoints : {&slabMesh.FirstSlicePoints, &slabMesh.LastSlicePoints})
+  {
+    for (const auto &slicePoint : *slicePoints)
+      points->SetPoint(slicePoint.second, indexPolyData->GetPoint(slicePoint.second));
+  }
+
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    points->GetPoint(i, point);
+    mitkVtkLinearTransformPoint(matrix, point, point);
+    points->SetPoint(i, point);
+  }
+
+  vtkSmartPointer<vtkPolyData> transformed = vtkSmartPointer<vtkPolyData>::New();
+  transformed->ShallowCopy(polydata);
+  transformed->SetPoints(points);
+
+  vtkSmartPointer<vtkPolyDataNormals> normalsFilter = vtkSmartPointer<vtkPolyDataNormals>::New();
+  normalsFilter->SetInputData(transformed);
+  normalsFilter->SplittingOff();
+  normalsFilter->ConsistencyOff();
+  normalsFilter->Update();
+
+  slabMesh.PolyData = normalsFilter->GetOutput();
+}
+
+vtkSmartPointer<vtkPolyData> mitk::LabelSetImageToSurfaceFilter::StitchSlabMeshes(const SlabMesh *slabMeshes,
+                                                                                 std::size_t numberOfSlabs) const
+{
+  vtkIdType numberOfPoints = 0;
+  vtkIdType numberOfCells = 0;
+  vtkPolyData *firstPolyData = nullptr;
+
+  for (std::size_t slab = 0; slab < numberOfSlabs; ++slab)
+  {
+    vtkPolyData *polyData = slabMeshes[slab].PolyData;
+    numberOfPoints += polyData->GetNumberOfPoints();
+    numberOfCells += polyData->GetNumberOfCells();
+
+    if (nullptr == firstPolyData && polyData->GetNumberOfCells() > 0)
+      firstPolyData = polyData;
+  }
+
+  vtkSmartPointer<vtkPolyData> stitched = vtkSmartPointer<vtkPolyData>::New();
+
+  if (nullptr == firstPolyData)
+    return stitched;
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataType(firstPolyData->GetPoints()->GetDataType());
+  points->Allocate(numberOfPoints);
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  stitched->GetPointData()->CopyAllocate(firstPolyData->GetPointData(), numberOfPoints);
+  stitched->GetCellData()->CopyAllocate(firstPolyData->GetCellData(), numberOfCells);
+
+  // the discrete marching cubes meshes only consist of polygons, so the cells are copied as they are and
+  // only the points of the slices shared by two slabs have to be merged
+  std::unordered_map<std::int64_t, vtkIdType> previousSlicePoints;
+  vtkSmartPointer<vtkIdList> cellPoints = vtkSmartPointer<vtkIdList>::New();
+
+  for (std::size_t slab = 0; slab < numberOfSlabs; ++slab)
+  {
+    const SlabMesh &slabMesh = slabMeshes[slab];
+    vtkPolyData *polyData = slabMesh.PolyData;
+
+    std::vector<vtkIdType> pointIds(polyData->GetNumberOfPoints(), -1);
+
+    for (const auto &slicePoint : slabMesh.FirstSlicePoints)
+    {
+      auto previousPoint = previousSlicePoints.find(slicePoint.first);
+      if (previousPoint != previousSlicePoints.end())
+        pointIds[slicePoint.second] = previousPoint->second;
+    }
+
+    for (vtkIdType i = 0; i < polyData->GetNumberOfPoints(); ++i)
+    {
+      if (pointIds[i] < 0)
+      {
+        pointIds[i] = points->InsertNextPoint(polyData->GetPoint(i));
+        stitched->GetPointData()->CopyData(polyData->GetPointData(), i, pointIds[i]);
+      }
+    }
+
+    vtkCellArray *slabPolys = polyData->GetPolys();
+    slabPolys->InitTraversal();
+
+    for (vtkIdType cell = 0; slabPolys->GetNextCell(cellPoints); ++cell)
+    {
+      for (vtkIdType i = 0; i < cellPoints->GetNumberOfIds(); ++i)
+        cellPoints->SetId(i, pointIds[cellPoints->GetId(i)]);
+
+      const vtkIdType stitchedCell = polys->InsertNextCell(cellPoints);
+      stitched->GetCellData()->CopyData(polyData->GetCellData(), cell, stitchedCell);
+    }
+
+    previousSlicePoints.clear();
+    for (const auto &slicePoint : slabMesh.LastSlicePoints)
+      previousSlicePoints[slicePoint.first] = pointIds[slicePoint.second];
+  }
+
+  stitched->SetPoints(points);
+  stitched->SetPolys(polys);
+  stitched->Squeeze();
+
+  return stitched;
 }
 
 template <typename TPixel, unsigned int VDimension>
@@ -23,10 +23,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkSurfaceSource.h>
 
 #include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
 
 #include <itkImage.h>
 
+#include <cstdint>
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace mitk
 {
@@ -34,6 +39,16 @@ namespace mitk
    * Generates surface meshes from a labelset image.
    * If you want to calculate a surface representation for all available labels,
    * you may call GenerateAllLabelsOn().
+   *
+   * In this mode the surfaces of all labels of every time step are extracted in a single
+   * discrete marching cubes pass per time step. The volume is split into slabs of SlabThickness
+   * slices which are extracted, smoothed and transformed in parallel, and stitched afterwards by
+   * merging the points of the slices shared by neighbouring slabs. The label value of each triangle
+   * is stored in the cell scalars ("Label") of the output. The slab meshes and a copy of the label
+   * data they were extracted from are kept by the filter. If the input was modified (its MTime
+   * changed), a subsequent update compares the label data of each slab and only processes the
+   * slabs whose content changed. An image with a single slice is padded with the background label,
+   * so that its labels are enclosed by a surface as well.
    */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceFilter : public SurfaceSource
   {
@@ -109,6 +124,19 @@ namespace mitk
      */
     itkSetMacro(Sigma, float);
 
+    /**
+     * Sets the number of slices per slab used if all labels are generated, by default 32.
+     * Smaller slabs allow more parallelism and make updates after local edits cheaper.
+     */
+    itkSetClampMacro(SlabThickness, unsigned int, 1, itk::NumericTraits<unsigned int>::max());
+    itkGetConstMacro(SlabThickness, unsigned int);
+
+    /**
+     * Returns the number of slabs that had to be extracted during the last update if all labels
+     * are generated. Unchanged slabs are reused from the previous update.
+     */
+    itkGetConstMacro(NumberOfUpdatedSlabs, unsigned int);
+
   protected:
     LabelSetImageToSurfaceFilter();
 
@@ -149,6 +177,64 @@ namespace mitk
 
     mitk::Vector3D m_InputImageSpacing;
 
+    /**
+     * Extracts the surfaces of all labels of all time steps, see GenerateAllLabelsOn().
+     */
+    void GenerateAllLabelsData(const mitk::Image *input, mitk::Surface *surface);
+
+    /**
+     * Mesh of one slab and the label data it was extracted from.
+     */
+    struct SlabMesh
+    {
+      /** Label data of the slices of the slab. */
+      std::vector<LabelType> Labels;
+
+      /** Mesh extracted by discrete marching cubes, in index coordinates. */
+      vtkSmartPointer<vtkPolyData> IndexPolyData;
+
+      /** Smoothed mesh in world coordinates with normals, see PostProcessSlabMesh(). */
+      vtkSmartPointer<vtkPolyData> PolyData;
+
+      /** Points of PolyData located on the first and last slice, if they are shared with a neighbouring slab,
+       *  identified by their position within the slice. */
+      std::vector<std::pair<std::int64_t, vtkIdType>> FirstSlicePoints;
+      std::vector<std::pair<std::int64_t, vtkIdType>> LastSlicePoints;
+
+      /** Parameters PolyData was computed with. */
+      int Smoothing = 0;
+      itk::ModifiedTimeType GeometryMTime = 0;
+    };
+
+    /**
+     * Smoothes the extracted mesh of a slab, transforms it into world coordinates using @a geometry and
+     * computes its normals. The points on slices shared with a neighbouring slab keep their position.
+     */
+    void PostProcessSlabMesh(SlabMesh &slabMesh,
+                             unsigned int firstSlice,
+                             unsigned int lastSlice,
+                             bool hasPreviousSlab,
+                             bool hasNextSlab,
+                             const mitk::BaseGeometry *geometry) const;
+
+    /**
+     * Concatenates the post-processed meshes of the slabs of one time step and merges the points on the
+     * slices shared by neighbouring slabs.
+     */
+    vtkSmartPointer<vtkPolyData> StitchSlabMeshes(const SlabMesh *slabMeshes, std::size_t numberOfSlabs) const;
+
+    std::vector<SlabMesh> m_SlabMeshes;
+
+    unsigned int m_SlabMeshDimensions[3];
+
+    int m_SlabMeshBackgroundLabel;
+
+    itk::ModifiedTimeType m_SlabMeshInputMTime;
+
+    unsigned int m_SlabThickness;
+
+    unsigned int m_NumberOfUpdatedSlabs;
+
     void GenerateData() override;
 
     void GenerateOutputInformation() override;
@@ -17,11 +17,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkLabelSetImageToSurfaceThreadedFilter.h"
 
 #include "mitkLabelSetImage.h"
-#include "mitkLabelSetImageToSurfaceFilter.h"
+#include "mitkLookupTableProperty.h"
 
 namespace mitk
 {
-  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter() : m_RequestedLabel(1), m_Result(nullptr)
+  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter()
+    : m_RequestedLabel(1),
+      m_GenerateAllLabels(false),
+      m_Filter(LabelSetImageToSurfaceFilter::New()),
+      m_Result(nullptr)
   {
   }
 
@@ -74,10 +78,20 @@ namespace mitk
       MITK_WARN << "\"RequestedLabel\" parameter was not set: will use the default value (" << m_RequestedLabel << ").";
     }
 
-    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    try
+    {
+      this->GetParameter("GenerateAllLabels", m_GenerateAllLabels);
+    }
+    catch (std::invalid_argument &)
+    {
+      m_GenerateAllLabels = false;
+    }
+
+    // the filter is reused, so it can keep the meshes of unchanged slabs if all labels are generated
+    mitk::LabelSetImageToSurfaceFilter *filter = m_Filter;
     filter->SetInput(image);
     //  filter->SetObserver(obsv);
-    filter->SetGenerateAllLabels(false);
+    filter->SetGenerateAllLabels(m_GenerateAllLabels);
     filter->SetRequestedLabel(m_RequestedLabel);
     filter->SetUseSmoothing(useSmoothing);
 
@@ -123,8 +137,21 @@ namespace mitk
     node->SetData(m_Result);
     node->SetName(name);
 
-    mitk::Color color = image->GetLabel(m_RequestedLabel, image->GetActiveLayer())->GetColor();
-    node->SetColor(color);
+    if (m_GenerateAllLabels)
+    {
+      // color the surface by the label values stored in its cell scalars
+      mitk::LookupTableProperty::Pointer lookupTableProperty =
+        mitk::LookupTableProperty::New(image->GetActiveLabelSet()->GetLookupTable()->Clone());
+      node->SetProperty("LookupTable", lookupTableProperty);
+      node->SetBoolProperty("scalar visibility", true);
+      node->SetDoubleProperty("ScalarsRangeMinimum", 0.0);
+      node->SetDoubleProperty("ScalarsRangeMaximum", 65536.0);
+    }
+    else
+    {
+      mitk::Color color = image->GetLabel(m_RequestedLabel, image->GetActiveLayer())->GetColor();
+      node->SetColor(color);
+    }
 
     this->InsertBelowGroupNode(node);
 
@@ -17,12 +17,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef __mitkLabelSetImageToSurfaceThreadedFilter_H_
 #define __mitkLabelSetImageToSurfaceThreadedFilter_H_
 
+#include "mitkLabelSetImageToSurfaceFilter.h"
 #include "mitkSegmentationSink.h"
 #include "mitkSurface.h"
 #include <MitkMultilabelExports.h>
 
 namespace mitk
 {
+  /**
+   * Runs LabelSetImageToSurfaceFilter in the background. Parameters are "Input", "Smooth", "RequestedLabel"
+   * and the optional "GenerateAllLabels". If all labels are generated, the surface filter is kept alive between
+   * runs so that only the parts of the image that changed since the last run are extracted again.
+   */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceThreadedFilter : public SegmentationSink
   {
   public:
@@ -42,6 +48,8 @@ namespace mitk
 
   private:
     int m_RequestedLabel;
+    bool m_GenerateAllLabels;
+    LabelSetImageToSurfaceFilter::Pointer m_Filter;
     Surface::Pointer m_Result;
   };
 
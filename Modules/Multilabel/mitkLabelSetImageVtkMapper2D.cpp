@@ -56,6 +56,64 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkRGBAPixel.h>
 #include <mitkRenderingModeProperty.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  // Index region of the image that contains all voxels cut by the plane, padded by one voxel for
+  // the nearest neighbor interpolation of the reslicer.
+  itk::ImageRegion<3> ComputeRegionCutByPlane(const mitk::Image *image,
+                                              int timeStep,
+                                              const mitk::PlaneGeometry *worldGeometry)
+  {
+    itk::ImageRegion<3> region;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      region.SetIndex(i, 0);
+      region.SetSize(i, image->GetDimension(i));
+    }
+
+    // the corners of curved planes do not bound the surface
+    if (nullptr != dynamic_cast<const mitk::AbstractTransformGeometry *>(worldGeometry))
+      return region;
+
+    const mitk::BaseGeometry *imageGeometry = image->GetTimeGeometry()->GetGeometryForTimeStep(timeStep);
+    if (nullptr == imageGeometry)
+      return region;
+
+    double lowerBound[3];
+    double upperBound[3];
+    std::fill(lowerBound, lowerBound + 3, std::numeric_limits<double>::max());
+    std::fill(upperBound, upperBound + 3, std::numeric_limits<double>::lowest());
+
+    for (int corner = 0; corner < 8; ++corner)
+    {
+      mitk::Point3D index;
+      imageGeometry->WorldToIndex(worldGeometry->GetCornerPoint(corner), index);
+
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        lowerBound[i] = std::min(lowerBound[i], index[i]);
+        upperBound[i] = std::max(upperBound[i], index[i]);
+      }
+    }
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      const double dimension = image->GetDimension(i);
+      const double begin = std::min(std::max(std::floor(lowerBound[i]) - 1.0, 0.0), dimension - 1.0);
+      const double end = std::min(std::max(std::ceil(upperBound[i]) + 2.0, begin + 1.0), dimension);
+
+      region.SetIndex(i, static_cast<itk::IndexValueType>(begin));
+      region.SetSize(i, static_cast<itk::SizeValueType>(end - begin));
+    }
+
+    return region;
+  }
+}
+
 mitk::LabelSetImageVtkMapper2D::LabelSetImageVtkMapper2D()
 {
 }
@@ -147,23 +205,33 @@ void mitk::LabelSetImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer
     return;
   }
 
+  // part of the inactive layers that is cut by the current plane
+  const auto layerRegion = ComputeRegionCutByPlane(image, this->GetTimestep(), worldGeometry);
+
   for (int lidx = 0; lidx < numberOfLayers; ++lidx)
   {
-    mitk::Image *layerImage = nullptr;
+    mitk::Image::Pointer layerImage;
+    int timeStep = this->GetTimestep();
 
-    // set main input for ExtractSliceFilter
+    // set main input for ExtractSliceFilter; inactive layers are not kept as images, so only the
+    // region cut by the plane is read from their sparse storage
     if (lidx == activeLayer)
+    {
       layerImage = image;
+    }
     else
-      layerImage = image->GetLayerImage(lidx);
+    {
+      layerImage = image->GetLayerImageRegion(lidx, timeStep, layerRegion);
+      timeStep = 0;
+    }
 
     localStorage->m_ReslicerVector[lidx]->SetInput(layerImage);
     localStorage->m_ReslicerVector[lidx]->SetWorldGeometry(worldGeometry);
-    localStorage->m_ReslicerVector[lidx]->SetTimeStep(this->GetTimestep());
+    localStorage->m_ReslicerVector[lidx]->SetTimeStep(timeStep);
 
     // set the transformation of the image to adapt reslice axis
     localStorage->m_ReslicerVector[lidx]->SetResliceTransformByGeometry(
-      layerImage->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep()));
+      layerImage->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
 
     // is the geometry of the slice based on the image image or the worldgeometry?
     bool inPlaneResampleExtentByGeometry = false;
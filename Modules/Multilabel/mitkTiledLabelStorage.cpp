@@ -0,0 +1,399 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTiledLabelStorage.h"
+
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkParallelFor.h>
+#include <mitkPixelTypeMultiplex.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+  bool IsZero(mitk::Label::PixelType value) { return 0 == value; }
+
+  template <typename TPixel>
+  void ConvertToLabels(const mitk::PixelType &,
+                       const void *data,
+                       std::size_t numberOfPixels,
+                       std::vector<mitk::Label::PixelType> &labels)
+  {
+    const TPixel *pixels = static_cast<const TPixel *>(data);
+    labels.resize(numberOfPixels);
+    std::transform(pixels, pixels + numberOfPixels, labels.begin(), [](TPixel value) {
+      return static_cast<mitk::Label::PixelType>(value);
+    });
+  }
+}
+
+const unsigned int mitk::TiledLabelStorage::TileSize;
+
+mitk::TiledLabelStorage::TiledLabelStorage() : m_TimeSteps(0)
+{
+  std::fill(m_Dimensions, m_Dimensions + 3, 0);
+  std::fill(m_NumberOfTiles, m_NumberOfTiles + 3, 0);
+}
+
+mitk::TiledLabelStorage::TiledLabelStorage(const TiledLabelStorage &other)
+  : itk::Object(), m_TimeSteps(other.m_TimeSteps), m_Tiles(other.m_Tiles)
+{
+  std::copy(other.m_Dimensions, other.m_Dimensions + 3, m_Dimensions);
+  std::copy(other.m_NumberOfTiles, other.m_NumberOfTiles + 3, m_NumberOfTiles);
+}
+
+mitk::TiledLabelStorage::~TiledLabelStorage()
+{
+}
+
+itk::LightObject::Pointer mitk::TiledLabelStorage::InternalClone() const
+{
+  itk::LightObject::Pointer result(new Self(*this));
+  result->UnRegister();
+  return result;
+}
+
+const mitk::TiledLabelStorage::TilePointer &mitk::TiledLabelStorage::GetEmptyTile()
+{
+  static const TilePointer emptyTile = std::make_shared<const TileType>(TileSize * TileSize * TileSize, 0);
+  return emptyTile;
+}
+
+void mitk::TiledLabelStorage::Initialize(const unsigned int *dimensions, unsigned int timeSteps)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    m_Dimensions[i] = dimensions[i];
+    m_NumberOfTiles[i] = (dimensions[i] + TileSize - 1) / TileSize;
+  }
+
+  m_TimeSteps = timeSteps;
+
+  m_Tiles.assign(static_cast<std::size_t>(m_NumberOfTiles[0]) * m_NumberOfTiles[1] * m_NumberOfTiles[2] * m_TimeSteps,
+                 GetEmptyTile());
+
+  this->Modified();
+}
+
+void mitk::TiledLabelStorage::Initialize(const Image *image)
+{
+  const unsigned int dimensions[] = {image->GetDimension(0), image->GetDimension(1), image->GetDimension(2)};
+  this->Initialize(dimensions, image->GetDimension(3));
+}
+
+std::size_t mitk::TiledLabelStorage::GetTileIndex(unsigned int tileX,
+                                                  unsigned int tileY,
+                                                  unsigned int tileZ,
+                                                  unsigned int timeStep) const
+{
+  return ((static_cast<std::size_t>(timeStep) * m_NumberOfTiles[2] + tileZ) * m_NumberOfTiles[1] + tileY) *
+           m_NumberOfTiles[0] +
+         tileX;
+}
+
+void mitk::TiledLabelStorage::GetTileRegion(std::size_t tileIndex,
+                                            unsigned int *begin,
+                                            unsigned int *size,
+                                            unsigned int &timeStep) const
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    begin[i] = static_cast<unsigned int>(tileIndex % m_NumberOfTiles[i]) * TileSize;
+    size[i] = std::min(TileSize, m_Dimensions[i] - begin[i]);
+    tileIndex /= m_NumberOfTiles[i];
+  }
+
+  timeStep = static_cast<unsigned int>(tileIndex);
+}
+
+void mitk::TiledLabelStorage::Pack(const PixelType *volume, unsigned int timeStep)
+{
+  if (timeStep >= m_TimeSteps)
+    mitkThrow() << "Time step " << timeStep << " is out of range.";
+
+  const std::size_t lineStride = m_Dimensions[0];
+  const std::size_t sliceStride = lineStride * m_Dimensions[1];
+
+  TileType tile(TileSize * TileSize * TileSize);
+
+  for (unsigned int tileZ = 0; tileZ < m_NumberOfTiles[2]; ++tileZ)
+  {
+    const unsigned int beginZ = tileZ * TileSize;
+    const unsigned int sizeZ = std::min(TileSize, m_Dimensions[2] - beginZ);
+
+    for (unsigned int tileY = 0; tileY < m_NumberOfTiles[1]; ++tileY)
+    {
+      const unsigned int beginY = tileY * TileSize;
+      const unsigned int sizeY = std::min(TileSize, m_Dimensions[1] - beginY);
+
+      for (unsigned int tileX = 0; tileX < m_NumberOfTiles[0]; ++tileX)
+      {
+        const unsigned int beginX = tileX * TileSize;
+        const unsigned int sizeX = std::min(TileSize, m_Dimensions[0] - beginX);
+
+        const PixelType *origin = volume + beginZ * sliceStride + beginY * lineStride + beginX;
+        TilePointer &storedTile = m_Tiles[this->GetTileIndex(tileX, tileY, tileZ, timeStep)];
+
+        // most tiles are background, so check for that before gathering the tile
+        bool isEmpty = true;
+        for (unsigned int z = 0; z < sizeZ && isEmpty; ++z)
+        {
+          for (unsigned int y = 0; y < sizeY && isEmpty; ++y)
+          {
+            const PixelType *line = origin + z * sliceStride + y * lineStride;
+            isEmpty = std::all_of(line, line + sizeX, IsZero);
+          }
+        }
+
+        if (isEmpty)
+        {
+          storedTile = GetEmptyTile();
+          continue;
+        }
+
+        if (sizeX < TileSize || sizeY < TileSize || sizeZ < TileSize)
+          std::fill(tile.begin(), tile.end(), 0);
+
+        for (unsigned int z = 0; z < sizeZ; ++z)
+        {
+          for (unsigned int y = 0; y < sizeY; ++y)
+          {
+            const PixelType *line = origin + z * sliceStride + y * lineStride;
+            std::copy(line, line + sizeX, tile.begin() + (z * TileSize + y) * TileSize);
+          }
+        }
+
+        // keep unchanged tiles, they might be shared with clones
+        if (*storedTile != tile)
+          storedTile = std::make_shared<const TileType>(tile);
+      }
+    }
+  }
+
+  this->Modified();
+}
+
+void mitk::TiledLabelStorage::Unpack(PixelType *volume, unsigned int timeStep) const
+{
+  const unsigned int begin[] = {0, 0, 0};
+  this->UnpackRegion(volume, begin, m_Dimensions, timeStep);
+}
+
+void mitk::TiledLabelStorage::UnpackRegion(PixelType *region,
+                                           const unsigned int *begin,
+                                           const unsigned int *size,
+                                           unsigned int timeStep) const
+{
+  if (timeStep >= m_TimeSteps)
+    mitkThrow() << "Time step " << timeStep << " is out of range.";
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (0 == size[i] || begin[i] >= m_Dimensions[i] || size[i] > m_Dimensions[i] - begin[i])
+      mitkThrow() << "Region is not located within the volume.";
+  }
+
+  const std::size_t lineStride = size[0];
+  const std::size_t sliceStride = lineStride * size[1];
+
+  // tiles intersecting the region
+  unsigned int firstTile[3];
+  unsigned int endTile[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    firstTile[i] = begin[i] / TileSize;
+    endTile[i] = (begin[i] + size[i] - 1) / TileSize + 1;
+  }
+
+  for (unsigned int tileZ = firstTile[2]; tileZ < endTile[2]; ++tileZ)
+  {
+    const unsigned int beginZ = std::max(tileZ * TileSize, begin[2]);
+    const unsigned int endZ = std::min((tileZ + 1) * TileSize, begin[2] + size[2]);
+
+    for (unsigned int tileY = firstTile[1]; tileY < endTile[1]; ++tileY)
+    {
+      const unsigned int beginY = std::max(tileY * TileSize, begin[1]);
+      const unsigned int endY = std::min((tileY + 1) * TileSize, begin[1] + size[1]);
+
+      for (unsigned int tileX = firstTile[0]; tileX < endTile[0]; ++tileX)
+      {
+        const unsigned int beginX = std::max(tileX * TileSize, begin[0]);
+        const unsigned int sizeX = std::min((tileX + 1) * TileSize, begin[0] + size[0]) - beginX;
+
+        const TilePointer &tile = m_Tiles[this->GetTileIndex(tileX, tileY, tileZ, timeStep)];
+        const bool isEmpty = tile == GetEmptyTile();
+
+        for (unsigned int z = beginZ; z < endZ; ++z)
+        {
+          for (unsigned int y = beginY; y < endY; ++y)
+          {
+            PixelType *line = region + (z - begin[2]) * sliceStride + (y - begin[1]) * lineStride + (beginX - begin[0]);
+
+            if (isEmpty)
+            {
+              std::fill(line, line + sizeX, 0);
+            }
+            else
+            {
+              auto tileLine = tile->begin() +
+                              ((z - tileZ * TileSize) * TileSize + (y - tileY * TileSize)) * TileSize +
+                              (beginX - tileX * TileSize);
+              std::copy(tileLine, tileLine + sizeX, line);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+void mitk::TiledLabelStorage::CheckSize(const Image *image) const
+{
+  if (image == nullptr)
+    mitkThrow() << "No image given.";
+
+  if (image->GetDimension(0) != m_Dimensions[0] || image->GetDimension(1) != m_Dimensions[1] ||
+      image->GetDimension(2) != m_Dimensions[2] || image->GetDimension(3) != m_TimeSteps)
+    mitkThrow() << "Size of the image does not match the size of the label storage.";
+}
+
+void mitk::TiledLabelStorage::Pack(Image *image)
+{
+  this->CheckSize(image);
+
+  const mitk::PixelType pixelType = image->GetPixelType();
+
+  if (pixelType.GetNumberOfComponents() != 1)
+    mitkThrow() << "Label data must be stored in scalar images.";
+
+  const bool isLabelPixelType = pixelType == MakeScalarPixelType<PixelType>();
+  const std::size_t numberOfPixels = static_cast<std::size_t>(m_Dimensions[0]) * m_Dimensions[1] * m_Dimensions[2];
+  std::vector<PixelType> labels;
+
+  for (unsigned int timeStep = 0; timeStep < m_TimeSteps; ++timeStep)
+  {
+    ImageReadAccessor accessor(image, image->GetVolumeData(timeStep));
+
+    if (isLabelPixelType)
+    {
+      this->Pack(static_cast<const PixelType *>(accessor.GetData()), timeStep);
+    }
+    else
+    {
+      mitkPixelTypeMultiplex3(ConvertToLabels, pixelType, accessor.GetData(), numberOfPixels, labels);
+      this->Pack(labels.data(), timeStep);
+    }
+  }
+}
+
+void mitk::TiledLabelStorage::Unpack(Image *image) const
+{
+  this->CheckSize(image);
+
+  if (image->GetPixelType() != MakeScalarPixelType<PixelType>())
+    mitkThrow() << "Pixel type of the image does not match the label pixel type.";
+
+  for (unsigned int timeStep = 0; timeStep < m_TimeSteps; ++timeStep)
+  {
+    ImageWriteAccessor accessor(image, image->GetVolumeData(timeStep));
+    this->Unpack(static_cast<PixelType *>(accessor.GetData()), timeStep);
+  }
+
+  image->Modified();
+}
+
+void mitk::TiledLabelStorage::RemapLabels(const std::vector<PixelType> &lookupTable)
+{
+  this->RemapLabels(lookupTable, TileFunction());
+}
+
+void mitk::TiledLabelStorage::RemapLabels(const std::vector<PixelType> &lookupTable, const TileFunction &function)
+{
+  if (lookupTable.size() <= std::numeric_limits<PixelType>::max())
+    mitkThrow() << "Lookup table does not cover all label values.";
+
+  // an exterior label that is remapped to another label fills the empty tiles
+  const TilePointer remappedEmptyTile =
+    0 != lookupTable[0] ? std::make_shared<const TileType>(TileSize * TileSize * TileSize, lookupTable[0]) : GetEmptyTile();
+
+  mitk::ParallelFor(m_Tiles.size(), [&](std::size_t i) {
+    TilePointer &tile = m_Tiles[i];
+
+    if (tile == GetEmptyTile())
+    {
+      tile = remappedEmptyTile;
+    }
+    else
+    {
+      TileType remappedTile(tile->size());
+      std::transform(tile->begin(), tile->end(), remappedTile.begin(), [&lookupTable](PixelType value) {
+        return lookupTable[value];
+      });
+
+      if (std::all_of(remappedTile.begin(), remappedTile.end(), IsZero))
+      {
+        tile = GetEmptyTile();
+      }
+      else if (*tile != remappedTile)
+      {
+        // keep unchanged tiles, they might be shared with clones
+        tile = std::make_shared<const TileType>(std::move(remappedTile));
+      }
+    }
+
+    if (function)
+    {
+      unsigned int begin[3];
+      unsigned int size[3];
+      unsigned int timeStep;
+      this->GetTileRegion(i, begin, size, timeStep);
+      function(tile == GetEmptyTile() ? nullptr : tile->data(), begin, size, timeStep);
+    }
+  });
+
+  this->Modified();
+}
+
+void mitk::TiledLabelStorage::ForEachTile(const TileFunction &function) const
+{
+  mitk::ParallelFor(m_Tiles.size(), [&](std::size_t i) {
+    const TilePointer &tile = m_Tiles[i];
+
+    unsigned int begin[3];
+    unsigned int size[3];
+    unsigned int timeStep;
+    this->GetTileRegion(i, begin, size, timeStep);
+    function(tile == GetEmptyTile() ? nullptr : tile->data(), begin, size, timeStep);
+  });
+}
+
+bool mitk::TiledLabelStorage::IsEmpty() const
+{
+  return 0 == this->GetNumberOfAllocatedTiles();
+}
+
+std::size_t mitk::TiledLabelStorage::GetNumberOfAllocatedTiles() const
+{
+  return static_cast<std::size_t>(
+    std::count_if(m_Tiles.begin(), m_Tiles.end(), [](const TilePointer &tile) { return tile != GetEmptyTile(); }));
+}
+
+std::size_t mitk::TiledLabelStorage::GetAllocatedMemorySize() const
+{
+  return this->GetNumberOfAllocatedTiles() * TileSize * TileSize * TileSize * sizeof(PixelType);
+}
@@ -0,0 +1,143 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkTiledLabelStorage_H_
+#define __mitkTiledLabelStorage_H_
+
+#include "MitkMultilabelExports.h"
+
+#include <mitkImage.h>
+#include <mitkLabel.h>
+
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mitk
+{
+  //
+  // Documentation
+  // @brief Sparse storage of the label data of one LabelSetImage layer.
+  //
+  // The (3D+t) label volume is split into cubic tiles of TileSize^3 pixels. Tiles containing only
+  // the exterior label (0) are not allocated but refer to a single, shared empty tile, so a layer
+  // that is mostly background only occupies memory for the tiles that actually contain labels.
+  // Allocated tiles are immutable and shared between clones; packing new data only replaces the
+  // tiles whose content changed.
+  //
+  // Tiles at the upper borders of the volume are padded with 0.
+  // @ingroup Data
+  //
+  class MITKMULTILABEL_EXPORT TiledLabelStorage : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(TiledLabelStorage, itk::Object);
+    itkNewMacro(Self);
+    itkCloneMacro(Self);
+
+    typedef mitk::Label::PixelType PixelType;
+
+    /** \brief Edge length of the cubic tiles in pixels. */
+    static const unsigned int TileSize = 32;
+
+    /** \brief Function called for a tile of time step @a timeStep, see ForEachTile(). @a tile points to the
+     * TileSize^3 pixels of the tile, nullptr for an empty tile. Only the box of @a size pixels at the tile origin
+     * is located within the volume, its first pixel has the index @a begin. */
+    typedef std::function<void(const PixelType *tile, const unsigned int *begin, const unsigned int *size, unsigned int timeStep)>
+      TileFunction;
+
+    /** \brief Initialize an empty storage for volumes of the given size.
+     *
+     * @param dimensions the size of the volume in x, y and z
+     * @param timeSteps the number of volumes */
+    void Initialize(const unsigned int *dimensions, unsigned int timeSteps);
+
+    /** \brief Initialize an empty storage matching the size of @a image. */
+    void Initialize(const Image *image);
+
+    /** \brief Store the contiguous volume @a volume as time step @a timeStep. */
+    void Pack(const PixelType *volume, unsigned int timeStep);
+
+    /** \brief Write time step @a timeStep into the contiguous volume @a volume. */
+    void Unpack(PixelType *volume, unsigned int timeStep) const;
+
+    /** \brief Write the box of @a size pixels starting at index @a begin of time step @a timeStep into the
+     * contiguous buffer @a region. Only the tiles intersecting the box are read.
+     * \throw mitk::Exception if the box is not located within the volume. */
+    void UnpackRegion(PixelType *region, const unsigned int *begin, const unsigned int *size, unsigned int timeStep) const;
+
+    /** \brief Store all time steps of @a image, pixel values are cast to the label pixel type.
+     * \throw mitk::Exception if @a image is not scalar or its size does not match the storage. */
+    void Pack(Image *image);
+
+    /** \brief Write all time steps into @a image.
+     * \throw mitk::Exception if pixel type or size of @a image do not match the storage. */
+    void Unpack(Image *image) const;
+
+    /** \brief Replace each label value v by @a lookupTable[v] in all time steps.
+     *
+     * Empty tiles are only visited if the exterior label is remapped as well. Tiles that become empty
+     * are released. */
+    void RemapLabels(const std::vector<PixelType> &lookupTable);
+
+    /** \brief Like RemapLabels(const std::vector<PixelType> &), but calls @a function for each remapped tile while it
+     * is still in the cache, e.g. to gather statistics of the remapped labels without a second pass. */
+    void RemapLabels(const std::vector<PixelType> &lookupTable, const TileFunction &function);
+
+    /** \brief Calls @a function for each tile of all time steps, concurrently. The label data are read in place. */
+    void ForEachTile(const TileFunction &function) const;
+
+    /** \brief Returns true if no tile contains a label other than the exterior label. */
+    bool IsEmpty() const;
+
+    std::size_t GetNumberOfTiles() const { return m_Tiles.size(); }
+    std::size_t GetNumberOfAllocatedTiles() const;
+
+    /** \brief Memory occupied by the allocated tiles in bytes. */
+    std::size_t GetAllocatedMemorySize() const;
+
+  protected:
+    TiledLabelStorage();
+    TiledLabelStorage(const TiledLabelStorage &other);
+    ~TiledLabelStorage() override;
+
+    itk::LightObject::Pointer InternalClone() const override;
+
+  private:
+    typedef std::vector<PixelType> TileType;
+    typedef std::shared_ptr<const TileType> TilePointer;
+
+    static const TilePointer &GetEmptyTile();
+
+    void CheckSize(const Image *image) const;
+
+    std::size_t GetTileIndex(unsigned int tileX, unsigned int tileY, unsigned int tileZ, unsigned int timeStep) const;
+
+    /** Computes the box of the volume covered by the tile with the given index, clipped to the volume. */
+    void GetTileRegion(std::size_t tileIndex, unsigned int *begin, unsigned int *size, unsigned int &timeStep) const;
+
+    unsigned int m_Dimensions[3];
+    unsigned int m_NumberOfTiles[3];
+    unsigned int m_TimeSteps;
+
+    std::vector<TilePointer> m_Tiles;
+  };
+}
+
+#endif
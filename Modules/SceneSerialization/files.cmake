@@ -8,6 +8,7 @@ set(CPP_FILES
   mitkPropertyListDeserializerV1.cpp
   mitkSceneIO.cpp
   mitkSceneReader.cpp
+  mitkSceneContainer.cpp
   mitkSceneReaderV1.cpp
   mitkSurfaceSerializer.cpp
 )
@@ -0,0 +1,134 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkSceneContainer_h_included
+#define mitkSceneContainer_h_included
+
+#include <MitkSceneSerializationExports.h>
+
+#include <mitkCommon.h>
+
+#include <itkLightObject.h>
+#include <itkObjectFactory.h>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Indexed single-file container for the files of a scene.
+
+    Alternative to the zip archive written by SceneIO. Files are appended to the
+    container as soon as they are available, optionally deflated with a fast
+    compression level, and listed in a directory at the end of the container.
+    Each entry can be extracted on its own by seeking to its offset, so neither
+    writing nor reading a scene requires a copy of the complete archive content.
+
+    AddFile() may be called concurrently from several threads while the container
+    is being written. Files are compressed and copied outside of the lock, only the
+    space of each entry in the container is reserved under it. All calls to AddFile()
+    have to be finished before Close() is called. ExtractEntry() and ReadEntry() may be called concurrently
+    on an opened container.
+  */
+  class MITKSCENESERIALIZATION_EXPORT SceneContainer : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(SceneContainer, itk::LightObject);
+    itkFactorylessNewMacro(Self);
+
+    /**
+      \brief Returns true if the given file starts with the signature of a scene container.
+    */
+    static bool CanRead(const std::string &filename);
+
+    /**
+      \brief Start writing a new container, replacing an existing file.
+      \param compress deflate the added files with the fastest compression level
+      \throw mitk::Exception if the file cannot be created.
+    */
+    void Create(const std::string &filename, bool compress);
+
+    /**
+      \brief Append the content of a file as entry with the given name.
+
+      With compression, the deflated content is staged in a temporary file next to @a filename.
+      \throw mitk::Exception if the file cannot be read or the container cannot be written.
+    */
+    void AddFile(const std::string &entryName, const std::string &filename);
+
+    /**
+      \brief Write the directory of entries and close the container.
+      \throw mitk::Exception if the container cannot be written.
+    */
+    void Close();
+
+    /**
+      \brief Read the directory of an existing container.
+      \throw mitk::Exception if the file is no valid container.
+    */
+    void Open(const std::string &filename);
+
+    std::vector<std::string> GetEntryNames() const;
+
+    bool HasEntry(const std::string &entryName) const;
+
+    /**
+      \brief Write the (decompressed) content of an entry to a file.
+      \throw mitk::Exception if the entry does not exist or cannot be extracted.
+    */
+    void ExtractEntry(const std::string &entryName, const std::string &filename) const;
+
+    /**
+      \brief Return the (decompressed) content of an entry.
+      \throw mitk::Exception if the entry does not exist or cannot be read.
+    */
+    std::string ReadEntry(const std::string &entryName) const;
+
+  protected:
+    SceneContainer();
+    ~SceneContainer() override;
+
+    struct Entry
+    {
+      std::uint64_t Offset = 0;
+      std::uint64_t StoredSize = 0;
+      std::uint64_t Size = 0;
+      bool Compressed = false;
+    };
+
+    void CopyEntry(const std::string &entryName, std::ostream &target) const;
+
+    std::string m_Filename;
+    std::ofstream m_Stream;
+    bool m_Compress;
+
+    /** End of the last reserved entry, where the directory will be written */
+    std::uint64_t m_EndOffset;
+
+    std::map<std::string, Entry> m_Entries;
+    std::mutex m_Mutex;
+
+  private:
+    SceneContainer(const SceneContainer &);
+  };
+}
+
+#endif
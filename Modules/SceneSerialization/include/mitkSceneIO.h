@@ -24,6 +24,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <Poco/Zip/ZipLocalFileHeader.h>
 
+#include <set>
+#include <string>
+#include <vector>
+
+class TiXmlDocument;
 class TiXmlElement;
 
 namespace mitk
@@ -39,6 +44,37 @@ namespace mitk
 
       typedef DataStorage::SetOfObjects FailedBaseDataListType;
 
+    /**
+     * \brief Write scenes as indexed SceneContainer instead of a zip archive.
+     *
+     * The nodes of a scene are serialized concurrently. In a SceneContainer, each node's
+     * files are streamed into the container as soon as the node is serialized,
+     * so no temporary copy of the complete scene is needed, and loading extracts
+     * only the entries referenced by the scene, directly from their offsets.
+     * LoadScene() recognizes both formats regardless of this setting. Single nodes of a
+     * SceneContainer can be loaded on demand with LoadSceneNodes(). Default is off.
+     */
+    itkSetMacro(UseSceneContainer, bool);
+    itkGetConstMacro(UseSceneContainer, bool);
+    itkBooleanMacro(UseSceneContainer);
+
+    /**
+     * \brief Deflate the entries of a SceneContainer with the fastest compression level. Default is off.
+     */
+    itkSetMacro(CompressSceneContainer, bool);
+    itkGetConstMacro(CompressSceneContainer, bool);
+    itkBooleanMacro(CompressSceneContainer);
+
+    /**
+     * \brief Store images in the chunked *.mitkimage format instead of nrrd.
+     *
+     * The chunked format is compressed and decompressed by several threads, but scenes
+     * containing it cannot be loaded by older MITK versions. Default is off.
+     */
+    itkSetMacro(UseChunkedImageFormat, bool);
+    itkGetConstMacro(UseChunkedImageFormat, bool);
+    itkBooleanMacro(UseChunkedImageFormat);
+
     /**
      * \brief Load a scene of objects from file
      * \return DataStorage with all scene objects and their relations. If loading failed, query GetFailedNodes() and
@@ -56,6 +92,33 @@ namespace mitk
                                            DataStorage *storage = nullptr,
                                            bool clearStorageFirst = false);
 
+    /**
+     * \brief Get the UIDs of all nodes of a scene that was written as SceneContainer
+     *
+     * Only the scene description is read. The UIDs are assigned when the scene is saved and
+     * identify the nodes for LoadSceneNodes(). Returns an empty list for zip archives.
+     *
+     * \param filename full filename of the scene file
+     */
+    std::vector<std::string> GetSceneNodeUIDs(const std::string &filename);
+
+    /**
+     * \brief Load only some nodes of a scene that was written as SceneContainer
+     * \return DataStorage with the requested nodes and the relations between them.
+     *
+     * Only the container entries of the requested nodes are read, by seeking to their offsets,
+     * so single nodes of a large scene can be loaded when they are needed. Relations to nodes
+     * that are not loaded are dropped. Zip archives have no index and can only be loaded
+     * completely by LoadScene().
+     *
+     * \param filename full filename of the scene file
+     * \param nodeUIDs UIDs of the nodes to load, see GetSceneNodeUIDs()
+     * \param storage If given, this DataStorage is used instead of a newly created one
+     */
+    DataStorage::Pointer LoadSceneNodes(const std::string &filename,
+                                        const std::vector<std::string> &nodeUIDs,
+                                        DataStorage *storage = nullptr);
+
     /**
      * \brief Save a scene of objects to file
      * \return True if complete success, false if any problem occurred. Note that a scene file might still be written if
@@ -101,8 +164,42 @@ namespace mitk
 
     std::string CreateEmptyTempDirectory();
 
-    TiXmlElement *SaveBaseData(BaseData *data, const std::string &filenamehint, bool &error);
-    TiXmlElement *SavePropertyList(PropertyList *propertyList, const std::string &filenamehint);
+    /**
+     * \brief Shared implementation of LoadScene() and LoadSceneNodes(), nodeUIDs is nullptr to load all nodes.
+     */
+    DataStorage::Pointer DoLoadScene(const std::string &filename,
+                                     DataStorage *storage,
+                                     bool clearStorageFirst,
+                                     const std::set<std::string> *nodeUIDs);
+
+    /**
+     * \brief Serialize data into the sub directory nodeDirectory of the working directory.
+     *
+     * Called concurrently for different nodes.
+     */
+    TiXmlElement *SaveBaseData(BaseData *data,
+                               const std::string &filenamehint,
+                               const std::string &nodeDirectory,
+                               bool &error);
+
+    /**
+     * \brief Serialize propertyList into the sub directory nodeDirectory of the working directory.
+     *
+     * Called concurrently for different nodes, properties that cannot be serialized are added to failedProperties.
+     */
+    TiXmlElement *SavePropertyList(PropertyList *propertyList,
+                                   const std::string &filenamehint,
+                                   const std::string &nodeDirectory,
+                                   PropertyList *failedProperties);
+
+    /**
+     * \brief Extract the files referenced by the scene description of a SceneContainer into the working directory.
+     *
+     * If nodeUIDs is given, all other nodes are removed from document and their files are not extracted.
+     */
+    bool ExtractSceneContainer(const std::string &filename,
+                               TiXmlDocument &document,
+                               const std::set<std::string> *nodeUIDs = nullptr);
 
     void OnUnzipError(const void *pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> &info);
     void OnUnzipOk(const void *pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path> &info);
@@ -112,6 +209,10 @@ namespace mitk
 
     std::string m_WorkingDirectory;
     unsigned int m_UnzipErrors;
+
+    bool m_UseSceneContainer;
+    bool m_CompressSceneContainer;
+    bool m_UseChunkedImageFormat;
   };
 }
 
@@ -17,11 +17,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageSerializer.h"
 #include "mitkIOUtil.h"
 #include "mitkImage.h"
+#include <mitkChunkedImageIO.h>
 #include <Poco/Path.h>
 
 MITK_REGISTER_SERIALIZER(ImageSerializer)
 
-mitk::ImageSerializer::ImageSerializer()
+mitk::ImageSerializer::ImageSerializer() : m_UseChunkedImageFormat(false)
 {
 }
 
@@ -45,7 +46,15 @@ std::string mitk::ImageSerializer::Serialize()
 
   std::string fullname(m_WorkingDirectory);
   fullname += Poco::Path::separator();
-  fullname += filename + ".nrrd";
+  // the chunked format reads and writes much faster, but only on request since older versions cannot read it
+  if (m_UseChunkedImageFormat && ChunkedImageIO::CanWriteImage(image))
+  {
+    fullname += filename + ".mitkimage";
+  }
+  else
+  {
+    fullname += filename + ".nrrd";
+  }
 
   try
   {
@@ -32,9 +32,20 @@ namespace mitk
 
       std::string Serialize() override;
 
+    /**
+      \brief Store images in the chunked *.mitkimage format instead of nrrd, where possible.
+
+      The chunked format is written and read concurrently, but older MITK versions cannot
+      read it. Default is off.
+    */
+    itkSetMacro(UseChunkedImageFormat, bool);
+    itkGetConstMacro(UseChunkedImageFormat, bool);
+
   protected:
     ImageSerializer();
     ~ImageSerializer() override;
+
+    bool m_UseChunkedImageFormat;
   };
 
 } // namespace
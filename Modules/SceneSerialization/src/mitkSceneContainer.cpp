@@ -0,0 +1,374 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkSceneContainer.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <Poco/DeflatingStream.h>
+#include <Poco/InflatingStream.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+  const char ContainerSignature[8] = {'M', 'I', 'T', 'K', 'S', 'C', 'N', '\0'};
+  const std::uint32_t ContainerVersion = 1;
+
+  // signature, version, reserved flags, offset of the directory
+  const std::uint64_t HeaderSize = sizeof(ContainerSignature) + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+
+  const std::size_t CopyBufferSize = 1 << 20;
+
+  template <typename T>
+  void WriteValue(std::ostream &stream, T value)
+  {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void WriteString(std::ostream &stream, const std::string &value)
+  {
+    WriteValue(stream, static_cast<std::uint32_t>(value.size()));
+    stream.write(value.data(), value.size());
+  }
+
+  template <typename T>
+  bool ReadValue(std::istream &stream, T &value)
+  {
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+  }
+
+  bool ReadString(std::istream &stream, std::string &value)
+  {
+    std::uint32_t size = 0;
+    if (!ReadValue(stream, size))
+      return false;
+
+    value.resize(size);
+    return size == 0 || static_cast<bool>(stream.read(&value[0], size));
+  }
+
+  /** Copy up to size bytes (everything if size is negative) from source to target, returns the number of bytes. */
+  std::uint64_t CopyStream(std::istream &source, std::ostream &target, std::int64_t size = -1)
+  {
+    std::vector<char> buffer(CopyBufferSize);
+    std::uint64_t copied = 0;
+
+    while (size < 0 || copied < static_cast<std::uint64_t>(size))
+    {
+      std::streamsize chunk = static_cast<std::streamsize>(buffer.size());
+      if (size >= 0)
+        chunk = std::min(chunk, static_cast<std::streamsize>(size - copied));
+
+      source.read(buffer.data(), chunk);
+      std::streamsize read = source.gcount();
+      if (read <= 0)
+        break;
+
+      target.write(buffer.data(), read);
+      copied += read;
+    }
+
+    return copied;
+  }
+}
+
+mitk::SceneContainer::SceneContainer() : m_Compress(false), m_EndOffset(0)
+{
+}
+
+mitk::SceneContainer::~SceneContainer()
+{
+}
+
+bool mitk::SceneContainer::CanRead(const std::string &filename)
+{
+  std::ifstream stream(filename.c_str(), std::ios::binary);
+  char signature[sizeof(ContainerSignature)];
+
+  return stream.read(signature, sizeof(signature)) &&
+         std::memcmp(signature, ContainerSignature, sizeof(ContainerSignature)) == 0;
+}
+
+void mitk::SceneContainer::Create(const std::string &filename, bool compress)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  m_Entries.clear();
+  m_Filename = filename;
+  m_Compress = compress;
+
+  m_Stream.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!m_Stream.is_open())
+  {
+    mitkThrow() << "Cannot create scene container " << filename;
+  }
+
+  m_Stream.write(ContainerSignature, sizeof(ContainerSignature));
+  WriteValue(m_Stream, ContainerVersion);
+  WriteValue(m_Stream, std::uint32_t(0));
+  WriteValue(m_Stream, std::uint64_t(0)); // directory offset, written by Close()
+  m_Stream.flush();
+
+  m_EndOffset = HeaderSize;
+}
+
+void mitk::SceneContainer::AddFile(const std::string &entryName, const std::string &filename)
+{
+  std::ifstream source(filename.c_str(), std::ios::binary);
+  if (!source.is_open())
+  {
+    mitkThrow() << "Cannot read " << filename << " for scene container " << m_Filename;
+  }
+
+  Entry entry;
+  entry.Compressed = m_Compress;
+
+  // deflate into a temporary file next to the source first, so that files of several
+  // threads are compressed concurrently and only the space in the container is reserved
+  // under the lock
+  std::string payloadFilename = filename;
+
+  if (entry.Compressed)
+  {
+    payloadFilename = filename + ".deflated";
+
+    std::ofstream deflated(payloadFilename.c_str(), std::ios::binary | std::ios::trunc);
+    Poco::DeflatingOutputStream deflater(deflated, Poco::DeflatingStreamBuf::STREAM_ZLIB, 1);
+    entry.Size = CopyStream(source, deflater);
+    deflater.close();
+    deflated.close();
+
+    if (!deflated)
+    {
+      std::remove(payloadFilename.c_str());
+      mitkThrow() << "Cannot compress " << filename << " for scene container " << m_Filename;
+    }
+  }
+
+  std::ifstream payload(payloadFilename.c_str(), std::ios::binary | std::ios::ate);
+  if (!payload.is_open())
+  {
+    mitkThrow() << "Cannot read " << payloadFilename << " for scene container " << m_Filename;
+  }
+
+  entry.StoredSize = static_cast<std::uint64_t>(payload.tellg());
+  payload.seekg(0);
+
+  if (!entry.Compressed)
+  {
+    entry.Size = entry.StoredSize;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (!m_Stream.is_open())
+    {
+      mitkThrow() << "Scene container is not open for writing";
+    }
+
+    if (m_Entries.find(entryName) != m_Entries.end())
+    {
+      mitkThrow() << "Duplicate entry " << entryName << " in scene container " << m_Filename;
+    }
+
+    entry.Offset = m_EndOffset;
+    m_EndOffset += entry.StoredSize;
+    m_Entries.insert(std::make_pair(entryName, entry));
+  }
+
+  // every call writes its reserved range through its own stream
+  std::fstream target(m_Filename.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+  target.seekp(entry.Offset);
+
+  const std::uint64_t written = CopyStream(payload, target, static_cast<std::int64_t>(entry.StoredSize));
+  target.close();
+  payload.close();
+
+  if (entry.Compressed)
+  {
+    std::remove(payloadFilename.c_str());
+  }
+
+  if (!target || written != entry.StoredSize)
+  {
+    mitkThrow() << "Cannot write " << entryName << " to scene container " << m_Filename;
+  }
+}
+
+void mitk::SceneContainer::Close()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  if (!m_Stream.is_open())
+  {
+    return;
+  }
+
+  // the entries have been written through their own streams
+  const std::uint64_t directoryOffset = m_EndOffset;
+  m_Stream.seekp(directoryOffset);
+
+  WriteValue(m_Stream, static_cast<std::uint64_t>(m_Entries.size()));
+  for (const auto &entry : m_Entries)
+  {
+    WriteString(m_Stream, entry.first);
+    WriteValue(m_Stream, entry.second.Offset);
+    WriteValue(m_Stream, entry.second.StoredSize);
+    WriteValue(m_Stream, entry.second.Size);
+    WriteValue(m_Stream, static_cast<std::uint8_t>(entry.second.Compressed ? 1 : 0));
+  }
+
+  m_Stream.seekp(HeaderSize - sizeof(std::uint64_t));
+  WriteValue(m_Stream, directoryOffset);
+
+  bool success = static_cast<bool>(m_Stream);
+  m_Stream.close();
+
+  if (!success)
+  {
+    mitkThrow() << "Cannot write scene container " << m_Filename;
+  }
+}
+
+void mitk::SceneContainer::Open(const std::string &filename)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  m_Entries.clear();
+  m_Filename = filename;
+
+  std::ifstream stream(filename.c_str(), std::ios::binary);
+  if (!stream.is_open())
+  {
+    mitkThrow() << "Cannot open scene container " << filename;
+  }
+
+  char signature[sizeof(ContainerSignature)];
+  std::uint32_t version = 0;
+  std::uint32_t flags = 0;
+  std::uint64_t directoryOffset = 0;
+
+  if (!stream.read(signature, sizeof(signature)) ||
+      std::memcmp(signature, ContainerSignature, sizeof(ContainerSignature)) != 0 || !ReadValue(stream, version) ||
+      version != ContainerVersion || !ReadValue(stream, flags) || !ReadValue(stream, directoryOffset) ||
+      directoryOffset < HeaderSize)
+  {
+    mitkThrow() << filename << " is no valid scene container";
+  }
+
+  std::uint64_t numberOfEntries = 0;
+  stream.seekg(directoryOffset);
+  if (!ReadValue(stream, numberOfEntries))
+  {
+    mitkThrow() << "Scene container " << filename << " is truncated";
+  }
+
+  for (std::uint64_t i = 0; i < numberOfEntries; ++i)
+  {
+    std::string entryName;
+    Entry entry;
+    std::uint8_t compressed = 0;
+
+    if (!ReadString(stream, entryName) || !ReadValue(stream, entry.Offset) || !ReadValue(stream, entry.StoredSize) ||
+        !ReadValue(stream, entry.Size) || !ReadValue(stream, compressed) ||
+        entry.Offset + entry.StoredSize > directoryOffset)
+    {
+      m_Entries.clear();
+      mitkThrow() << "Scene container " << filename << " is truncated";
+    }
+
+    entry.Compressed = compressed != 0;
+    m_Entries.insert(std::make_pair(entryName, entry));
+  }
+}
+
+std::vector<std::string> mitk::SceneContainer::GetEntryNames() const
+{
+  std::vector<std::string> names;
+  names.reserve(m_Entries.size());
+
+  for (const auto &entry : m_Entries)
+  {
+    names.push_back(entry.first);
+  }
+
+  return names;
+}
+
+bool mitk::SceneContainer::HasEntry(const std::string &entryName) const
+{
+  return m_Entries.find(entryName) != m_Entries.end();
+}
+
+void mitk::SceneContainer::CopyEntry(const std::string &entryName, std::ostream &target) const
+{
+  auto entryIter = m_Entries.find(entryName);
+  if (entryIter == m_Entries.end())
+  {
+    mitkThrow() << "No entry " << entryName << " in scene container " << m_Filename;
+  }
+
+  const Entry &entry = entryIter->second;
+
+  // every call uses its own stream, so entries can be extracted concurrently
+  std::ifstream stream(m_Filename.c_str(), std::ios::binary);
+  stream.seekg(entry.Offset);
+  if (!stream)
+  {
+    mitkThrow() << "Cannot read entry " << entryName << " of scene container " << m_Filename;
+  }
+
+  std::uint64_t size = 0;
+  if (entry.Compressed)
+  {
+    Poco::InflatingOutputStream inflater(target, Poco::InflatingStreamBuf::STREAM_ZLIB);
+    CopyStream(stream, inflater, static_cast<std::int64_t>(entry.StoredSize));
+    inflater.close();
+    size = entry.Size;
+  }
+  else
+  {
+    size = CopyStream(stream, target, static_cast<std::int64_t>(entry.StoredSize));
+  }
+
+  if (!target || size != entry.Size)
+  {
+    mitkThrow() << "Cannot read entry " << entryName << " of scene container " << m_Filename;
+  }
+}
+
+void mitk::SceneContainer::ExtractEntry(const std::string &entryName, const std::string &filename) const
+{
+  std::ofstream target(filename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!target.is_open())
+  {
+    mitkThrow() << "Cannot write " << filename;
+  }
+
+  this->CopyEntry(entryName, target);
+}
+
+std::string mitk::SceneContainer::ReadEntry(const std::string &entryName) const
+{
+  std::ostringstream target;
+  this->CopyEntry(entryName, target);
+  return target.str();
+}
@@ -21,11 +21,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <Poco/Zip/Decompress.h>
 
 #include "mitkBaseDataSerializer.h"
+#include "mitkImageSerializer.h"
 #include "mitkPropertyListSerializer.h"
+#include "mitkSceneContainer.h"
 #include "mitkSceneIO.h"
 #include "mitkSceneReader.h"
 
 #include "mitkBaseRenderer.h"
+#include "mitkParallelFor.h"
 #include "mitkProgressBar.h"
 #include "mitkRenderingManager.h"
 #include "mitkStandaloneDataStorage.h"
@@ -36,13 +39,23 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <tinyxml.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <mitkIOUtil.h>
+#include <set>
 #include <sstream>
+#include <thread>
 
 #include "itksys/SystemTools.hxx"
 
-mitk::SceneIO::SceneIO() : m_WorkingDirectory(""), m_UnzipErrors(0)
+mitk::SceneIO::SceneIO()
+  : m_WorkingDirectory(""),
+    m_UnzipErrors(0),
+    m_UseSceneContainer(false),
+    m_CompressSceneContainer(false),
+    m_UseChunkedImageFormat(false)
 {
 }
 
@@ -88,6 +101,65 @@ std::string mitk::SceneIO::CreateEmptyTempDirectory()
 mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
                                                     DataStorage *pStorage,
                                                     bool clearStorageFirst)
+{
+  return DoLoadScene(filename, pStorage, clearStorageFirst, nullptr);
+}
+
+std::vector<std::string> mitk::SceneIO::GetSceneNodeUIDs(const std::string &filename)
+{
+  std::vector<std::string> nodeUIDs;
+
+  if (!SceneContainer::CanRead(filename))
+  {
+    MITK_ERROR << "'" << filename << "' is no scene container. Node UIDs are only available for scene containers.";
+    return nodeUIDs;
+  }
+
+  mitk::LocaleSwitch localeSwitch("C");
+
+  TiXmlDocument document;
+  try
+  {
+    SceneContainer::Pointer container = SceneContainer::New();
+    container->Open(filename);
+    document.Parse(container->ReadEntry("index.xml").c_str());
+  }
+  catch (std::exception &e)
+  {
+    MITK_ERROR << "Could not read scene container " << filename << ": " << e.what();
+    return nodeUIDs;
+  }
+
+  if (document.Error())
+  {
+    MITK_ERROR << "Could not parse index.xml of " << filename << "\nTinyXML reports: " << document.ErrorDesc();
+    return nodeUIDs;
+  }
+
+  for (TiXmlElement *nodeElement = document.FirstChildElement("node"); nodeElement != nullptr;
+       nodeElement = nodeElement->NextSiblingElement("node"))
+  {
+    if (const char *uid = nodeElement->Attribute("UID"))
+    {
+      nodeUIDs.push_back(uid);
+    }
+  }
+
+  return nodeUIDs;
+}
+
+mitk::DataStorage::Pointer mitk::SceneIO::LoadSceneNodes(const std::string &filename,
+                                                         const std::vector<std::string> &nodeUIDs,
+                                                         DataStorage *pStorage)
+{
+  const std::set<std::string> requestedUIDs(nodeUIDs.begin(), nodeUIDs.end());
+  return DoLoadScene(filename, pStorage, false, &requestedUIDs);
+}
+
+mitk::DataStorage::Pointer mitk::SceneIO::DoLoadScene(const std::string &filename,
+                                                      DataStorage *pStorage,
+                                                      bool clearStorageFirst,
+                                                      const std::set<std::string> *nodeUIDs)
 {
   mitk::LocaleSwitch localeSwitch("C");
 
@@ -125,6 +197,13 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
     return storage;
   }
 
+  const bool isSceneContainer = SceneContainer::CanRead(filename);
+  if (nodeUIDs != nullptr && !isSceneContainer)
+  {
+    MITK_ERROR << "'" << filename << "' is no scene container. Single nodes can only be loaded from scene containers.";
+    return storage;
+  }
+
   // get new temporary directory
   m_WorkingDirectory = CreateEmptyTempDirectory();
   if (m_WorkingDirectory.empty())
@@ -133,36 +212,55 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
     return storage;
   }
 
-  // unzip all filenames contents to temp dir
-  m_UnzipErrors = 0;
-  Poco::Zip::Decompress unzipper(file, Poco::Path(m_WorkingDirectory));
-  unzipper.EError += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
-    this, &SceneIO::OnUnzipError);
-  unzipper.EOk += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
-    this, &SceneIO::OnUnzipOk);
-  unzipper.decompressAllFiles();
-  unzipper.EError -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
-    this, &SceneIO::OnUnzipError);
-  unzipper.EOk -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
-    this, &SceneIO::OnUnzipOk);
+  TiXmlDocument document;
 
-  if (m_UnzipErrors)
+  if (isSceneContainer)
   {
-    MITK_ERROR << "There were " << m_UnzipErrors << " errors unzipping '" << filename
-               << "'. Will attempt to read whatever could be unzipped.";
-  }
+    file.close();
 
-  // transcode locale-dependent string
-  m_WorkingDirectory = Poco::Path::transcode (m_WorkingDirectory);
+    // extract only the files referenced by index.xml, directly from their offsets
+    bool extracted = ExtractSceneContainer(filename, document, nodeUIDs);
 
-  // test if index.xml exists
-  // parse index.xml with TinyXML
-  TiXmlDocument document(m_WorkingDirectory + mitk::IOUtil::GetDirectorySeparator() + "index.xml");
-  if (!document.LoadFile())
+    // transcode locale-dependent string
+    m_WorkingDirectory = Poco::Path::transcode(m_WorkingDirectory);
+
+    if (!extracted)
+    {
+      return storage;
+    }
+  }
+  else
   {
-    MITK_ERROR << "Could not open/read/parse " << m_WorkingDirectory << mitk::IOUtil::GetDirectorySeparator()
-               << "index.xml\nTinyXML reports: " << document.ErrorDesc() << std::endl;
-    return storage;
+    // unzip all filenames contents to temp dir
+    m_UnzipErrors = 0;
+    Poco::Zip::Decompress unzipper(file, Poco::Path(m_WorkingDirectory));
+    unzipper.EError += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
+      this, &SceneIO::OnUnzipError);
+    unzipper.EOk += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
+      this, &SceneIO::OnUnzipOk);
+    unzipper.decompressAllFiles();
+    unzipper.EError -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
+      this, &SceneIO::OnUnzipError);
+    unzipper.EOk -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
+      this, &SceneIO::OnUnzipOk);
+
+    if (m_UnzipErrors)
+    {
+      MITK_ERROR << "There were " << m_UnzipErrors << " errors unzipping '" << filename
+                 << "'. Will attempt to read whatever could be unzipped.";
+    }
+
+    // transcode locale-dependent string
+    m_WorkingDirectory = Poco::Path::transcode (m_WorkingDirectory);
+
+    // test if index.xml exists
+    // parse index.xml with TinyXML
+    if (!document.LoadFile(m_WorkingDirectory + mitk::IOUtil::GetDirectorySeparator() + "index.xml"))
+    {
+      MITK_ERROR << "Could not open/read/parse " << m_WorkingDirectory << mitk::IOUtil::GetDirectorySeparator()
+                 << "index.xml\nTinyXML reports: " << document.ErrorDesc() << std::endl;
+      return storage;
+    }
   }
 
   SceneReader::Pointer reader = SceneReader::New();
@@ -186,6 +284,114 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
   return storage;
 }
 
+bool mitk::SceneIO::ExtractSceneContainer(const std::string &filename,
+                                          TiXmlDocument &document,
+                                          const std::set<std::string> *nodeUIDs)
+{
+  SceneContainer::Pointer container = SceneContainer::New();
+  std::string description;
+  try
+  {
+    container->Open(filename);
+    description = container->ReadEntry("index.xml");
+  }
+  catch (std::exception &e)
+  {
+    MITK_ERROR << "Could not read scene container " << filename << ": " << e.what();
+    return false;
+  }
+
+  document.Parse(description.c_str());
+  if (document.Error())
+  {
+    MITK_ERROR << "Could not parse index.xml of " << filename << "\nTinyXML reports: " << document.ErrorDesc();
+    return false;
+  }
+
+  if (nodeUIDs != nullptr)
+  {
+    // the scene reader only sees the requested nodes
+    TiXmlElement *nodeElement = document.FirstChildElement("node");
+    while (nodeElement != nullptr)
+    {
+      TiXmlElement *nextNodeElement = nodeElement->NextSiblingElement("node");
+      const char *uid = nodeElement->Attribute("UID");
+      if (uid == nullptr || nodeUIDs->count(uid) == 0)
+      {
+        document.RemoveChild(nodeElement);
+      }
+      nodeElement = nextNodeElement;
+    }
+  }
+
+  // collect the files of data objects and property lists
+  std::vector<std::string> entries;
+  auto addEntry = [&](TiXmlElement *element) {
+    const char *file = element->Attribute("file");
+    if (file && strlen(file) != 0)
+    {
+      entries.push_back(file);
+    }
+  };
+
+  for (TiXmlElement *nodeElement = document.FirstChildElement("node"); nodeElement != nullptr;
+       nodeElement = nodeElement->NextSiblingElement("node"))
+  {
+    if (TiXmlElement *dataElement = nodeElement->FirstChildElement("data"))
+    {
+      addEntry(dataElement);
+      for (TiXmlElement *properties = dataElement->FirstChildElement("properties"); properties != nullptr;
+           properties = properties->NextSiblingElement("properties"))
+      {
+        addEntry(properties);
+      }
+    }
+
+    for (TiXmlElement *properties = nodeElement->FirstChildElement("properties"); properties != nullptr;
+         properties = properties->NextSiblingElement("properties"))
+    {
+      addEntry(properties);
+    }
+  }
+
+  std::set<std::string> nodeDirectories;
+  for (const auto &entry : entries)
+  {
+    auto separatorPosition = entry.find_last_of('/');
+    if (separatorPosition != std::string::npos)
+    {
+      nodeDirectories.insert(entry.substr(0, separatorPosition));
+    }
+  }
+
+  for (const auto &nodeDirectory : nodeDirectories)
+  {
+    Poco::File(m_WorkingDirectory + Poco::Path::separator() + nodeDirectory).createDirectories();
+  }
+
+  std::atomic<unsigned int> extractionErrors(0);
+  mitk::ParallelFor(entries.size(), [&](std::size_t index) {
+    try
+    {
+      container->ExtractEntry(entries[index],
+                              Poco::Path::transcode(m_WorkingDirectory + Poco::Path::separator() + entries[index]));
+    }
+    catch (std::exception &e)
+    {
+      ++extractionErrors;
+      MITK_ERROR << "Error while extracting " << entries[index] << ": " << e.what();
+    }
+  });
+
+  if (extractionErrors)
+  {
+    MITK_ERROR << "There were " << extractionErrors.load() << " errors extracting '" << filename
+               << "'. Will attempt to read whatever could be extracted.";
+  }
+
+  return true;
+}
+
 bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes,
                               const DataStorage *storage,
                               const std::string &filename)
@@ -231,6 +437,8 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
 
     // DataStorage::SetOfObjects::ConstPointer sceneNodes = storage->GetSubset( predicate );
 
+    SceneContainer::Pointer container;
+
     if (sceneNodes.IsNull())
     {
       MITK_WARN << "Saving empty scene to " << filename;
@@ -293,94 +501,182 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
         }
       }
 
+      if (m_UseSceneContainer)
+      {
+        container = SceneContainer::New();
+        container->Create(filename, m_CompressSceneContainer);
+      }
+
       // write out objects, dependencies and properties
+      // nodes are serialized concurrently, each one into a sub directory named after its UID
+      std::vector<DataNode *> nodes;
       for (auto iter = sceneNodes->begin(); iter != sceneNodes->end(); ++iter)
       {
-        DataNode *node = iter->GetPointer();
+        nodes.push_back(iter->GetPointer());
+      }
+
+      std::vector<TiXmlElement *> nodeElements(nodes.size(), nullptr);
+      std::vector<PropertyList::Pointer> failedProperties(nodes.size());
+      std::vector<char> failedNodes(nodes.size(), 0);
+
+      auto saveNode = [&](std::size_t index) {
+        DataNode *node = nodes[index];
+        if (!node)
+          return;
+
+        const std::string &nodeUID = nodeUIDs.find(node)->second;
+        const std::string nodePath = m_WorkingDirectory + Poco::Path::separator() + nodeUID;
+        Poco::File(nodePath).createDirectories();
+
+        failedProperties[index] = PropertyList::New();
 
-        if (node)
+        auto *nodeElement = new TiXmlElement("node");
+        std::string filenameHint(node->GetName());
+        filenameHint = itksys::SystemTools::MakeCindentifier(
+          filenameHint.c_str()); // escape filename <-- only allow [A-Za-z0-9_], replace everything else with _
+
+        // store this node's ID
+        nodeElement->SetAttribute("UID", nodeUID.c_str());
+
+        // store dependencies
+        auto searchSourcesIter = sourceUIDs.find(node);
+        if (searchSourcesIter != sourceUIDs.end())
         {
-          auto *nodeElement = new TiXmlElement("node");
-          std::string filenameHint(node->GetName());
-          filenameHint = itksys::SystemTools::MakeCindentifier(
-            filenameHint.c_str()); // escape filename <-- only allow [A-Za-z0-9_], replace everything else with _
-
-          // store dependencies
-          auto searchUIDIter = nodeUIDs.find(node);
-          if (searchUIDIter != nodeUIDs.end())
+          // store all source IDs
+          for (auto sourceUIDIter = searchSourcesIter->second.begin();
+               sourceUIDIter != searchSourcesIter->second.end();
+               ++sourceUIDIter)
+          {
+            auto *uidElement = new TiXmlElement("source");
+            uidElement->SetAttribute("UID", sourceUIDIter->c_str());
+            nodeElement->LinkEndChild(uidElement);
+          }
+        }
+
+        // store basedata
+        if (BaseData *data = node->GetData())
+        {
+          bool error(false);
+          TiXmlElement *dataElement(
+            SaveBaseData(data, filenameHint, nodeUID, error)); // returns a reference to a file
+          if (error)
+          {
+            failedNodes[index] = 1;
+          }
+
+          // store basedata properties
+          PropertyList *propertyList = data->GetPropertyList();
+          if (propertyList && !propertyList->IsEmpty())
           {
-            // store this node's ID
-            nodeElement->SetAttribute("UID", searchUIDIter->second.c_str());
+            TiXmlElement *baseDataPropertiesElement(SavePropertyList(
+              propertyList, filenameHint + "-data", nodeUID, failedProperties[index])); // returns a reference to a file
+            dataElement->LinkEndChild(baseDataPropertiesElement);
           }
 
-          auto searchSourcesIter = sourceUIDs.find(node);
-          if (searchSourcesIter != sourceUIDs.end())
+          nodeElement->LinkEndChild(dataElement);
+        }
+
+        // store all renderwindow specific propertylists
+        mitk::DataNode::PropertyListKeyNames propertyListKeys = node->GetPropertyListNames();
+        for (auto renderWindowName : propertyListKeys)
+        {
+          PropertyList *propertyList = node->GetPropertyList(renderWindowName);
+          if (propertyList && !propertyList->IsEmpty())
           {
-            // store all source IDs
-            for (auto sourceUIDIter = searchSourcesIter->second.begin();
-                 sourceUIDIter != searchSourcesIter->second.end();
-                 ++sourceUIDIter)
-            {
-              auto *uidElement = new TiXmlElement("source");
-              uidElement->SetAttribute("UID", sourceUIDIter->c_str());
-              nodeElement->LinkEndChild(uidElement);
-            }
+            TiXmlElement *renderWindowPropertiesElement(
+              SavePropertyList(propertyList,
+                               filenameHint + "-" + renderWindowName,
+                               nodeUID,
+                               failedProperties[index])); // returns a reference to a file
+            renderWindowPropertiesElement->SetAttribute("renderwindow", renderWindowName);
+            nodeElement->LinkEndChild(renderWindowPropertiesElement);
           }
+        }
+
+        // don't forget the renderwindow independent list
+        PropertyList *propertyList = node->GetPropertyList();
+        if (propertyList && !propertyList->IsEmpty())
+        {
+          TiXmlElement *propertiesElement(SavePropertyList(
+            propertyList, filenameHint + "-node", nodeUID, failedProperties[index])); // returns a reference to a file
+          nodeElement->LinkEndChild(propertiesElement);
+        }
 
-          // store basedata
-          if (BaseData *data = node->GetData())
+        nodeElements[index] = nodeElement;
+
+        // stream the files of this node into the container right away
+        if (container.IsNotNull())
+        {
+          std::vector<std::string> nodeFiles;
+          Poco::File(nodePath).list(nodeFiles);
+          for (const auto &nodeFile : nodeFiles)
           {
-            // std::string filenameHint( node->GetName() );
-            bool error(false);
-            TiXmlElement *dataElement(SaveBaseData(data, filenameHint, error)); // returns a reference to a file
-            if (error)
-            {
-              m_FailedNodes->push_back(node);
-            }
-
-            // store basedata properties
-            PropertyList *propertyList = data->GetPropertyList();
-            if (propertyList && !propertyList->IsEmpty())
-            {
-              TiXmlElement *baseDataPropertiesElement(
-                SavePropertyList(propertyList, filenameHint + "-data")); // returns a reference to a file
-              dataElement->LinkEndChild(baseDataPropertiesElement);
-            }
-
-            nodeElement->LinkEndChild(dataElement);
+            container->AddFile(nodeUID + "/" + nodeFile,
+                               Poco::Path::transcode(nodePath + Poco::Path::separator() + nodeFile));
           }
 
-          // store all renderwindow specific propertylists
-          mitk::DataNode::PropertyListKeyNames propertyListKeys = node->GetPropertyListNames();
-          for (auto renderWindowName : propertyListKeys)
+          Poco::File(nodePath).remove(true);
+        }
+      };
+
+      // the progress bar is only updated from the calling thread, which takes part in saving the nodes
+      const std::thread::id callingThread = std::this_thread::get_id();
+      std::atomic<unsigned int> savedNodes(0);
+      unsigned int reportedNodes = 0;
+
+      auto reportProgress = [&]() {
+        const unsigned int saved = savedNodes;
+        if (saved > reportedNodes)
+        {
+          ProgressBar::GetInstance()->Progress(saved - reportedNodes);
+          reportedNodes = saved;
+        }
+      };
+
+      try
+      {
+        mitk::ParallelFor(nodes.size(), [&](std::size_t index) {
+          saveNode(index);
+          ++savedNodes;
+
+          if (std::this_thread::get_id() == callingThread)
+            reportProgress();
+        });
+      }
+      catch (...)
+      {
+        for (auto nodeElement : nodeElements)
+        {
+          delete nodeElement;
+        }
+        throw;
+      }
+
+      for (std::size_t index = 0; index < nodes.size(); ++index)
+      {
+        if (nodeElements[index])
+        {
+          document.LinkEndChild(nodeElements[index]);
+
+          if (failedNodes[index])
           {
-            PropertyList *propertyList = node->GetPropertyList(renderWindowName);
-            if (propertyList && !propertyList->IsEmpty())
-            {
-              TiXmlElement *renderWindowPropertiesElement(
-                SavePropertyList(propertyList, filenameHint + "-" + renderWindowName)); // returns a reference to a file
-              renderWindowPropertiesElement->SetAttribute("renderwindow", renderWindowName);
-              nodeElement->LinkEndChild(renderWindowPropertiesElement);
-            }
+            m_FailedNodes->push_back(nodes[index]);
           }
 
-          // don't forget the renderwindow independent list
-          PropertyList *propertyList = node->GetPropertyList();
-          if (propertyList && !propertyList->IsEmpty())
+          if (!failedProperties[index]->IsEmpty())
           {
-            TiXmlElement *propertiesElement(
-              SavePropertyList(propertyList, filenameHint + "-node")); // returns a reference to a file
-            nodeElement->LinkEndChild(propertiesElement);
+            // move failed properties to global list
+            m_FailedProperties->ConcatenatePropertyList(failedProperties[index], true);
           }
-          document.LinkEndChild(nodeElement);
         }
         else
         {
           MITK_WARN << "Ignoring nullptr node during scene serialization.";
         }
+      }
 
-        ProgressBar::GetInstance()->Progress();
-      } // end for all nodes
+      // nodes finished by other threads after the last node of the calling thread
+      reportProgress();
     }   // end if sceneNodes
 
     std::string defaultLocale_WorkingDirectory = Poco::Path::transcode( m_WorkingDirectory );
@@ -395,6 +691,16 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
     {
       try
       {
+        if (container.IsNotNull())
+        {
+          // node files have already been streamed into the container
+          container->AddFile("index.xml", defaultLocale_WorkingDirectory + Poco::Path::separator() + "index.xml");
+          container->Close();
+          Poco::File deleteDir(m_WorkingDirectory);
+          deleteDir.remove(true); // recursive
+          return true;
+        }
+
         Poco::File deleteFile(filename.c_str());
         if (deleteFile.exists())
         {
@@ -428,7 +734,7 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
       }
       catch (std::exception &e)
       {
-        MITK_ERROR << "Could not create ZIP file from " << m_WorkingDirectory << "\nReason: " << e.what();
+        MITK_ERROR << "Could not create scene file from " << m_WorkingDirectory << "\nReason: " << e.what();
         return false;
       }
       return true;
@@ -441,7 +747,10 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
   }
 }
 
-TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &filenamehint, bool &error)
+TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data,
+                                          const std::string &filenamehint,
+                                          const std::string &nodeDirectory,
+                                          bool &error)
 {
   assert(data);
   error = true;
@@ -473,12 +782,17 @@ TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &fil
     {
       serializer->SetData(data);
       serializer->SetFilenameHint(filenamehint);
-      std::string defaultLocale_WorkingDirectory = Poco::Path::transcode( m_WorkingDirectory );
+      std::string defaultLocale_WorkingDirectory =
+        Poco::Path::transcode(m_WorkingDirectory + Poco::Path::separator() + nodeDirectory);
       serializer->SetWorkingDirectory(defaultLocale_WorkingDirectory);
+      if (auto *imageSerializer = dynamic_cast<ImageSerializer *>(serializer))
+      {
+        imageSerializer->SetUseChunkedImageFormat(m_UseChunkedImageFormat);
+      }
       try
       {
         std::string writtenfilename = serializer->Serialize();
-        element->SetAttribute("file", writtenfilename);
+        element->SetAttribute("file", writtenfilename.empty() ? writtenfilename : nodeDirectory + "/" + writtenfilename);
         error = false;
       }
       catch (std::exception &e)
@@ -492,7 +806,10 @@ TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &fil
   return element;
 }
 
-TiXmlElement *mitk::SceneIO::SavePropertyList(PropertyList *propertyList, const std::string &filenamehint)
+TiXmlElement *mitk::SceneIO::SavePropertyList(PropertyList *propertyList,
+                                              const std::string &filenamehint,
+                                              const std::string &nodeDirectory,
+                                              PropertyList *failedProperties)
 {
   assert(propertyList);
 
@@ -504,17 +821,18 @@ TiXmlElement *mitk::SceneIO::SavePropertyList(PropertyList *propertyList, const
 
   serializer->SetPropertyList(propertyList);
   serializer->SetFilenameHint(filenamehint);
-  std::string defaultLocale_WorkingDirectory = Poco::Path::transcode( m_WorkingDirectory );
+  std::string defaultLocale_WorkingDirectory =
+    Poco::Path::transcode(m_WorkingDirectory + Poco::Path::separator() + nodeDirectory);
   serializer->SetWorkingDirectory(defaultLocale_WorkingDirectory);
   try
   {
     std::string writtenfilename = serializer->Serialize();
-    element->SetAttribute("file", writtenfilename);
-    PropertyList::Pointer failedProperties = serializer->GetFailedProperties();
-    if (failedProperties.IsNotNull())
+    element->SetAttribute("file", writtenfilename.empty() ? writtenfilename : nodeDirectory + "/" + writtenfilename);
+    PropertyList::Pointer serializerFailedProperties = serializer->GetFailedProperties();
+    if (serializerFailedProperties.IsNotNull())
     {
-      // move failed properties to global list
-      m_FailedProperties->ConcatenatePropertyList(failedProperties, true);
+      // move failed properties to the list of this node
+      failedProperties->ConcatenatePropertyList(serializerFailedProperties, true);
     }
   }
   catch (std::exception &e)
@@ -82,13 +82,68 @@ class mitkSceneIOTest2Suite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkSceneIOTest2Suite);
   MITK_TEST(Test_SceneIOInterfaces);
   MITK_TEST(Test_ReconstructionOfScenes);
+  MITK_TEST(Test_ReconstructionOfScenesFromSceneContainer);
+  MITK_TEST(Test_ReconstructionOfScenesFromCompressedSceneContainer);
+  MITK_TEST(Test_ReconstructionOfScenesWithChunkedImages);
+  MITK_TEST(Test_LoadSingleNodesFromSceneContainer);
   CPPUNIT_TEST_SUITE_END();
 
   mitk::SceneIOTestScenarioProvider m_TestCaseProvider;
 
 public:
   void Test_SceneIOInterfaces() { CPPUNIT_ASSERT_MESSAGE("Not urgent", true); }
-  void Test_ReconstructionOfScenes()
+  void Test_ReconstructionOfScenes() { this->ReconstructScenes(false, false, false); }
+  void Test_ReconstructionOfScenesFromSceneContainer() { this->ReconstructScenes(true, false, false); }
+  void Test_ReconstructionOfScenesFromCompressedSceneContainer() { this->ReconstructScenes(true, true, false); }
+  void Test_ReconstructionOfScenesWithChunkedImages() { this->ReconstructScenes(false, false, true); }
+
+  void Test_LoadSingleNodesFromSceneContainer()
+  {
+    std::string tempDir = mitk::IOUtil::CreateTemporaryDirectory("SceneIOTest_XXXXXX");
+
+    for (auto scenario : m_TestCaseProvider.GetAllScenarios())
+    {
+      if (!scenario.serializable)
+        continue;
+
+      MITK_TEST_OUTPUT(<< "\n===== Test_LoadSingleNodesFromSceneContainer, scenario '" << scenario.key << "' =====");
+
+      std::string archiveFilename = mitk::IOUtil::CreateTemporaryFile("scene_XXXXXX.mitk", tempDir);
+      mitk::SceneIO::Pointer writer = mitk::SceneIO::New();
+      writer->SetUseSceneContainer(true);
+      mitk::DataStorage::Pointer originalStorage = scenario.BuildDataStorage();
+      CPPUNIT_ASSERT(writer->SaveScene(originalStorage->GetAll(), originalStorage, archiveFilename));
+
+      mitk::SceneIO::Pointer reader = mitk::SceneIO::New();
+      std::vector<std::string> nodeUIDs = reader->GetSceneNodeUIDs(archiveFilename);
+      CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(originalStorage->GetAll()->Size()), nodeUIDs.size());
+
+      // zip archives have no index
+      std::string zipFilename = mitk::IOUtil::CreateTemporaryFile("scene_XXXXXX.mitk", tempDir);
+      writer->SetUseSceneContainer(false);
+      CPPUNIT_ASSERT(writer->SaveScene(originalStorage->GetAll(), originalStorage, zipFilename));
+      CPPUNIT_ASSERT(reader->GetSceneNodeUIDs(zipFilename).empty());
+
+      if (nodeUIDs.empty())
+        continue;
+
+      mitk::DataStorage::Pointer singleNodeStorage =
+        reader->LoadSceneNodes(archiveFilename, std::vector<std::string>(1, nodeUIDs.front()));
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Only the requested node is loaded", 1u, singleNodeStorage->GetAll()->Size());
+
+      mitk::DataStorage::Pointer restoredStorage = reader->LoadSceneNodes(archiveFilename, nodeUIDs);
+      CPPUNIT_ASSERT_MESSAGE(std::string("Comparing test scenario '") + scenario.key + "' restored node by node",
+                             mitk::DataStorageCompare(originalStorage,
+                                                      restoredStorage,
+                                                      mitk::DataStorageCompare::CMP_Hierarchy |
+                                                        mitk::DataStorageCompare::CMP_Data |
+                                                        mitk::DataStorageCompare::CMP_Properties,
+                                                      scenario.comparisonPrecision)
+                               .CompareVerbose());
+    }
+  }
+
+  void ReconstructScenes(bool useSceneContainer, bool compressSceneContainer, bool useChunkedImageFormat)
   {
     std::string tempDir = mitk::IOUtil::CreateTemporaryDirectory("SceneIOTest_XXXXXX");
 
@@ -100,6 +155,9 @@ public:
 
       std::string archiveFilename = mitk::IOUtil::CreateTemporaryFile("scene_XXXXXX.mitk", tempDir);
       mitk::SceneIO::Pointer writer = mitk::SceneIO::New();
+      writer->SetUseSceneContainer(useSceneContainer);
+      writer->SetCompressSceneContainer(compressSceneContainer);
+      writer->SetUseChunkedImageFormat(useChunkedImageFormat);
       mitk::DataStorage::Pointer originalStorage = scenario.BuildDataStorage();
       CPPUNIT_ASSERT_MESSAGE(
         std::string("Save test scenario '") + scenario.key + "' to '" + archiveFilename + "'",